@@ -726,6 +726,7 @@ rm -rf $RPM_BUILD_ROOT
 %exclude %{_bindir}/sjobexitmod
 %exclude %{_bindir}/sjstat
 %exclude %{_bindir}/smail
+%{_sbindir}/slurmcached
 %{_sbindir}/slurmctld
 %{_sbindir}/slurmd
 %{_sbindir}/slurmstepd
@@ -742,6 +743,7 @@ rm -rf $RPM_BUILD_ROOT
 %{_mandir}/man5/nonstop.*
 %{_mandir}/man5/slurm.*
 %{_mandir}/man5/topology.*
+%{_mandir}/man8/slurmcached.*
 %{_mandir}/man8/slurmctld.*
 %{_mandir}/man8/slurmd.*
 %{_mandir}/man8/slurmstepd*
@@ -267,12 +267,18 @@ typedef struct {
 	List cluster_list;	/* list of char * */
 	uint32_t cpus_max;      /* number of cpus high range */
 	uint32_t cpus_min;      /* number of cpus low range */
+	char *cursor_cluster;	/* with page_size, return jobs after this
+				 * cluster and job id, set by
+				 * slurmdb_jobs_get() */
+	uint32_t cursor_jobid;	/* with page_size, see cursor_cluster */
 	uint16_t duplicates;    /* report duplicate job entries */
 	int32_t exitcode;       /* exit code of job */
 	List groupid_list;	/* list of char * */
 	List jobname_list;	/* list of char * */
 	uint32_t nodes_max;     /* number of nodes high range */
 	uint32_t nodes_min;     /* number of nodes low range */
+	uint32_t page_size;	/* if set, return jobs from at most this many
+				 * job ids per call, 0 for all jobs */
 	List partition_list;	/* list of char * */
 	List qos_list;  	/* list of char * */
 	List resv_list;		/* list of char * */
@@ -348,7 +354,9 @@ typedef struct {
 typedef struct {
 	uint64_t alloc_secs; /* number of cpu seconds allocated */
 	uint32_t id;	/* association/wckey ID		*/
-	time_t period_start; /* when this record was started */
+	time_t period_start; /* when this record was started, records of
+			      * associations and wckeys got with_usage
+			      * cover the whole usage period */
 	slurmdb_tres_rec_t tres_rec;
 } slurmdb_accounting_rec_t;
 
@@ -764,6 +772,8 @@ typedef struct {
 } slurmdb_job_rec_t;
 
 typedef struct {
+	void *acct_limit_hash; /* index of acct_limit_list by account
+				* name (DON'T PACK) */
 	List acct_limit_list; /* slurmdb_used_limits_t's (DON'T PACK
 			       * for state file) */
 	List job_list; /* list of job pointers to submitted/running
@@ -787,6 +797,8 @@ typedef struct {
 
 	long double *usage_tres_raw; /* measure of each TRES usage (DON'T
 				      * PACK for state file)*/
+	void *user_limit_hash; /* index of user_limit_list by uid
+				* (DON'T PACK) */
 	List user_limit_list; /* slurmdb_used_limits_t's (DON'T PACK
 			       * for state file) */
 } slurmdb_qos_usage_t;
@@ -1200,11 +1212,15 @@ typedef struct {
 #define ROLLUP_MONTH	2
 #define ROLLUP_COUNT	3
 typedef struct rollup_stats {
+	uint32_t rollup_hours;		/* hours of usage rolled up */
+	time_t rollup_last_hour;	/* end of the last hour rolled up */
 	uint32_t rollup_time[ROLLUP_COUNT];
 } rollup_stats_t;
 
 typedef struct {
 	uint16_t *rollup_count;		/* Length should be ROLLUP_COUNT */
+	uint64_t rollup_hours;		/* hours of usage rolled up */
+	time_t rollup_last_hour;	/* end of the last hour rolled up */
 	uint64_t *rollup_time;		/* Length should be ROLLUP_COUNT */
 	uint64_t *rollup_max_time;	/* Length should be ROLLUP_COUNT */
 
@@ -1498,6 +1514,9 @@ extern List slurmdb_events_get(void *db_conn,
  * get info from the storage
  * returns List of slurmdb_job_rec_t *
  * note List needs to be freed with slurm_list_destroy() when called
+ * If job_cond->page_size is set only the next page of jobs is returned and
+ * the cursor in job_cond is moved past it, call again until an empty List
+ * is returned to get all jobs.
  */
 extern List slurmdb_jobs_get(void *db_conn, slurmdb_job_cond_t *job_cond);
 
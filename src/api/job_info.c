@@ -1004,6 +1004,25 @@ slurm_sprint_job_info ( job_info_t * job_ptr, int one_liner )
 extern int
 slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 		 uint16_t show_flags)
+{
+	return slurm_load_jobs_filter(update_time, job_info_msg_pptr,
+				      show_flags, NULL);
+}
+
+/*
+ * slurm_load_jobs_filter - issue RPC to get slurm information about the jobs
+ *	matching a filter if changed since update_time. The filtering is done
+ *	by slurmctld, so only the matching jobs are sent.
+ * IN update_time - time of current configuration data
+ * IN/OUT job_info_msg_pptr - place to store a job configuration pointer
+ * IN show_flags -  job filtering option: 0, SHOW_ALL or SHOW_DETAIL
+ * IN filter - jobs to report, NULL for all jobs
+ * RET 0 or -1 on error
+ * NOTE: free the response using slurm_free_job_info_msg
+ */
+extern int
+slurm_load_jobs_filter(time_t update_time, job_info_msg_t **job_info_msg_pptr,
+		       uint16_t show_flags, job_info_filter_t *filter)
 {
 	int rc;
 	slurm_msg_t resp_msg;
@@ -1015,6 +1034,7 @@ slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 
 	req.last_update  = update_time;
 	req.show_flags   = show_flags;
+	req.filter       = filter;
 	req_msg.msg_type = REQUEST_JOB_INFO;
 	req_msg.data     = &req;
 
@@ -47,6 +47,7 @@
 #include <stdlib.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -77,6 +78,23 @@
 
 #define MAX_THREADS      8	/* These can be huge messages, so
 				 * only run MAX_THREADS at one time */
+#define DEFAULT_WINDOW   4	/* Blocks in flight by default */
+#define MAX_WINDOW      16	/* Maximum blocks in flight */
+
+/* Shared by the threads broadcasting blocks of one file */
+typedef struct {
+	file_bcast_msg_t *bcast_msg;	/* fields common to all blocks */
+	struct bcast_parameters *params;
+	pthread_mutex_t lock;		/* protects fields below */
+	uint32_t block_no;		/* number of next block */
+	bool last_claimed;		/* last block read */
+	off_t offset;			/* file offset of next block */
+	int rc;				/* first error */
+	uint64_t size_compressed;	/* bytes sent */
+	uint64_t size_uncompressed;	/* bytes read */
+	uint64_t time_read;		/* usec reading and compressing */
+	uint64_t time_send;		/* usec waiting for block RPCs */
+} bcast_state_t;
 
 int block_len;				/* block size */
 int fd;					/* source file descriptor */
@@ -204,65 +222,40 @@ static int _file_bcast(struct bcast_parameters *params,
 	return rc;
 }
 
-/* load a buffer with data from the file to broadcast,
- * return number of bytes read, zero on end of file */
-static int _get_block_none(char **buffer, int *orig_len, bool *more)
+/* Point a block at the next part of the mmap'd file, no copy is needed
+ * since the message is packed from it directly.
+ * return number of bytes in the block */
+static int _get_block_none(void *position, int remaining, char **buffer,
+			   int *orig_len)
 {
-	static int remaining = -1;
-	static void *position;
-	int size;
-
-	if (remaining < 0) {
-		*buffer = xmalloc(block_len);
-		remaining = f_stat.st_size;
-		position = src;
-	}
-
-	size = MIN(block_len, remaining);
-	memcpy(*buffer, position, size);
-	remaining -= size;
-	position += size;
+	int size = MIN(block_len, remaining);
 
+	*buffer = position;
 	*orig_len = size;
-	*more = (remaining) ? true : false;
 	return size;
 }
 
-static int _get_block_zlib(struct bcast_parameters *params,
-			   char **buffer,
-			   int *orig_len,
-			   bool *more)
+/* Compress the next block_len bytes of the file, each block independently.
+ * return number of bytes in the compressed block */
+static int _get_block_zlib(void *position, int remaining, char **buffer,
+			   int *orig_len)
 {
 #if HAVE_LIBZ
-	static z_stream strm;
+	z_stream strm;
 	int chunk = (256 * 1024);
 	int flush = Z_NO_FLUSH;
+	int max_out, chunk_remaining, out_remaining, chunk_bite, size = 0;
 
-	static int remaining = -1;
-	static int max_out;
-	static void *position;
-	int chunk_remaining, out_remaining, chunk_bite, size = 0;
-
-	/* allocate deflate state, compress each block independently */
 	strm.zalloc = Z_NULL;
 	strm.zfree = Z_NULL;
 	strm.opaque = Z_NULL;
 	strm.avail_in = 0;
 	strm.next_in = Z_NULL;
-	if (deflateInit(&strm, Z_DEFAULT_COMPRESSION) != Z_OK) {
-		error("File compression configuration error,"
-		      "sending uncompressed file.");
-		params->compress = 0;
-		return _get_block_none(buffer, orig_len, more);
-	}
+	if (deflateInit(&strm, Z_DEFAULT_COMPRESSION) != Z_OK)
+		return -1;
 
-	/* first pass through, initialize */
-	if (remaining < 0) {
-		remaining = f_stat.st_size;
-		max_out = deflateBound(&strm, block_len);
-		*buffer = xmalloc(max_out);
-		position = src;
-	}
+	max_out = deflateBound(&strm, block_len);
+	*buffer = xmalloc(max_out);
 
 	chunk_remaining = MIN(block_len, remaining);
 	out_remaining = max_out;
@@ -284,96 +277,189 @@ static int _get_block_zlib(struct bcast_parameters *params,
 		chunk_remaining -= chunk_bite;
 		out_remaining = strm.avail_out;
 	}
-	remaining -= size;
 
 	(void) deflateEnd(&strm);
 
 	*orig_len = size;
-	*more = (remaining) ? true : false;
 	return (max_out - out_remaining);
 #else
-	info("zlib compression not supported, sending uncompressed file.");
-	params->compress = 0;
-	return _get_block_none(buffer, orig_len, more);
+	return -1;
 #endif
 }
 
-static int _get_block_lz4(struct bcast_parameters *params,
-			  char **buffer,
-			  int32_t *orig_len,
-			  bool *more)
+/* Compress as much of the file as fits in block_len bytes. The amount of
+ * file consumed is only known afterwards, so blocks must be compressed in
+ * order. return number of bytes in the compressed block */
+static int _get_block_lz4(void *position, int remaining, char **buffer,
+			  int *orig_len)
 {
 #if HAVE_LZ4
 	int size_out;
-	static int remaining = -1;
-	static void *position;
 	int size;
 
-	if (!f_stat.st_size) {
-		*more = false;
-		return 0;
-	}
-
-	if (remaining < 0) {
-		position = src;
-		remaining = f_stat.st_size;
-		*buffer = xmalloc(block_len);
-	}
-
+	*buffer = xmalloc(block_len);
 	/* intentionally limit decompressed size to 10x compressed
 	 * to avoid problems on receive size when decompressed */
 	size = MIN(block_len * 10, remaining);
-	if (!(size_out = LZ4_compress_destSize(position, *buffer,
-					       &size, block_len))) {
+	if (size && !(size_out = LZ4_compress_destSize(position, *buffer,
+							&size, block_len))) {
 		/* compression failure */
 		fatal("LZ4 compression error");
 	}
-	position += size;
-	remaining -= size;
+	if (!size)
+		size_out = 0;
 
 	*orig_len = size;
-	*more = (remaining) ? true : false;
 	return size_out;
 #else
-	info("lz4 compression not supported, sending uncompressed file.");
-	params->compress = 0;
-	return _get_block_none(buffer, orig_len, more);
+	return -1;
 #endif
+}
+
+/* Read, compress and broadcast the next block of the file.
+ * RET false once the last block was claimed or an error occurred */
+static bool _bcast_block(bcast_state_t *state)
+{
+	file_bcast_msg_t bcast_msg;
+	char *buffer = NULL;
+	void *position;
+	int remaining, orig_len = 0, block_size, rc;
+	bool more;
+	DEF_TIMERS;
+
+	slurm_mutex_lock(&state->lock);
+	if (state->last_claimed || state->rc) {
+		slurm_mutex_unlock(&state->lock);
+		return false;
+	}
+	memcpy(&bcast_msg, state->bcast_msg, sizeof(file_bcast_msg_t));
+	bcast_msg.block_no = state->block_no++;
+	bcast_msg.block_offset = state->offset;
+	position = src + state->offset;
+	/* No block ever consumes more than 10x block_len of the file */
+	remaining = MIN(f_stat.st_size - state->offset, (off_t) block_len * 10);
+
+	START_TIMER;
+	if (bcast_msg.compress == COMPRESS_LZ4) {
+		/* Compressed under the lock, the next block starts where
+		 * this one ends */
+		block_size = _get_block_lz4(position, remaining, &buffer,
+					    &orig_len);
+	} else {
+		block_size = 0;
+		orig_len = MIN(block_len, remaining);
+	}
+	END_TIMER;
+	state->time_read += DELTA_TIMER;
+	state->offset += orig_len;
+	if (state->offset >= f_stat.st_size) {
+		bcast_msg.last_block = 1;
+		state->last_claimed = true;
+	}
+	more = !state->last_claimed;
+	slurm_mutex_unlock(&state->lock);
+
+	START_TIMER;
+	if (bcast_msg.compress == COMPRESS_ZLIB) {
+		block_size = _get_block_zlib(position, remaining, &buffer,
+					     &orig_len);
+		if (block_size < 0) {
+			error("File compression configuration error, "
+			      "sending uncompressed block.");
+			bcast_msg.compress = COMPRESS_OFF;
+		}
+	}
+	if (bcast_msg.compress == COMPRESS_OFF)
+		block_size = _get_block_none(position, remaining, &buffer,
+					     &orig_len);
+	bcast_msg.block_cksum = bcast_block_cksum(position, orig_len);
+	END_TIMER;
+
+	bcast_msg.block_len = block_size;
+	bcast_msg.uncomp_len = orig_len;
+	bcast_msg.block = buffer;
+	debug("block %u, size %u", bcast_msg.block_no, bcast_msg.block_len);
+
+	slurm_mutex_lock(&state->lock);
+	state->time_read += DELTA_TIMER;
+	state->size_uncompressed += orig_len;
+	state->size_compressed += block_size;
+	slurm_mutex_unlock(&state->lock);
+
+	START_TIMER;
+	rc = _file_bcast(state->params, &bcast_msg, sbcast_cred);
+	END_TIMER;
+
+	if (bcast_msg.compress != COMPRESS_OFF)
+		xfree(buffer);
+
+	slurm_mutex_lock(&state->lock);
+	state->time_send += DELTA_TIMER;
+	if (rc != SLURM_SUCCESS)
+		state->rc = MAX(state->rc, rc);
+	if (state->rc)
+		more = false;
+	slurm_mutex_unlock(&state->lock);
+
+	return more;
+}
 
+static void *_bcast_thread(void *arg)
+{
+	bcast_state_t *state = (bcast_state_t *) arg;
+
+	while (_bcast_block(state))
+		;
+
+	return NULL;
 }
 
-static int _next_block(struct bcast_parameters *params,
-		       char **buffer,
-		       int32_t *orig_len,
-		       bool *more)
+/* Check that the requested compression library is available */
+static uint16_t _valid_compress(uint16_t compress)
 {
-	switch(params->compress) {
+	switch (compress) {
 	case COMPRESS_OFF:
-		return _get_block_none(buffer, orig_len, more);
+		return compress;
 	case COMPRESS_ZLIB:
-		return _get_block_zlib(params, buffer, orig_len, more);
+#if HAVE_LIBZ
+		return compress;
+#else
+		info("zlib compression not supported, sending uncompressed file.");
+		return COMPRESS_OFF;
+#endif
 	case COMPRESS_LZ4:
-		return _get_block_lz4(params, buffer, orig_len, more);
+#if HAVE_LZ4
+		return compress;
+#else
+		info("lz4 compression not supported, sending uncompressed file.");
+		return COMPRESS_OFF;
+#endif
 	}
 
 	/* compression type not recognized */
 	error("File compression type %u not supported,"
-	      " sending uncompressed file.", params->compress);
-	params->compress = 0;
-	return _get_block_none(buffer, orig_len, more);
+	      " sending uncompressed file.", compress);
+	return COMPRESS_OFF;
+}
+
+/* Megabytes per second */
+static double _rate(uint64_t bytes, uint64_t usec)
+{
+	if (!usec)
+		return 0.0;
+	return ((double) bytes / (1024.0 * 1024.0)) /
+	       ((double) usec / 1000000.0);
 }
 
 /* read and broadcast the file */
 static int _bcast_file(struct bcast_parameters *params)
 {
-	int rc = SLURM_SUCCESS;
 	file_bcast_msg_t bcast_msg;
-	char *buffer = NULL;
-	int32_t orig_len = 0;
-	uint32_t size_uncompressed = 0, size_compressed = 0;
-	uint32_t time_compression = 0;
-	bool more = true;
-	DEF_TIMERS;
+	bcast_state_t state;
+	pthread_t thread_id[MAX_WINDOW];
+	int i, window, thread_cnt = 0;
+	struct timeval tv_start, tv_end;
+	uint64_t wall_time;
 
 	if (params->block_size)
 		block_len = MIN(params->block_size, f_stat.st_size);
@@ -382,7 +468,6 @@ static int _bcast_file(struct bcast_parameters *params)
 
 	bzero(&bcast_msg, sizeof(file_bcast_msg_t));
 	bcast_msg.fname		= params->dst_fname;
-	bcast_msg.block_no	= 1;
 	bcast_msg.force		= params->force;
 	bcast_msg.modes		= f_stat.st_mode;
 	bcast_msg.uid		= f_stat.st_uid;
@@ -390,6 +475,8 @@ static int _bcast_file(struct bcast_parameters *params)
 	bcast_msg.gid		= f_stat.st_gid;
 	bcast_msg.file_size	= f_stat.st_size;
 	bcast_msg.cred          = sbcast_cred->sbcast_cred;
+	params->compress = _valid_compress(params->compress);
+	bcast_msg.compress	= params->compress;
 
 	if (params->preserve) {
 		bcast_msg.atime     = f_stat.st_atime;
@@ -400,50 +487,93 @@ static int _bcast_file(struct bcast_parameters *params)
 		params->fanout = MAX_THREADS;
 	slurm_set_tree_width(MIN(MAX_THREADS, params->fanout));
 
-	while (more) {
-		START_TIMER;
-		bcast_msg.block_len = _next_block(params, &buffer, &orig_len,
-						  &more);
-		END_TIMER;
-		time_compression += DELTA_TIMER;
-		size_uncompressed += orig_len;
-		size_compressed += bcast_msg.block_len;
-		debug("block %d, size %u", bcast_msg.block_no,
-		      bcast_msg.block_len);
-		bcast_msg.compress = params->compress;
-		bcast_msg.uncomp_len = orig_len;
-		bcast_msg.block = buffer;
-		if (!more)
-			bcast_msg.last_block = 1;
-
-		rc = _file_bcast(params, &bcast_msg, sbcast_cred);
-		if (rc != SLURM_SUCCESS)
-			break;
-		if (bcast_msg.last_block)
-			break;	/* end of file */
-		bcast_msg.block_no++;
-		bcast_msg.block_offset += orig_len;
+	window = params->window ? params->window : DEFAULT_WINDOW;
+	window = MIN(window, MAX_WINDOW);
+
+	bzero(&state, sizeof(bcast_state_t));
+	slurm_mutex_init(&state.lock);
+	state.params = params;
+	state.bcast_msg = &bcast_msg;
+	state.block_no = 1;
+
+	gettimeofday(&tv_start, NULL);
+	/* The first block registers the file on each node and must complete
+	 * before others are sent, later blocks may arrive in any order */
+	if (_bcast_block(&state)) {
+		for (i = 0; i < window; i++) {
+			if (pthread_create(&thread_id[thread_cnt], NULL,
+					   _bcast_thread, &state)) {
+				error("pthread_create: %m");
+				break;
+			}
+			thread_cnt++;
+		}
+		if (!thread_cnt)
+			_bcast_thread(&state);
+		for (i = 0; i < thread_cnt; i++)
+			pthread_join(thread_id[i], NULL);
 	}
+	gettimeofday(&tv_end, NULL);
+	wall_time = (tv_end.tv_sec - tv_start.tv_sec) * 1000000 +
+		    (tv_end.tv_usec - tv_start.tv_usec);
+	slurm_mutex_destroy(&state.lock);
 	xfree(bcast_msg.user_name);
-	xfree(buffer);
 
-	if (size_uncompressed && params->compress != 0) {
-		int64_t pct = (int64_t) size_uncompressed - size_compressed;
+	if (state.size_uncompressed && params->compress != 0) {
+		int64_t pct = (int64_t) state.size_uncompressed -
+			      state.size_compressed;
 		/* Dividing a negative by a positive in C99 results in
 		 * "truncation towards zero" which gives unexpected values for
 		 * pct. This construct avoids that problem.
 		 */
-		pct = (pct>=0) ? pct * 100 / size_uncompressed
-			       : - (-pct * 100 / size_uncompressed);
-		verbose("File compressed from %u to %u (%d percent) in %u usec",
-			size_uncompressed, size_compressed, (int) pct,
-			time_compression);
+		pct = (pct>=0) ? pct * 100 / state.size_uncompressed
+			       : - (-pct * 100 / state.size_uncompressed);
+		verbose("File compressed from %"PRIu64" to %"PRIu64" "
+			"(%d percent) in %"PRIu64" usec",
+			state.size_uncompressed, state.size_compressed,
+			(int) pct, state.time_read);
 	}
-
-	return rc;
+	verbose("Blocks sent: %u with up to %d in flight",
+		state.block_no - 1, (thread_cnt ? thread_cnt : 1));
+	verbose("Read/compress: %"PRIu64" bytes in %"PRIu64" usec "
+		"(%.1f MB/s per thread)",
+		state.size_uncompressed, state.time_read,
+		_rate(state.size_uncompressed, state.time_read));
+	verbose("Transmit: %"PRIu64" bytes in %"PRIu64" usec "
+		"(%.1f MB/s per block in flight)",
+		state.size_compressed, state.time_send,
+		_rate(state.size_compressed, state.time_send));
+	verbose("Total: %"PRIu64" bytes to %u nodes in %"PRIu64" usec "
+		"(%.1f MB/s per node)",
+		state.size_uncompressed, sbcast_cred->node_cnt, wall_time,
+		_rate(state.size_uncompressed, wall_time));
+
+	return state.rc;
 }
 
 
+extern uint32_t bcast_block_cksum(const void *data, uint32_t len)
+{
+	const unsigned char *ptr = data;
+	uint64_t sum1 = 0, sum2 = 0;
+	uint32_t i;
+
+	/* Fletcher style sums over little-endian 32-bit words */
+	for (i = 0; (i + 4) <= len; i += 4) {
+		sum1 += (uint32_t) ptr[i] | ((uint32_t) ptr[i + 1] << 8) |
+			((uint32_t) ptr[i + 2] << 16) |
+			((uint32_t) ptr[i + 3] << 24);
+		sum2 += sum1;
+	}
+	for ( ; i < len; i++) {
+		sum1 += ptr[i];
+		sum2 += sum1;
+	}
+	sum2 += len;
+
+	return (uint32_t) (sum1 ^ (sum1 >> 32) ^ sum2 ^ (sum2 >> 32));
+}
+
 static int _decompress_data_zlib(file_bcast_msg_t *req)
 {
 #if HAVE_LIBZ
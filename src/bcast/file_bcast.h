@@ -52,6 +52,7 @@ struct bcast_parameters {
 	uint32_t step_id;
 	int timeout;
 	int verbose;
+	int window;
 };
 
 typedef struct file_bcast_info {
@@ -62,7 +63,7 @@ typedef struct file_bcast_info {
 	gid_t gid;		/* gid of owner */
 	uint32_t job_id;	/* job id */
 	time_t last_update;	/* transfer last block received */
-	int received_blocks;	/* number of blocks received */
+	uint64_t received_bytes;/* bytes of file data written */
 	time_t start_time;	/* transfer start time */
 	uid_t uid;		/* uid of owner */
 } file_bcast_info_t;
@@ -71,4 +72,11 @@ extern int bcast_file(struct bcast_parameters *params);
 
 extern int bcast_decompress_data(file_bcast_msg_t *req);
 
+/*
+ * Checksum of a block's uncompressed data, computed by sbcast and verified
+ * by every slurmd the block reaches so corruption in transit is caught.
+ * Independent of host byte order.
+ */
+extern uint32_t bcast_block_cksum(const void *data, uint32_t len);
+
 #endif
@@ -57,6 +57,7 @@ uint32_t g_qos_max_priority = 0;
 uint32_t g_qos_count = 0;
 uint32_t g_user_assoc_count = 0;
 uint32_t g_tres_count = 0;
+uint32_t g_assoc_tree_gen = 0;
 
 List assoc_mgr_tres_list = NULL;
 slurmdb_tres_rec_t **assoc_mgr_tres_array = NULL;
@@ -951,6 +952,7 @@ static int _post_assoc_list(void)
 	list_iterator_destroy(itr);
 
 	slurmdb_sort_hierarchical_assoc_list(assoc_mgr_assoc_list, true);
+	g_assoc_tree_gen++;
 
 	//END_TIMER2("load_associations");
 	return SLURM_SUCCESS;
@@ -2032,6 +2034,7 @@ extern int assoc_mgr_fini(char *state_save_location)
 	assoc_mgr_wckey_list = NULL;
 
 	assoc_mgr_root_assoc = NULL;
+	g_assoc_tree_gen++;
 	running_cache = 0;
 
 	xfree(assoc_hash_id);
@@ -3839,6 +3842,7 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update, bool locked)
 	if (parents_changed) {
 		int reset = 1;
 		g_user_assoc_count = 0;
+		g_assoc_tree_gen++;
 		slurmdb_sort_hierarchical_assoc_list(
 			assoc_mgr_assoc_list, true);
 
@@ -41,7 +41,9 @@
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/time.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "slurm/slurm.h"
@@ -52,10 +54,28 @@
 #include "src/common/slurm_route.h"
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_interface.h"
+#include "src/common/timers.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
 #define MAX_RETRIES 3
+#define FWD_FAIL_TTL 300	/* seconds a failed node is not a tree head */
+
+/*
+ * Response history of the nodes this daemon forwarded messages to. It is used
+ * to avoid making a node which recently failed to answer, or answered close to
+ * the message timeout, the head of a subtree, where it would stall all the
+ * nodes below it until the timeout.
+ */
+typedef struct {
+	time_t fail_time;	/* time of last failure, 0 if answering */
+	char *node_name;
+	uint32_t latency_usec;	/* smoothed latency of direct messages */
+} fwd_node_health_t;
+
+static xhash_t *fwd_health_hash = NULL;
+static pthread_mutex_t fwd_health_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 typedef struct {
 	pthread_cond_t *notify;
@@ -75,6 +95,169 @@ static void _forward_msg_internal(hostlist_t hl, hostlist_t* sp_hl,
 				  header_t *header, int timeout,
 				  int hl_count);
 
+static const char *_fwd_health_id(void *item)
+{
+	fwd_node_health_t *health = (fwd_node_health_t *) item;
+	return health->node_name;
+}
+
+static void _fwd_health_free(void *item)
+{
+	fwd_node_health_t *health = (fwd_node_health_t *) item;
+
+	xfree(health->node_name);
+	xfree(health);
+}
+
+/* fwd_health_mutex must be locked by the caller */
+static fwd_node_health_t *_fwd_health_get(char *node_name, bool create)
+{
+	fwd_node_health_t *health;
+
+	if (!fwd_health_hash) {
+		if (!create)
+			return NULL;
+		fwd_health_hash = xhash_init(_fwd_health_id, _fwd_health_free,
+					     NULL, 0);
+	}
+	if (!(health = xhash_get(fwd_health_hash, node_name)) && create) {
+		health = xmalloc(sizeof(fwd_node_health_t));
+		health->node_name = xstrdup(node_name);
+		xhash_add(fwd_health_hash, health);
+	}
+	return health;
+}
+
+/*
+ * Record the outcome of a message sent to "head" along with "fwd_cnt" other
+ * nodes. "usec" is the time spent waiting for the responses, which is the
+ * latency of "head" if the message was not forwarded any further.
+ */
+static void _fwd_health_update(List ret_list, char *head, int fwd_cnt,
+			       uint32_t usec)
+{
+	fwd_node_health_t *health;
+	ret_data_info_t *ret_data_info;
+	ListIterator itr;
+	time_t now = time(NULL);
+
+	if (!ret_list)
+		return;
+
+	slurm_mutex_lock(&fwd_health_mutex);
+	itr = list_iterator_create(ret_list);
+	while ((ret_data_info = list_next(itr))) {
+		char *node_name = ret_data_info->node_name;
+
+		if (!node_name)
+			node_name = head;
+		if (!node_name)
+			continue;
+		if (ret_data_info->type == RESPONSE_FORWARD_FAILED) {
+			health = _fwd_health_get(node_name, true);
+			health->fail_time = now;
+			continue;
+		}
+		if (!(health = _fwd_health_get(node_name, !fwd_cnt)))
+			continue;
+		health->fail_time = 0;
+		if (!fwd_cnt && !xstrcmp(node_name, head)) {
+			if (health->latency_usec)
+				health->latency_usec = (health->latency_usec *
+							3 + usec) / 4;
+			else
+				health->latency_usec = usec;
+		}
+	}
+	list_iterator_destroy(itr);
+	slurm_mutex_unlock(&fwd_health_mutex);
+}
+
+/* Record that "node_name" could not be reached */
+static void _fwd_health_fail(char *node_name)
+{
+	slurm_mutex_lock(&fwd_health_mutex);
+	_fwd_health_get(node_name, true)->fail_time = time(NULL);
+	slurm_mutex_unlock(&fwd_health_mutex);
+}
+
+/*
+ * Return how unsuitable a node is to be a subtree head: 2 if it failed within
+ * FWD_FAIL_TTL seconds, 1 if its latency exceeds half the message timeout,
+ * 0 otherwise. fwd_health_mutex must be locked by the caller.
+ */
+static int _fwd_health_score(char *node_name, time_t now, uint32_t slow_usec)
+{
+	fwd_node_health_t *health = _fwd_health_get(node_name, false);
+
+	if (!health)
+		return 0;
+	if (health->fail_time && ((now - health->fail_time) < FWD_FAIL_TTL))
+		return 2;
+	if (health->latency_usec > slow_usec)
+		return 1;
+	return 0;
+}
+
+/*
+ * Make the most responsive node of each hostlist its first node, which is
+ * the one the message is sent to and which forwards it to the others.
+ * The order of the other nodes is preserved.
+ */
+static void _fwd_pick_heads(hostlist_t *sp_hl, int hl_count)
+{
+	hostlist_iterator_t hi;
+	hostlist_t new_hl;
+	time_t now = time(NULL);
+	uint32_t slow_usec;
+	char *name, *best;
+	int j, score, best_score;
+	bool health_known;
+
+	/* The table is created by the threads collecting replies */
+	slurm_mutex_lock(&fwd_health_mutex);
+	health_known = (fwd_health_hash != NULL);
+	slurm_mutex_unlock(&fwd_health_mutex);
+	if (!health_known)
+		return;
+
+	slow_usec = slurm_get_msg_timeout() * 500000;
+	for (j = 0; j < hl_count; j++) {
+		if (!sp_hl[j] || (hostlist_count(sp_hl[j]) < 2))
+			continue;
+		best = NULL;
+		best_score = 3;
+		slurm_mutex_lock(&fwd_health_mutex);
+		hi = hostlist_iterator_create(sp_hl[j]);
+		while ((name = hostlist_next(hi))) {
+			score = _fwd_health_score(name, now, slow_usec);
+			if (score < best_score) {
+				free(best);
+				best = name;
+				best_score = score;
+				if (!score)
+					break;
+			} else
+				free(name);
+		}
+		hostlist_iterator_destroy(hi);
+		slurm_mutex_unlock(&fwd_health_mutex);
+
+		name = hostlist_nth(sp_hl[j], 0);
+		if (best && xstrcmp(name, best)) {
+			debug2("forward: using %s rather than unresponsive %s "
+			       "as tree head", best, name);
+			hostlist_delete_host(sp_hl[j], best);
+			new_hl = hostlist_create(best);
+			hostlist_push_list(new_hl, sp_hl[j]);
+			hostlist_destroy(sp_hl[j]);
+			sp_hl[j] = new_hl;
+		}
+		free(name);
+		free(best);
+	}
+}
+
 void _destroy_tree_fwd(fwd_tree_t *fwd_tree)
 {
 	if (fwd_tree) {
@@ -108,6 +291,7 @@ void *_forward_thread(void *arg)
 	char *buf = NULL;
 	int steps = 0;
 	int start_timeout = fwd_msg->timeout;
+	DEF_TIMERS;
 
 	/* repeat until we are sure the message was sent */
 	while ((name = hostlist_shift(hl))) {
@@ -126,6 +310,7 @@ void *_forward_thread(void *arg)
 		}
 		if ((fd = slurm_open_msg_conn(&addr)) < 0) {
 			error("forward_thread to %s: %m", name);
+			_fwd_health_fail(name);
 
 			slurm_mutex_lock(&fwd_struct->forward_mutex);
 			mark_as_failed_forward(
@@ -185,6 +370,7 @@ void *_forward_thread(void *arg)
 				     get_buf_offset(buffer),
 				     SLURM_PROTOCOL_NO_SEND_RECV_FLAGS ) < 0) {
 			error("forward_thread: slurm_msg_sendto: %m");
+			_fwd_health_fail(name);
 
 			slurm_mutex_lock(&fwd_struct->forward_mutex);
 			mark_as_failed_forward(&fwd_struct->ret_list, name,
@@ -250,12 +436,19 @@ void *_forward_thread(void *arg)
 			/*      steps, fwd_msg->timeout); */
 		}
 
+		START_TIMER;
 		ret_list = slurm_receive_msgs(fd, steps, fwd_msg->timeout);
+		END_TIMER;
+		if (ret_list)
+			_fwd_health_update(ret_list, name,
+					   fwd_msg->header.forward.cnt,
+					   DELTA_TIMER);
 		/* info("sent %d forwards got %d back", */
 		/*      fwd_msg->header.forward.cnt, list_count(ret_list)); */
 
 		if (!ret_list || (fwd_msg->header.forward.cnt != 0
 				  && list_count(ret_list) <= 1)) {
+			_fwd_health_fail(name);
 			slurm_mutex_lock(&fwd_struct->forward_mutex);
 			mark_as_failed_forward(&fwd_struct->ret_list, name,
 					       errno);
@@ -353,6 +546,7 @@ void *_fwd_tree_thread(void *arg)
 	char *name = NULL;
 	char *buf = NULL;
 	slurm_msg_t send_msg;
+	DEF_TIMERS;
 
 	slurm_msg_t_init(&send_msg);
 	send_msg.msg_type = fwd_tree->orig_msg->msg_type;
@@ -389,8 +583,12 @@ void *_fwd_tree_thread(void *arg)
 		} else
 			debug3("Tree sending to %s", name);
 
+		START_TIMER;
 		ret_list = slurm_send_addr_recv_msgs(&send_msg, name,
 						     fwd_tree->timeout);
+		END_TIMER;
+		_fwd_health_update(ret_list, name, send_msg.forward.cnt,
+				   DELTA_TIMER);
 
 		xfree(send_msg.forward.nodelist);
 
@@ -652,6 +850,7 @@ extern int forward_msg(forward_struct_t *forward_struct, header_t *header)
 		hostlist_destroy(hl);
 		return SLURM_ERROR;
 	}
+	_fwd_pick_heads(sp_hl, hl_count);
 
 	_forward_msg_internal(NULL, sp_hl, forward_struct, header,
 			      forward_struct->timeout, hl_count);
@@ -696,6 +895,7 @@ extern List start_msg_tree(hostlist_t hl, slurm_msg_t *msg, int timeout)
 		error("unable to split forward hostlist");
 		return NULL;
 	}
+	_fwd_pick_heads(sp_hl, hl_count);
 	slurm_mutex_init(&tree_mutex);
 	slurm_cond_init(&notify, NULL);
 
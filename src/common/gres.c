@@ -146,10 +146,20 @@ static pthread_mutex_t gres_context_lock = PTHREAD_MUTEX_INITIALIZER;
 static List gres_conf_list = NULL;
 static bool init_run = false;
 
+/* GRES type (model) names interned to small integers, so that the scheduling
+ * tests compare integers rather than strings. Ids are process local, never
+ * packed and remain valid for the life of the process (including across
+ * gres_plugin_reconfig), so the table is never freed. */
+static pthread_mutex_t gres_type_lock = PTHREAD_MUTEX_INITIALIZER;
+static char **gres_type_names = NULL;
+static uint32_t gres_type_cnt = 0;
+
 /* Local functions */
 static gres_node_state_t *
 		_build_gres_node_state(void);
 static uint32_t	_build_id(char *gres_name);
+static bitstr_t *_cpu_bitmap_local(bitstr_t *cpu_bitmap, int cpu_start_bit,
+				   int cpu_cnt);
 static bitstr_t *_cpu_bitmap_rebuild(bitstr_t *old_cpu_bitmap, int new_size);
 static void	_destroy_gres_slurmd_conf(void *x);
 static void	_get_gres_cnt(gres_node_state_t *gres_data, char *orig_config,
@@ -157,6 +167,7 @@ static void	_get_gres_cnt(gres_node_state_t *gres_data, char *orig_config,
 			      int gres_name_colon_len);
 static uint64_t	_get_tot_gres_cnt(uint32_t plugin_id, uint64_t *set_cnt);
 static int	_gres_find_id(void *x, void *key);
+static uint32_t	_gres_type_id(char *type);
 static void	_gres_job_list_delete(void *list_element);
 static bool	_is_gres_cnt_zero(char *config);
 static int	_job_alloc(void *job_gres_data, void *node_gres_data,
@@ -244,6 +255,31 @@ static uint32_t	_build_id(char *gres_name)
 	return id;
 }
 
+/* Map a GRES type (model) name to a unique non-zero id, 0 if type is NULL.
+ * The number of distinct types is small, so a linear search suffices. */
+static uint32_t _gres_type_id(char *type)
+{
+	uint32_t i;
+
+	if (!type)
+		return 0;
+
+	slurm_mutex_lock(&gres_type_lock);
+	for (i = 0; i < gres_type_cnt; i++) {
+		if (!xstrcmp(gres_type_names[i], type))
+			break;
+	}
+	if (i >= gres_type_cnt) {
+		gres_type_names = xrealloc(gres_type_names,
+					   sizeof(char *) * (i + 1));
+		gres_type_names[i] = xstrdup(type);
+		gres_type_cnt++;
+	}
+	slurm_mutex_unlock(&gres_type_lock);
+
+	return i + 1;
+}
+
 static int _gres_find_id(void *x, void *key)
 {
 	uint32_t *plugin_id = (uint32_t *)key;
@@ -1335,12 +1371,14 @@ static void _gres_node_list_delete(void *list_element)
 	xfree(gres_node_ptr->topo_gres_cnt_alloc);
 	xfree(gres_node_ptr->topo_gres_cnt_avail);
 	xfree(gres_node_ptr->topo_model);
+	xfree(gres_node_ptr->topo_type_id);
 	for (i = 0; i < gres_node_ptr->type_cnt; i++) {
 		xfree(gres_node_ptr->type_model[i]);
 	}
 	xfree(gres_node_ptr->type_cnt_alloc);
 	xfree(gres_node_ptr->type_cnt_avail);
 	xfree(gres_node_ptr->type_model);
+	xfree(gres_node_ptr->type_id);
 	xfree(gres_node_ptr);
 	xfree(gres_ptr);
 }
@@ -1349,14 +1387,16 @@ static void _add_gres_type(char *type, gres_node_state_t *gres_data,
 			   uint64_t tmp_gres_cnt)
 {
 	int i;
+	uint32_t type_id;
 
 	if (!xstrcasecmp(type, "no_consume")) {
 		gres_data->no_consume = true;
 		return;
 	}
 
+	type_id = _gres_type_id(type);
 	for (i = 0; i < gres_data->type_cnt; i++) {
-		if (xstrcmp(gres_data->type_model[i], type))
+		if (gres_data->type_id[i] != type_id)
 			continue;
 		gres_data->type_cnt_avail[i] += tmp_gres_cnt;
 		break;
@@ -1373,8 +1413,12 @@ static void _add_gres_type(char *type, gres_node_state_t *gres_data,
 		gres_data->type_model =
 			xrealloc(gres_data->type_model,
 				 sizeof(char *) * gres_data->type_cnt);
+		gres_data->type_id =
+			xrealloc(gres_data->type_id,
+				 sizeof(uint32_t) * gres_data->type_cnt);
 		gres_data->type_cnt_avail[i] += tmp_gres_cnt;
 		gres_data->type_model[i] = xstrdup(type);
+		gres_data->type_id[i] = type_id;
 	}
 }
 
@@ -1472,8 +1516,8 @@ static int _valid_gres_type(char *gres_name, gres_node_state_t *gres_data,
 	for (i = 0; i < gres_data->type_cnt; i++) {
 		model_cnt = 0;
 		for (j = 0; j < gres_data->topo_cnt; j++) {
-			if (!xstrcmp(gres_data->type_model[i],
-				     gres_data->topo_model[j]))
+			if (gres_data->type_id[i] ==
+			    gres_data->topo_type_id[j])
 				model_cnt += gres_data->topo_gres_cnt_avail[j];
 		}
 		if (fast_schedule >= 2) {
@@ -1768,6 +1812,7 @@ extern int _node_config_validate(char *node_name, char *orig_config,
 		xfree(gres_data->topo_gres_bitmap);
 		xfree(gres_data->topo_cpus_bitmap);
 		xfree(gres_data->topo_model);
+		xfree(gres_data->topo_type_id);
 		gres_data->topo_cnt = set_cnt;
 	}
 
@@ -1799,6 +1844,8 @@ extern int _node_config_validate(char *node_name, char *orig_config,
 				 set_cnt * sizeof(bitstr_t *));
 		gres_data->topo_model = xrealloc(gres_data->topo_model,
 						 set_cnt * sizeof(char *));
+		gres_data->topo_type_id = xrealloc(gres_data->topo_type_id,
+						   set_cnt * sizeof(uint32_t));
 		gres_data->topo_cnt = set_cnt;
 
 		iter = list_iterator_create(gres_conf_list);
@@ -1828,6 +1875,8 @@ extern int _node_config_validate(char *node_name, char *orig_config,
 			}
 			gres_data->topo_model[i] = xstrdup(gres_slurmd_conf->
 							   type);
+			gres_data->topo_type_id[i] =
+				_gres_type_id(gres_slurmd_conf->type);
 			i++;
 		}
 		list_iterator_destroy(iter);
@@ -1906,6 +1955,7 @@ extern int _node_config_validate(char *node_name, char *orig_config,
 			xfree(gres_data->topo_gres_cnt_alloc);
 			xfree(gres_data->topo_gres_cnt_avail);
 			xfree(gres_data->topo_model);
+			xfree(gres_data->topo_type_id);
 		}
 		gres_data->topo_cnt = 0;
 	} else if ((fast_schedule == 0) &&
@@ -2346,6 +2396,8 @@ static void *_node_state_dup(void *gres_data)
 	new_gres->topo_gres_cnt_avail = xmalloc(gres_ptr->topo_cnt *
 						sizeof(uint64_t));
 	new_gres->topo_model = xmalloc(gres_ptr->topo_cnt * sizeof(char *));
+	new_gres->topo_type_id = xmalloc(gres_ptr->topo_cnt *
+					 sizeof(uint32_t));
 	for (i = 0; i < gres_ptr->topo_cnt; i++) {
 		if (gres_ptr->topo_cpus_bitmap[i]) {
 			new_gres->topo_cpus_bitmap[i] =
@@ -2358,6 +2410,7 @@ static void *_node_state_dup(void *gres_data)
 		new_gres->topo_gres_cnt_avail[i] =
 			gres_ptr->topo_gres_cnt_avail[i];
 		new_gres->topo_model[i] = xstrdup(gres_ptr->topo_model[i]);
+		new_gres->topo_type_id[i] = gres_ptr->topo_type_id[i];
 	}
 
 	new_gres->type_cnt       = gres_ptr->type_cnt;
@@ -2366,10 +2419,12 @@ static void *_node_state_dup(void *gres_data)
 	new_gres->type_cnt_avail = xmalloc(gres_ptr->type_cnt *
 					   sizeof(uint64_t));
 	new_gres->type_model = xmalloc(gres_ptr->type_cnt * sizeof(char *));
+	new_gres->type_id = xmalloc(gres_ptr->type_cnt * sizeof(uint32_t));
 	for (i = 0; i < gres_ptr->type_cnt; i++) {
 		new_gres->type_cnt_alloc[i] = gres_ptr->type_cnt_alloc[i];
 		new_gres->type_cnt_avail[i] = gres_ptr->type_cnt_avail[i];
 		new_gres->type_model[i] = xstrdup(gres_ptr->type_model[i]);
+		new_gres->type_id[i] = gres_ptr->type_id[i];
 	}
 	return new_gres;
 }
@@ -2514,8 +2569,8 @@ static char *_node_gres_used(void *gres_data, char *gres_name)
 			for (j = i + 1; j < gres_node_ptr->topo_cnt; j++) {
 				if (bit_test(topo_printed, j))
 					continue;
-				if (xstrcmp(gres_node_ptr->topo_model[i],
-					    gres_node_ptr->topo_model[j]))
+				if (gres_node_ptr->topo_type_id[i] !=
+				    gres_node_ptr->topo_type_id[j])
 					continue;
 				bit_set(topo_printed, j);
 				if (gres_node_ptr->topo_gres_bitmap[j]) {
@@ -2950,6 +3005,7 @@ static int _job_state_validate(char *config, gres_job_state_t **gres_data,
 		gres_ptr = xmalloc(sizeof(gres_job_state_t));
 		gres_ptr->gres_cnt_alloc = cnt;
 		gres_ptr->type_model = type;
+		gres_ptr->type_id = _gres_type_id(type);
 		type = NULL;
 
 		*gres_data = gres_ptr;
@@ -3045,6 +3101,7 @@ static void *_job_state_dup(void *gres_data)
 	new_gres_ptr->gres_cnt_alloc	= gres_ptr->gres_cnt_alloc;
 	new_gres_ptr->node_cnt		= gres_ptr->node_cnt;
 	new_gres_ptr->type_model	= xstrdup(gres_ptr->type_model);
+	new_gres_ptr->type_id		= gres_ptr->type_id;
 
 	if (gres_ptr->gres_bit_alloc) {
 		new_gres_ptr->gres_bit_alloc = xmalloc(sizeof(bitstr_t *) *
@@ -3072,6 +3129,7 @@ static void *_job_state_dup2(void *gres_data, int node_index)
 	new_gres_ptr->gres_cnt_alloc	= gres_ptr->gres_cnt_alloc;
 	new_gres_ptr->node_cnt		= 1;
 	new_gres_ptr->type_model	= xstrdup(gres_ptr->type_model);
+	new_gres_ptr->type_id		= gres_ptr->type_id;
 
 	if (gres_ptr->gres_bit_alloc && gres_ptr->gres_bit_alloc[node_index]) {
 		new_gres_ptr->gres_bit_alloc	= xmalloc(sizeof(bitstr_t *));
@@ -3270,6 +3328,8 @@ extern int gres_plugin_job_state_unpack(List *gres_list, Buf buffer,
 			safe_unpack64(&gres_job_ptr->gres_cnt_alloc, buffer);
 			safe_unpackstr_xmalloc(&gres_job_ptr->type_model,
 					       &utmp32, buffer);
+			gres_job_ptr->type_id =
+				_gres_type_id(gres_job_ptr->type_model);
 			safe_unpack32(&gres_job_ptr->node_cnt, buffer);
 			safe_unpack8(&has_more, buffer);
 
@@ -3376,6 +3436,28 @@ static bitstr_t *_cpu_bitmap_rebuild(bitstr_t *old_cpu_bitmap, int new_size)
 	return new_cpu_bitmap;
 }
 
+/* Copy this node's portion of cpu_bitmap (cpu_cnt bits starting at
+ * cpu_start_bit) into a node-local bitmap, which can then be tested against
+ * the topo_cpus_bitmap entries with word-wise bitmap operations rather than
+ * bit by bit. Use FREE_NULL_BITMAP() to release the returned bitmap. */
+static bitstr_t *_cpu_bitmap_local(bitstr_t *cpu_bitmap, int cpu_start_bit,
+				   int cpu_cnt)
+{
+	bitstr_t *local_bitmap;
+	int i;
+
+	local_bitmap = bit_alloc(cpu_cnt);
+	if ((cpu_start_bit == 0) && (bit_size(cpu_bitmap) == cpu_cnt)) {
+		bit_copybits(local_bitmap, cpu_bitmap);
+		return local_bitmap;
+	}
+	for (i = 0; i < cpu_cnt; i++) {
+		if (bit_test(cpu_bitmap, cpu_start_bit + i))
+			bit_set(local_bitmap, i);
+	}
+	return local_bitmap;
+}
+
 static void _validate_gres_node_cpus(gres_node_state_t *node_gres_ptr,
 				     int cpus_ctld, char *node_name)
 {
@@ -3425,9 +3507,9 @@ static void	_job_core_filter(void *job_gres_data, void *node_gres_data,
 	    !job_gres_ptr->gres_cnt_alloc)		/* No job GRES */
 		return;
 
-	/* Determine which specific CPUs can be used */
-	avail_cpu_bitmap = bit_copy(cpu_bitmap);
-	bit_nclear(avail_cpu_bitmap, cpu_start_bit, cpu_end_bit);
+	/* Determine which specific CPUs can be used, as the union of the
+	 * usable topology entries' CPUs in a node-local bitmap */
+	cpus_ctld = cpu_end_bit - cpu_start_bit + 1;
 	for (i = 0; i < node_gres_ptr->topo_cnt; i++) {
 		if (node_gres_ptr->topo_gres_cnt_avail[i] == 0)
 			continue;
@@ -3435,25 +3517,25 @@ static void	_job_core_filter(void *job_gres_data, void *node_gres_data,
 		    (node_gres_ptr->topo_gres_cnt_alloc[i] >=
 		     node_gres_ptr->topo_gres_cnt_avail[i]))
 			continue;
-		if (job_gres_ptr->type_model &&
-		    (!node_gres_ptr->topo_model[i] ||
-		     xstrcmp(job_gres_ptr->type_model,
-			     node_gres_ptr->topo_model[i])))
+		if (job_gres_ptr->type_id &&
+		    (job_gres_ptr->type_id !=
+		     node_gres_ptr->topo_type_id[i]))
 			continue;
 		if (!node_gres_ptr->topo_cpus_bitmap[i]) {
 			FREE_NULL_BITMAP(avail_cpu_bitmap);	/* No filter */
 			return;
 		}
-		cpus_ctld = cpu_end_bit - cpu_start_bit + 1;
-		_validate_gres_node_cpus(node_gres_ptr, cpus_ctld, node_name);
-		cpus_ctld = bit_size(node_gres_ptr->topo_cpus_bitmap[i]);
-		for (j = 0; j < cpus_ctld; j++) {
-			if (bit_test(node_gres_ptr->topo_cpus_bitmap[i], j)) {
-				bit_set(avail_cpu_bitmap, cpu_start_bit + j);
-			}
+		if (!avail_cpu_bitmap) {
+			_validate_gres_node_cpus(node_gres_ptr, cpus_ctld,
+						 node_name);
+			avail_cpu_bitmap = bit_alloc(cpus_ctld);
 		}
+		bit_or(avail_cpu_bitmap, node_gres_ptr->topo_cpus_bitmap[i]);
+	}
+	for (j = 0; j < cpus_ctld; j++) {
+		if (!avail_cpu_bitmap || !bit_test(avail_cpu_bitmap, j))
+			bit_clear(cpu_bitmap, cpu_start_bit + j);
 	}
-	bit_and(cpu_bitmap, avail_cpu_bitmap);
 	FREE_NULL_BITMAP(avail_cpu_bitmap);
 }
 
@@ -3462,7 +3544,7 @@ static uint32_t _job_test(void *job_gres_data, void *node_gres_data,
 			  int cpu_start_bit, int cpu_end_bit, bool *topo_set,
 			  uint32_t job_id, char *node_name, char *gres_name)
 {
-	int i, j, cpu_size, cpus_ctld, top_inx;
+	int i, j, cpus_ctld, top_inx;
 	uint64_t gres_avail = 0, gres_total;
 	gres_job_state_t  *job_gres_ptr  = (gres_job_state_t *)  job_gres_data;
 	gres_node_state_t *node_gres_ptr = (gres_node_state_t *) node_gres_data;
@@ -3487,12 +3569,14 @@ static uint32_t _job_test(void *job_gres_data, void *node_gres_data,
 			}
 			_validate_gres_node_cpus(node_gres_ptr, cpus_ctld,
 						 node_name);
+			alloc_cpu_bitmap = _cpu_bitmap_local(cpu_bitmap,
+							     cpu_start_bit,
+							     cpus_ctld);
 		}
 		for (i = 0; i < node_gres_ptr->topo_cnt; i++) {
-			if (job_gres_ptr->type_model &&
-			    (!node_gres_ptr->topo_model[i] ||
-			     xstrcmp(node_gres_ptr->topo_model[i],
-				     job_gres_ptr->type_model)))
+			if (job_gres_ptr->type_id &&
+			    (job_gres_ptr->type_id !=
+			     node_gres_ptr->topo_type_id[i]))
 				continue;
 			if (!node_gres_ptr->topo_cpus_bitmap[i]) {
 				gres_avail += node_gres_ptr->
@@ -3503,24 +3587,18 @@ static uint32_t _job_test(void *job_gres_data, void *node_gres_data,
 				}
 				continue;
 			}
-			cpus_ctld = bit_size(node_gres_ptr->
-					     topo_cpus_bitmap[i]);
-			for (j = 0; j < cpus_ctld; j++) {
-				if (cpu_bitmap &&
-				    !bit_test(cpu_bitmap, cpu_start_bit+j))
-					continue;
-				if (!bit_test(node_gres_ptr->
-					      topo_cpus_bitmap[i], j))
-					continue; /* not avail for this gres */
-				gres_avail += node_gres_ptr->
-					      topo_gres_cnt_avail[i];
-				if (!use_total_gres) {
-					gres_avail -= node_gres_ptr->
-						      topo_gres_cnt_alloc[i];
-				}
-				break;
+			if (alloc_cpu_bitmap ?
+			    !bit_overlap(alloc_cpu_bitmap,
+					 node_gres_ptr->topo_cpus_bitmap[i]) :
+			    (bit_ffs(node_gres_ptr->topo_cpus_bitmap[i]) < 0))
+				continue;	/* not avail for this gres */
+			gres_avail += node_gres_ptr->topo_gres_cnt_avail[i];
+			if (!use_total_gres) {
+				gres_avail -= node_gres_ptr->
+					      topo_gres_cnt_alloc[i];
 			}
 		}
+		FREE_NULL_BITMAP(alloc_cpu_bitmap);
 		if (job_gres_ptr->gres_cnt_alloc > gres_avail)
 			return (uint32_t) 0;	/* insufficient, gres to use */
 		return NO_VAL;
@@ -3551,13 +3629,12 @@ static uint32_t _job_test(void *job_gres_data, void *node_gres_data,
 			}
 		}
 
-		alloc_cpu_bitmap = bit_alloc(cpus_ctld);
 		if (cpu_bitmap) {
-			for (j = 0; j < cpus_ctld; j++) {
-				if (bit_test(cpu_bitmap, cpu_start_bit+j))
-					bit_set(alloc_cpu_bitmap, j);
-			}
+			alloc_cpu_bitmap = _cpu_bitmap_local(cpu_bitmap,
+							     cpu_start_bit,
+							     cpus_ctld);
 		} else {
+			alloc_cpu_bitmap = bit_alloc(cpus_ctld);
 			bit_nset(alloc_cpu_bitmap, 0, cpus_ctld - 1);
 		}
 
@@ -3570,24 +3647,21 @@ static uint32_t _job_test(void *job_gres_data, void *node_gres_data,
 			    (node_gres_ptr->topo_gres_cnt_alloc[i] >=
 			     node_gres_ptr->topo_gres_cnt_avail[i]))
 				continue;
-			if (job_gres_ptr->type_model &&
-			    (!node_gres_ptr->topo_model[i] ||
-			     xstrcmp(node_gres_ptr->topo_model[i],
-				     job_gres_ptr->type_model)))
+			if (job_gres_ptr->type_id &&
+			    (job_gres_ptr->type_id !=
+			     node_gres_ptr->topo_type_id[i]))
 				continue;
 			if (!node_gres_ptr->topo_cpus_bitmap[i]) {
 				cpus_avail[i] = cpu_end_bit - cpu_start_bit + 1;
 				continue;
 			}
-			cpu_size = bit_size(node_gres_ptr->topo_cpus_bitmap[i]);
-			for (j = 0; j < cpu_size; j++) {
-				if (cpu_bitmap &&
-				    !bit_test(cpu_bitmap, cpu_start_bit+j))
-					continue;
-				if (bit_test(node_gres_ptr->
-					     topo_cpus_bitmap[i], j)) {
-					cpus_avail[i]++;
-				}
+			if (cpu_bitmap) {
+				cpus_avail[i] = bit_overlap(alloc_cpu_bitmap,
+							    node_gres_ptr->
+							    topo_cpus_bitmap[i]);
+			} else {
+				cpus_avail[i] = bit_set_count(node_gres_ptr->
+							topo_cpus_bitmap[i]);
 			}
 		}
 
@@ -3660,11 +3734,9 @@ static uint32_t _job_test(void *job_gres_data, void *node_gres_data,
 		xfree(cpus_addnt);
 		xfree(cpus_avail);
 		return cpu_cnt;
-	} else if (job_gres_ptr->type_model) {
+	} else if (job_gres_ptr->type_id) {
 		for (i = 0; i < node_gres_ptr->type_cnt; i++) {
-			if (node_gres_ptr->type_model[i] &&
-			    !xstrcmp(node_gres_ptr->type_model[i],
-				     job_gres_ptr->type_model))
+			if (node_gres_ptr->type_id[i] == job_gres_ptr->type_id)
 				break;
 		}
 		if (i >= node_gres_ptr->type_cnt)
@@ -3853,10 +3925,9 @@ static bool _cores_on_gres(bitstr_t *core_bitmap, bitstr_t *alloc_core_bitmap,
 			continue;
 		if (!bit_test(node_gres_ptr->topo_gres_bitmap[i], gres_inx))
 			continue;
-		if (job_gres_ptr->type_model &&
-		    (!node_gres_ptr->topo_model[i] ||
-		     xstrcmp(job_gres_ptr->type_model,
-			     node_gres_ptr->topo_model[i])))
+		if (job_gres_ptr->type_id &&
+		    (job_gres_ptr->type_id !=
+		     node_gres_ptr->topo_type_id[i]))
 			continue;
 		if (!node_gres_ptr->topo_cpus_bitmap[i])
 			return true;
@@ -4078,10 +4149,9 @@ static int _job_alloc(void *job_gres_data, void *node_gres_data,
 	    node_gres_ptr->topo_gres_bitmap &&
 	    node_gres_ptr->topo_gres_cnt_alloc) {
 		for (i = 0; i < node_gres_ptr->topo_cnt; i++) {
-			if (job_gres_ptr->type_model &&
-			    (!node_gres_ptr->topo_model[i] ||
-			     xstrcmp(job_gres_ptr->type_model,
-				     node_gres_ptr->topo_model[i])))
+			if (job_gres_ptr->type_id &&
+			    (job_gres_ptr->type_id !=
+			     node_gres_ptr->topo_type_id[i]))
 				continue;
 			sz1 = bit_size(job_gres_ptr->gres_bit_alloc[node_offset]);
 			sz2 = bit_size(node_gres_ptr->topo_gres_bitmap[i]);
@@ -4097,13 +4167,12 @@ static int _job_alloc(void *job_gres_data, void *node_gres_data,
 					       topo_gres_bitmap[i]);
 			node_gres_ptr->topo_gres_cnt_alloc[i] += gres_cnt;
 			if ((node_gres_ptr->type_cnt == 0) ||
-			    (node_gres_ptr->topo_model == NULL) ||
-			    (node_gres_ptr->topo_model[i] == NULL))
+			    (node_gres_ptr->topo_type_id == NULL) ||
+			    (node_gres_ptr->topo_type_id[i] == 0))
 				continue;
 			for (j = 0; j < node_gres_ptr->type_cnt; j++) {
-				if (!node_gres_ptr->type_model[j] ||
-				    xstrcmp(node_gres_ptr->topo_model[i],
-					    node_gres_ptr->type_model[j]))
+				if (node_gres_ptr->type_id[j] !=
+				    node_gres_ptr->topo_type_id[i])
 					continue;
 				node_gres_ptr->type_cnt_alloc[j] += gres_cnt;
 			}
@@ -4125,13 +4194,12 @@ static int _job_alloc(void *job_gres_data, void *node_gres_data,
 				continue;
 			node_gres_ptr->topo_gres_cnt_alloc[i]++;
 			if ((node_gres_ptr->type_cnt == 0) ||
-			    (node_gres_ptr->topo_model == NULL) ||
-			    (node_gres_ptr->topo_model[i] == NULL))
+			    (node_gres_ptr->topo_type_id == NULL) ||
+			    (node_gres_ptr->topo_type_id[i] == 0))
 				continue;
 			for (j = 0; j < node_gres_ptr->type_cnt; j++) {
-				if (!node_gres_ptr->type_model[j] ||
-				    xstrcmp(node_gres_ptr->topo_model[i],
-					    node_gres_ptr->type_model[j]))
+				if (node_gres_ptr->type_id[j] !=
+				    node_gres_ptr->topo_type_id[i])
 					continue;
 				node_gres_ptr->type_cnt_alloc[j]++;
 			}
@@ -4145,8 +4213,8 @@ static int _job_alloc(void *job_gres_data, void *node_gres_data,
 			_add_gres_type(job_gres_ptr->type_model, node_gres_ptr,
 				       0);
 			for (j = 0; j < node_gres_ptr->type_cnt; j++) {
-				if (xstrcmp(job_gres_ptr->type_model,
-					    node_gres_ptr->type_model[j]))
+				if (job_gres_ptr->type_id !=
+				    node_gres_ptr->type_id[j])
 					continue;
 				node_gres_ptr->type_cnt_alloc[j] +=
 					job_gres_ptr->gres_cnt_alloc;
@@ -4155,12 +4223,10 @@ static int _job_alloc(void *job_gres_data, void *node_gres_data,
 		}
 	}
 
-	if (!type_array_updated && job_gres_ptr->type_model) {
+	if (!type_array_updated && job_gres_ptr->type_id) {
 		gres_cnt = job_gres_ptr->gres_cnt_alloc;
 		for (j = 0; j < node_gres_ptr->type_cnt; j++) {
-			if (!node_gres_ptr->type_model[j] ||
-			    xstrcmp(job_gres_ptr->type_model,
-				    node_gres_ptr->type_model[j]))
+			if (node_gres_ptr->type_id[j] != job_gres_ptr->type_id)
 				continue;
 			k = node_gres_ptr->type_cnt_avail[j] -
 			    node_gres_ptr->type_cnt_alloc[j];
@@ -4348,13 +4414,12 @@ static int _job_dealloc(void *job_gres_data, void *node_gres_data,
 				node_gres_ptr->topo_gres_cnt_alloc[i] = 0;
 			}
 			if ((node_gres_ptr->type_cnt == 0) ||
-			    (node_gres_ptr->topo_model == NULL) ||
-			    (node_gres_ptr->topo_model[i] == NULL))
+			    (node_gres_ptr->topo_type_id == NULL) ||
+			    (node_gres_ptr->topo_type_id[i] == 0))
 				continue;
 			for (j = 0; j < node_gres_ptr->type_cnt; j++) {
-				if (!node_gres_ptr->type_model[j] ||
-				    xstrcmp(node_gres_ptr->topo_model[i],
-					    node_gres_ptr->type_model[j]))
+				if (node_gres_ptr->type_id[j] !=
+				    node_gres_ptr->topo_type_id[i])
 					continue;
 				if (node_gres_ptr->type_cnt_alloc[j] >=
 				    gres_cnt) {
@@ -4387,13 +4452,12 @@ static int _job_dealloc(void *job_gres_data, void *node_gres_data,
 				continue;
 			node_gres_ptr->topo_gres_cnt_alloc[i]--;
 			if ((node_gres_ptr->type_cnt == 0) ||
-			    (node_gres_ptr->topo_model == NULL) ||
-			    (node_gres_ptr->topo_model[i] == NULL))
+			    (node_gres_ptr->topo_type_id == NULL) ||
+			    (node_gres_ptr->topo_type_id[i] == 0))
 				continue;
 			for (j = 0; j < node_gres_ptr->type_cnt; j++) {
-				if (!node_gres_ptr->type_model[j] ||
-				    xstrcmp(node_gres_ptr->topo_model[i],
-					    node_gres_ptr->type_model[j]))
+				if (node_gres_ptr->type_id[j] !=
+				    node_gres_ptr->topo_type_id[i])
 					continue;
 				node_gres_ptr->type_cnt_alloc[j]--;
  			}
@@ -4401,12 +4465,10 @@ static int _job_dealloc(void *job_gres_data, void *node_gres_data,
 		type_array_updated = true;
 	}
 
-	if (!type_array_updated && job_gres_ptr->type_model) {
+	if (!type_array_updated && job_gres_ptr->type_id) {
 		gres_cnt = job_gres_ptr->gres_cnt_alloc;
 		for (j = 0; j < node_gres_ptr->type_cnt; j++) {
-			if (!node_gres_ptr->type_model[j] ||
-			    xstrcmp(job_gres_ptr->type_model,
-				    node_gres_ptr->type_model[j]))
+			if (node_gres_ptr->type_id[j] != job_gres_ptr->type_id)
 				continue;
 			k = MIN(gres_cnt, node_gres_ptr->type_cnt_alloc[j]);
 			node_gres_ptr->type_cnt_alloc[j] -= k;
@@ -4908,6 +4970,7 @@ static int _step_state_validate(char *config, gres_step_state_t **gres_data,
 		gres_ptr = xmalloc(sizeof(gres_step_state_t));
 		gres_ptr->gres_cnt_alloc = (uint32_t) cnt;
 		gres_ptr->type_model = type;
+		gres_ptr->type_id = _gres_type_id(type);
 		type = NULL;
 
 		*gres_data = gres_ptr;
@@ -5048,13 +5111,12 @@ extern int gres_plugin_step_state_validate(char *req_config,
 				if (job_gres_ptr->plugin_id !=
 				    gres_context[i].plugin_id)
 					continue;
-				if (!step_gres_state->type_model)
+				if (!step_gres_state->type_id)
 					break;	/* match GRES name only */
 				job_gres_state = (gres_job_state_t *)
 						 job_gres_ptr->gres_data;
-				if (!job_gres_state->type_model ||
-				    xstrcmp(job_gres_state->type_model,
-					    step_gres_state->type_model))
+				if (job_gres_state->type_id !=
+				    step_gres_state->type_id)
 					continue;
 				break;	/* match GRES name and model */
 			}
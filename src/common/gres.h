@@ -110,17 +110,20 @@ typedef struct gres_node_state {
 	uint64_t *topo_gres_cnt_alloc;
 	uint64_t *topo_gres_cnt_avail;
 	char **topo_model;		/* Type of this gres (e.g. model name) */
+	uint32_t *topo_type_id;		/* Interned topo_model, 0 if none */
 
 	/* Gres type specific information (if gres.conf contains type option) */
 	uint16_t type_cnt;		/* Size of type_ arrays */
 	uint64_t *type_cnt_alloc;
 	uint64_t *type_cnt_avail;
 	char **type_model;		/* Type of this gres (e.g. model name) */
+	uint32_t *type_id;		/* Interned type_model, 0 if none */
 } gres_node_state_t;
 
 /* Gres job state as used by slurmctld daemon */
 typedef struct gres_job_state {
 	char *type_model;		/* Type of this gres (e.g. model name) */
+	uint32_t type_id;		/* Interned type_model, 0 if none */
 
 	/* Count of resources needed per node */
 	uint64_t gres_cnt_alloc;
@@ -139,6 +142,7 @@ typedef struct gres_job_state {
 /* Gres job step state as used by slurmctld daemon */
 typedef struct gres_step_state {
 	char *type_model;		/* Type of this gres (e.g. model name) */
+	uint32_t type_id;		/* Interned type_model, 0 if none */
 
 	/* Count of resources needed per node */
 	uint64_t gres_cnt_alloc;
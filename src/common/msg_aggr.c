@@ -39,6 +39,7 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include <inttypes.h>
 #include <pthread.h>
 
 #include "slurm/slurm.h"
@@ -53,6 +54,16 @@
 #include "src/common/xstring.h"
 #include "src/slurmd/slurmd/slurmd.h"
 
+/*
+ * Collection windows adapt to the load: a window in which more messages than
+ * the one which opened it were collected doubles the next window, up to the
+ * configured WindowTime, while a window collecting a single message halves it,
+ * down to MSG_AGGR_MIN_WINDOW milliseconds. An isolated message is then
+ * delayed little, while a burst of messages (e.g. the end of a large job
+ * array) is packed into few composite messages.
+ */
+#define MSG_AGGR_MIN_WINDOW 10
+
 typedef struct {
 	pthread_mutex_t	aggr_mutex;
 	pthread_cond_t	cond;
@@ -66,6 +77,7 @@ typedef struct {
 	bool            running;
 	pthread_t       thread_id;
 	uint64_t        window;
+	uint64_t        window_cur;
 } msg_collection_type_t;
 
 typedef struct {
@@ -197,6 +209,8 @@ static void * _msg_aggregation_sender(void *arg)
 	struct timespec timeout;
 	slurm_msg_t msg;
 	composite_msg_t cmp;
+	uint64_t min_window;
+	int msg_cnt;
 
 	msg_collection.running = 1;
 
@@ -212,10 +226,14 @@ static void * _msg_aggregation_sender(void *arg)
 			break;
 
 		/* A msg has been collected; start new window */
+		min_window = MIN(MSG_AGGR_MIN_WINDOW, msg_collection.window);
+		if ((msg_collection.window_cur < min_window) ||
+		    (msg_collection.window_cur > msg_collection.window))
+			msg_collection.window_cur = msg_collection.window;
 		gettimeofday(&now, NULL);
-		timeout.tv_sec = now.tv_sec + (msg_collection.window / 1000);
+		timeout.tv_sec = now.tv_sec + (msg_collection.window_cur / 1000);
 		timeout.tv_nsec = (now.tv_usec * 1000) +
-			(1000000 * (msg_collection.window % 1000));
+			(1000000 * (msg_collection.window_cur % 1000));
 		timeout.tv_sec += timeout.tv_nsec / 1000000000;
 		timeout.tv_nsec %= 1000000000;
 
@@ -236,6 +254,18 @@ static void * _msg_aggregation_sender(void *arg)
 		memcpy(&cmp.sender, &msg_collection.node_addr,
 		       sizeof(slurm_addr_t));
 		cmp.msg_list = msg_collection.msg_list;
+		msg_cnt = list_count(cmp.msg_list);
+
+		if (msg_cnt > 1)
+			msg_collection.window_cur =
+				MIN(msg_collection.window_cur * 2,
+				    msg_collection.window);
+		else
+			msg_collection.window_cur =
+				MAX(msg_collection.window_cur / 2, min_window);
+		if (msg_collection.debug_flags & DEBUG_FLAG_ROUTE)
+			info("msg aggr: sending %d msgs, next window %"PRIu64
+			     " msec", msg_cnt, msg_collection.window_cur);
 
 		msg_collection.msg_list =
 			list_create(slurm_free_comp_msg_list);
@@ -278,6 +308,7 @@ extern void msg_aggr_sender_init(char *host, uint16_t port, uint64_t window,
 	slurm_cond_init(&msg_collection.cond, NULL);
 	slurm_set_addr(&msg_collection.node_addr, port, host);
 	msg_collection.window = window;
+	msg_collection.window_cur = window;
 	msg_collection.max_msg_cnt = max_msg_cnt;
 	msg_collection.msg_aggr_list = list_create(_msg_aggr_free);
 	msg_collection.msg_list = list_create(slurm_free_comp_msg_list);
@@ -966,6 +966,10 @@ extern void purge_node_rec (struct node_record *node_ptr)
 	xfree(node_ptr->node_hostname);
 	FREE_NULL_BITMAP(node_ptr->node_spec_bitmap);
 	xfree(node_ptr->os);
+	if (node_ptr->pack_cache) {
+		xfree(node_ptr->pack_cache->data);
+		xfree(node_ptr->pack_cache);
+	}
 	xfree(node_ptr->part_pptr);
 	xfree(node_ptr->power);
 	xfree(node_ptr->reason);
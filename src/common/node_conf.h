@@ -80,6 +80,18 @@ struct config_record {
 };
 extern List config_list;	/* list of config_record entries */
 
+/* Packed copy of the node_record fields which rarely change, kept as
+ * NODE_PACK_SEG_CNT segments which are copied into node information
+ * responses between the fields which are always packed from the record.
+ * See _pack_node() in slurmctld/node_mgr.c */
+#define NODE_PACK_SEG_CNT 5
+typedef struct node_pack_cache {
+	uint32_t epoch;		/* valid if matches node_mgr's pack epoch */
+	uint16_t fast_schedule;	/* FastSchedule value when packed */
+	uint32_t seg_end[NODE_PACK_SEG_CNT]; /* end offset of each segment */
+	char *data;		/* packed segments, back to back */
+} node_pack_cache_t;
+
 extern List front_end_list;	/* list of slurm_conf_frontend_t entries */
 
 struct node_record {
@@ -170,6 +182,7 @@ struct node_record {
 	char *tres_fmt_str;		/* tres this node has */
 	uint64_t *tres_cnt;		/* tres this node has. NO_PACK*/
 	char *mcs_label;		/* mcs_label if mcs plugin in use */
+	node_pack_cache_t *pack_cache;	/* packed static fields, NO_PACK */
 };
 extern struct node_record *node_record_table_ptr;  /* ptr to node records */
 extern int node_record_count;		/* count in node_record_table_ptr */
@@ -2323,7 +2323,7 @@ static void _sbcast_cache_del(void *x)
  *	recently been restarted.
  * RET 0 on success, -1 on error */
 int extract_sbcast_cred(slurm_cred_ctx_t ctx,
-			sbcast_cred_t *sbcast_cred, uint16_t block_no,
+			sbcast_cred_t *sbcast_cred, uint32_t block_no,
 			uint32_t *job_id, char **nodes)
 {
 	struct sbcast_cache *next_cache_rec;
@@ -387,6 +387,8 @@ static slurm_errtab_t slurm_errtab[] = {
 	  "Job step is suspended"                               },
  	{ ESLURMD_STEP_NOTSUSPENDED,
 	  "Job step is not currently suspended"                 },
+	{ ESLURMD_BCAST_CHECKSUM_ERROR,
+	  "File broadcast block failed checksum verification"   },
 
 	/* slurmd errors in user batch job */
 	{ ESCRIPT_CHDIR_FAILED,
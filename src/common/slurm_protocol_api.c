@@ -45,6 +45,7 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <poll.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -86,6 +87,7 @@ strong_alias(get_unit_type, slurm_get_unit_type);
 /* #DEFINES */
 #define _DEBUG	0
 #define MAX_SHUTDOWN_RETRY 5
+#define PERSIST_CTLD_RETRY 60	/* seconds before reopening failed conn */
 
 /* STATIC VARIABLES */
 /* static pthread_mutex_t config_lock = PTHREAD_MUTEX_INITIALIZER; */
@@ -94,6 +96,13 @@ static slurm_protocol_config_t *proto_conf = &proto_conf_default;
 /* static slurm_ctl_conf_t slurmctld_conf; */
 static int message_timeout = -1;
 
+/* Persistent connection to the primary slurmctld for node daemon RPCs,
+ * used with CommunicationParameters=persist_node_conn */
+static slurm_persist_conn_t *persist_ctld_conn = NULL;
+static pthread_mutex_t persist_ctld_mutex = PTHREAD_MUTEX_INITIALIZER;
+static time_t persist_ctld_retry_time = 0;
+static time_t persist_ctld_shutdown = 0;
+
 /* STATIC FUNCTIONS */
 static char *_global_auth_key(void);
 static void  _remap_slurmctld_errno(void);
@@ -491,6 +500,24 @@ char *slurm_get_mpi_params(void)
 	return mpi_params;
 }
 
+/* slurm_get_comm_params
+ * get communication parameters value from slurmctld_conf object
+ * RET char *   - communication parameters from slurm.conf,
+ * MUST be xfreed by caller
+ */
+char *slurm_get_comm_params(void)
+{
+	char *comm_params = NULL;
+	slurm_ctl_conf_t *conf;
+
+	if (!slurmdbd_conf) {
+		conf = slurm_conf_lock();
+		comm_params = xstrdup(conf->comm_params);
+		slurm_conf_unlock();
+	}
+	return comm_params;
+}
+
 /* slurm_get_msg_aggr_params
  * get message aggregation parameters value from slurmctld_conf object
  * RET char *   - message aggregation value from slurm.conf,
@@ -4261,6 +4288,281 @@ _send_and_recv_msgs(int fd, slurm_msg_t *req, int timeout)
 }
 
 
+/*
+ * slurm_persist_ctld_conn_init - Send node daemon RPCs to the primary
+ *	slurmctld over one persistent connection rather than opening a new
+ *	connection for each, see slurm_persist_ctld_msg_type()
+ */
+extern void slurm_persist_ctld_conn_init(void)
+{
+	slurm_ctl_conf_t *conf;
+
+	slurm_mutex_lock(&persist_ctld_mutex);
+	if (persist_ctld_conn) {
+		slurm_mutex_unlock(&persist_ctld_mutex);
+		return;
+	}
+
+	conf = slurm_conf_lock();
+	if (conf->cluster_name && conf->control_addr) {
+		persist_ctld_conn = xmalloc(sizeof(slurm_persist_conn_t));
+		persist_ctld_conn->cluster_name = xstrdup(conf->cluster_name);
+		persist_ctld_conn->fd = -1;
+		persist_ctld_conn->rem_host = xstrdup(conf->control_addr);
+		persist_ctld_conn->rem_port = conf->slurmctld_port;
+		persist_ctld_conn->shutdown = &persist_ctld_shutdown;
+		persist_ctld_conn->timeout = conf->msg_timeout * 1000;
+		persist_ctld_conn->version = SLURM_PROTOCOL_VERSION;
+	}
+	slurm_conf_unlock();
+	persist_ctld_retry_time = 0;
+	slurm_mutex_unlock(&persist_ctld_mutex);
+}
+
+/*
+ * slurm_persist_ctld_conn_fini - Close the persistent slurmctld connection
+ *	opened by slurm_persist_ctld_conn_init()
+ */
+extern void slurm_persist_ctld_conn_fini(void)
+{
+	slurm_mutex_lock(&persist_ctld_mutex);
+	slurm_persist_conn_destroy(persist_ctld_conn);
+	persist_ctld_conn = NULL;
+	slurm_mutex_unlock(&persist_ctld_mutex);
+}
+
+/*
+ * slurm_persist_ctld_msg_type - Return true if the RPC type may be sent
+ *	over a persistent node daemon connection to slurmctld. Their slurmctld
+ *	handlers reply with exactly one slurm_send_rc_msg(), except for
+ *	MESSAGE_COMPOSITE, which is sent by slurm_send_only_controller_msg()
+ *	and gets no reply over the connection.
+ */
+extern bool slurm_persist_ctld_msg_type(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case MESSAGE_COMPOSITE:
+	case MESSAGE_EPILOG_COMPLETE:
+	case MESSAGE_NODE_REGISTRATION_STATUS:
+	case REQUEST_COMPLETE_BATCH_JOB:
+	case REQUEST_COMPLETE_BATCH_SCRIPT:
+	case REQUEST_COMPLETE_PROLOG:
+	case REQUEST_STEP_COMPLETE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * Open the persistent slurmctld connection unless it is open already.
+ * persist_ctld_mutex must be locked by the caller.
+ * RET true if the connection can be used
+ */
+static bool _persist_ctld_conn_ready(void)
+{
+	struct pollfd pfd;
+	time_t now;
+
+	if (!persist_ctld_conn)
+		return false;
+
+	if (persist_ctld_conn->fd >= 0) {
+		/* slurmctld sends nothing but replies, so a readable idle
+		 * connection was closed, e.g. by slurmctld going to standby */
+		pfd.fd = persist_ctld_conn->fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, 0) != 0)
+			slurm_persist_conn_close(persist_ctld_conn);
+	}
+
+	if (persist_ctld_conn->fd < 0) {
+		now = time(NULL);
+		if (now < persist_ctld_retry_time)
+			return false;
+		persist_ctld_conn->version = SLURM_PROTOCOL_VERSION;
+		if (slurm_persist_conn_open(persist_ctld_conn) !=
+		    SLURM_SUCCESS) {
+			debug("%s: unable to open persistent connection to "
+			      "slurmctld, retrying in %d seconds",
+			      __func__, PERSIST_CTLD_RETRY);
+			persist_ctld_retry_time = now + PERSIST_CTLD_RETRY;
+			return false;
+		}
+		debug2("%s: opened persistent connection to slurmctld at %s:%hu",
+		       __func__, persist_ctld_conn->rem_host,
+		       persist_ctld_conn->rem_port);
+	}
+
+	return true;
+}
+
+/*
+ * Send a message to the primary slurmctld over the persistent connection
+ * without waiting for a response.
+ * RET SLURM_SUCCESS, or SLURM_ERROR if the message was not sent, in which
+ *	case it should be sent over a new connection instead
+ */
+static int _send_only_persist_ctld_msg(slurm_msg_t *req)
+{
+	int rc = SLURM_ERROR;
+
+	/* Don't wait behind another RPC, open a new connection instead */
+	if (pthread_mutex_trylock(&persist_ctld_mutex))
+		return rc;
+	if (!_persist_ctld_conn_ready())
+		goto fini;
+
+	req->conn = persist_ctld_conn;
+	if (slurm_send_node_msg(persist_ctld_conn->fd, req) < 0)
+		slurm_persist_conn_close(persist_ctld_conn);
+	else
+		rc = SLURM_SUCCESS;
+
+fini:
+	req->conn = NULL;
+	slurm_mutex_unlock(&persist_ctld_mutex);
+	return rc;
+}
+
+/*
+ * Send a message to the primary slurmctld over the persistent connection
+ * and wait for its response.
+ * OUT fallback - set if the message was not sent, in which case it should be
+ *	sent over a new connection instead
+ * RET 0 on success, -1 on failure
+ */
+static int _send_recv_persist_ctld_msg(slurm_msg_t *req, slurm_msg_t *resp,
+				       bool *fallback)
+{
+	int rc = -1;
+
+	*fallback = true;
+
+	/* Don't wait behind another RPC, open a new connection instead */
+	if (pthread_mutex_trylock(&persist_ctld_mutex))
+		return rc;
+	if (!_persist_ctld_conn_ready())
+		goto fini;
+
+	req->conn = persist_ctld_conn;
+	if (slurm_send_node_msg(persist_ctld_conn->fd, req) < 0) {
+		slurm_persist_conn_close(persist_ctld_conn);
+		goto fini;
+	}
+	*fallback = false;
+
+	slurm_msg_t_init(resp);
+	resp->conn = persist_ctld_conn;
+	rc = slurm_receive_msg(persist_ctld_conn->fd, resp, 0);
+	resp->conn = NULL;
+
+	if (rc != 0) {
+		slurm_persist_conn_close(persist_ctld_conn);
+	} else if ((resp->msg_type == RESPONSE_SLURM_RC) &&
+		   (((return_code_msg_t *) resp->data)->return_code ==
+		    ESLURM_IN_STANDBY_MODE)) {
+		/* Let the regular logic find the controller in charge */
+		slurm_free_return_code_msg(resp->data);
+		resp->data = NULL;
+		slurm_persist_conn_close(persist_ctld_conn);
+		persist_ctld_retry_time = time(NULL) + PERSIST_CTLD_RETRY;
+		*fallback = true;
+		rc = -1;
+	}
+
+fini:
+	req->conn = NULL;
+	slurm_mutex_unlock(&persist_ctld_mutex);
+	return rc;
+}
+
+/*
+ * slurm_query_cache_msg_type - Return true if the RPC type may be answered
+ *	by a slurmcached on the local host, see SlurmcachedPort
+ */
+extern bool slurm_query_cache_msg_type(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case REQUEST_JOB_INFO:
+	case REQUEST_JOB_USER_INFO:
+	case REQUEST_NODE_INFO:
+	case REQUEST_PARTITION_INFO:
+	case REQUEST_PRIORITY_FACTORS:
+	case REQUEST_SHARE_INFO:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * Send a read-only query to the slurmcached on the local host, if any, and
+ * wait for its response. Its answers other than data and "no change" are
+ * discarded, the query should then be sent to slurmctld, which gives the
+ * authoritative answer (including any error).
+ * RET 0 on success, -1 if the query should be sent to slurmctld instead
+ */
+static int _send_recv_query_cache_msg(slurm_msg_t *req, slurm_msg_t *resp)
+{
+	slurm_ctl_conf_t *conf;
+	slurm_addr_t cache_addr;
+	uint16_t cache_port;
+	uint32_t slurm_user_id;
+	char *auth_info;
+	uid_t uid = (uid_t) -1;
+	int fd, rc;
+
+	if (getenv("SLURM_NO_QUERY_CACHE"))
+		return -1;
+	conf = slurm_conf_lock();
+	cache_port = conf->slurmcached_port;
+	slurm_user_id = conf->slurm_user_id;
+	slurm_conf_unlock();
+	if (!cache_port)
+		return -1;
+
+	slurm_set_addr(&cache_addr, cache_port, "127.0.0.1");
+	if ((fd = slurm_open_msg_conn(&cache_addr)) < 0)
+		return -1;	/* No slurmcached on this host */
+
+	rc = _send_and_recv_msg(fd, req, resp, 0);
+	if (resp->auth_cred) {
+		auth_info = slurm_get_auth_info();
+		uid = g_slurm_auth_get_uid(resp->auth_cred, auth_info);
+		xfree(auth_info);
+		g_slurm_auth_destroy(resp->auth_cred);
+		resp->auth_cred = NULL;
+	} else
+		rc = -1;
+	if (rc != 0)
+		return -1;
+
+	/* Only SlurmUser's (or root's) slurmcached speaks for slurmctld */
+	if ((uid != 0) && (uid != slurm_user_id)) {
+		error("%s: slurmcached answer from invalid uid %d ignored",
+		      __func__, (int) uid);
+		slurm_free_msg_data(resp->msg_type, resp->data);
+		resp->data = NULL;
+		return -1;
+	}
+
+	if ((resp->msg_type == RESPONSE_SLURM_RC) &&
+	    (((return_code_msg_t *) resp->data)->return_code !=
+	     SLURM_NO_CHANGE_IN_DATA)) {
+		debug2("%s: slurmcached did not answer %s: %s", __func__,
+		       rpc_num2string(req->msg_type),
+		       slurm_strerror(((return_code_msg_t *) resp->data)->
+				      return_code));
+		slurm_free_return_code_msg(resp->data);
+		resp->data = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
 /*
  * slurm_send_recv_controller_msg
  * opens a connection to the controller, sends the controller a message,
@@ -4291,6 +4593,18 @@ int slurm_send_recv_controller_msg(slurm_msg_t *req, slurm_msg_t *resp)
 
 	if (working_cluster_rec)
 		req->flags |= SLURM_GLOBAL_AUTH_KEY;
+	else if (persist_ctld_conn &&
+		 slurm_persist_ctld_msg_type(req->msg_type)) {
+		bool fallback;
+
+		rc = _send_recv_persist_ctld_msg(req, resp, &fallback);
+		if (!fallback)
+			goto cleanup;
+	} else if (slurm_query_cache_msg_type(req->msg_type) &&
+		   (_send_recv_query_cache_msg(req, resp) == 0)) {
+		rc = 0;
+		goto cleanup;
+	}
 
 	if ((fd = slurm_open_controller_conn(&ctrl_addr, &use_backup)) < 0) {
 		rc = -1;
@@ -4380,6 +4694,11 @@ int slurm_send_only_controller_msg(slurm_msg_t *req)
 	slurm_addr_t ctrl_addr;
 	bool     use_backup = false;
 
+	if (persist_ctld_conn && !working_cluster_rec &&
+	    slurm_persist_ctld_msg_type(req->msg_type) &&
+	    (_send_only_persist_ctld_msg(req) == SLURM_SUCCESS))
+		return SLURM_SUCCESS;
+
 	/*
 	 *  Open connection to SLURM controller:
 	 */
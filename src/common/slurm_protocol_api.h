@@ -201,6 +201,13 @@ char *slurm_get_mpi_default(void);
  */
 char *slurm_get_mpi_params(void);
 
+/* slurm_get_comm_params
+ * get communication parameters value from slurmctld_conf object
+ * RET char *   - communication parameters value from slurm.conf,
+ *                MUST be xfreed by caller
+ */
+char *slurm_get_comm_params(void);
+
 /* slurm_get_msg_aggr_params
  * get message aggregation parameters value from slurmctld_conf object
  * RET char *   - msg aggregation parameters default value from slurm.conf,
@@ -1184,6 +1191,32 @@ int slurm_send_rc_msg(slurm_msg_t * request_msg, int rc);
  */
 int slurm_send_rc_err_msg(slurm_msg_t *msg, int rc, char *err_msg);
 
+/*
+ * slurm_persist_ctld_conn_init - Send node daemon RPCs to the primary
+ *	slurmctld over one persistent connection rather than opening a new
+ *	connection for each, see slurm_persist_ctld_msg_type()
+ */
+extern void slurm_persist_ctld_conn_init(void);
+
+/*
+ * slurm_persist_ctld_conn_fini - Close the persistent slurmctld connection
+ *	opened by slurm_persist_ctld_conn_init()
+ */
+extern void slurm_persist_ctld_conn_fini(void);
+
+/*
+ * slurm_persist_ctld_msg_type - Return true if the RPC type may be sent
+ *	over a persistent node daemon connection to slurmctld
+ */
+extern bool slurm_persist_ctld_msg_type(uint16_t msg_type);
+
+/*
+ * slurm_query_cache_msg_type - Return true if the RPC type may be answered
+ *	by a slurmcached on the local host, see SlurmcachedPort. Set the
+ *	SLURM_NO_QUERY_CACHE environment variable to always query slurmctld.
+ */
+extern bool slurm_query_cache_msg_type(uint16_t msg_type);
+
 /* slurm_send_recv_controller_msg
  * opens a connection to the controller, sends the controller a message,
  * listens for the response, then closes the connection
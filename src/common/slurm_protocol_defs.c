@@ -695,7 +695,22 @@ extern void slurm_free_job_step_kill_msg(job_step_kill_msg_t * msg)
 
 extern void slurm_free_job_info_request_msg(job_info_request_msg_t *msg)
 {
-	xfree(msg);
+	if (msg) {
+		slurm_free_job_info_filter(msg->filter);
+		xfree(msg);
+	}
+}
+
+extern void slurm_free_job_info_filter(job_info_filter_t *filter)
+{
+	if (filter) {
+		xfree(filter->accounts);
+		xfree(filter->job_ids);
+		xfree(filter->partitions);
+		xfree(filter->states);
+		xfree(filter->user_ids);
+		xfree(filter);
+	}
 }
 
 extern void slurm_free_job_step_info_request_msg(job_step_info_request_msg_t *msg)
@@ -1415,6 +1430,8 @@ extern void slurm_free_suspend_int_msg(suspend_int_msg_t *msg)
 
 extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg)
 {
+	uint32_t i;
+
 	if (msg) {
 		xfree(msg->rpc_type_id);
 		xfree(msg->rpc_type_cnt);
@@ -1422,6 +1439,14 @@ extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg)
 		xfree(msg->rpc_user_id);
 		xfree(msg->rpc_user_cnt);
 		xfree(msg->rpc_user_time);
+		if (msg->rpc_comp_host) {
+			for (i = 0; i < msg->rpc_comp_size; i++)
+				xfree(msg->rpc_comp_host[i]);
+			xfree(msg->rpc_comp_host);
+		}
+		xfree(msg->rpc_comp_cnt);
+		xfree(msg->rpc_comp_msg_cnt);
+		xfree(msg->rpc_comp_time);
 		xfree(msg);
 	}
 }
@@ -2172,6 +2197,140 @@ extern uint32_t job_state_num(const char *state_name)
 	return NO_VAL;
 }
 
+static char **_split_names(char *names, int *name_cnt)
+{
+	char **name_array = NULL, *tmp_names, *tok, *last = NULL;
+	int cnt = 0;
+
+	*name_cnt = 0;
+	if (!names || !names[0])
+		return NULL;
+	tmp_names = xstrdup(names);
+	tok = strtok_r(tmp_names, ",", &last);
+	while (tok) {
+		xrealloc(name_array, sizeof(char *) * (cnt + 1));
+		name_array[cnt++] = xstrdup(tok);
+		tok = strtok_r(NULL, ",", &last);
+	}
+	xfree(tmp_names);
+	*name_cnt = cnt;
+	return name_array;
+}
+
+static void _free_names(char **name_array, int name_cnt)
+{
+	int i;
+
+	for (i = 0; i < name_cnt; i++)
+		xfree(name_array[i]);
+	xfree(name_array);
+}
+
+static bool _name_in_array(char *name, char **name_array, int name_cnt)
+{
+	int i;
+
+	if (!name)
+		return false;
+	for (i = 0; i < name_cnt; i++) {
+		if (!xstrcasecmp(name, name_array[i]))
+			return true;
+	}
+	return false;
+}
+
+extern void job_filter_args_init(job_filter_args_t *args,
+				 job_info_filter_t *filter)
+{
+	args->filter = filter;
+	args->acct_array = _split_names(filter->accounts, &args->acct_cnt);
+	args->part_array = _split_names(filter->partitions, &args->part_cnt);
+}
+
+extern void job_filter_args_free(job_filter_args_t *args)
+{
+	_free_names(args->acct_array, args->acct_cnt);
+	_free_names(args->part_array, args->part_cnt);
+	args->acct_array = args->part_array = NULL;
+	args->acct_cnt = args->part_cnt = 0;
+}
+
+extern bool job_filter_match(job_filter_args_t *args, uint32_t job_id,
+			     uint32_t array_job_id, uint32_t user_id,
+			     uint32_t job_state, char *account)
+{
+	job_info_filter_t *filter = args->filter;
+	uint32_t state;
+	bool match;
+	int i;
+
+	if (filter->job_id_cnt) {
+		match = false;
+		for (i = 0; i < filter->job_id_cnt; i++) {
+			if ((filter->job_ids[i] == job_id) ||
+			    (filter->job_ids[i] == array_job_id)) {
+				match = true;
+				break;
+			}
+		}
+		if (!match)
+			return false;
+	}
+
+	if (filter->user_id_cnt) {
+		match = false;
+		for (i = 0; i < filter->user_id_cnt; i++) {
+			if (filter->user_ids[i] == user_id) {
+				match = true;
+				break;
+			}
+		}
+		if (!match)
+			return false;
+	}
+
+	if (filter->state_cnt) {
+		match = false;
+		for (i = 0; i < filter->state_cnt; i++) {
+			state = filter->states[i];
+			if (state & JOB_STATE_FLAGS) {
+				if (state & job_state) {
+					match = true;
+					break;
+				}
+			} else if (state == (job_state & JOB_STATE_BASE)) {
+				match = true;
+				break;
+			}
+		}
+		if (!match)
+			return false;
+	}
+
+	if (args->acct_cnt &&
+	    !_name_in_array(account, args->acct_array, args->acct_cnt))
+		return false;
+
+	return true;
+}
+
+extern bool job_filter_part_match(job_filter_args_t *args, char *partitions)
+{
+	char *tmp_name, *tok, *last = NULL;
+	bool match = false;
+
+	if (!partitions)
+		return false;
+	tmp_name = xstrdup(partitions);
+	tok = strtok_r(tmp_name, ",", &last);
+	while (tok && !match) {
+		match = _name_in_array(tok, args->part_array, args->part_cnt);
+		tok = strtok_r(NULL, ",", &last);
+	}
+	xfree(tmp_name);
+	return match;
+}
+
 extern char *trigger_res_type(uint16_t res_type)
 {
 	if      (res_type == TRIGGER_RES_TYPE_JOB)
@@ -563,6 +563,14 @@ typedef struct priority_factors_object {
 	double   *tres_weights; /* PriorityWeightTRES weights as an array */
 
 	uint32_t nice;
+
+	/* Not packed. Used by priority/multifactor to reuse the weighted job
+	 * size, partition, QOS and TRES factors while their inputs are
+	 * unchanged, recalculating only the age and fair-share factors */
+	uint32_t cache_epoch;	/* plugin configuration epoch of the cache */
+	uint32_t cache_sig;	/* checksum of the static factor inputs */
+	double   cache_tres;	/* sum of the weighted TRES factors */
+	uint32_t cache_prio;	/* priority last calculated */
 } priority_factors_object_t;
 
 typedef struct priority_factors_request_msg {
@@ -606,6 +614,7 @@ typedef struct job_step_id_msg {
 typedef struct job_info_request_msg {
 	time_t last_update;
 	uint16_t show_flags;
+	job_info_filter_t *filter;	/* NULL for all jobs */
 } job_info_request_msg_t;
 
 typedef struct job_step_info_request_msg {
@@ -1115,7 +1124,7 @@ enum compress_type {
 
 typedef struct file_bcast_msg {
 	char *fname;		/* name of the destination file */
-	uint16_t block_no;	/* block number of this data */
+	uint32_t block_no;	/* block number of this data */
 	uint16_t last_block;	/* last block of bcast if set */
 	uint16_t force;		/* replace existing file if set */
 	uint16_t compress;	/* compress file if set, use compress_type */
@@ -1126,8 +1135,9 @@ typedef struct file_bcast_msg {
 	time_t atime;		/* last access time for destination file */
 	time_t mtime;		/* last modification time for dest file */
 	sbcast_cred_t *cred;	/* credential for the RPC */
+	uint32_t block_cksum;	/* checksum of uncompressed block data */
 	uint32_t block_len;	/* length of this data block */
-	uint32_t block_offset;	/* offset for this data block */
+	uint64_t block_offset;	/* offset for this data block */
 	uint32_t uncomp_len;	/* uncompressed length of this data block */
 	char *block;		/* data for this block */
 	uint64_t file_size;	/* file size */
@@ -1297,6 +1307,7 @@ extern void slurm_free_last_update_msg(last_update_msg_t * msg);
 extern void slurm_free_return_code_msg(return_code_msg_t * msg);
 extern void slurm_free_job_alloc_info_msg(job_alloc_info_msg_t * msg);
 extern void slurm_free_job_info_request_msg(job_info_request_msg_t *msg);
+extern void slurm_free_job_info_filter(job_info_filter_t *filter);
 extern void slurm_free_job_step_info_request_msg(
 		job_step_info_request_msg_t *msg);
 extern void slurm_free_front_end_info_request_msg(
@@ -1478,6 +1489,36 @@ extern char *job_share_string(uint16_t shared);
 extern char *job_state_string(uint32_t inx);
 extern char *job_state_string_compact(uint32_t inx);
 extern uint32_t job_state_num(const char *state_name);
+
+/* A job_info_filter_t with its account and partition names split */
+typedef struct {
+	job_info_filter_t *filter;
+	char **acct_array;
+	int acct_cnt;
+	char **part_array;
+	int part_cnt;
+} job_filter_args_t;
+
+/* Split the names of a filter, free the result with job_filter_args_free() */
+extern void job_filter_args_init(job_filter_args_t *args,
+				 job_info_filter_t *filter);
+extern void job_filter_args_free(job_filter_args_t *args);
+
+/*
+ * Test a job's IDs, state and account against a filter, the partitions
+ * are tested by job_filter_part_match()
+ * RET true if the job matches
+ */
+extern bool job_filter_match(job_filter_args_t *args, uint32_t job_id,
+			     uint32_t array_job_id, uint32_t user_id,
+			     uint32_t job_state, char *account);
+
+/*
+ * Test a comma separated list of partition names against a filter
+ * RET true if any of them is in the filter
+ */
+extern bool job_filter_part_match(job_filter_args_t *args, char *partitions);
+
 extern char *node_state_string(uint32_t inx);
 extern char *node_state_string_compact(uint32_t inx);
 
@@ -156,6 +156,35 @@ extern int slurm_unpack_block_info_msg(
 	block_info_msg_t **block_info_msg_pptr, Buf buffer,
 	uint16_t protocol_version);
 
+/*
+ * unpack_job_info_offsets - unpack a RESPONSE_JOB_INFO message body,
+ *	optionally recording where in the buffer each job record starts
+ * OUT msg - the unpacked message
+ * OUT offsets - if not NULL, set to an xmalloc'ed array of record_count + 1
+ *	buffer offsets, the last one being the end of the last record
+ * IN/OUT buffer - source of the unpack
+ * RET 0 or error code
+ */
+extern int unpack_job_info_offsets(job_info_msg_t **msg, uint32_t **offsets,
+				   Buf buffer, uint16_t protocol_version);
+
+/*
+ * pack_job_info_records - Pack a RESPONSE_JOB_INFO message body holding
+ *	the selected job records of another one, copied as they were packed
+ *	rather than packed again
+ * IN job_info - the message, unpacked from src
+ * IN src - buffer holding the packed job records
+ * IN offsets - offsets of the records in src, as set by
+ *	unpack_job_info_offsets()
+ * IN match - called for each job, its record is copied if it returns true
+ * IN arg - passed to match
+ * RET the message body, free with free_buf()
+ */
+extern Buf pack_job_info_records(job_info_msg_t *job_info, Buf src,
+				 uint32_t *offsets,
+				 bool (*match)(job_info_t *job, void *arg),
+				 void *arg);
+
 /* Translate memory limits from old format to new */
 /* Remove when version 16.05 support is no longer required. */
 extern uint32_t xlate_mem_new2old(uint64_t new_mem);
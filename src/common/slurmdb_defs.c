@@ -46,6 +46,7 @@
 #include "src/common/slurm_protocol_defs.h"
 #include "src/common/slurm_time.h"
 #include "src/common/slurmdb_defs.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/slurmdbd/read_config.h"
@@ -659,8 +660,10 @@ extern void slurmdb_destroy_qos_usage(void *object)
 		(slurmdb_qos_usage_t *)object;
 
 	if (usage) {
+		xhash_free_ptr((xhash_t **) &usage->acct_limit_hash);
 		FREE_NULL_LIST(usage->acct_limit_list);
 		FREE_NULL_LIST(usage->job_list);
+		xhash_free_ptr((xhash_t **) &usage->user_limit_hash);
 		FREE_NULL_LIST(usage->user_limit_list);
 		xfree(usage->grp_used_tres_run_secs);
 		xfree(usage->grp_used_tres);
@@ -1128,6 +1131,7 @@ extern void slurmdb_destroy_job_cond(void *object)
 		FREE_NULL_LIST(job_cond->acct_list);
 		FREE_NULL_LIST(job_cond->associd_list);
 		FREE_NULL_LIST(job_cond->cluster_list);
+		xfree(job_cond->cursor_cluster);
 		FREE_NULL_LIST(job_cond->groupid_list);
 		FREE_NULL_LIST(job_cond->jobname_list);
 		FREE_NULL_LIST(job_cond->partition_list);
@@ -1253,6 +1257,144 @@ extern void slurmdb_destroy_used_limits(void *object)
 	}
 }
 
+/* Entry of the xhash indexes of a QOS's acct_limit_list and user_limit_list.
+ * The records themselves are owned by the lists. */
+typedef struct {
+	char uid_str[16];
+	slurmdb_used_limits_t *used_limits;
+} used_limits_idx_t;
+
+static const char *_used_limits_acct_id(void *item)
+{
+	used_limits_idx_t *idx = (used_limits_idx_t *) item;
+
+	return idx->used_limits->acct ? idx->used_limits->acct : "";
+}
+
+static const char *_used_limits_user_id(void *item)
+{
+	used_limits_idx_t *idx = (used_limits_idx_t *) item;
+
+	return idx->uid_str;
+}
+
+static void _used_limits_idx_free(void *item)
+{
+	xfree(item);
+}
+
+static void _used_limits_idx_add(xhash_t *hash,
+				 slurmdb_used_limits_t *used_limits)
+{
+	used_limits_idx_t *idx = xmalloc(sizeof(used_limits_idx_t));
+
+	idx->used_limits = used_limits;
+	snprintf(idx->uid_str, sizeof(idx->uid_str), "%u", used_limits->uid);
+	xhash_add(hash, idx);
+}
+
+/* Make sure the index covers every record of the list, records can be added
+ * to the list without going through the index (e.g. when unpacked) */
+static xhash_t *_used_limits_idx_sync(void **hash_ptr, List limit_list,
+				      xhash_idfunc_t idfunc)
+{
+	xhash_t *hash = (xhash_t *) *hash_ptr;
+	slurmdb_used_limits_t *used_limits;
+	ListIterator itr;
+
+	if (!hash)
+		*hash_ptr = hash = xhash_init(idfunc, _used_limits_idx_free,
+						 NULL, 0);
+	else if (xhash_count(hash) == list_count(limit_list))
+		return hash;
+
+	xhash_clear(hash);
+	itr = list_iterator_create(limit_list);
+	while ((used_limits = list_next(itr)))
+		_used_limits_idx_add(hash, used_limits);
+	list_iterator_destroy(itr);
+
+	return hash;
+}
+
+static slurmdb_used_limits_t *_used_limits_create(int tres_cnt)
+{
+	slurmdb_used_limits_t *used_limits;
+	int i = sizeof(uint64_t) * tres_cnt;
+
+	used_limits = xmalloc(sizeof(slurmdb_used_limits_t));
+	used_limits->tres = xmalloc(i);
+	used_limits->tres_run_mins = xmalloc(i);
+
+	return used_limits;
+}
+
+/* Checks for record in usage->acct_limit_list of acct, if the list doesn't
+ * exist it will be created, if the acct record doesn't exist it will be
+ * added to the list. Lookups go through a hash table indexed by account name.
+ * In all cases the account record is returned.
+ */
+extern slurmdb_used_limits_t *slurmdb_get_acct_used_limits(
+	slurmdb_qos_usage_t *usage, char *acct, int tres_cnt)
+{
+	slurmdb_used_limits_t *used_limits;
+	used_limits_idx_t *idx;
+	xhash_t *hash;
+
+	xassert(usage);
+
+	if (!usage->acct_limit_list)
+		usage->acct_limit_list =
+			list_create(slurmdb_destroy_used_limits);
+	hash = _used_limits_idx_sync(&usage->acct_limit_hash,
+				     usage->acct_limit_list,
+				     _used_limits_acct_id);
+
+	if ((idx = xhash_get(hash, acct ? acct : "")))
+		return idx->used_limits;
+
+	used_limits = _used_limits_create(tres_cnt);
+	used_limits->acct = xstrdup(acct);
+	list_append(usage->acct_limit_list, used_limits);
+	_used_limits_idx_add(hash, used_limits);
+
+	return used_limits;
+}
+
+/* Checks for record in usage->user_limit_list of user_id, if the list
+ * doesn't exist it will be created, if the user_id record doesn't exist it
+ * will be added to the list. Lookups go through a hash table indexed by uid.
+ * In all cases the user record is returned.
+ */
+extern slurmdb_used_limits_t *slurmdb_get_user_used_limits(
+	slurmdb_qos_usage_t *usage, uint32_t user_id, int tres_cnt)
+{
+	slurmdb_used_limits_t *used_limits;
+	used_limits_idx_t *idx;
+	char uid_str[16];
+	xhash_t *hash;
+
+	xassert(usage);
+
+	if (!usage->user_limit_list)
+		usage->user_limit_list =
+			list_create(slurmdb_destroy_used_limits);
+	hash = _used_limits_idx_sync(&usage->user_limit_hash,
+				     usage->user_limit_list,
+				     _used_limits_user_id);
+
+	snprintf(uid_str, sizeof(uid_str), "%u", user_id);
+	if ((idx = xhash_get(hash, uid_str)))
+		return idx->used_limits;
+
+	used_limits = _used_limits_create(tres_cnt);
+	used_limits->uid = user_id;
+	list_append(usage->user_limit_list, used_limits);
+	_used_limits_idx_add(hash, used_limits);
+
+	return used_limits;
+}
+
 extern void slurmdb_destroy_update_shares_rec(void *object)
 {
 	xfree(object);
@@ -277,4 +277,11 @@ extern int slurmdb_get_old_tres_pos(slurmdb_tres_rec_t **new_array,
 
 extern int slurmdb_get_tres_base_unit(char *tres_type);
 
+/* Return the used limits record of an account or user within a QOS's usage,
+ * creating it (with tres_cnt sized arrays) if it doesn't exist yet. */
+extern slurmdb_used_limits_t *slurmdb_get_acct_used_limits(
+	slurmdb_qos_usage_t *usage, char *acct, int tres_cnt);
+extern slurmdb_used_limits_t *slurmdb_get_user_used_limits(
+	slurmdb_qos_usage_t *usage, uint32_t user_id, int tres_cnt);
+
 #endif
@@ -3556,6 +3556,11 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t protocol_version,
 			pack32(NO_VAL, buffer);	/* count(wckey_list) */
 			pack16(0, buffer);	/* without_steps */
 			pack16(0, buffer);	/* without_usage_truncation */
+			if (protocol_version >= SLURM_17_11_PROTOCOL_VERSION) {
+				packnull(buffer); /* cursor_cluster */
+				pack32(0, buffer);	/* cursor_jobid */
+				pack32(0, buffer);	/* page_size */
+			}
 			return;
 		}
 
@@ -3745,6 +3750,11 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t protocol_version,
 
 		pack16(object->without_steps, buffer);
 		pack16(object->without_usage_truncation, buffer);
+		if (protocol_version >= SLURM_17_11_PROTOCOL_VERSION) {
+			packstr(object->cursor_cluster, buffer);
+			pack32(object->cursor_jobid, buffer);
+			pack32(object->page_size, buffer);
+		}
 	}
 }
 
@@ -3938,6 +3948,12 @@ extern int slurmdb_unpack_job_cond(void **object, uint16_t protocol_version,
 
 		safe_unpack16(&object_ptr->without_steps, buffer);
 		safe_unpack16(&object_ptr->without_usage_truncation, buffer);
+		if (protocol_version >= SLURM_17_11_PROTOCOL_VERSION) {
+			safe_unpackstr_xmalloc(&object_ptr->cursor_cluster,
+					       &uint32_tmp, buffer);
+			safe_unpack32(&object_ptr->cursor_jobid, buffer);
+			safe_unpack32(&object_ptr->page_size, buffer);
+		}
 	}
 
 	return SLURM_SUCCESS;
@@ -5490,6 +5506,11 @@ extern void slurmdb_pack_stats_msg(void *object, uint16_t protocol_version,
 		pack32_array(stats_ptr->rpc_user_id,   i, buffer);
 		pack32_array(stats_ptr->rpc_user_cnt,  i, buffer);
 		pack64_array(stats_ptr->rpc_user_time, i, buffer);
+
+		if (protocol_version >= SLURM_17_11_PROTOCOL_VERSION) {
+			pack64(stats_ptr->rollup_hours, buffer);
+			pack_time(stats_ptr->rollup_last_hour, buffer);
+		}
 	} else {
 		error("%s: protocol_version %hu not supported",
 		      __func__, protocol_version);
@@ -5551,6 +5572,11 @@ extern int slurmdb_unpack_stats_msg(void **object, uint16_t protocol_version,
 				    buffer);
 		if (uint32_tmp != stats_ptr->user_cnt)
 			goto unpack_error;
+
+		if (protocol_version >= SLURM_17_11_PROTOCOL_VERSION) {
+			safe_unpack64(&stats_ptr->rollup_hours, buffer);
+			safe_unpack_time(&stats_ptr->rollup_last_hour, buffer);
+		}
 	} else {
 		error("%s: protocol_version %hu not supported",
 		      __func__, protocol_version);
@@ -186,6 +186,20 @@ extern int slurm_close_slurmdbd_conn(void)
 	return SLURM_SUCCESS;
 }
 
+/* Return the protocol version agreed upon with the SlurmDBD, 0 if no
+ * connection has been opened */
+extern uint16_t slurmdbd_conn_version(void)
+{
+	uint16_t version = 0;
+
+	slurm_mutex_lock(&slurmdbd_lock);
+	if (slurmdbd_conn && (slurmdbd_conn->fd >= 0))
+		version = slurmdbd_conn->version;
+	slurm_mutex_unlock(&slurmdbd_lock);
+
+	return version;
+}
+
 /* Send an RPC to the SlurmDBD and wait for the return code reply.
  * The RPC will not be queued if an error occurs.
  * Returns SLURM_SUCCESS or an error code */
@@ -40,6 +40,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "mysql_common.h"
 #include "src/common/log.h"
 #include "src/common/xstring.h"
@@ -55,6 +57,44 @@ typedef struct {
 	char *columns;
 } db_key_t;
 
+/* Upper bounds in usec of the prepared statement latency histogram
+ * buckets, the last bucket holds everything slower */
+#define STMT_HIST_CNT 6
+static uint32_t stmt_hist_usec[STMT_HIST_CNT - 1] =
+	{ 100, 1000, 10000, 100000, 1000000 };
+static char *stmt_hist_name[STMT_HIST_CNT] =
+	{ "<100us", "<1ms", "<10ms", "<100ms", "<1s", ">=1s" };
+
+typedef struct {
+	uint64_t exec_cnt;
+	uint64_t hist[STMT_HIST_CNT];
+	uint64_t max_usec;
+	char *query;
+	MYSQL_STMT *stmt;
+	uint64_t total_usec;
+} db_stmt_t;
+
+static void _destroy_db_stmt(void *arg)
+{
+	db_stmt_t *db_stmt = (db_stmt_t *)arg;
+
+	if (db_stmt) {
+		if (db_stmt->stmt)
+			mysql_stmt_close(db_stmt->stmt);
+		xfree(db_stmt->query);
+		xfree(db_stmt);
+	}
+}
+
+static int _find_db_stmt(void *x, void *key)
+{
+	db_stmt_t *db_stmt = (db_stmt_t *)x;
+
+	if (!xstrcmp(db_stmt->query, (char *)key))
+		return 1;
+	return 0;
+}
+
 static void _destroy_db_key(void *arg)
 {
 	db_key_t *db_key = (db_key_t *)arg;
@@ -602,6 +642,8 @@ extern mysql_conn_t *create_mysql_conn(int conn_num, bool rollback,
 	mysql_conn->cluster_name = xstrdup(cluster_name);
 	slurm_mutex_init(&mysql_conn->lock);
 	mysql_conn->update_list = list_create(slurmdb_destroy_update_object);
+	mysql_conn->stmt_list = list_create(_destroy_db_stmt);
+	mysql_conn->stmt_log_time = time(NULL);
 
 	return mysql_conn;
 }
@@ -614,6 +656,7 @@ extern int destroy_mysql_conn(mysql_conn_t *mysql_conn)
 		xfree(mysql_conn->cluster_name);
 		slurm_mutex_destroy(&mysql_conn->lock);
 		FREE_NULL_LIST(mysql_conn->update_list);
+		FREE_NULL_LIST(mysql_conn->stmt_list);
 		xfree(mysql_conn);
 	}
 
@@ -743,6 +786,11 @@ extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn)
 {
 	slurm_mutex_lock(&mysql_conn->lock);
 	if (mysql_conn && mysql_conn->db_conn) {
+		/* statements belong to the connection being closed,
+		 * connections not made by create_mysql_conn() (e.g. the
+		 * rollup threads') have none */
+		if (mysql_conn->stmt_list)
+			list_flush(mysql_conn->stmt_list);
 		if (mysql_thread_safe())
 			mysql_thread_end();
 		mysql_close(mysql_conn->db_conn);
@@ -966,3 +1014,204 @@ extern int mysql_db_create_table(mysql_conn_t *mysql_conn, char *table_name,
 		mysql_conn, table_name, first_field, ending);
 	return rc;
 }
+
+/* NOTE: Insure that mysql_conn->lock is set on function entry */
+static int _stmt_prepare(MYSQL *db_conn, db_stmt_t *db_stmt)
+{
+	if (!(db_stmt->stmt = mysql_stmt_init(db_conn))) {
+		error("mysql_stmt_init failed: %s", mysql_error(db_conn));
+		return SLURM_ERROR;
+	}
+
+	if (mysql_stmt_prepare(db_stmt->stmt, db_stmt->query,
+			       strlen(db_stmt->query))) {
+		errno = mysql_stmt_errno(db_stmt->stmt);
+		if (errno == ER_NO_SUCH_TABLE)
+			debug4("This could happen often and is expected.\n"
+			       "mysql_stmt_prepare failed: %d %s\n%s",
+			       errno, mysql_stmt_error(db_stmt->stmt),
+			       db_stmt->query);
+		else
+			error("mysql_stmt_prepare failed: %d %s\n%s",
+			      errno, mysql_stmt_error(db_stmt->stmt),
+			      db_stmt->query);
+		mysql_stmt_close(db_stmt->stmt);
+		db_stmt->stmt = NULL;
+		return SLURM_ERROR;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+static void _stmt_record_time(db_stmt_t *db_stmt, uint64_t usec)
+{
+	int i;
+
+	db_stmt->exec_cnt++;
+	db_stmt->total_usec += usec;
+	db_stmt->max_usec = MAX(db_stmt->max_usec, usec);
+	for (i = 0; i < (STMT_HIST_CNT - 1); i++) {
+		if (usec < stmt_hist_usec[i])
+			break;
+	}
+	db_stmt->hist[i]++;
+}
+
+extern int mysql_db_stmt_query(mysql_conn_t *mysql_conn, char *query,
+			       MYSQL_BIND *bind)
+{
+	db_stmt_t *db_stmt;
+	bool retry = true;
+	int err, rc = SLURM_SUCCESS;
+	DEF_TIMERS;
+
+	if (!mysql_conn || !mysql_conn->db_conn) {
+		fatal("You haven't inited this storage yet.");
+		return 0;	/* For CLANG false positive */
+	}
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	/* clear out the old results so we don't get a 2014 error */
+	_clear_results(mysql_conn->db_conn);
+
+	if (!(db_stmt = list_find_first(mysql_conn->stmt_list,
+					_find_db_stmt, query))) {
+		db_stmt = xmalloc(sizeof(db_stmt_t));
+		db_stmt->query = xstrdup(query);
+		list_append(mysql_conn->stmt_list, db_stmt);
+	}
+
+	START_TIMER;
+	while (1) {
+		if (!db_stmt->stmt &&
+		    (_stmt_prepare(mysql_conn->db_conn, db_stmt) !=
+		     SLURM_SUCCESS)) {
+			/* Same as _mysql_query_internal() */
+			if (errno == ER_NO_SUCH_TABLE)
+				errno = 0;
+			else
+				rc = SLURM_ERROR;
+			break;
+		}
+
+		if (!mysql_stmt_bind_param(db_stmt->stmt, bind) &&
+		    !mysql_stmt_execute(db_stmt->stmt))
+			break;
+
+		err = mysql_stmt_errno(db_stmt->stmt);
+		/* Statements don't survive the client reconnecting to the
+		 * server, prepare it again and give it one more try. */
+		if (retry && ((err == CR_SERVER_GONE_ERROR) ||
+			      (err == CR_SERVER_LOST) ||
+			      (err == ER_UNKNOWN_STMT_HANDLER) ||
+			      (err == ER_NEED_REPREPARE))) {
+			debug("mysql_stmt_execute failed: %d %s, preparing "
+			      "the statement again", err,
+			      mysql_stmt_error(db_stmt->stmt));
+			mysql_stmt_close(db_stmt->stmt);
+			db_stmt->stmt = NULL;
+			retry = false;
+			continue;
+		}
+
+		error("mysql_stmt_execute failed: %d %s\n%s",
+		      err, mysql_stmt_error(db_stmt->stmt), query);
+		if (err == ER_LOCK_WAIT_TIMEOUT)
+			fatal("mysql gave ER_LOCK_WAIT_TIMEOUT as an error. "
+			      "The only way to fix this is restart the "
+			      "calling program");
+		errno = err;
+		rc = SLURM_ERROR;
+		break;
+	}
+	END_TIMER;
+
+	if ((rc == SLURM_SUCCESS) && db_stmt->stmt)
+		_stmt_record_time(db_stmt, DELTA_TIMER);
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
+extern void mysql_db_stmt_log_stats(mysql_conn_t *mysql_conn)
+{
+	ListIterator itr;
+	db_stmt_t *db_stmt;
+	char *hist_str = NULL;
+	int i;
+
+	if (!mysql_conn || !mysql_conn->stmt_list)
+		return;
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	mysql_conn->stmt_log_time = time(NULL);
+	itr = list_iterator_create(mysql_conn->stmt_list);
+	while ((db_stmt = list_next(itr))) {
+		if (!db_stmt->exec_cnt)
+			continue;
+		for (i = 0; i < STMT_HIST_CNT; i++)
+			xstrfmtcat(hist_str, " %s:%"PRIu64,
+				   stmt_hist_name[i], db_stmt->hist[i]);
+		info("prepared statement ran %"PRIu64" times, "
+		     "ave %"PRIu64" usec, max %"PRIu64" usec,%s\n%s",
+		     db_stmt->exec_cnt,
+		     db_stmt->total_usec / db_stmt->exec_cnt,
+		     db_stmt->max_usec, hist_str, db_stmt->query);
+		xfree(hist_str);
+	}
+	list_iterator_destroy(itr);
+	slurm_mutex_unlock(&mysql_conn->lock);
+}
+
+extern void mysql_db_bind_int(MYSQL_BIND *bind, int *val)
+{
+	memset(bind, 0, sizeof(MYSQL_BIND));
+	bind->buffer_type = MYSQL_TYPE_LONG;
+	bind->buffer = val;
+}
+
+extern void mysql_db_bind_int64(MYSQL_BIND *bind, int64_t *val)
+{
+	memset(bind, 0, sizeof(MYSQL_BIND));
+	bind->buffer_type = MYSQL_TYPE_LONGLONG;
+	bind->buffer = val;
+}
+
+extern void mysql_db_bind_uint16(MYSQL_BIND *bind, uint16_t *val)
+{
+	memset(bind, 0, sizeof(MYSQL_BIND));
+	bind->buffer_type = MYSQL_TYPE_SHORT;
+	bind->buffer = val;
+	bind->is_unsigned = 1;
+}
+
+extern void mysql_db_bind_uint32(MYSQL_BIND *bind, uint32_t *val)
+{
+	memset(bind, 0, sizeof(MYSQL_BIND));
+	bind->buffer_type = MYSQL_TYPE_LONG;
+	bind->buffer = val;
+	bind->is_unsigned = 1;
+}
+
+extern void mysql_db_bind_uint64(MYSQL_BIND *bind, uint64_t *val)
+{
+	memset(bind, 0, sizeof(MYSQL_BIND));
+	bind->buffer_type = MYSQL_TYPE_LONGLONG;
+	bind->buffer = val;
+	bind->is_unsigned = 1;
+}
+
+extern void mysql_db_bind_double(MYSQL_BIND *bind, double *val)
+{
+	memset(bind, 0, sizeof(MYSQL_BIND));
+	bind->buffer_type = MYSQL_TYPE_DOUBLE;
+	bind->buffer = val;
+}
+
+extern void mysql_db_bind_str(MYSQL_BIND *bind, char *str)
+{
+	memset(bind, 0, sizeof(MYSQL_BIND));
+	bind->buffer_type = MYSQL_TYPE_STRING;
+	bind->buffer = str ? str : "";
+	bind->buffer_length = str ? strlen(str) : 0;
+}
@@ -51,6 +51,7 @@
 
 #include <mysql.h>
 #include <mysqld_error.h>
+#include <errmsg.h>
 
 typedef enum {
 	SLURM_MYSQL_PLUGIN_NOTSET,
@@ -67,6 +68,8 @@ typedef struct {
 	bool rollback;
 	List update_list;
 	int conn;
+	List stmt_list;	/* prepared statements, see mysql_db_stmt_query() */
+	time_t stmt_log_time; /* last mysql_db_stmt_log_stats() */
 } mysql_conn_t;
 
 typedef struct {
@@ -107,4 +110,27 @@ extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query);
 extern int mysql_db_create_table(mysql_conn_t *mysql_conn, char *table_name,
 				 storage_field_t *fields, char *ending);
 
+/*
+ * Run query, which has a '?' for each value in bind, as a prepared
+ * statement.  Each connection keeps the statements it has prepared keyed
+ * by their text, so a statement is only parsed by the server the first
+ * time a connection runs it.  Only for statements not returning rows.
+ */
+extern int mysql_db_stmt_query(mysql_conn_t *mysql_conn, char *query,
+			       MYSQL_BIND *bind);
+
+/* Log the execution count and latency histogram of every prepared
+ * statement on the connection since it was opened. */
+extern void mysql_db_stmt_log_stats(mysql_conn_t *mysql_conn);
+
+/* Fill in bind to pass *val to mysql_db_stmt_query(), val must stay valid
+ * until the query is run.  A NULL str is stored as an empty string. */
+extern void mysql_db_bind_int(MYSQL_BIND *bind, int *val);
+extern void mysql_db_bind_int64(MYSQL_BIND *bind, int64_t *val);
+extern void mysql_db_bind_uint16(MYSQL_BIND *bind, uint16_t *val);
+extern void mysql_db_bind_uint32(MYSQL_BIND *bind, uint32_t *val);
+extern void mysql_db_bind_uint64(MYSQL_BIND *bind, uint64_t *val);
+extern void mysql_db_bind_double(MYSQL_BIND *bind, double *val);
+extern void mysql_db_bind_str(MYSQL_BIND *bind, char *str);
+
 #endif
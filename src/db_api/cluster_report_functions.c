@@ -42,6 +42,7 @@
 
 #include "src/common/slurmdb_defs.h"
 #include "src/common/slurm_accounting_storage.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
 typedef enum {
@@ -51,9 +52,50 @@ typedef enum {
 	CLUSTER_REPORT_WU
 } cluster_report_t;
 
-static void _process_ua(List user_list, slurmdb_assoc_rec_t *assoc)
+/* Entry of the index of a report cluster's user_list or assoc_list, the
+ * records are owned by the list */
+typedef struct {
+	char *key;
+	void *rec;
+} report_idx_t;
+
+static const char *_report_idx_id(void *item)
+{
+	report_idx_t *report_idx = (report_idx_t *)item;
+
+	return report_idx->key;
+}
+
+static void _report_idx_free(void *item)
+{
+	report_idx_t *report_idx = (report_idx_t *)item;
+
+	xfree(report_idx->key);
+	xfree(report_idx);
+}
+
+/* Return the record indexed under key, NULL if none. key is consumed. */
+static void *_report_idx_get(xhash_t *rec_hash, char *key)
+{
+	report_idx_t *report_idx = xhash_get(rec_hash, key);
+
+	xfree(key);
+	return report_idx ? report_idx->rec : NULL;
+}
+
+/* Index rec under key, key is consumed */
+static void _report_idx_add(xhash_t *rec_hash, char *key, void *rec)
+{
+	report_idx_t *report_idx = xmalloc(sizeof(report_idx_t));
+
+	report_idx->key = key;
+	report_idx->rec = rec;
+	xhash_add(rec_hash, report_idx);
+}
+
+static void _process_ua(List user_list, xhash_t *rec_hash,
+			slurmdb_assoc_rec_t *assoc)
 {
-	ListIterator itr = NULL;
 	slurmdb_report_user_rec_t *slurmdb_report_user = NULL;
 
 	/* make sure we add all associations to this
@@ -61,13 +103,8 @@ static void _process_ua(List user_list, slurmdb_assoc_rec_t *assoc)
 	   partitions which would create another
 	   record otherwise
 	*/
-	itr = list_iterator_create(user_list);
-	while((slurmdb_report_user = list_next(itr))) {
-		if (!xstrcmp(slurmdb_report_user->name, assoc->user)
-		   && !xstrcmp(slurmdb_report_user->acct, assoc->acct))
-			break;
-	}
-	list_iterator_destroy(itr);
+	slurmdb_report_user = _report_idx_get(
+		rec_hash, xstrdup_printf("%s,%s", assoc->user, assoc->acct));
 
 	if (!slurmdb_report_user) {
 		struct passwd *passwd_ptr = NULL;
@@ -87,6 +124,10 @@ static void _process_ua(List user_list, slurmdb_assoc_rec_t *assoc)
 		slurmdb_report_user->acct = xstrdup(assoc->acct);
 
 		list_append(user_list, slurmdb_report_user);
+		_report_idx_add(rec_hash,
+				xstrdup_printf("%s,%s", assoc->user,
+					       assoc->acct),
+				slurmdb_report_user);
 	}
 
 	/* get the amount of time this assoc used
@@ -141,26 +182,26 @@ static void _process_uw(List user_list, slurmdb_wckey_rec_t *wckey)
 					  &slurmdb_report_user->tres_list);
 }
 
-static void _process_wu(List assoc_list, slurmdb_wckey_rec_t *wckey)
+static void _process_wu(List assoc_list, xhash_t *rec_hash,
+			slurmdb_wckey_rec_t *wckey)
 {
 	slurmdb_report_assoc_rec_t *slurmdb_report_assoc = NULL,
 		*parent_assoc = NULL;
-	ListIterator itr = NULL;
 
 	/* find the parent */
-	itr = list_iterator_create(assoc_list);
-	while((parent_assoc = list_next(itr))) {
-		if (!parent_assoc->user
-		   && !xstrcmp(parent_assoc->acct, wckey->name))
-			break;
-	}
-	list_iterator_destroy(itr);
+	parent_assoc = _report_idx_get(rec_hash,
+				       xstrdup_printf("%s", wckey->name ?
+						      wckey->name : ""));
 	if (!parent_assoc) {
 		parent_assoc = xmalloc(sizeof(slurmdb_report_assoc_rec_t));
 
 		list_append(assoc_list,
 			    parent_assoc);
 		parent_assoc->acct = xstrdup(wckey->name);
+		_report_idx_add(rec_hash,
+				xstrdup_printf("%s", wckey->name ?
+					       wckey->name : ""),
+				parent_assoc);
 	}
 
 	/* now add one for the user */
@@ -181,6 +222,7 @@ static void _process_wu(List assoc_list, slurmdb_wckey_rec_t *wckey)
 static void _process_assoc_type(
 	ListIterator itr,
 	slurmdb_report_cluster_rec_t *slurmdb_report_cluster,
+	xhash_t *rec_hash,
 	char *cluster_name,
 	cluster_report_t type)
 {
@@ -200,7 +242,7 @@ static void _process_assoc_type(
 
 		if (type == CLUSTER_REPORT_UA)
 			_process_ua(slurmdb_report_cluster->user_list,
-				    assoc);
+				    rec_hash, assoc);
 		else if (type == CLUSTER_REPORT_AU)
 			_process_au(slurmdb_report_cluster->assoc_list,
 				    assoc);
@@ -212,6 +254,7 @@ static void _process_assoc_type(
 static void _process_wckey_type(
 	ListIterator itr,
 	slurmdb_report_cluster_rec_t *slurmdb_report_cluster,
+	xhash_t *rec_hash,
 	char *cluster_name,
 	cluster_report_t type)
 {
@@ -234,7 +277,7 @@ static void _process_wckey_type(
 				    wckey);
 		else if (type == CLUSTER_REPORT_WU)
 			_process_wu(slurmdb_report_cluster->assoc_list,
-				    wckey);
+				    rec_hash, wckey);
 
 		list_delete_item(itr);
 	}
@@ -250,6 +293,7 @@ static List _process_util_by_report(void *db_conn, char *calling_name,
 	List first_list = NULL;
 	slurmdb_cluster_rec_t *cluster = NULL;
 	slurmdb_report_cluster_rec_t *slurmdb_report_cluster = NULL;
+	xhash_t *rec_hash = NULL;
 	time_t start_time, end_time;
 
 	int exit_code = 0;
@@ -343,13 +387,16 @@ static List _process_util_by_report(void *db_conn, char *calling_name,
 			slurmdb_report_cluster->assoc_list =
 				list_create(slurmdb_destroy_report_assoc_rec);
 
+		rec_hash = xhash_init(_report_idx_id, _report_idx_free,
+				      NULL, 0);
 		if ((type == CLUSTER_REPORT_UA) || (type == CLUSTER_REPORT_AU))
 			_process_assoc_type(type_itr, slurmdb_report_cluster,
-					    cluster->name, type);
+					    rec_hash, cluster->name, type);
 		else if ((type == CLUSTER_REPORT_UW)
 			|| (type == CLUSTER_REPORT_WU))
 			_process_wckey_type(type_itr, slurmdb_report_cluster,
-					    cluster->name, type);
+					    rec_hash, cluster->name, type);
+		xhash_free_ptr(&rec_hash);
 		list_iterator_reset(type_itr);
 	}
 	list_iterator_destroy(type_itr);
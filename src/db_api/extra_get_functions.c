@@ -42,7 +42,10 @@
 #include "slurm/slurm_errno.h"
 #include "slurm/slurmdb.h"
 
+#include "src/common/macros.h"
 #include "src/common/slurm_accounting_storage.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
 
 /*
  * reconfigure the slurmdbd
@@ -81,7 +84,32 @@ extern List slurmdb_events_get(void *db_conn,
  */
 extern List slurmdb_jobs_get(void *db_conn, slurmdb_job_cond_t *job_cond)
 {
-	return jobacct_storage_g_get_jobs_cond(db_conn, getuid(), job_cond);
+	List job_list;
+	ListIterator itr;
+	slurmdb_job_rec_t *job, *last_job = NULL;
+	uint32_t last_jobid = 0;
+
+	job_list = jobacct_storage_g_get_jobs_cond(db_conn, getuid(), job_cond);
+	if (!job_list || !job_cond || !job_cond->page_size)
+		return job_list;
+
+	/* A page holds jobs of one cluster in job id order, except that
+	 * resized jobs are moved to the front, so continue after the
+	 * largest job id. */
+	itr = list_iterator_create(job_list);
+	while ((job = list_next(itr))) {
+		last_job = job;
+		last_jobid = MAX(last_jobid, job->jobid);
+	}
+	list_iterator_destroy(itr);
+
+	if (last_job) {
+		xfree(job_cond->cursor_cluster);
+		job_cond->cursor_cluster = xstrdup(last_job->cluster);
+		job_cond->cursor_jobid = last_jobid;
+	}
+
+	return job_list;
 }
 
 /*
@@ -43,8 +43,59 @@
 #include "slurm/slurmdb.h"
 
 #include "src/common/slurm_accounting_storage.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
+/* Entry of the index of the account groupings of all clusters by cluster
+ * and account name, the groupings are owned by the clusters' acct_list */
+typedef struct {
+	slurmdb_report_acct_grouping_t *acct_group;
+	char *key;
+} acct_group_idx_t;
+
+static const char *_acct_group_idx_id(void *item)
+{
+	acct_group_idx_t *acct_group_idx = (acct_group_idx_t *)item;
+
+	return acct_group_idx->key;
+}
+
+static void _acct_group_idx_free(void *item)
+{
+	acct_group_idx_t *acct_group_idx = (acct_group_idx_t *)item;
+
+	xfree(acct_group_idx->key);
+	xfree(acct_group_idx);
+}
+
+static slurmdb_report_acct_grouping_t *_acct_group_idx_get(
+	xhash_t *acct_hash, char *cluster, char *acct)
+{
+	acct_group_idx_t *acct_group_idx;
+	char *key = xstrdup_printf("%s,%s", cluster, acct);
+
+	acct_group_idx = xhash_get(acct_hash, key);
+	xfree(key);
+
+	return acct_group_idx ? acct_group_idx->acct_group : NULL;
+}
+
+static void _acct_group_idx_add(xhash_t *acct_hash, char *cluster,
+				slurmdb_report_acct_grouping_t *acct_group)
+{
+	acct_group_idx_t *acct_group_idx = xmalloc(sizeof(acct_group_idx_t));
+
+	acct_group_idx->acct_group = acct_group;
+	acct_group_idx->key = xstrdup_printf("%s,%s", cluster,
+					     acct_group->acct);
+	xhash_add(acct_hash, acct_group_idx);
+}
+
+static const char *_size_group_id(void *item)
+{
+	return (const char *)item;
+}
+
 static int _sort_group_asc(void *v1, void *v2)
 {
 	char *group_a = *(char **)v1;
@@ -60,7 +111,7 @@ static int _sort_group_asc(void *v1, void *v2)
 }
 
 static void _check_create_grouping(
-	List cluster_list,  ListIterator group_itr,
+	List cluster_list,  ListIterator group_itr, xhash_t *acct_hash,
 	char *cluster, char *name, void *object,
 	bool individual, bool wckey_type)
 {
@@ -87,12 +138,7 @@ static void _check_create_grouping(
 		list_append(cluster_list, cluster_group);
 	}
 
-	itr = list_iterator_create(cluster_group->acct_list);
-	while ((acct_group = list_next(itr))) {
-		if (!xstrcmp(name, acct_group->acct))
-			break;
-	}
-	list_iterator_destroy(itr);
+	acct_group = _acct_group_idx_get(acct_hash, cluster, name);
 
 	if (!acct_group) {
 		uint32_t last_size = 0;
@@ -100,6 +146,7 @@ static void _check_create_grouping(
 		acct_group = xmalloc(sizeof(slurmdb_report_acct_grouping_t));
 
 		acct_group->acct = xstrdup(name);
+		_acct_group_idx_add(acct_hash, cluster, acct_group);
 		if (wckey_type)
 			acct_group->lft = wckey->id;
 		else {
@@ -163,6 +210,7 @@ static List _process_grouped_report(
 	List object_list = NULL, object2_list = NULL;
 
 	List tmp_acct_list = NULL;
+	xhash_t *acct_hash = NULL, *size_hash = NULL;
 	bool destroy_job_cond = 0;
 	bool destroy_grouping_list = 0;
 	bool individual = 0;
@@ -203,6 +251,7 @@ static List _process_grouped_report(
 		char *group = NULL;
 
 		individual = 1;
+		size_hash = xhash_init(_size_group_id, NULL, NULL, 0);
 		itr = list_iterator_create(job_list);
 		while ((job = list_next(itr))) {
 			char *tmp = NULL;
@@ -218,22 +267,20 @@ static List _process_grouped_report(
 
 			tmp = xstrdup_printf("%"PRIu64, count);
 
-			while ((group = list_next(group_itr))) {
-				if (!xstrcmp(group, tmp)) {
-					break;
-				}
-			}
-			if (!group)
+			if (!(group = xhash_get(size_hash, tmp))) {
 				list_append(grouping_list, tmp);
-			else
+				xhash_add(size_hash, tmp);
+			} else
 				xfree(tmp);
-			list_iterator_reset(group_itr);
 		}
 		list_iterator_destroy(itr);
+		xhash_free_ptr(&size_hash);
 		list_sort(grouping_list, (ListCmpF)_sort_group_asc);
 	}
 
 	cluster_list = list_create(slurmdb_destroy_report_cluster_grouping);
+	acct_hash = xhash_init(_acct_group_idx_id, _acct_group_idx_free,
+			       NULL, 0);
 
 	cluster_itr = list_iterator_create(cluster_list);
 
@@ -294,8 +341,8 @@ static List _process_grouped_report(
 				name = assoc->acct;
 			}
 			_check_create_grouping(cluster_list, group_itr,
-					       cluster, name, object,
-					       individual, wckey_type);
+					       acct_hash, cluster, name,
+					       object, individual, wckey_type);
 			continue;
 		}
 
@@ -319,8 +366,8 @@ static List _process_grouped_report(
 					 wckey2->name, assoc->acct);
 			}
 			_check_create_grouping(cluster_list, group_itr,
-					       cluster, name, object,
-					       individual, wckey_type);
+					       acct_hash, cluster, name,
+					       object, individual, wckey_type);
 		}
 		list_iterator_reset(itr2);
 	}
@@ -384,13 +431,16 @@ no_objects:
 			list_append(cluster_list, cluster_group);
 		}
 
+		/* Only the top account view needs to look at the
+		 * account hierarchy, the others match names */
+		if (wckey_type || flat_view) {
+			acct_group = _acct_group_idx_get(
+				acct_hash, cluster_group->cluster, tmp_acct);
+			goto got_acct_group;
+		}
+
 		acct_itr = list_iterator_create(cluster_group->acct_list);
 		while((acct_group = list_next(acct_itr))) {
-			if (wckey_type) {
-				if (!xstrcmp(tmp_acct, acct_group->acct))
-					break;
-				continue;
-			}
 
 			if (!flat_view
 			   && (acct_group->lft != (uint32_t)NO_VAL)
@@ -417,6 +467,7 @@ no_objects:
 		}
 		list_iterator_destroy(acct_itr);
 
+	got_acct_group:
 		if (!acct_group) {
 			char *group = NULL;
 			uint32_t last_size = 0;
@@ -432,6 +483,8 @@ no_objects:
 			acct_group->groups = list_create(
 				slurmdb_destroy_report_job_grouping);
 			list_append(cluster_group->acct_list, acct_group);
+			_acct_group_idx_add(acct_hash, cluster_group->cluster,
+					    acct_group);
 
 			while((group = list_next(group_itr))) {
 				job_group = xmalloc(
@@ -511,6 +564,7 @@ no_objects:
 	list_iterator_destroy(cluster_itr);
 
 end_it:
+	xhash_free_ptr(&acct_hash);
 	FREE_NULL_LIST(object_list);
 
 	FREE_NULL_LIST(object2_list);
@@ -36,14 +36,56 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include <ctype.h>
+#include <string.h>
+
 #include "slurm/slurm.h"
 #include "slurm/slurm_errno.h"
 #include "slurm/slurmdb.h"
 
 #include "src/common/slurmdb_defs.h"
 #include "src/common/slurm_accounting_storage.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
+/* Entry of the index of the report users of all clusters, the records are
+ * owned by the clusters' user_list */
+typedef struct {
+	char *key;
+	slurmdb_report_user_rec_t *slurmdb_report_user;
+} user_idx_t;
+
+static const char *_user_idx_id(void *item)
+{
+	user_idx_t *user_idx = (user_idx_t *)item;
+
+	return user_idx->key;
+}
+
+static void _user_idx_free(void *item)
+{
+	user_idx_t *user_idx = (user_idx_t *)item;
+
+	xfree(user_idx->key);
+	xfree(user_idx);
+}
+
+/* Report users are the same user if they have the same uid or, without one,
+ * the same name */
+static char *_user_idx_key(char *cluster, slurmdb_user_rec_t *user)
+{
+	char *key;
+	int i;
+
+	if (user->uid != NO_VAL)
+		return xstrdup_printf("%s:%u", cluster, user->uid);
+
+	key = xstrdup_printf("%s:%s", cluster, user->name);
+	for (i = strlen(cluster) + 1; key[i]; i++)
+		key[i] = tolower((int)key[i]);
+	return key;
+}
+
 extern List slurmdb_report_user_top_usage(void *db_conn,
 					  slurmdb_user_cond_t *user_cond,
 					  bool group_accounts)
@@ -63,6 +105,9 @@ extern List slurmdb_report_user_top_usage(void *db_conn,
 	slurmdb_assoc_rec_t *assoc = NULL;
 	slurmdb_report_user_rec_t *slurmdb_report_user = NULL;
 	slurmdb_report_cluster_rec_t *slurmdb_report_cluster = NULL;
+	xhash_t *user_hash = NULL;
+	user_idx_t *user_idx = NULL;
+	char *user_key = NULL;
 	uid_t my_uid = getuid();
 	bool delete_user_cond = 0, delete_assoc_cond = 0,
 		delete_cluster_list = 0;
@@ -146,6 +191,7 @@ extern List slurmdb_report_user_top_usage(void *db_conn,
 	list_iterator_destroy(itr);
 	FREE_NULL_LIST(usage_cluster_list);
 
+	user_hash = xhash_init(_user_idx_id, _user_idx_free, NULL, 0);
 	itr = list_iterator_create(user_list);
 	cluster_itr = list_iterator_create(cluster_list);
 	while((user = list_next(itr))) {
@@ -169,50 +215,8 @@ extern List slurmdb_report_user_top_usage(void *db_conn,
 			while((slurmdb_report_cluster =
 			       list_next(cluster_itr))) {
 				if (!xstrcmp(slurmdb_report_cluster->name,
-					     assoc->cluster)) {
-					ListIterator user_itr = NULL;
-					if (!group_accounts) {
-						slurmdb_report_user = NULL;
-						goto new_user;
-					}
-					user_itr = list_iterator_create(
-						slurmdb_report_cluster->
-						user_list);
-					while((slurmdb_report_user
-					       = list_next(user_itr))) {
-						if (slurmdb_report_user->uid
-						   != NO_VAL) {
-							if (slurmdb_report_user->
-							   uid
-							   == user->uid)
-								break;
-						} else if (slurmdb_report_user->
-							  name
-							  && !xstrcasecmp(
-								  slurmdb_report_user->
-								  name,
-								  user->name))
-							break;
-					}
-					list_iterator_destroy(user_itr);
-				new_user:
-					if (!slurmdb_report_user) {
-						slurmdb_report_user = xmalloc(
-							sizeof
-							(slurmdb_report_user_rec_t));
-						slurmdb_report_user->name =
-							xstrdup(assoc->user);
-						slurmdb_report_user->uid =
-							user->uid;
-						slurmdb_report_user->acct_list =
-							list_create
-							(slurm_destroy_char);
-						list_append(slurmdb_report_cluster->
-							    user_list,
-							    slurmdb_report_user);
-					}
+					     assoc->cluster))
 					break;
-				}
 			}
 			if (!slurmdb_report_cluster) {
 				error("This cluster '%s' hasn't "
@@ -225,6 +229,20 @@ extern List slurmdb_report_user_top_usage(void *db_conn,
 				slurmdb_report_cluster->name = xstrdup(assoc->cluster);
 				slurmdb_report_cluster->user_list =
 					list_create(slurmdb_destroy_report_user_rec);
+			}
+			list_iterator_reset(cluster_itr);
+
+			/* When grouping accounts there is one record per
+			 * user and cluster, found with the index rather
+			 * than by scanning the cluster's user_list */
+			slurmdb_report_user = NULL;
+			if (group_accounts) {
+				user_key = _user_idx_key(assoc->cluster, user);
+				if ((user_idx = xhash_get(user_hash, user_key)))
+					slurmdb_report_user =
+						user_idx->slurmdb_report_user;
+			}
+			if (!slurmdb_report_user) {
 				slurmdb_report_user =
 					xmalloc(sizeof(slurmdb_report_user_rec_t));
 				slurmdb_report_user->name = xstrdup(assoc->user);
@@ -233,8 +251,16 @@ extern List slurmdb_report_user_top_usage(void *db_conn,
 					list_create(slurm_destroy_char);
 				list_append(slurmdb_report_cluster->user_list,
 					    slurmdb_report_user);
+				if (group_accounts) {
+					user_idx = xmalloc(sizeof(user_idx_t));
+					user_idx->key = user_key;
+					user_key = NULL;
+					user_idx->slurmdb_report_user =
+						slurmdb_report_user;
+					xhash_add(user_hash, user_idx);
+				}
 			}
-			list_iterator_reset(cluster_itr);
+			xfree(user_key);
 
 			itr3 = list_iterator_create(
 				slurmdb_report_user->acct_list);
@@ -255,6 +281,7 @@ extern List slurmdb_report_user_top_usage(void *db_conn,
 	}
 	list_iterator_destroy(itr);
 	list_iterator_destroy(cluster_itr);
+	xhash_free_ptr(&user_hash);
 
 end_it:
 	if (delete_cluster_list) {
@@ -36,13 +36,20 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include "config.h"
+
+#include <arpa/inet.h>
 #include <fcntl.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#if HAVE_LIBZ
+#  include <zlib.h>
+#endif
 
 #include "src/common/env.h"
+#include "src/common/fd.h"
 #include "src/common/slurmdbd_defs.h"
 #include "src/common/slurm_auth.h"
 #include "src/common/slurm_time.h"
@@ -860,68 +867,235 @@ static char *_make_archive_name(time_t period_start, time_t period_end,
 			      start_char, end_char);
 }
 
-extern int archive_write_file(Buf buffer, char *cluster_name,
-			      time_t period_start, time_t period_end,
-			      char *arch_dir, char *arch_type,
-			      uint32_t archive_period)
-{
-	int fd = 0;
-	int rc = SLURM_SUCCESS;
-	char *old_file = NULL, *new_file = NULL, *reg_file = NULL;
-	static int high_buffer_size = (1024 * 1024);
-	static pthread_mutex_t local_file_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t local_file_lock = PTHREAD_MUTEX_INITIALIZER;
 
-	xassert(buffer);
+/* Move new_file in place as reg_file, keeping the last one as reg_file.old */
+static void _archive_file_shuffle(char *reg_file, char *new_file)
+{
+	char *old_file = xstrdup_printf("%s.old", reg_file);
 
 	slurm_mutex_lock(&local_file_lock);
+	(void) unlink(old_file);
+	if (link(reg_file, old_file))
+		debug4("Link(%s, %s): %m", reg_file, old_file);
+	(void) unlink(reg_file);
+	if (link(new_file, reg_file))
+		debug4("Link(%s, %s): %m", new_file, reg_file);
+	(void) unlink(new_file);
+	slurm_mutex_unlock(&local_file_lock);
 
-	/* write the buffer to file */
-	reg_file = _make_archive_name(period_start, period_end,
-				      cluster_name, arch_dir,
-				      arch_type, archive_period);
+	xfree(old_file);
+}
 
-	debug("Storing %s archive for %s at %s",
-	      arch_type, cluster_name, reg_file);
-	old_file = xstrdup_printf("%s.old", reg_file);
-	new_file = xstrdup_printf("%s.new", reg_file);
+#if HAVE_LIBZ
+/* Write a gzip compressed copy of in_file as out_file */
+static int _archive_file_compress(char *in_file, char *out_file)
+{
+	int fd, out_fd, amount, rc = SLURM_SUCCESS;
+	char *data;
+	gzFile gz_file;
 
-	fd = creat(new_file, 0600);
-	if (fd < 0) {
-		error("Can't save archive, create file %s error %m", new_file);
+	if ((fd = open(in_file, O_RDONLY)) < 0) {
+		error("Can't compress archive, open file %s error %m",
+		      in_file);
+		return SLURM_ERROR;
+	}
+	if (((out_fd = creat(out_file, 0600)) < 0) ||
+	    !(gz_file = gzdopen(out_fd, "wb"))) {
+		error("Can't compress archive, create file %s error %m",
+		      out_file);
+		if (out_fd >= 0)
+			close(out_fd);
+		close(fd);
+		return SLURM_ERROR;
+	}
+
+	data = xmalloc(BUF_SIZE * 64);
+	while ((amount = read(fd, data, BUF_SIZE * 64))) {
+		if (amount < 0) {
+			if (errno == EINTR)
+				continue;
+			error("Error reading file %s, %m", in_file);
+			rc = SLURM_ERROR;
+			break;
+		}
+		if (gzwrite(gz_file, data, amount) != amount) {
+			error("Error compressing file %s", out_file);
+			rc = SLURM_ERROR;
+			break;
+		}
+	}
+	xfree(data);
+	close(fd);
+	if ((gzclose(gz_file) != Z_OK) && (rc == SLURM_SUCCESS)) {
+		error("Error writing file %s", out_file);
 		rc = SLURM_ERROR;
-	} else {
-		int pos = 0, nwrite = get_buf_offset(buffer), amount;
-		char *data = (char *)get_buf_data(buffer);
-		high_buffer_size = MAX(nwrite, high_buffer_size);
-		while (nwrite > 0) {
-			amount = write(fd, &data[pos], nwrite);
-			if ((amount < 0) && (errno != EINTR)) {
-				error("Error writing file %s, %m", new_file);
-				rc = SLURM_ERROR;
-				break;
-			}
-			nwrite -= amount;
-			pos    += amount;
+	}
+
+	if (rc != SLURM_SUCCESS)
+		(void) unlink(out_file);
+
+	return rc;
+}
+#endif
+
+extern archive_file_t *archive_file_open(char *cluster_name,
+					 time_t period_start,
+					 time_t period_end,
+					 char *arch_dir, char *arch_type,
+					 uint32_t archive_period,
+					 uint32_t cnt_offset)
+{
+	archive_file_t *arch_file = xmalloc(sizeof(archive_file_t));
+
+	arch_file->cnt_offset = cnt_offset;
+	arch_file->reg_file = _make_archive_name(period_start, period_end,
+						 cluster_name, arch_dir,
+						 arch_type, archive_period);
+	arch_file->new_file = xstrdup_printf("%s.new", arch_file->reg_file);
+
+	debug("Storing %s archive for %s at %s",
+	      arch_type, cluster_name, arch_file->reg_file);
+
+	arch_file->fd = creat(arch_file->new_file, 0600);
+	if (arch_file->fd < 0) {
+		error("Can't save archive, create file %s error %m",
+		      arch_file->new_file);
+		xfree(arch_file->new_file);
+		xfree(arch_file->reg_file);
+		xfree(arch_file);
+		return NULL;
+	}
+	fd_set_close_on_exec(arch_file->fd);
+
+	return arch_file;
+}
+
+extern int archive_file_write(archive_file_t *arch_file, Buf buffer,
+			      uint32_t rec_cnt)
+{
+	int pos = 0, nwrite = get_buf_offset(buffer), amount;
+	char *data = (char *)get_buf_data(buffer);
+	uint32_t cnt = htonl(rec_cnt);
+
+	xassert(arch_file);
+
+	while (nwrite > 0) {
+		amount = write(arch_file->fd, &data[pos], nwrite);
+		if (amount < 0) {
+			if (errno == EINTR)
+				continue;
+			error("Error writing file %s, %m", arch_file->new_file);
+			return SLURM_ERROR;
 		}
-		fsync(fd);
-		close(fd);
+		nwrite -= amount;
+		pos    += amount;
 	}
 
-	if (rc)
-		(void) unlink(new_file);
-	else {			/* file shuffle */
-		(void) unlink(old_file);
-		if (link(reg_file, old_file))
-			debug4("Link(%s, %s): %m", reg_file, old_file);
-		(void) unlink(reg_file);
-		if (link(new_file, reg_file))
-			debug4("Link(%s, %s): %m", new_file, reg_file);
-		(void) unlink(new_file);
+	if (pwrite(arch_file->fd, &cnt, sizeof(cnt), arch_file->cnt_offset)
+	    != sizeof(cnt)) {
+		error("Error writing file %s, %m", arch_file->new_file);
+		return SLURM_ERROR;
 	}
-	xfree(old_file);
-	xfree(reg_file);
-	xfree(new_file);
-	slurm_mutex_unlock(&local_file_lock);
+
+	/* The records are purged once this returns */
+	if (fsync(arch_file->fd)) {
+		error("Error syncing file %s, %m", arch_file->new_file);
+		return SLURM_ERROR;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+extern int archive_file_close(archive_file_t *arch_file, bool compress)
+{
+	int rc = SLURM_SUCCESS;
+
+	if (!arch_file)
+		return rc;
+
+	close(arch_file->fd);
+
+#if HAVE_LIBZ
+	if (compress) {
+		char *gz_file = xstrdup_printf("%s.gz", arch_file->reg_file);
+		char *gz_new_file = xstrdup_printf("%s.new", gz_file);
+
+		if ((rc = _archive_file_compress(arch_file->new_file,
+						 gz_new_file))
+		    == SLURM_SUCCESS) {
+			_archive_file_shuffle(gz_file, gz_new_file);
+			(void) unlink(arch_file->new_file);
+		} else {
+			/* Keep it uncompressed rather than losing it */
+			_archive_file_shuffle(arch_file->reg_file,
+					      arch_file->new_file);
+		}
+		xfree(gz_file);
+		xfree(gz_new_file);
+	} else
+#endif
+		_archive_file_shuffle(arch_file->reg_file,
+				      arch_file->new_file);
+
+	xfree(arch_file->new_file);
+	xfree(arch_file->reg_file);
+	xfree(arch_file);
+
+	return rc;
+}
+
+extern int archive_read_file(char *file_name, char **data,
+			     uint32_t *data_size)
+{
+	int rc = SLURM_SUCCESS;
+	int data_allocated, data_read;
+#if HAVE_LIBZ
+	/* gzread() reads files which aren't compressed as they are */
+	gzFile fd = gzopen(file_name, "rb");
+
+	if (!fd) {
+#else
+	int fd = open(file_name, O_RDONLY);
+
+	if (fd < 0) {
+#endif
+		info("No archive file (%s) to recover", file_name);
+		return ENOENT;
+	}
+
+	*data_size = 0;
+	data_allocated = BUF_SIZE + 1;
+	*data = xmalloc_nz(data_allocated);
+	while (1) {
+#if HAVE_LIBZ
+		data_read = gzread(fd, &(*data)[*data_size], BUF_SIZE);
+#else
+		data_read = read(fd, &(*data)[*data_size], BUF_SIZE);
+#endif
+		if (data_read < 0) {
+			(*data)[*data_size] = '\0';
+			if (errno == EINTR)
+				continue;
+			error("Read error on %s: %m", file_name);
+			rc = SLURM_ERROR;
+			break;
+		}
+		(*data)[*data_size + data_read] = '\0';
+		if (data_read == 0)	/* eof */
+			break;
+		*data_size     += data_read;
+		data_allocated += data_read;
+		xrealloc_nz(*data, data_allocated);
+	}
+#if HAVE_LIBZ
+	gzclose(fd);
+#else
+	close(fd);
+#endif
+
+	if (rc != SLURM_SUCCESS)
+		xfree(*data);
 
 	return rc;
 }
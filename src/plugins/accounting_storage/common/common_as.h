@@ -41,6 +41,14 @@
 
 #include "src/common/assoc_mgr.h"
 
+/* An archive file written a batch of records at a time */
+typedef struct {
+	uint32_t cnt_offset;	/* offset of the record count in the file */
+	int fd;
+	char *new_file;		/* file being written */
+	char *reg_file;		/* name of the file once it is complete */
+} archive_file_t;
+
 extern int addto_update_list(List update_list, slurmdb_update_type_t type,
 			     void *object);
 
@@ -80,9 +88,39 @@ extern char* acct_get_db_name(void);
 extern time_t archive_setup_end_time(time_t last_submit, uint32_t purge);
 extern int archive_run_script(slurmdb_archive_cond_t *arch_cond,
 			      char *cluster_name, time_t last_submit);
-extern int archive_write_file(Buf buffer, char *cluster_name,
-			      time_t period_start, time_t period_end,
-			      char *arch_dir, char *arch_type,
-			      uint32_t archive_period);
+
+/*
+ * Create an archive file to write records to. cnt_offset is where the
+ * header written first holds the record count, which archive_file_write()
+ * keeps up to date so the file can be loaded even if it is never closed.
+ * RET archive file to be closed with archive_file_close() or NULL on error
+ */
+extern archive_file_t *archive_file_open(char *cluster_name,
+					 time_t period_start,
+					 time_t period_end,
+					 char *arch_dir, char *arch_type,
+					 uint32_t archive_period,
+					 uint32_t cnt_offset);
+
+/*
+ * Append the data packed in buffer to the archive file and sync it to disk
+ * along with the new record count, so the records can then be purged.
+ */
+extern int archive_file_write(archive_file_t *arch_file, Buf buffer,
+			      uint32_t rec_cnt);
+
+/*
+ * Move a complete archive file in place, gzip compressed when compress is
+ * set and zlib is available, and free arch_file.
+ */
+extern int archive_file_close(archive_file_t *arch_file, bool compress);
+
+/*
+ * Read an archive file, which may be gzip compressed, into *data, which is
+ * NUL terminated and must be xfree'd.
+ * RET SLURM_SUCCESS, ENOENT if there isn't such a file or SLURM_ERROR
+ */
+extern int archive_read_file(char *file_name, char **data,
+			     uint32_t *data_size);
 
 #endif
@@ -81,7 +81,7 @@ List as_mysql_cluster_list = NULL;
    end of the life of the slurmdbd.
 */
 List as_mysql_total_cluster_list = NULL;
-pthread_mutex_t as_mysql_cluster_list_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_rwlock_t as_mysql_cluster_list_lock = PTHREAD_RWLOCK_INITIALIZER;
 
 /*
  * These variables are required by the generic plugin interface.  If they
@@ -117,6 +117,9 @@ static mysql_db_info_t *mysql_db_info = NULL;
 static char *mysql_db_name = NULL;
 
 #define DELETE_SEC_BACK 86400
+/* How often a connection logs its prepared statement stats with
+ * DebugFlags=DB_QUERY, the slurmctld connections can stay open for weeks */
+#define STMT_LOG_INTERVAL 3600
 
 char *acct_coord_table = "acct_coord_table";
 char *acct_table = "acct_table";
@@ -859,10 +862,10 @@ static int _as_mysql_acct_check_tables(mysql_conn_t *mysql_conn)
 			fatal("problem adding tres 'cpu'");
 	}
 
-	slurm_mutex_lock(&as_mysql_cluster_list_lock);
+	slurm_rwlock_wrlock(&as_mysql_cluster_list_lock);
 	if (!(as_mysql_cluster_list = _get_cluster_names(mysql_conn, 0))) {
 		error("issue getting contents of %s", cluster_table);
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 		return SLURM_ERROR;
 	}
 
@@ -873,13 +876,13 @@ static int _as_mysql_acct_check_tables(mysql_conn_t *mysql_conn)
 	if (!(as_mysql_total_cluster_list =
 	      _get_cluster_names(mysql_conn, 1))) {
 		error("issue getting total contents of %s", cluster_table);
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 		return SLURM_ERROR;
 	}
 
 	if (as_mysql_convert_tables(mysql_conn) != SLURM_SUCCESS) {
 		error("issue converting tables");
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 		return SLURM_ERROR;
 	}
 
@@ -894,7 +897,7 @@ static int _as_mysql_acct_check_tables(mysql_conn_t *mysql_conn)
 			break;
 	}
 	list_iterator_destroy(itr);
-	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+	slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 
 	if (rc != SLURM_SUCCESS)
 		return rc;
@@ -2430,11 +2433,12 @@ extern int init ( void )
 
 extern int fini ( void )
 {
-	slurm_mutex_lock(&as_mysql_cluster_list_lock);
+	slurm_rwlock_wrlock(&as_mysql_cluster_list_lock);
 	FREE_NULL_LIST(as_mysql_cluster_list);
 	FREE_NULL_LIST(as_mysql_total_cluster_list);
-	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
-	slurm_mutex_destroy(&as_mysql_cluster_list_lock);
+	slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
+	slurm_rwlock_destroy(&as_mysql_cluster_list_lock);
+	as_mysql_usage_cache_flush();
 	destroy_mysql_db_info(mysql_db_info);
 	xfree(mysql_db_name);
 	xfree(default_qos_str);
@@ -2478,6 +2482,8 @@ extern int acct_storage_p_close_connection(mysql_conn_t **mysql_conn)
 		return SLURM_SUCCESS;
 
 	acct_storage_p_commit((*mysql_conn), 0);
+	if (debug_flags & DEBUG_FLAG_DB_QUERY)
+		mysql_db_stmt_log_stats(*mysql_conn);
 	rc = destroy_mysql_conn(*mysql_conn);
 	*mysql_conn = NULL;
 
@@ -2528,6 +2534,11 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 		}
 	}
 
+	if ((debug_flags & DEBUG_FLAG_DB_QUERY) &&
+	    (difftime(time(NULL), mysql_conn->stmt_log_time) >=
+	     STMT_LOG_INTERVAL))
+		mysql_db_stmt_log_stats(mysql_conn);
+
 	if (commit && list_count(mysql_conn->update_list)) {
 		char *query = NULL;
 		MYSQL_RES *result = NULL;
@@ -2537,6 +2548,10 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 		char *rem_cluster = NULL, *cluster_name = NULL;
 		slurmdb_update_object_t *object = NULL;
 
+		/* Associations or clusters may have been added, moved or
+		 * removed */
+		as_mysql_usage_cache_flush();
+
 		xstrfmtcat(query, "select control_host, control_port, "
 			   "name, rpc_version "
 			   "from %s where deleted=0 && control_port != 0",
@@ -2558,15 +2573,21 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 	skip:
 		(void) assoc_mgr_update(mysql_conn->update_list, 0);
 
-		slurm_mutex_lock(&as_mysql_cluster_list_lock);
-		itr2 = list_iterator_create(as_mysql_cluster_list);
 		itr = list_iterator_create(mysql_conn->update_list);
 		while ((object = list_next(itr))) {
 			if (!object->objects || !list_count(object->objects))
 				continue;
-			/* We only care about clusters removed here. */
+			/* We only care about clusters removed here.  Only
+			 * take the write lock when there is one, so
+			 * commits don't wait on queries reading the list. */
 			switch(object->type) {
 			case SLURMDB_REMOVE_CLUSTER:
+				if (!itr2) {
+					slurm_rwlock_wrlock(
+						&as_mysql_cluster_list_lock);
+					itr2 = list_iterator_create(
+						as_mysql_cluster_list);
+				}
 				itr3 = list_iterator_create(object->objects);
 				while ((rem_cluster = list_next(itr3))) {
 					while ((cluster_name =
@@ -2586,8 +2607,10 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 			}
 		}
 		list_iterator_destroy(itr);
-		list_iterator_destroy(itr2);
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+		if (itr2) {
+			list_iterator_destroy(itr2);
+			slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
+		}
 
 		if (get_qos_count)
 			_set_qos_cnt(mysql_conn);
@@ -3125,6 +3148,7 @@ extern int jobacct_storage_p_archive(mysql_conn_t *mysql_conn,
 	/* Make sure only 1 archive is happening at a time. */
 	slurm_mutex_lock(&usage_rollup_lock);
 	rc = as_mysql_jobacct_process_archive(mysql_conn, arch_cond);
+	as_mysql_usage_cache_flush();
 	slurm_mutex_unlock(&usage_rollup_lock);
 
 	return rc;
@@ -3136,10 +3160,15 @@ extern int jobacct_storage_p_archive(mysql_conn_t *mysql_conn,
 extern int jobacct_storage_p_archive_load(mysql_conn_t *mysql_conn,
 					  slurmdb_archive_rec_t *arch_rec)
 {
+	int rc;
+
 	if (check_connection(mysql_conn) != SLURM_SUCCESS)
 		return ESLURM_DB_CONNECTION;
 
-	return as_mysql_jobacct_process_archive_load(mysql_conn, arch_rec);
+	rc = as_mysql_jobacct_process_archive_load(mysql_conn, arch_rec);
+	as_mysql_usage_cache_flush();
+
+	return rc;
 }
 
 extern int acct_storage_p_update_shares_used(mysql_conn_t *mysql_conn,
@@ -98,11 +98,13 @@ extern char *wckey_month_table;
 extern char *wckey_table;
 
 /* Since tables are cluster centric we have a global cluster list to
- * go off of.
+ * go off of.  Queries walking the list only need a read lock, so a
+ * long running query for one client doesn't hold up the others; only
+ * adding or removing a cluster takes the write lock.
  */
 extern List as_mysql_cluster_list;
 extern List as_mysql_total_cluster_list;
-extern pthread_mutex_t as_mysql_cluster_list_lock;
+extern pthread_rwlock_t as_mysql_cluster_list_lock;
 
 extern uint64_t debug_flags;
 
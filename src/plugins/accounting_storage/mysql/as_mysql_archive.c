@@ -61,6 +61,9 @@
 
 #define MAX_PURGE_LIMIT 50000 /* Number of records that are purged at a time
 				 so that locks can be periodically released. */
+#define PURGE_BATCH_DELAY 50000 /* usecs to wait between batches of records
+				   purged so queries waiting on the locks
+				   held get to run. */
 #define MAX_ARCHIVE_AGE (60 * 60 * 24 * 60) /* If archive data is older than
 					       this then archive by month to
 					       handle large datasets. */
@@ -543,10 +546,12 @@ typedef enum {
 
 static void _init_local_job(local_job_t *);
 
-static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
-			       char *cluster_name, time_t period_end,
-			       char *arch_dir, uint32_t archive_period,
-			       char *sql_table, uint32_t usage_info);
+static int _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
+			  char *cluster_name, char *table, char *cond,
+			  time_t period_start, time_t period_end,
+			  char *arch_dir, uint32_t archive_period,
+			  char *sql_table, uint32_t usage_info,
+			  archive_file_t **arch_file, uint32_t *rec_cnt);
 
 static int high_buffer_size = (1024 * 1024);
 
@@ -1797,21 +1802,12 @@ static char *_get_archive_columns(purge_type_t type)
 }
 
 
-static Buf _pack_archive_events(MYSQL_RES *result, char *cluster_name,
-				uint32_t cnt, uint32_t usage_info,
-				time_t *period_start)
+static void _pack_archive_events(MYSQL_RES *result, time_t *period_start,
+				 Buf buffer)
 {
 	MYSQL_ROW row;
-	Buf buffer;
 	local_event_t event;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_GOT_EVENTS, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
 	while ((row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[EVENT_REQ_START]);
@@ -1829,8 +1825,6 @@ static Buf _pack_archive_events(MYSQL_RES *result, char *cluster_name,
 
 		_pack_local_event(&event, SLURM_PROTOCOL_VERSION, buffer);
 	}
-
-	return buffer;
 }
 
 /* returns sql statement from archived data or NULL on error */
@@ -1885,21 +1879,12 @@ _load_events(uint16_t rpc_version, Buf buffer, char *cluster_name,
 	return insert;
 }
 
-static Buf _pack_archive_jobs(MYSQL_RES *result, char *cluster_name,
-			      uint32_t cnt, uint32_t usage_info,
-			      time_t *period_start)
+static void _pack_archive_jobs(MYSQL_RES *result, time_t *period_start,
+			       Buf buffer)
 {
 	MYSQL_ROW row;
-	Buf buffer;
 	local_job_t job;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_GOT_JOBS, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
 	while ((row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[JOB_REQ_SUBMIT]);
@@ -1945,8 +1930,6 @@ static Buf _pack_archive_jobs(MYSQL_RES *result, char *cluster_name,
 
 		_pack_local_job(&job, SLURM_PROTOCOL_VERSION, buffer);
 	}
-
-	return buffer;
 }
 
 /* returns sql statement from archived data or NULL on error */
@@ -2041,21 +2024,12 @@ _init_local_job(local_job_t *job)
 	xstrcat(job->array_taskid, "4294967294");
 }
 
-static Buf _pack_archive_resvs(MYSQL_RES *result, char *cluster_name,
-			       uint32_t cnt, uint32_t usage_info,
-			       time_t *period_start)
+static void _pack_archive_resvs(MYSQL_RES *result, time_t *period_start,
+				Buf buffer)
 {
 	MYSQL_ROW row;
-	Buf buffer;
 	local_resv_t resv;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_GOT_RESVS, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
 	while ((row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[RESV_REQ_START]);
@@ -2074,8 +2048,6 @@ static Buf _pack_archive_resvs(MYSQL_RES *result, char *cluster_name,
 
 		_pack_local_resv(&resv, SLURM_PROTOCOL_VERSION, buffer);
 	}
-
-	return buffer;
 }
 
 /* returns sql statement from archived data or NULL on error */
@@ -2129,21 +2101,12 @@ static char *_load_resvs(uint16_t rpc_version, Buf buffer,
 	return insert;
 }
 
-static Buf _pack_archive_steps(MYSQL_RES *result, char *cluster_name,
-			       uint32_t cnt, uint32_t usage_info,
-			       time_t *period_start)
+static void _pack_archive_steps(MYSQL_RES *result, time_t *period_start,
+				Buf buffer)
 {
 	MYSQL_ROW row;
-	Buf buffer;
 	local_step_t step;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_STEP_START, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
 	while ((row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[STEP_REQ_START]);
@@ -2201,8 +2164,6 @@ static Buf _pack_archive_steps(MYSQL_RES *result, char *cluster_name,
 
 		_pack_local_step(&step, SLURM_PROTOCOL_VERSION, buffer);
 	}
-
-	return buffer;
 }
 
 /* returns sql statement from archived data or NULL on error */
@@ -2295,21 +2256,12 @@ static char *_load_steps(uint16_t rpc_version, Buf buffer,
 	return insert;
 }
 
-static Buf _pack_archive_suspends(MYSQL_RES *result, char *cluster_name,
-				  uint32_t cnt, uint32_t usage_info,
-				  time_t *period_start)
+static void _pack_archive_suspends(MYSQL_RES *result, time_t *period_start,
+				   Buf buffer)
 {
 	MYSQL_ROW row;
-	Buf buffer;
 	local_suspend_t suspend;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_JOB_SUSPEND, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
 	while ((row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[SUSPEND_REQ_START]);
@@ -2323,8 +2275,6 @@ static Buf _pack_archive_suspends(MYSQL_RES *result, char *cluster_name,
 
 		_pack_local_suspend(&suspend, SLURM_PROTOCOL_VERSION, buffer);
 	}
-
-	return buffer;
 }
 
 
@@ -2371,21 +2321,12 @@ static char *_load_suspend(uint16_t rpc_version, Buf buffer,
 	return insert;
 }
 
-static Buf _pack_archive_txns(MYSQL_RES *result, char *cluster_name,
-			      uint32_t cnt, uint32_t usage_info,
-			      time_t *period_start)
+static void _pack_archive_txns(MYSQL_RES *result, time_t *period_start,
+			       Buf buffer)
 {
 	MYSQL_ROW row;
-	Buf buffer;
 	local_txn_t txn;
 
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_GOT_TXN, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-
 	while ((row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
 			*period_start = slurm_atoul(row[TXN_REQ_TS]);
@@ -2402,8 +2343,6 @@ static Buf _pack_archive_txns(MYSQL_RES *result, char *cluster_name,
 
 		_pack_local_txn(&txn, SLURM_PROTOCOL_VERSION, buffer);
 	}
-
-	return buffer;
 }
 
 
@@ -2457,23 +2396,11 @@ static char *_load_txn(uint16_t rpc_version, Buf buffer,
 	return insert;
 }
 
-static Buf _pack_archive_usage(MYSQL_RES *result, char *cluster_name,
-			       uint32_t cnt, uint32_t usage_info,
-			       time_t *period_start)
+static void _pack_archive_usage(MYSQL_RES *result, time_t *period_start,
+				Buf buffer)
 {
 	MYSQL_ROW row;
-	Buf buffer;
 	local_usage_t usage;
-	uint16_t type = usage_info & 0x0000ffff;
-	uint16_t period = usage_info >> 16;
-
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(type, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-	pack16(period, buffer);
 
 	while ((row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
@@ -2488,8 +2415,6 @@ static Buf _pack_archive_usage(MYSQL_RES *result, char *cluster_name,
 
 		_pack_local_usage(&usage, SLURM_PROTOCOL_VERSION, buffer);
 	}
-
-	return buffer;
 }
 
 /* returns sql statement from archived data or NULL on error */
@@ -2577,22 +2502,11 @@ static char *_load_usage(uint16_t rpc_version, Buf buffer,
 	return insert;
 }
 
-static Buf _pack_archive_cluster_usage(MYSQL_RES *result, char *cluster_name,
-				       uint32_t cnt, uint32_t usage_info,
-				       time_t *period_start)
+static void _pack_archive_cluster_usage(MYSQL_RES *result, time_t *period_start,
+					Buf buffer)
 {
 	MYSQL_ROW row;
-	Buf buffer;
 	local_cluster_usage_t usage;
-	uint16_t period = usage_info >> 16;
-
-	buffer = init_buf(high_buffer_size);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(time(NULL), buffer);
-	pack16(DBD_GOT_CLUSTER_USAGE, buffer);
-	packstr(cluster_name, buffer);
-	pack32(cnt, buffer);
-	pack16(period, buffer);
 
 	while ((row = mysql_fetch_row(result))) {
 		if (period_start && !*period_start)
@@ -2613,8 +2527,6 @@ static Buf _pack_archive_cluster_usage(MYSQL_RES *result, char *cluster_name,
 		_pack_local_cluster_usage(
 			&usage, SLURM_PROTOCOL_VERSION, buffer);
 	}
-
-	return buffer;
 }
 
 /* returns sql statement from archived data or NULL on error */
@@ -2683,20 +2595,75 @@ static char *_load_cluster_usage(uint16_t rpc_version, Buf buffer,
 }
 
 /* returns count of events archived or SLURM_ERROR on error */
-static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
-			       char *cluster_name, time_t period_end,
-			       char *arch_dir, uint32_t archive_period,
-			       char *sql_table, uint32_t usage_info)
+/* Pack the header of an archive file of records of type.
+ * RET offset of the record count in the buffer */
+static uint32_t _pack_archive_header(purge_type_t type, char *cluster_name,
+				     uint32_t usage_info, Buf buffer)
+{
+	uint16_t msg_type;
+	uint32_t cnt_offset;
+
+	switch (type) {
+	case PURGE_EVENT:
+		msg_type = DBD_GOT_EVENTS;
+		break;
+	case PURGE_SUSPEND:
+		msg_type = DBD_JOB_SUSPEND;
+		break;
+	case PURGE_RESV:
+		msg_type = DBD_GOT_RESVS;
+		break;
+	case PURGE_JOB:
+		msg_type = DBD_GOT_JOBS;
+		break;
+	case PURGE_STEP:
+		msg_type = DBD_STEP_START;
+		break;
+	case PURGE_TXN:
+		msg_type = DBD_GOT_TXN;
+		break;
+	case PURGE_USAGE:
+		msg_type = usage_info & 0x0000ffff;
+		break;
+	case PURGE_CLUSTER_USAGE:
+		msg_type = DBD_GOT_CLUSTER_USAGE;
+		break;
+	default:
+		fatal("Unknown purge type: %d", type);
+		return 0;
+	}
+
+	pack16(SLURM_PROTOCOL_VERSION, buffer);
+	pack_time(time(NULL), buffer);
+	pack16(msg_type, buffer);
+	packstr(cluster_name, buffer);
+	cnt_offset = get_buf_offset(buffer);
+	pack32(0, buffer); /* set as the records are written */
+	if ((type == PURGE_USAGE) || (type == PURGE_CLUSTER_USAGE))
+		pack16(usage_info >> 16, buffer);
+
+	return cnt_offset;
+}
+
+/* Archive the records of table matching cond, the batch about to be purged.
+ * They are locked until the purge is committed so a record can not become
+ * purgeable, and be purged, without being archived.  They are appended to
+ * *arch_file, which is created along with the first ones.
+ * RET number of records archived or SLURM_ERROR */
+static int _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
+			  char *cluster_name, char *table, char *cond,
+			  time_t period_start, time_t period_end,
+			  char *arch_dir, uint32_t archive_period,
+			  char *sql_table, uint32_t usage_info,
+			  archive_file_t **arch_file, uint32_t *rec_cnt)
 {
 	MYSQL_RES *result = NULL;
 	char *cols = NULL, *query = NULL;
-	time_t period_start = 0;
-	uint32_t cnt = 0;
+	uint32_t cnt = 0, cnt_offset = 0;
 	Buf buffer;
 	int error_code = 0;
-	Buf (*pack_func)(MYSQL_RES *result, char *cluster_name,
-			 uint32_t cnt, uint32_t usage_info,
-			 time_t *period_start);
+	void (*pack_func)(MYSQL_RES *result, time_t *period_start,
+			  Buf buffer);
 
 	cols = _get_archive_columns(type);
 
@@ -2732,29 +2699,16 @@ static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
 
 	switch (type) {
 	case PURGE_TXN:
-		query = xstrdup_printf("select %s from \"%s\" where "
-				       "timestamp <= %ld && cluster='%s' "
-				       "order by timestamp asc "
-				       "for update",
-				       cols, sql_table,
-				       period_end, cluster_name);
-		break;
 	case PURGE_USAGE:
 	case PURGE_CLUSTER_USAGE:
-		query = xstrdup_printf("select %s from \"%s_%s\" where "
-				       "time_start <= %ld "
-				       "order by time_start asc "
-				       "for update",
-				       cols, cluster_name, sql_table,
-				       period_end);
+		query = xstrdup_printf("select %s from %s where %s for update",
+				       cols, table, cond);
 		break;
 	default:
-		query = xstrdup_printf("select %s from \"%s_%s\" where "
-				       "time_start <= %ld && time_end != 0 "
-				       "&& !deleted order by time_start asc "
-				       "for update",
-				       cols, cluster_name, sql_table,
-				       period_end);
+		/* Deleted records are purged but not archived */
+		query = xstrdup_printf("select %s from %s where %s "
+				       "&& !deleted for update",
+				       cols, table, cond);
 		break;
 	}
 
@@ -2773,18 +2727,27 @@ static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
 		return 0;
 	}
 
-	buffer = (*pack_func)(result, cluster_name, cnt, usage_info,
-			      &period_start);
+	buffer = init_buf(high_buffer_size);
+	if (!*arch_file)
+		cnt_offset = _pack_archive_header(type, cluster_name,
+						  usage_info, buffer);
+	(*pack_func)(result, NULL, buffer);
 	mysql_free_result(result);
 
-	error_code = archive_write_file(buffer, cluster_name,
-					period_start, period_end,
-					arch_dir, sql_table,
-					archive_period);
+	if (!*arch_file &&
+	    !(*arch_file = archive_file_open(cluster_name, period_start,
+					     period_end, arch_dir, sql_table,
+					     archive_period, cnt_offset))) {
+		free_buf(buffer);
+		return SLURM_ERROR;
+	}
+
+	*rec_cnt += cnt;
+	error_code = archive_file_write(*arch_file, buffer, *rec_cnt);
 	free_buf(buffer);
 
 	if (error_code != SLURM_SUCCESS)
-		return error_code;
+		return SLURM_ERROR;
 
 	return cnt;
 }
@@ -2870,6 +2833,85 @@ static int _get_oldest_record(mysql_conn_t *mysql_conn, char *cluster,
 	return 1; /* found one record */
 }
 
+/* Append to *cond the comparison of the primary key key_cols to the quoted
+ * values key_vals in key order, records after them if after is set, up to
+ * and including them otherwise.  Written out column by column so MySQL reads
+ * just that range of the primary key. */
+static void _key_range_cond(char **cond, char **key_cols, char **key_vals,
+			    int key_cnt, bool after)
+{
+	int i;
+
+	for (i = 0; i < key_cnt - 1; i++)
+		xstrfmtcat(*cond, "(%s %s %s || (%s = %s && ",
+			   key_cols[i], after ? ">" : "<", key_vals[i],
+			   key_cols[i], key_vals[i]);
+	xstrfmtcat(*cond, "%s %s %s", key_cols[i], after ? ">" : "<=",
+		   key_vals[i]);
+	for (i = 0; i < key_cnt - 1; i++)
+		xstrcat(*cond, "))");
+	xstrcat(*cond, " && ");
+}
+
+static void _free_key_vals(char **key_vals, int key_cnt)
+{
+	int i;
+
+	for (i = 0; i < key_cnt; i++)
+		xfree(key_vals[i]);
+}
+
+/* Get the end of the next batch of MAX_PURGE_LIMIT purgeable records, those
+ * matching purge_cond.  Batches are ranges of the primary key key_cols, so
+ * the records are read in primary key order from the end of the previous
+ * batch and only the purgeable ones are counted.
+ * IN batch_start - quoted key values the previous batch ended at, NULL for
+ *	the first batch
+ * OUT batch_end - set to the quoted key values the batch ends at, all NULL
+ *	when it includes the rest of the purgeable records, must be xfreed
+ */
+static int _get_batch_end(mysql_conn_t *mysql_conn, char *table,
+			  char *purge_cond, char **key_cols, int key_cnt,
+			  char **batch_start, char **batch_end)
+{
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	char *query = NULL, *cols = NULL, *range = NULL, *tmp;
+	int i;
+
+	for (i = 0; i < key_cnt; i++)
+		xstrfmtcat(cols, "%s%s", i ? ", " : "", key_cols[i]);
+	if (batch_start[0])
+		_key_range_cond(&range, key_cols, batch_start, key_cnt, true);
+
+	query = xstrdup_printf("select %s from %s where %s%s "
+			       "order by %s asc LIMIT %d, 1",
+			       cols, table, range ? range : "", purge_cond,
+			       cols, MAX_PURGE_LIMIT - 1);
+	xfree(cols);
+	xfree(range);
+
+	if (debug_flags & DEBUG_FLAG_DB_ARCHIVE)
+		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
+	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+		xfree(query);
+		return SLURM_ERROR;
+	}
+	xfree(query);
+
+	/* No row means the rest fits in one batch */
+	if ((row = mysql_fetch_row(result))) {
+		for (i = 0; i < key_cnt; i++) {
+			tmp = slurm_add_slash_to_quotes(row[i]);
+			batch_end[i] = xstrdup_printf("'%s'", tmp);
+			xfree(tmp);
+		}
+	}
+	mysql_free_result(result);
+
+	return SLURM_SUCCESS;
+}
+
 /* Archive and purge a table.
  *
  * Returns SLURM_ERROR on error and SLURM_SUCCESS on success.
@@ -2883,40 +2925,54 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 	uint16_t type, period;
 	time_t   last_submit = time(NULL);
 	time_t   curr_end    = 0, tmp_end = 0, record_start = 0;
-	char    *query = NULL, *sql_table = NULL,
-		*col_name = NULL;
-	uint32_t tmp_archive_period;
+	char    *query = NULL, *sql_table = NULL, *col_name = NULL;
+	char    *table = NULL, *purge_cond = NULL, *batch_cond = NULL;
+	char    *key_cols[3], *batch_start[3], *batch_end[3];
+	int      key_cnt = 0;
+	uint32_t tmp_archive_period, rec_cnt;
+	archive_file_t *arch_file;
+	bool     compress = slurmdbd_conf && slurmdbd_conf->archive_compress;
 
 	switch (purge_type) {
 	case PURGE_EVENT:
 		purge_attr = arch_cond->purge_event;
 		sql_table  = event_table;
 		col_name   = event_req_inx[EVENT_REQ_START];
+		key_cols[key_cnt++] = event_req_inx[EVENT_REQ_NODE];
+		key_cols[key_cnt++] = event_req_inx[EVENT_REQ_START];
 		break;
 	case PURGE_SUSPEND:
 		purge_attr = arch_cond->purge_suspend;
 		sql_table  = suspend_table;
 		col_name   = suspend_req_inx[SUSPEND_REQ_START];
+		key_cols[key_cnt++] = suspend_req_inx[SUSPEND_REQ_DB_INX];
+		key_cols[key_cnt++] = suspend_req_inx[SUSPEND_REQ_START];
 		break;
 	case PURGE_RESV:
 		purge_attr = arch_cond->purge_resv;
 		sql_table  = resv_table;
 		col_name   = step_req_inx[STEP_REQ_START];
+		key_cols[key_cnt++] = resv_req_inx[RESV_REQ_ID];
+		key_cols[key_cnt++] = resv_req_inx[RESV_REQ_START];
 		break;
 	case PURGE_JOB:
 		purge_attr = arch_cond->purge_job;
 		sql_table  = job_table;
 		col_name   = job_req_inx[JOB_REQ_SUBMIT];
+		key_cols[key_cnt++] = job_req_inx[JOB_REQ_DB_INX];
 		break;
 	case PURGE_STEP:
 		purge_attr = arch_cond->purge_step;
 		sql_table  = step_table;
 		col_name   = step_req_inx[STEP_REQ_START];
+		key_cols[key_cnt++] = step_req_inx[STEP_REQ_DB_INX];
+		key_cols[key_cnt++] = step_req_inx[STEP_REQ_STEPID];
 		break;
 	case PURGE_TXN:
 		purge_attr = arch_cond->purge_txn;
 		sql_table  = txn_table;
 		col_name   = txn_req_inx[TXN_REQ_TS];
+		key_cols[key_cnt++] = txn_req_inx[TXN_REQ_ID];
 		break;
 	case PURGE_USAGE:
 		type = usage_info & 0x0000ffff;
@@ -2965,6 +3021,9 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 
 		purge_attr = arch_cond->purge_usage;
 		col_name   = usage_req_inx[USAGE_START];
+		key_cols[key_cnt++] = usage_req_inx[USAGE_ID];
+		key_cols[key_cnt++] = usage_req_inx[USAGE_TRES];
+		key_cols[key_cnt++] = usage_req_inx[USAGE_START];
 		break;
 	case PURGE_CLUSTER_USAGE:
 		period = usage_info >> 16;
@@ -2987,6 +3046,8 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 
 		purge_attr = arch_cond->purge_usage;
 		col_name   = cluster_req_inx[CLUSTER_START];
+		key_cols[key_cnt++] = cluster_req_inx[CLUSTER_TRES];
+		key_cols[key_cnt++] = cluster_req_inx[CLUSTER_START];
 		break;
 	default:
 		fatal("Unknown purge type: %d", purge_type);
@@ -3021,67 +3082,110 @@ static int _archive_purge_table(purge_type_t purge_type, uint32_t usage_info,
 			debug("Purging %s_%s before %ld",
 			      cluster_name, sql_table, tmp_end);
 
-		if (SLURMDB_PURGE_ARCHIVE_SET(purge_attr)) {
-			rc = _archive_table(purge_type, mysql_conn,
-					    cluster_name, tmp_end,
-					    arch_cond->archive_dir,
-					    tmp_archive_period,
-					    sql_table, usage_info);
-			if (!rc) /* no records archived */
-				continue;
-			else if (rc == SLURM_ERROR)
-				return rc;
-		}
-
+		/* The records purged in this pass */
 		switch (purge_type) {
 		case PURGE_TXN:
-			query = xstrdup_printf(
-				"delete from \"%s\" where "
-				"%s <= %ld && cluster='%s' LIMIT %d",
-				sql_table, col_name,
-				tmp_end, cluster_name, MAX_PURGE_LIMIT);
+			table = xstrdup_printf("\"%s\"", sql_table);
+			purge_cond = xstrdup_printf("%s <= %ld && cluster='%s'",
+						    col_name, tmp_end,
+						    cluster_name);
 			break;
 		case PURGE_USAGE:
 		case PURGE_CLUSTER_USAGE:
-			query = xstrdup_printf(
-				"delete from \"%s_%s\" where "
-				"%s <= %ld LIMIT %d",
-				cluster_name, sql_table, col_name,
-				tmp_end, MAX_PURGE_LIMIT);
+			table = xstrdup_printf("\"%s_%s\"",
+					       cluster_name, sql_table);
+			purge_cond = xstrdup_printf("%s <= %ld",
+						    col_name, tmp_end);
 			break;
 		default:
-			query = xstrdup_printf(
-				"delete from \"%s_%s\" where "
-				"%s <= %ld && time_end != 0 LIMIT %d",
-				cluster_name, sql_table, col_name,
-				tmp_end, MAX_PURGE_LIMIT);
+			table = xstrdup_printf("\"%s_%s\"",
+					       cluster_name, sql_table);
+			purge_cond = xstrdup_printf("%s <= %ld && time_end != 0",
+						    col_name, tmp_end);
 			break;
 		}
-		if (debug_flags & DEBUG_FLAG_DB_ARCHIVE)
-			DB_DEBUG(mysql_conn->conn, "query\n%s", query);
 
-		while ((rc = mysql_db_delete_affected_rows(
-				mysql_conn, query)) > 0) {
-			/* Commit here every time since this could create a huge
-			 * transaction.
-			 */
+		/* Archive and purge in batches of MAX_PURGE_LIMIT purgeable
+		 * records, ranges of the primary key committed one at a time
+		 * so neither the records nor the locks on them pile up.  Each
+		 * batch is locked while archived and synced to the archive
+		 * file before it is purged. */
+		arch_file = NULL;
+		rec_cnt = 0;
+		memset(batch_start, 0, sizeof(batch_start));
+		memset(batch_end, 0, sizeof(batch_end));
+		do {
+			if ((rc = _get_batch_end(mysql_conn, table, purge_cond,
+						 key_cols, key_cnt,
+						 batch_start, batch_end))
+			    != SLURM_SUCCESS)
+				break;
+
+			if (batch_start[0])
+				_key_range_cond(&batch_cond, key_cols,
+						batch_start, key_cnt, true);
+			if (batch_end[0])
+				_key_range_cond(&batch_cond, key_cols,
+						batch_end, key_cnt, false);
+			xstrcat(batch_cond, purge_cond);
+
+			if (SLURMDB_PURGE_ARCHIVE_SET(purge_attr) &&
+			    (_archive_table(purge_type, mysql_conn,
+					    cluster_name, table, batch_cond,
+					    record_start, tmp_end,
+					    arch_cond->archive_dir,
+					    tmp_archive_period,
+					    sql_table, usage_info,
+					    &arch_file, &rec_cnt)
+			     == SLURM_ERROR)) {
+				rc = SLURM_ERROR;
+				break;
+			}
+
+			query = xstrdup_printf("delete from %s where %s",
+					       table, batch_cond);
+			if (debug_flags & DEBUG_FLAG_DB_ARCHIVE)
+				DB_DEBUG(mysql_conn->conn, "query\n%s", query);
+
+			rc = mysql_db_query(mysql_conn, query);
+			xfree(query);
+			if (rc != SLURM_SUCCESS) {
+				error("Couldn't remove old data from %s table",
+				      sql_table);
+				break;
+			}
 			if (mysql_db_commit(mysql_conn)) {
 				error("Couldn't commit cluster (%s) purge",
 				      cluster_name);
+				rc = SLURM_ERROR;
 				break;
 			}
-		}
 
-		xfree(query);
-		if (rc != SLURM_SUCCESS) {
-			error("Couldn't remove old data from %s table",
-			      sql_table);
+			xfree(batch_cond);
+			_free_key_vals(batch_start, key_cnt);
+			memcpy(batch_start, batch_end, sizeof(batch_start));
+			memset(batch_end, 0, sizeof(batch_end));
+			if (batch_start[0])
+				usleep(PURGE_BATCH_DELAY);
+		} while (batch_start[0]);
+		xfree(batch_cond);
+		_free_key_vals(batch_start, key_cnt);
+		_free_key_vals(batch_end, key_cnt);
+		xfree(purge_cond);
+		xfree(table);
+
+		if (rc != SLURM_SUCCESS)
+			mysql_db_rollback(mysql_conn);
+
+		/* Whatever was purged is in the archive file, so keep it
+		 * even when a later batch failed. */
+		if (arch_file &&
+		    (archive_file_close(arch_file, compress) != SLURM_SUCCESS))
+			error("Couldn't compress %s_%s archive",
+			      cluster_name, sql_table);
+
+		if (rc != SLURM_SUCCESS)
 			return SLURM_ERROR;
-		} else if (mysql_db_commit(mysql_conn)) {
-			error("Couldn't commit cluster (%s) purge",
-			      cluster_name);
-			break;
-		}
 	} while (tmp_end < curr_end);
 
 	return SLURM_SUCCESS;
@@ -3189,12 +3293,12 @@ extern int as_mysql_jobacct_process_archive(mysql_conn_t *mysql_conn,
 		 */
 		new_cluster_list = true;
 		use_cluster_list = list_create(slurm_destroy_char);
-		slurm_mutex_lock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
 		itr = list_iterator_create(as_mysql_cluster_list);
 		while ((cluster_name = list_next(itr)))
 			list_append(use_cluster_list, xstrdup(cluster_name));
 		list_iterator_destroy(itr);
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 	}
 
 	itr = list_iterator_create(use_cluster_list);
@@ -3229,37 +3333,8 @@ extern int as_mysql_jobacct_process_archive_load(
 	if (arch_rec->insert) {
 		data = xstrdup(arch_rec->insert);
 	} else if (arch_rec->archive_file) {
-		int data_allocated, data_read = 0;
-		int state_fd = open(arch_rec->archive_file, O_RDONLY);
-		if (state_fd < 0) {
-			info("No archive file (%s) to recover",
-			     arch_rec->archive_file);
-			error_code = ENOENT;
-		} else {
-			data_allocated = BUF_SIZE + 1;
-			data = xmalloc_nz(data_allocated);
-			while (1) {
-				data_read = read(state_fd, &data[data_size],
-						 BUF_SIZE);
-				if (data_read < 0) {
-					data[data_size] = '\0';
-					if (errno == EINTR)
-						continue;
-					else {
-						error("Read error on %s: %m",
-						      arch_rec->archive_file);
-						break;
-					}
-				}
-				data[data_size + data_read] = '\0';
-				if (data_read == 0)	/* eof */
-					break;
-				data_size      += data_read;
-				data_allocated += data_read;
-				xrealloc_nz(data, data_allocated);
-			}
-			close(state_fd);
-		}
+		error_code = archive_read_file(arch_rec->archive_file,
+					       &data, &data_size);
 		if (error_code != SLURM_SUCCESS) {
 			xfree(data);
 			return error_code;
@@ -351,7 +351,7 @@ static int _make_sure_users_have_default(
 	if (!user_list)
 		return SLURM_SUCCESS;
 
-	slurm_mutex_lock(&as_mysql_cluster_list_lock);
+	slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
 
 	clus_itr = list_iterator_create(as_mysql_cluster_list);
 	itr = list_iterator_create(user_list);
@@ -416,7 +416,7 @@ static int _make_sure_users_have_default(
 	}
 	list_iterator_destroy(itr);
 	list_iterator_destroy(clus_itr);
-	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+	slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 
 	return rc;
 }
@@ -2801,7 +2801,7 @@ extern int as_mysql_add_assocs(mysql_conn_t *mysql_conn, uint32_t uid,
 		if (!moved_parent) {
 			char *cluster_name;
 
-			slurm_mutex_lock(&as_mysql_cluster_list_lock);
+			slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
 			itr = list_iterator_create(as_mysql_cluster_list);
 			while ((cluster_name = list_next(itr))) {
 				uint32_t smallest_lft = 0xFFFFFFFF;
@@ -2820,7 +2820,7 @@ extern int as_mysql_add_assocs(mysql_conn_t *mysql_conn, uint32_t uid,
 						smallest_lft);
 			}
 			list_iterator_destroy(itr);
-			slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+			slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 		}
 
 		/* make sure we don't have any other default accounts */
@@ -3022,7 +3022,7 @@ is_same_user:
 	if (assoc_cond->cluster_list && list_count(assoc_cond->cluster_list))
 		use_cluster_list = assoc_cond->cluster_list;
 	else
-		slurm_mutex_lock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
 
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
@@ -3065,7 +3065,7 @@ is_same_user:
 	}
 	list_iterator_destroy(itr);
 	if (use_cluster_list == as_mysql_cluster_list)
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 	xfree(vals);
 	xfree(object);
 	xfree(extra);
@@ -3137,7 +3137,7 @@ extern List as_mysql_remove_assocs(mysql_conn_t *mysql_conn, uint32_t uid,
 	if (assoc_cond->cluster_list && list_count(assoc_cond->cluster_list))
 		use_cluster_list = assoc_cond->cluster_list;
 	else
-		slurm_mutex_lock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
 
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
@@ -3212,7 +3212,7 @@ extern List as_mysql_remove_assocs(mysql_conn_t *mysql_conn, uint32_t uid,
 	}
 	list_iterator_destroy(itr);
 	if (use_cluster_list == as_mysql_cluster_list)
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 	xfree(object);
 	xfree(extra);
 
@@ -3294,7 +3294,7 @@ empty:
 	assoc_list = list_create(slurmdb_destroy_assoc_rec);
 
 	if (use_cluster_list == as_mysql_cluster_list)
-		slurm_mutex_lock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
 		int rc;
@@ -3309,7 +3309,7 @@ empty:
 	}
 	list_iterator_destroy(itr);
 	if (use_cluster_list == as_mysql_cluster_list)
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 	xfree(tmp);
 	xfree(extra);
 
@@ -3342,7 +3342,7 @@ extern int as_mysql_reset_lft_rgt(mysql_conn_t *mysql_conn, uid_t uid,
 	if (cluster_list && list_count(cluster_list))
 		use_cluster_list = cluster_list;
 	/* else */
-	/* 	slurm_mutex_lock(&as_mysql_cluster_list_lock); */
+	/* 	slurm_rwlock_rdlock(&as_mysql_cluster_list_lock); */
 
 	memset(&assoc_cond, 0, sizeof(slurmdb_assoc_cond_t));
 
@@ -3524,7 +3524,7 @@ extern int as_mysql_reset_lft_rgt(mysql_conn_t *mysql_conn, uid_t uid,
 	xfree(tmp);
 
 	/* if (use_cluster_list == as_mysql_cluster_list) */
-	/* 	slurm_mutex_unlock(&as_mysql_cluster_list_lock); */
+	/* 	slurm_rwlock_unlock(&as_mysql_cluster_list_lock); */
 
 	return rc;
 }
@@ -248,7 +248,7 @@ extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 	char temp_bit[BUF_SIZE];
 	char *query = NULL;
 	int reinit = 0;
-	time_t begin_time, check_time, start_time, submit_time;
+	time_t begin_time, check_time, start_time, submit_time, last_rollup;
 	uint32_t wckeyid = 0;
 	uint32_t job_state;
 	int node_cnt = 0;
@@ -326,8 +326,13 @@ extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 	else
 		check_time = submit_time;
 
+	/* Don't hold the rollup_lock over the query below, it is shared
+	 * by every cluster's job starts. */
 	slurm_mutex_lock(&rollup_lock);
-	if (check_time < global_last_rollup) {
+	last_rollup = global_last_rollup;
+	slurm_mutex_unlock(&rollup_lock);
+
+	if (check_time < last_rollup) {
 		MYSQL_RES *result = NULL;
 		MYSQL_ROW row;
 
@@ -346,7 +351,6 @@ extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 		if (!(result =
 		      mysql_db_query_ret(mysql_conn, query, 0))) {
 			xfree(query);
-			slurm_mutex_unlock(&rollup_lock);
 			return SLURM_ERROR;
 		}
 		xfree(query);
@@ -355,7 +359,6 @@ extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 			debug4("revieved an update for a "
 			       "job (%u) already known about",
 			       job_ptr->job_id);
-			slurm_mutex_unlock(&rollup_lock);
 			goto no_rollup_change;
 		}
 		mysql_free_result(result);
@@ -379,7 +382,9 @@ extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 			      slurm_ctime2(&check_time),
 			      job_ptr->job_id, mysql_conn->cluster_name);
 
-		global_last_rollup = check_time;
+		slurm_mutex_lock(&rollup_lock);
+		if (check_time < global_last_rollup)
+			global_last_rollup = check_time;
 		slurm_mutex_unlock(&rollup_lock);
 
 		/* If the times here are later than the daily_rollup
@@ -397,8 +402,7 @@ extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 			DB_DEBUG(mysql_conn->conn, "query\n%s", query);
 		rc = mysql_db_query(mysql_conn, query);
 		xfree(query);
-	} else
-		slurm_mutex_unlock(&rollup_lock);
+	}
 
 no_rollup_change:
 
@@ -800,6 +804,9 @@ extern int as_mysql_job_complete(mysql_conn_t *mysql_conn,
 	int rc = SLURM_SUCCESS, job_state;
 	time_t submit_time, end_time;
 	uint32_t exit_code = 0;
+	MYSQL_BIND bind[8];
+	int b = 0, exit_int, requid;
+	int64_t end_int;
 
 	if (!job_ptr->db_index
 	    && ((!job_ptr->details || !job_ptr->details->submit_time)
@@ -892,30 +899,30 @@ extern int as_mysql_job_complete(mysql_conn_t *mysql_conn,
 		}
 	}
 
-	/*
-	 * make sure we handle any quotes that may be in the comment
-	 */
-
+	/* Run as a prepared statement, this is one of the most frequent
+	 * queries.  There are only a few variants of it depending on which
+	 * of the optional fields are set, each one is prepared once. */
 	query = xstrdup_printf("update \"%s_%s\" set "
 			       "mod_time=UNIX_TIMESTAMP(), "
-			       "time_end=%ld, state=%d",
-			       mysql_conn->cluster_name, job_table,
-			       end_time, job_state);
-
-	if (job_ptr->derived_ec != NO_VAL)
-		xstrfmtcat(query, ", derived_ec=%u", job_ptr->derived_ec);
+			       "time_end=?, state=?",
+			       mysql_conn->cluster_name, job_table);
+	end_int = end_time;
+	mysql_db_bind_int64(&bind[b++], &end_int);
+	mysql_db_bind_int(&bind[b++], &job_state);
+
+	if (job_ptr->derived_ec != NO_VAL) {
+		xstrcat(query, ", derived_ec=?");
+		mysql_db_bind_uint32(&bind[b++], &job_ptr->derived_ec);
+	}
 
 	if (job_ptr->comment) {
-		char *comment = slurm_add_slash_to_quotes(job_ptr->comment);
-		xstrfmtcat(query, ", derived_es='%s'", comment);
-		xfree(comment);
+		xstrcat(query, ", derived_es=?");
+		mysql_db_bind_str(&bind[b++], job_ptr->comment);
 	}
 
 	if (job_ptr->admin_comment) {
-		char *comment = slurm_add_slash_to_quotes(
-			job_ptr->admin_comment);
-		xstrfmtcat(query, ", admin_comment='%s'", comment);
-		xfree(comment);
+		xstrcat(query, ", admin_comment=?");
+		mysql_db_bind_str(&bind[b++], job_ptr->admin_comment);
 	}
 
 	exit_code = job_ptr->exit_code;
@@ -926,14 +933,18 @@ extern int as_mysql_job_complete(mysql_conn_t *mysql_conn,
 		exit_code = 256;
 	}
 
-	xstrfmtcat(query,
-		   ", exit_code=%d, kill_requid=%d where job_db_inx=%"PRIu64";",
-		   exit_code, job_ptr->requid,
-		   job_ptr->db_index);
+	xstrcat(query, ", exit_code=?, kill_requid=? where job_db_inx=?");
+	exit_int = (int)exit_code;
+	requid = (int)job_ptr->requid;
+	mysql_db_bind_int(&bind[b++], &exit_int);
+	mysql_db_bind_int(&bind[b++], &requid);
+	mysql_db_bind_uint64(&bind[b++], &job_ptr->db_index);
+	xassert(b <= (sizeof(bind) / sizeof(MYSQL_BIND)));
 
 	if (debug_flags & DEBUG_FLAG_DB_JOB)
-		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+		DB_DEBUG(mysql_conn->conn, "query\n%s\njob_db_inx=%"PRIu64,
+			 query, job_ptr->db_index);
+	rc = mysql_db_stmt_query(mysql_conn, query, bind);
 	xfree(query);
 
 	return rc;
@@ -946,9 +957,11 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 	int rc = SLURM_SUCCESS;
 	char temp_bit[BUF_SIZE];
 	char node_list[BUFFER_SIZE];
-	char *node_inx = NULL, *step_name = NULL;
+	char *node_inx = NULL;
 	time_t start_time, submit_time;
 	char *query = NULL;
+	MYSQL_BIND bind[14];
+	int step_id, start_int, state = JOB_RUNNING;
 
 	if (!step_ptr->job_ptr->db_index
 	    && ((!step_ptr->job_ptr->details
@@ -1066,39 +1079,47 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 		}
 	}
 
-	step_name = slurm_add_slash_to_quotes(step_ptr->name);
-
-	/* we want to print a -1 for the requid so leave it a
-	   %d */
-	/* The stepid could be -2 so use %d not %u */
+	/* Run as a prepared statement, this is one of the most frequent
+	 * queries.  The stepid could be -2 so bind it as an int. */
 	query = xstrdup_printf(
 		"insert into \"%s_%s\" (job_db_inx, id_step, time_start, "
 		"step_name, state, tres_alloc, "
 		"nodes_alloc, task_cnt, nodelist, node_inx, "
 		"task_dist, req_cpufreq, req_cpufreq_min, req_cpufreq_gov) "
-		"values (%"PRIu64", %d, %d, '%s', %d, '%s', %d, %d, "
-		"'%s', '%s', %d, %u, %u, %u) "
+		"values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
 		"on duplicate key update "
-		"nodes_alloc=%d, task_cnt=%d, time_end=0, state=%d, "
-		"nodelist='%s', node_inx='%s', task_dist=%d, "
-		"req_cpufreq=%u, req_cpufreq_min=%u, req_cpufreq_gov=%u,"
-		"tres_alloc='%s';",
-		mysql_conn->cluster_name, step_table,
-		step_ptr->job_ptr->db_index,
-		step_ptr->step_id,
-		(int)start_time, step_name,
-		JOB_RUNNING, step_ptr->tres_alloc_str,
-		nodes, tasks, node_list, node_inx, task_dist,
-		step_ptr->cpu_freq_max, step_ptr->cpu_freq_min,
-		step_ptr->cpu_freq_gov, nodes, tasks, JOB_RUNNING,
-		node_list, node_inx, task_dist, step_ptr->cpu_freq_max,
-		step_ptr->cpu_freq_min, step_ptr->cpu_freq_gov,
-		step_ptr->tres_alloc_str);
+		"nodes_alloc=VALUES(nodes_alloc), task_cnt=VALUES(task_cnt), "
+		"time_end=0, state=VALUES(state), "
+		"nodelist=VALUES(nodelist), node_inx=VALUES(node_inx), "
+		"task_dist=VALUES(task_dist), "
+		"req_cpufreq=VALUES(req_cpufreq), "
+		"req_cpufreq_min=VALUES(req_cpufreq_min), "
+		"req_cpufreq_gov=VALUES(req_cpufreq_gov), "
+		"tres_alloc=VALUES(tres_alloc)",
+		mysql_conn->cluster_name, step_table);
+	step_id = (int)step_ptr->step_id;
+	start_int = (int)start_time;
+	mysql_db_bind_uint64(&bind[0], &step_ptr->job_ptr->db_index);
+	mysql_db_bind_int(&bind[1], &step_id);
+	mysql_db_bind_int(&bind[2], &start_int);
+	mysql_db_bind_str(&bind[3], step_ptr->name);
+	mysql_db_bind_int(&bind[4], &state);
+	mysql_db_bind_str(&bind[5], step_ptr->tres_alloc_str);
+	mysql_db_bind_int(&bind[6], &nodes);
+	mysql_db_bind_int(&bind[7], &tasks);
+	mysql_db_bind_str(&bind[8], node_list);
+	mysql_db_bind_str(&bind[9], node_inx);
+	mysql_db_bind_int(&bind[10], &task_dist);
+	mysql_db_bind_uint32(&bind[11], &step_ptr->cpu_freq_max);
+	mysql_db_bind_uint32(&bind[12], &step_ptr->cpu_freq_min);
+	mysql_db_bind_uint32(&bind[13], &step_ptr->cpu_freq_gov);
+
 	if (debug_flags & DEBUG_FLAG_DB_STEP)
-		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+		DB_DEBUG(mysql_conn->conn, "query\n%s\njob_db_inx=%"PRIu64" "
+			 "id_step=%d", query, step_ptr->job_ptr->db_index,
+			 step_id);
+	rc = mysql_db_stmt_query(mysql_conn, query, bind);
 	xfree(query);
-	xfree(step_name);
 
 	return rc;
 }
@@ -1114,6 +1135,13 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 	int rc = SLURM_SUCCESS;
 	uint32_t exit_code = 0;
 	time_t submit_time;
+	MYSQL_BIND bind[36];
+	int b = 0, now_int, requid, exit_int, step_id;
+	uint32_t comp_status32;
+	double ave_vsize = NO_VAL, ave_rss = NO_VAL, ave_pages = NO_VAL;
+	double ave_disk_read = (double)NO_VAL;
+	double ave_disk_write = (double)NO_VAL;
+	double ave_cpu = (double)NO_VAL;
 
 	if (!step_ptr->job_ptr->db_index
 	    && ((!step_ptr->job_ptr->details
@@ -1196,21 +1224,23 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 		}
 	}
 
-	/* The stepid could be -2 so use %d not %u */
+	/* Run as a prepared statement, this is one of the most frequent
+	 * queries.  The requid, exit_code and stepid could be negative so
+	 * bind them as ints. */
 	query = xstrdup_printf(
-		"update \"%s_%s\" set time_end=%d, state=%u, "
-		"kill_requid=%d, exit_code=%d",
-		mysql_conn->cluster_name, step_table, (int)now,
-		comp_status,
-		step_ptr->requid,
-		exit_code);
-
+		"update \"%s_%s\" set time_end=?, state=?, "
+		"kill_requid=?, exit_code=?",
+		mysql_conn->cluster_name, step_table);
+	now_int = (int)now;
+	comp_status32 = comp_status;
+	requid = (int)step_ptr->requid;
+	exit_int = (int)exit_code;
+	mysql_db_bind_int(&bind[b++], &now_int);
+	mysql_db_bind_uint32(&bind[b++], &comp_status32);
+	mysql_db_bind_int(&bind[b++], &requid);
+	mysql_db_bind_int(&bind[b++], &exit_int);
 
 	if (jobacct) {
-		double ave_vsize = NO_VAL, ave_rss = NO_VAL, ave_pages = NO_VAL;
-		double ave_disk_read =  (double)NO_VAL;
-		double ave_disk_write = (double)NO_VAL;
-		double ave_cpu = (double)NO_VAL;
 		/* figure out the ave of the totals sent */
 		if (tasks > 0) {
 			ave_vsize = (double)jobacct->tot_vsize;
@@ -1227,75 +1257,73 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 			ave_disk_write /= (double)tasks;
 		}
 
-		xstrfmtcat(query,
-			   ", user_sec=%u, user_usec=%u, "
-			   "sys_sec=%u, sys_usec=%u, "
-			   "max_disk_read=%f, max_disk_read_task=%u, "
-			   "max_disk_read_node=%u, ave_disk_read=%f, "
-			   "max_disk_write=%f, max_disk_write_task=%u, "
-			   "max_disk_write_node=%u, ave_disk_write=%f, "
-			   "max_vsize=%"PRIu64", max_vsize_task=%u, "
-			   "max_vsize_node=%u, ave_vsize=%f, "
-			   "max_rss=%"PRIu64", max_rss_task=%u, "
-			   "max_rss_node=%u, ave_rss=%f, "
-			   "max_pages=%"PRIu64", max_pages_task=%u, "
-			   "max_pages_node=%u, ave_pages=%f, "
-			   "min_cpu=%u, min_cpu_task=%u, "
-			   "min_cpu_node=%u, ave_cpu=%f, "
-			   "act_cpufreq=%u, consumed_energy=%"PRIu64"",
-			   /* user seconds */
-			   jobacct->user_cpu_sec,
-			   /* user microseconds */
-			   jobacct->user_cpu_usec,
-			   /* system seconds */
-			   jobacct->sys_cpu_sec,
-			   /* system microsecs */
-			   jobacct->sys_cpu_usec,
-			   /* max disk_read */
-			   jobacct->max_disk_read,
-			   /* max disk_read task */
-			   jobacct->max_disk_read_id.taskid,
-			   /* max disk_read node */
-			   jobacct->max_disk_read_id.nodeid,
-			   /* ave disk_read */
-			   ave_disk_read,
-			   /* max disk_write */
-			   jobacct->max_disk_write,
-			   /* max disk_write task */
-			   jobacct->max_disk_write_id.taskid,
-			   /* max disk_write node */
-			   jobacct->max_disk_write_id.nodeid,
-			   /* ave disk_write */
-			   ave_disk_write,
-			   jobacct->max_vsize,	/* max vsize */
-			   jobacct->max_vsize_id.taskid, /* max vsize task */
-			   jobacct->max_vsize_id.nodeid, /* max vsize node */
-			   ave_vsize,	/* ave vsize */
-			   jobacct->max_rss,	/* max vsize */
-			   jobacct->max_rss_id.taskid,	/* max rss task */
-			   jobacct->max_rss_id.nodeid,	/* max rss node */
-			   ave_rss,	/* ave rss */
-			   jobacct->max_pages,	/* max pages */
-			   jobacct->max_pages_id.taskid, /* max pages task */
-			   jobacct->max_pages_id.nodeid, /* max pages node */
-			   ave_pages,	/* ave pages */
-			   jobacct->min_cpu,	/* min cpu */
-			   jobacct->min_cpu_id.taskid,	/* min cpu task */
-			   jobacct->min_cpu_id.nodeid,	/* min cpu node */
-			   ave_cpu,	/* ave cpu */
-			   jobacct->act_cpufreq,
-			   jobacct->energy.consumed_energy);
+		xstrcat(query,
+			", user_sec=?, user_usec=?, "
+			"sys_sec=?, sys_usec=?, "
+			"max_disk_read=?, max_disk_read_task=?, "
+			"max_disk_read_node=?, ave_disk_read=?, "
+			"max_disk_write=?, max_disk_write_task=?, "
+			"max_disk_write_node=?, ave_disk_write=?, "
+			"max_vsize=?, max_vsize_task=?, "
+			"max_vsize_node=?, ave_vsize=?, "
+			"max_rss=?, max_rss_task=?, "
+			"max_rss_node=?, ave_rss=?, "
+			"max_pages=?, max_pages_task=?, "
+			"max_pages_node=?, ave_pages=?, "
+			"min_cpu=?, min_cpu_task=?, "
+			"min_cpu_node=?, ave_cpu=?, "
+			"act_cpufreq=?, consumed_energy=?");
+		mysql_db_bind_uint32(&bind[b++], &jobacct->user_cpu_sec);
+		mysql_db_bind_uint32(&bind[b++], &jobacct->user_cpu_usec);
+		mysql_db_bind_uint32(&bind[b++], &jobacct->sys_cpu_sec);
+		mysql_db_bind_uint32(&bind[b++], &jobacct->sys_cpu_usec);
+		mysql_db_bind_double(&bind[b++], &jobacct->max_disk_read);
+		mysql_db_bind_uint16(&bind[b++],
+				     &jobacct->max_disk_read_id.taskid);
+		mysql_db_bind_uint32(&bind[b++],
+				     &jobacct->max_disk_read_id.nodeid);
+		mysql_db_bind_double(&bind[b++], &ave_disk_read);
+		mysql_db_bind_double(&bind[b++], &jobacct->max_disk_write);
+		mysql_db_bind_uint16(&bind[b++],
+				     &jobacct->max_disk_write_id.taskid);
+		mysql_db_bind_uint32(&bind[b++],
+				     &jobacct->max_disk_write_id.nodeid);
+		mysql_db_bind_double(&bind[b++], &ave_disk_write);
+		mysql_db_bind_uint64(&bind[b++], &jobacct->max_vsize);
+		mysql_db_bind_uint16(&bind[b++], &jobacct->max_vsize_id.taskid);
+		mysql_db_bind_uint32(&bind[b++], &jobacct->max_vsize_id.nodeid);
+		mysql_db_bind_double(&bind[b++], &ave_vsize);
+		mysql_db_bind_uint64(&bind[b++], &jobacct->max_rss);
+		mysql_db_bind_uint16(&bind[b++], &jobacct->max_rss_id.taskid);
+		mysql_db_bind_uint32(&bind[b++], &jobacct->max_rss_id.nodeid);
+		mysql_db_bind_double(&bind[b++], &ave_rss);
+		mysql_db_bind_uint64(&bind[b++], &jobacct->max_pages);
+		mysql_db_bind_uint16(&bind[b++], &jobacct->max_pages_id.taskid);
+		mysql_db_bind_uint32(&bind[b++], &jobacct->max_pages_id.nodeid);
+		mysql_db_bind_double(&bind[b++], &ave_pages);
+		mysql_db_bind_uint32(&bind[b++], &jobacct->min_cpu);
+		mysql_db_bind_uint16(&bind[b++], &jobacct->min_cpu_id.taskid);
+		mysql_db_bind_uint32(&bind[b++], &jobacct->min_cpu_id.nodeid);
+		mysql_db_bind_double(&bind[b++], &ave_cpu);
+		mysql_db_bind_uint32(&bind[b++], &jobacct->act_cpufreq);
+		mysql_db_bind_uint64(&bind[b++],
+				     &jobacct->energy.consumed_energy);
 	}
 
-	/* id_step has to be %d here to handle the -2 -1 for the batch and
-	   extern steps.  Don't change it to a %u.
+	/* id_step has to be an int here to handle the -2 -1 for the batch
+	   and extern steps.  Don't change it to a uint32.
 	*/
-	xstrfmtcat(query,
-		   " where job_db_inx=%"PRIu64" and id_step=%d",
-		   step_ptr->job_ptr->db_index, step_ptr->step_id);
+	xstrcat(query, " where job_db_inx=? and id_step=?");
+	step_id = (int)step_ptr->step_id;
+	mysql_db_bind_uint64(&bind[b++], &step_ptr->job_ptr->db_index);
+	mysql_db_bind_int(&bind[b++], &step_id);
+	xassert(b <= (sizeof(bind) / sizeof(MYSQL_BIND)));
+
 	if (debug_flags & DEBUG_FLAG_DB_STEP)
-		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+		DB_DEBUG(mysql_conn->conn, "query\n%s\njob_db_inx=%"PRIu64" "
+			 "id_step=%d", query, step_ptr->job_ptr->db_index,
+			 step_id);
+	rc = mysql_db_stmt_query(mysql_conn, query, bind);
 	xfree(query);
 
 	return rc;
@@ -364,13 +364,65 @@ static void _destroy_local_cluster(void *object)
 	}
 }
 
+/*
+ * Limit a query of the cluster's job table to the next job_cond->page_size
+ * job ids after *page_jobid, all records of a job id are always in the same
+ * page.
+ * IN/OUT page_jobid - last job id of the previous page in, of this page out
+ * OUT page_more - set if there may be more job ids after this page
+ * RET SLURM_SUCCESS or error
+ */
+static int _page_job_limits(mysql_conn_t *mysql_conn,
+			    slurmdb_job_cond_t *job_cond,
+			    char *cluster_name, char **extra,
+			    uint32_t *page_jobid, bool *page_more)
+{
+	char *query = NULL;
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	uint32_t last_jobid = *page_jobid;
+	int rows = 0;
+
+	xstrfmtcat(*extra, "%s t1.id_job>%u",
+		   *extra ? " &&" : " where", *page_jobid);
+
+	query = xstrdup_printf("select t1.id_job from \"%s_%s\" as t1 "
+			       "left join \"%s_%s\" as t2 "
+			       "on t1.id_assoc=t2.id_assoc%s "
+			       "group by t1.id_job order by t1.id_job "
+			       "limit %u",
+			       cluster_name, job_table,
+			       cluster_name, assoc_table, *extra,
+			       job_cond->page_size);
+	if (debug_flags & DEBUG_FLAG_DB_JOB)
+		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
+	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+		xfree(query);
+		return SLURM_ERROR;
+	}
+	xfree(query);
+
+	while ((row = mysql_fetch_row(result))) {
+		last_jobid = slurm_atoul(row[0]);
+		rows++;
+	}
+	mysql_free_result(result);
+
+	xstrfmtcat(*extra, " && t1.id_job<=%u", last_jobid);
+	*page_jobid = last_jobid;
+	*page_more = (rows >= job_cond->page_size);
+
+	return SLURM_SUCCESS;
+}
+
 static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 			     slurmdb_user_rec_t *user,
 			     slurmdb_job_cond_t *job_cond,
 			     char *cluster_name,
 			     char *job_fields, char *step_fields,
 			     char *sent_extra,
-			     bool is_admin, int only_pending, List sent_list)
+			     bool is_admin, int only_pending, List sent_list,
+			     uint32_t *page_jobid, bool *page_more)
 {
 	char *query = NULL;
 	char *extra = xstrdup(sent_extra);
@@ -457,6 +509,14 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	setup_job_cluster_cond_limits(mysql_conn, job_cond,
 				      cluster_name, &extra);
 
+	if (page_jobid &&
+	    (_page_job_limits(mysql_conn, job_cond, cluster_name, &extra,
+			      page_jobid, page_more) != SLURM_SUCCESS)) {
+		xfree(extra);
+		rc = SLURM_ERROR;
+		goto end_it;
+	}
+
 	query = xstrdup_printf("select %s from \"%s_%s\" as t1 "
 			       "left join \"%s_%s\" as t2 "
 			       "on t1.id_assoc=t2.id_assoc "
@@ -989,6 +1049,54 @@ end_it:
 	return rc;
 }
 
+/*
+ * Get the next page of jobs after job_cond->cursor_cluster and
+ * job_cond->cursor_jobid. Pages of job ids are read until at least one job
+ * matches or every cluster has been read, so an empty job_list means there
+ * are no more jobs. Only one page of jobs is ever held in memory.
+ */
+static void _get_jobs_page(mysql_conn_t *mysql_conn,
+			   slurmdb_user_rec_t *user,
+			   slurmdb_job_cond_t *job_cond, List use_cluster_list,
+			   char *job_fields, char *step_fields,
+			   char *sent_extra, bool is_admin, int only_pending,
+			   List job_list)
+{
+	ListIterator itr;
+	char *cluster_name;
+	uint32_t page_jobid = 0;
+	bool page_more, resume = (job_cond->cursor_cluster != NULL);
+
+	itr = list_iterator_create(use_cluster_list);
+	while ((cluster_name = list_next(itr))) {
+		if (resume) {
+			if (xstrcmp(cluster_name, job_cond->cursor_cluster))
+				continue;
+			resume = false;
+			page_jobid = job_cond->cursor_jobid;
+		} else
+			page_jobid = 0;
+
+		do {
+			page_more = false;
+			if (_cluster_get_jobs(mysql_conn, user, job_cond,
+					      cluster_name, job_fields,
+					      step_fields, sent_extra,
+					      is_admin, only_pending, job_list,
+					      &page_jobid, &page_more)
+			    != SLURM_SUCCESS) {
+				error("Problem getting jobs for cluster %s",
+				      cluster_name);
+				break;
+			}
+		} while (page_more && !list_count(job_list));
+
+		if (list_count(job_list))
+			break;
+	}
+	list_iterator_destroy(itr);
+}
+
 extern List setup_cluster_list_with_inx(mysql_conn_t *mysql_conn,
 					slurmdb_job_cond_t *job_cond,
 					void **curr_cluster)
@@ -1597,27 +1705,35 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	    && job_cond->cluster_list && list_count(job_cond->cluster_list))
 		use_cluster_list = job_cond->cluster_list;
 	else
-		slurm_mutex_lock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
 
 	assoc_mgr_lock(&locks);
 
 	job_list = list_create(slurmdb_destroy_job_rec);
+	if (job_cond && job_cond->page_size) {
+		_get_jobs_page(mysql_conn, &user, job_cond, use_cluster_list,
+			       tmp, tmp2, extra, is_admin, only_pending,
+			       job_list);
+		goto end_clusters;
+	}
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
 		int rc;
 		if ((rc = _cluster_get_jobs(mysql_conn, &user, job_cond,
 					    cluster_name, tmp, tmp2, extra,
-					    is_admin, only_pending, job_list))
+					    is_admin, only_pending, job_list,
+					    NULL, NULL))
 		    != SLURM_SUCCESS)
 			error("Problem getting jobs for cluster %s",
 			      cluster_name);
 	}
 	list_iterator_destroy(itr);
+end_clusters:
 
 	assoc_mgr_unlock(&locks);
 
 	if (use_cluster_list == as_mysql_cluster_list)
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+		slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 
 	xfree(tmp);
 	xfree(tmp2);
@@ -1088,7 +1088,7 @@ extern List as_mysql_remove_qos(mysql_conn_t *mysql_conn, uint32_t uid,
 
 	user_name = uid_to_string((uid_t) uid);
 
-	slurm_mutex_lock(&as_mysql_cluster_list_lock);
+	slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
 	if (list_count(as_mysql_cluster_list)) {
 		itr = list_iterator_create(as_mysql_cluster_list);
 		while ((object = list_next(itr))) {
@@ -1104,7 +1104,7 @@ extern List as_mysql_remove_qos(mysql_conn_t *mysql_conn, uint32_t uid,
 				   user_name, qos_table, name_char,
 				   assoc_char, NULL, NULL, NULL);
 
-	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+	slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 
 	xfree(assoc_char);
 	xfree(name_char);
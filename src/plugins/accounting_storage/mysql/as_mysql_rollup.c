@@ -42,6 +42,11 @@
 #include "as_mysql_archive.h"
 #include "src/common/parse_time.h"
 #include "src/common/slurm_time.h"
+#include "src/common/xhash.h"
+
+/* Most threads to roll up the hours of a single cluster with, each one
+ * uses its own database connection. */
+#define MAX_HOURLY_ROLLUP_THREADS 4
 
 enum {
 	TIME_ALLOC,
@@ -69,6 +74,7 @@ typedef struct {
 
 typedef struct {
 	int id;
+	char id_str[11]; /* id as a string, key of the id usage hash */
 	List loc_tres;
 } local_id_usage_t;
 
@@ -88,6 +94,28 @@ typedef struct {
 	time_t start;
 } local_resv_usage_t;
 
+/* The hours of an hourly rollup, handed out one at a time to the threads
+ * rolling them up */
+typedef struct {
+	char *cluster_name;
+	time_t done_end;	/* every hour before this is committed */
+	time_t end;		/* end of the period to roll up */
+	uint32_t hours_done;	/* hours committed so far */
+	uint32_t hours_total;	/* hours in the period */
+	pthread_mutex_t lock;
+	mysql_conn_t *mysql_conn; /* connection of the cluster rollup */
+	time_t next_start;	/* start of the next hour to hand out */
+	time_t now;
+	int rc;
+	int thread_cnt;
+	time_t *working;	/* hour each thread is on, 0 if idle */
+} local_hour_range_t;
+
+typedef struct {
+	local_hour_range_t *range;
+	int thread_inx;
+} local_hour_thread_t;
+
 static void _destroy_local_tres_usage(void *object)
 {
 	local_tres_usage_t *a_usage = (local_tres_usage_t *)object;
@@ -134,14 +162,33 @@ static int _find_loc_tres(void *x, void *key)
 	return 0;
 }
 
-static int _find_id_usage(void *x, void *key)
+static const char *_id_usage_hash_id(void *item)
 {
-	local_id_usage_t *loc = (local_id_usage_t *)x;
-	uint32_t id = *(uint32_t *)key;
+	local_id_usage_t *id_usage = (local_id_usage_t *)item;
 
-	if (loc->id == id)
-		return 1;
-	return 0;
+	return id_usage->id_str;
+}
+
+/* Return the usage record for id, appending a new one to usage_list if
+ * there isn't one yet.  usage_hash indexes usage_list by id, it doesn't own
+ * the records. */
+static local_id_usage_t *_get_id_usage(List usage_list, xhash_t *usage_hash,
+				       uint32_t id)
+{
+	local_id_usage_t *id_usage;
+	char id_str[11];
+
+	snprintf(id_str, sizeof(id_str), "%u", id);
+	if ((id_usage = xhash_get(usage_hash, id_str)))
+		return id_usage;
+
+	id_usage = xmalloc(sizeof(local_id_usage_t));
+	id_usage->id = id;
+	memcpy(id_usage->id_str, id_str, sizeof(id_usage->id_str));
+	list_append(usage_list, id_usage);
+	xhash_add(usage_hash, id_usage);
+
+	return id_usage;
 }
 
 static void _remove_job_tres_time_from_cluster(List c_tres, List j_tres,
@@ -885,17 +932,61 @@ static local_cluster_usage_t *_setup_cluster_usage(mysql_conn_t *mysql_conn,
 	return c_usage;
 }
 
-extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
-				  char *cluster_name,
-				  time_t start, time_t end,
-				  uint16_t archive_data)
+/* Hand out the next hour of the range to thread_inx.
+ * RET false when there is nothing left to do or a thread failed */
+static bool _next_rollup_hour(local_hour_range_t *range, int thread_inx,
+			      time_t *curr_start)
+{
+	bool found = false;
+
+	slurm_mutex_lock(&range->lock);
+	if ((range->rc == SLURM_SUCCESS) && (range->next_start < range->end)) {
+		*curr_start = range->next_start;
+		range->working[thread_inx] = range->next_start;
+		range->next_start += 3600;
+		found = true;
+	}
+	slurm_mutex_unlock(&range->lock);
+
+	return found;
+}
+
+/* The hour thread_inx was working on is committed, move done_end up to the
+ * first hour still being worked on (or one that failed). */
+static void _finish_rollup_hour(local_hour_range_t *range, int thread_inx)
+{
+	time_t done_end;
+	int i;
+
+	slurm_mutex_lock(&range->lock);
+	range->working[thread_inx] = 0;
+	range->hours_done++;
+	done_end = MIN(range->next_start, range->end);
+	for (i = 0; i < range->thread_cnt; i++) {
+		if (range->working[i] && (range->working[i] < done_end))
+			done_end = range->working[i];
+	}
+	if (done_end > range->done_end)
+		range->done_end = done_end;
+	if (!(range->hours_done % 24) ||
+	    (range->hours_done == range->hours_total))
+		debug("%s: %s hourly rollup %u of %u hours done",
+		      __func__, range->cluster_name,
+		      range->hours_done, range->hours_total);
+	slurm_mutex_unlock(&range->lock);
+}
+
+/* Roll up hours handed out by range until there are none left, committing
+ * each one as it is done. */
+static int _hourly_rollup_hours(mysql_conn_t *mysql_conn,
+				local_hour_range_t *range, int thread_inx)
 {
 	int rc = SLURM_SUCCESS;
-	int add_sec = 3600;
 	int i=0;
-	time_t now = time(NULL);
-	time_t curr_start = start;
-	time_t curr_end = curr_start + add_sec;
+	char *cluster_name = range->cluster_name;
+	time_t now = range->now;
+	time_t curr_start = 0;
+	time_t curr_end = 0;
 	char *query = NULL;
 	MYSQL_RES *result = NULL;
 	MYSQL_ROW row;
@@ -907,6 +998,8 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	List cluster_down_list = list_create(_destroy_local_cluster_usage);
 	List wckey_usage_list = list_create(_destroy_local_id_usage);
 	List resv_usage_list = list_create(_destroy_local_resv_usage);
+	xhash_t *assoc_usage_hash = xhash_init(_id_usage_hash_id, NULL, NULL, 0);
+	xhash_t *wckey_usage_hash = xhash_init(_id_usage_hash_id, NULL, NULL, 0);
 	uint16_t track_wckey = slurm_get_track_wckey();
 	local_cluster_usage_t *loc_c_usage = NULL;
 	local_cluster_usage_t *c_usage = NULL;
@@ -1002,10 +1095,12 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	c_itr = list_iterator_create(cluster_down_list);
 	w_itr = list_iterator_create(wckey_usage_list);
 	r_itr = list_iterator_create(resv_usage_list);
-	while (curr_start < end) {
+	while (_next_rollup_hour(range, thread_inx, &curr_start)) {
 		int last_id = -1;
 		int last_wckeyid = -1;
 
+		curr_end = curr_start + 3600;
+
 		if (debug_flags & DEBUG_FLAG_DB_USAGE)
 			DB_DEBUG(mysql_conn->conn,
 				 "%s curr hour is now %ld-%ld",
@@ -1234,9 +1329,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			}
 
 			if (last_id != assoc_id) {
-				a_usage = xmalloc(sizeof(local_id_usage_t));
-				a_usage->id = assoc_id;
-				list_append(assoc_usage_list, a_usage);
+				a_usage = _get_id_usage(assoc_usage_list,
+							assoc_usage_hash,
+							assoc_id);
 				last_id = assoc_id;
 				/* a_usage->loc_tres is made later,
 				   don't do it here.
@@ -1249,20 +1344,12 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 
 			/* do the wckey calculation */
 			if (last_wckeyid != wckey_id) {
-				list_iterator_reset(w_itr);
-				while ((w_usage = list_next(w_itr)))
-					if (w_usage->id == wckey_id)
-						break;
-
-				if (!w_usage) {
-					w_usage = xmalloc(
-						sizeof(local_id_usage_t));
-					w_usage->id = wckey_id;
-					list_append(wckey_usage_list,
-						    w_usage);
+				w_usage = _get_id_usage(wckey_usage_list,
+							wckey_usage_hash,
+							wckey_id);
+				if (!w_usage->loc_tres)
 					w_usage->loc_tres = list_create(
 						_destroy_local_tres_usage);
-				}
 				last_wckeyid = wckey_id;
 			}
 
@@ -1483,20 +1570,16 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 					r_usage->local_assocs);
 				while ((assoc = list_next(tmp_itr))) {
 					uint32_t associd = slurm_atoul(assoc);
-					if ((last_id != associd) &&
-					    !(a_usage = list_find_first(
-						      assoc_usage_list,
-						      _find_id_usage,
-						      &associd))) {
-						a_usage = xmalloc(
-							sizeof(local_id_usage_t));
-						a_usage->id = associd;
-						list_append(assoc_usage_list,
-							    a_usage);
+					if (last_id != associd) {
+						a_usage = _get_id_usage(
+							assoc_usage_list,
+							assoc_usage_hash,
+							associd);
 						last_id = associd;
+					}
+					if (!a_usage->loc_tres)
 						a_usage->loc_tres = list_create(
 							_destroy_local_tres_usage);
-					}
 
 					_add_time_tres(a_usage->loc_tres,
 						       TIME_ALLOC, loc_tres->id,
@@ -1576,12 +1659,25 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		a_usage     = NULL;
 		w_usage     = NULL;
 
+		xhash_clear(assoc_usage_hash);
+		xhash_clear(wckey_usage_hash);
 		list_flush(assoc_usage_list);
 		list_flush(cluster_down_list);
 		list_flush(wckey_usage_list);
 		list_flush(resv_usage_list);
-		curr_start = curr_end;
-		curr_end = curr_start + add_sec;
+
+		/* Commit every hour by itself so a rollup failing part way
+		 * through doesn't throw away the hours already done. */
+		if (mysql_db_commit(mysql_conn)) {
+			char start[25], end[25];
+			error("Couldn't commit cluster (%s) "
+			      "hour rollup for %s - %s",
+			      cluster_name, slurm_ctime2_r(&curr_start, start),
+			      slurm_ctime2_r(&curr_end, end));
+			rc = SLURM_ERROR;
+			goto end_it;
+		}
+		_finish_rollup_hour(range, thread_inx);
 	}
 end_it:
 	xfree(query);
@@ -1605,27 +1701,127 @@ end_it:
 	FREE_NULL_LIST(cluster_down_list);
 	FREE_NULL_LIST(wckey_usage_list);
 	FREE_NULL_LIST(resv_usage_list);
+	xhash_free(assoc_usage_hash);
+	xhash_free(wckey_usage_hash);
 
 /* 	info("stop start %s", slurm_ctime2(&curr_start)); */
 /* 	info("stop end %s", slurm_ctime2(&curr_end)); */
 
-	/* go check to see if we archive and purge */
+	if (rc != SLURM_SUCCESS) {
+		if (mysql_db_rollback(mysql_conn))
+			error("rollback failed");
+		slurm_mutex_lock(&range->lock);
+		if (range->rc == SLURM_SUCCESS)
+			range->rc = rc;
+		slurm_mutex_unlock(&range->lock);
+	}
 
-	if (rc == SLURM_SUCCESS) {
-		if (mysql_db_commit(mysql_conn)) {
-			char start[25], end[25];
-			error("Couldn't commit cluster (%s) "
-			      "hour rollup for %s - %s",
-			      cluster_name, slurm_ctime2_r(&curr_start, start),
-			      slurm_ctime2_r(&curr_end, end));
-			rc = SLURM_ERROR;
-		} else
-			rc = _process_purge(mysql_conn, cluster_name,
-					    archive_data, SLURMDB_PURGE_HOURS);
+	return rc;
+}
+
+static void *_hourly_rollup_thread(void *arg)
+{
+	local_hour_thread_t *hour_thread = (local_hour_thread_t *)arg;
+	local_hour_range_t *range = hour_thread->range;
+	mysql_conn_t mysql_conn;
+
+	memset(&mysql_conn, 0, sizeof(mysql_conn_t));
+	mysql_conn.rollback = 1;
+	mysql_conn.conn = range->mysql_conn->conn;
+	slurm_mutex_init(&mysql_conn.lock);
+
+	/* Each thread needs it's own connection we can't use the one
+	 * sent from the parent thread. */
+	if (check_connection(&mysql_conn) == SLURM_SUCCESS) {
+		_hourly_rollup_hours(&mysql_conn, range,
+				     hour_thread->thread_inx);
+	} else {
+		slurm_mutex_lock(&range->lock);
+		range->rc = ESLURM_DB_CONNECTION;
+		slurm_mutex_unlock(&range->lock);
+	}
+
+	mysql_db_close_db_connection(&mysql_conn);
+	slurm_mutex_destroy(&mysql_conn.lock);
+	xfree(hour_thread);
+
+	return NULL;
+}
+
+extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
+				  char *cluster_name,
+				  time_t start, time_t end,
+				  uint16_t archive_data,
+				  time_t *done_end)
+{
+	local_hour_range_t range;
+	pthread_t *thread_ids;
+	pthread_attr_t attr;
+	int i, rc = SLURM_SUCCESS;
+
+	memset(&range, 0, sizeof(local_hour_range_t));
+	range.cluster_name = cluster_name;
+	range.done_end = start;
+	range.end = end;
+	range.hours_total = (end - start + 3599) / 3600;
+	slurm_mutex_init(&range.lock);
+	range.mysql_conn = mysql_conn;
+	range.next_start = start;
+	range.now = time(NULL);
+	range.rc = SLURM_SUCCESS;
+	range.thread_cnt = MIN(range.hours_total, MAX_HOURLY_ROLLUP_THREADS);
+	if (range.thread_cnt < 1)
+		range.thread_cnt = 1;
+	range.working = xmalloc(sizeof(time_t) * range.thread_cnt);
+
+	/* The hours are committed as they are rolled up, so commit what
+	 * was done on this connection before (like the first last_ran
+	 * record of a cluster) so the other connections don't wait on it. */
+	if (mysql_db_commit(mysql_conn)) {
+		error("Couldn't commit before cluster (%s) hour rollup",
+		      cluster_name);
+		rc = SLURM_ERROR;
+		goto end_it;
+	}
+
+	if (range.thread_cnt == 1) {
+		_hourly_rollup_hours(mysql_conn, &range, 0);
+	} else {
+		debug2("%s: rolling up %u hours of cluster %s with %d threads",
+		       __func__, range.hours_total, cluster_name,
+		       range.thread_cnt);
+		thread_ids = xmalloc(sizeof(pthread_t) * range.thread_cnt);
+		for (i = 0; i < range.thread_cnt; i++) {
+			local_hour_thread_t *hour_thread =
+				xmalloc(sizeof(local_hour_thread_t));
+			hour_thread->range = &range;
+			hour_thread->thread_inx = i;
+			slurm_attr_init(&attr);
+			if (pthread_create(&thread_ids[i], &attr,
+					   _hourly_rollup_thread,
+					   (void *)hour_thread))
+				fatal("pthread_create: %m");
+			slurm_attr_destroy(&attr);
+		}
+		for (i = 0; i < range.thread_cnt; i++)
+			pthread_join(thread_ids[i], NULL);
+		xfree(thread_ids);
 	}
+	rc = range.rc;
+
+	/* go check to see if we archive and purge */
+	if (rc == SLURM_SUCCESS)
+		rc = _process_purge(mysql_conn, cluster_name,
+				    archive_data, SLURMDB_PURGE_HOURS);
+end_it:
+	if (done_end)
+		*done_end = range.done_end;
+	slurm_mutex_destroy(&range.lock);
+	xfree(range.working);
 
 	return rc;
 }
+
 extern int as_mysql_nonhour_rollup(mysql_conn_t *mysql_conn,
 				   bool run_month,
 				   char *cluster_name,
@@ -44,11 +44,19 @@
 
 #include "accounting_storage_mysql.h"
 
+/*
+ * Roll up the hours between start and end, several hours at a time each on
+ * its own database connection.  Every hour is committed as soon as it is
+ * done.
+ * OUT done_end - every hour before this was rolled up and committed, even if
+ *                the rollup failed
+ */
 extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 				  char *cluster_name,
 				  time_t start,
 				  time_t end,
-				  uint16_t archive_data);
+				  uint16_t archive_data,
+				  time_t *done_end);
 extern int as_mysql_nonhour_rollup(mysql_conn_t *mysql_conn,
 				   bool run_month,
 				   char *cluster_name,
@@ -42,6 +42,7 @@
 #include "as_mysql_rollup.h"
 #include "src/common/macros.h"
 #include "src/common/slurm_time.h"
+#include "src/common/xhash.h"
 
 time_t global_last_rollup = 0;
 pthread_mutex_t rollup_lock = PTHREAD_MUTEX_INITIALIZER;
@@ -60,6 +61,35 @@ typedef struct {
 	time_t sent_start;
 } local_rollup_t;
 
+/* Number of report windows whose usage is kept by get_usage_for_list() */
+#define USAGE_CACHE_SIZE 32
+
+/* The usage of a set of associations or wckeys over a report window.
+ * Usage tables only change when rolled up or archived and the association
+ * hierarchy when associations are committed, see
+ * as_mysql_usage_cache_flush(). */
+typedef struct {
+	char *cluster_name;
+	time_t end;
+	char *id_str;		/* where clause selecting the objects */
+	uint32_t last_used;	/* usage_cache_seq when last used */
+	time_t start;
+	slurmdbd_msg_type_t type;
+	List usage_list;	/* list of slurmdb_accounting_rec_t's */
+	char *usage_table;
+} usage_cache_t;
+
+/* Index of the objects of get_usage_for_list() by id */
+typedef struct {
+	List acct_list;
+	char id_str[11];
+} usage_obj_idx_t;
+
+static List usage_cache_list = NULL;
+static pthread_mutex_t usage_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t usage_cache_seq = 0;
+static uint32_t usage_cache_gen = 0;	/* incremented on each flush */
+
 static void *_cluster_rollup_usage(void *arg)
 {
 	local_rollup_t *local_rollup = (local_rollup_t *)arg;
@@ -81,6 +111,7 @@ static void *_cluster_rollup_usage(void *arg)
 	time_t day_end;
 	time_t month_start;
 	time_t month_end;
+	time_t hour_done_end = 0;
 	long rollup_time[ROLLUP_COUNT];
 	DEF_TIMERS;
 
@@ -296,13 +327,34 @@ static void *_cluster_rollup_usage(void *arg)
 					    local_rollup->cluster_name,
 					    hour_start,
 					    hour_end,
-					    local_rollup->archive_data);
+					    local_rollup->archive_data,
+					    &hour_done_end);
 		snprintf(timer_str, sizeof(timer_str),
 			 "hourly_rollup for %s", local_rollup->cluster_name);
 		END_TIMER3(timer_str, 5000000);
 		rollup_time[ROLLUP_HOUR] += DELTA_TIMER;
-		if (rc != SLURM_SUCCESS)
+		if (rc != SLURM_SUCCESS) {
+			/* The hours before hour_done_end are committed,
+			 * remember that so they aren't done again. */
+			if ((hour_done_end > hour_start) &&
+			    !local_rollup->sent_end) {
+				query = xstrdup_printf(
+					"update \"%s_%s\" set hourly_rollup=%ld",
+					local_rollup->cluster_name,
+					last_ran_table, hour_done_end);
+				if (debug_flags & DEBUG_FLAG_DB_USAGE)
+					DB_DEBUG(mysql_conn.conn,
+						 "query\n%s", query);
+				if ((mysql_db_query(&mysql_conn, query) ==
+				     SLURM_SUCCESS) &&
+				    mysql_db_commit(&mysql_conn))
+					error("Couldn't commit hourly rollup "
+					      "progress of cluster %s",
+					      local_rollup->cluster_name);
+				xfree(query);
+			}
 			goto end_it;
+		}
 	}
 
 	if ((day_end - day_start) > 0) {
@@ -399,6 +451,13 @@ end_it:
 			local_rollup->rollup_stats->rollup_time[i] +=
 				rollup_time[i];
 		}
+		if (hour_done_end && (hour_done_end > hour_start)) {
+			local_rollup->rollup_stats->rollup_hours +=
+				(hour_done_end - hour_start) / 3600;
+			local_rollup->rollup_stats->rollup_last_hour =
+				MAX(local_rollup->rollup_stats->
+				    rollup_last_hour, hour_done_end);
+		}
 	}
 	if ((rc != SLURM_SUCCESS) && ((*local_rollup->rc) == SLURM_SUCCESS))
 		(*local_rollup->rc) = rc;
@@ -410,10 +469,17 @@ end_it:
 }
 
 /* assoc_mgr locks need to be unlocked before coming here */
+/*
+ * Get the usage of the objects selected by id_str
+ * IN sum - if set return one record per object and TRES, the sum of its
+ *	usage over the period, instead of one record per object, TRES and
+ *	usage table period
+ */
 static int _get_object_usage(mysql_conn_t *mysql_conn,
 			     slurmdbd_msg_type_t type, char *my_usage_table,
 			     char *cluster_name, char *id_str,
-			     time_t start, time_t end, List *usage_list)
+			     time_t start, time_t end, bool sum,
+			     List *usage_list)
 {
 	char *tmp = NULL;
 	int i = 0;
@@ -439,6 +505,10 @@ static int _get_object_usage(mysql_conn_t *mysql_conn,
 
 	if (type == DBD_GET_WCKEY_USAGE)
 		usage_req_inx[0] = "t1.id";
+	if (sum) {
+		usage_req_inx[USAGE_START] = "min(t1.time_start)";
+		usage_req_inx[USAGE_ALLOC] = "sum(t1.alloc_secs)";
+	}
 
 	xstrfmtcat(tmp, "%s", usage_req_inx[i]);
 	for (i=1; i<USAGE_COUNT; i++) {
@@ -452,18 +522,22 @@ static int _get_object_usage(mysql_conn_t *mysql_conn,
 			"\"%s_%s\" as t2, \"%s_%s\" as t3 "
 			"where (t1.time_start < %ld && t1.time_start >= %ld) "
 			"&& t1.id=t2.id_assoc && (%s) && "
-			"t2.lft between t3.lft and t3.rgt "
-			"order by t3.id_assoc, time_start;",
+			"t2.lft between t3.lft and t3.rgt %s;",
 			tmp, cluster_name, my_usage_table,
 			cluster_name, assoc_table, cluster_name, assoc_table,
-			end, start, id_str);
+			end, start, id_str,
+			sum ? "group by t3.id_assoc, t1.id_tres "
+			"order by t3.id_assoc" :
+			"order by t3.id_assoc, time_start");
 		break;
 	case DBD_GET_WCKEY_USAGE:
 		query = xstrdup_printf(
 			"select %s from \"%s_%s\" as t1 "
 			"where (time_start < %ld && time_start >= %ld) "
-			"&& (%s) order by id, time_start;",
-			tmp, cluster_name, my_usage_table, end, start, id_str);
+			"&& (%s) %s;",
+			tmp, cluster_name, my_usage_table, end, start, id_str,
+			sum ? "group by t1.id, t1.id_tres order by t1.id" :
+			"order by id, time_start");
 		break;
 	default:
 		error("Unknown usage type %d", type);
@@ -622,6 +696,152 @@ static int _get_cluster_usage(mysql_conn_t *mysql_conn, uid_t uid,
 }
 
 
+static void _destroy_usage_cache(void *object)
+{
+	usage_cache_t *usage_cache = (usage_cache_t *)object;
+
+	if (usage_cache) {
+		xfree(usage_cache->cluster_name);
+		xfree(usage_cache->id_str);
+		FREE_NULL_LIST(usage_cache->usage_list);
+		xfree(usage_cache->usage_table);
+		xfree(usage_cache);
+	}
+}
+
+static const char *_usage_obj_idx_id(void *item)
+{
+	usage_obj_idx_t *obj_idx = (usage_obj_idx_t *)item;
+
+	return obj_idx->id_str;
+}
+
+static void _usage_obj_idx_free(void *item)
+{
+	xfree(item);
+}
+
+static int _find_usage_cache_seq(void *x, void *key)
+{
+	usage_cache_t *usage_cache = (usage_cache_t *)x;
+	uint32_t seq = *(uint32_t *)key;
+
+	if (usage_cache->last_used == seq)
+		return 1;
+	return 0;
+}
+
+static List _copy_usage_list(List usage_list)
+{
+	List ret_list = list_create(slurmdb_destroy_accounting_rec);
+	slurmdb_accounting_rec_t *accounting_rec, *copy_rec;
+	ListIterator itr;
+
+	itr = list_iterator_create(usage_list);
+	while ((accounting_rec = list_next(itr))) {
+		copy_rec = xmalloc(sizeof(slurmdb_accounting_rec_t));
+		memcpy(copy_rec, accounting_rec,
+		       sizeof(slurmdb_accounting_rec_t));
+		copy_rec->tres_rec.name = xstrdup(accounting_rec->tres_rec.name);
+		copy_rec->tres_rec.type = xstrdup(accounting_rec->tres_rec.type);
+		list_append(ret_list, copy_rec);
+	}
+	list_iterator_destroy(itr);
+
+	return ret_list;
+}
+
+/* Return a copy of the cached usage of a report window or NULL if it isn't
+ * cached
+ * OUT gen - cache generation to pass to _usage_cache_add() */
+static List _usage_cache_get(slurmdbd_msg_type_t type, char *cluster_name,
+			     char *usage_table, char *id_str,
+			     time_t start, time_t end, uint32_t *gen)
+{
+	usage_cache_t *usage_cache;
+	List usage_list = NULL;
+	ListIterator itr;
+
+	slurm_mutex_lock(&usage_cache_lock);
+	*gen = usage_cache_gen;
+	if (!usage_cache_list) {
+		slurm_mutex_unlock(&usage_cache_lock);
+		return NULL;
+	}
+	itr = list_iterator_create(usage_cache_list);
+	while ((usage_cache = list_next(itr))) {
+		if ((usage_cache->type == type) &&
+		    (usage_cache->start == start) &&
+		    (usage_cache->end == end) &&
+		    !xstrcmp(usage_cache->usage_table, usage_table) &&
+		    !xstrcmp(usage_cache->cluster_name, cluster_name) &&
+		    !xstrcmp(usage_cache->id_str, id_str)) {
+			usage_cache->last_used = ++usage_cache_seq;
+			usage_list = _copy_usage_list(usage_cache->usage_list);
+			break;
+		}
+	}
+	list_iterator_destroy(itr);
+	slurm_mutex_unlock(&usage_cache_lock);
+
+	return usage_list;
+}
+
+/* Cache a copy of the usage of a report window, replacing the least
+ * recently used one if the cache is full.  Nothing is cached if the cache
+ * was flushed since gen was returned by _usage_cache_get(), the usage may
+ * have been read before the change that caused the flush was committed.
+ */
+static void _usage_cache_add(slurmdbd_msg_type_t type, char *cluster_name,
+			     char *usage_table, char *id_str,
+			     time_t start, time_t end, uint32_t gen,
+			     List usage_list)
+{
+	usage_cache_t *usage_cache, *tmp_cache;
+	uint32_t lru_seq = 0;
+	ListIterator itr;
+
+	usage_cache = xmalloc(sizeof(usage_cache_t));
+	usage_cache->cluster_name = xstrdup(cluster_name);
+	usage_cache->end = end;
+	usage_cache->id_str = xstrdup(id_str);
+	usage_cache->start = start;
+	usage_cache->type = type;
+	usage_cache->usage_list = _copy_usage_list(usage_list);
+	usage_cache->usage_table = xstrdup(usage_table);
+
+	slurm_mutex_lock(&usage_cache_lock);
+	if (gen != usage_cache_gen) {
+		slurm_mutex_unlock(&usage_cache_lock);
+		_destroy_usage_cache(usage_cache);
+		return;
+	}
+	if (!usage_cache_list)
+		usage_cache_list = list_create(_destroy_usage_cache);
+	if (list_count(usage_cache_list) >= USAGE_CACHE_SIZE) {
+		itr = list_iterator_create(usage_cache_list);
+		while ((tmp_cache = list_next(itr))) {
+			if (!lru_seq || (tmp_cache->last_used < lru_seq))
+				lru_seq = tmp_cache->last_used;
+		}
+		list_iterator_destroy(itr);
+		list_delete_all(usage_cache_list, _find_usage_cache_seq,
+				&lru_seq);
+	}
+	usage_cache->last_used = ++usage_cache_seq;
+	list_append(usage_cache_list, usage_cache);
+	slurm_mutex_unlock(&usage_cache_lock);
+}
+
+/* Forget the usage kept by get_usage_for_list(), to be called when usage
+ * tables or the association hierarchy change */
+extern void as_mysql_usage_cache_flush(void)
+{
+	slurm_mutex_lock(&usage_cache_lock);
+	FREE_NULL_LIST(usage_cache_list);
+	usage_cache_gen++;
+	slurm_mutex_unlock(&usage_cache_lock);
+}
 
 /* checks should already be done before this to see if this is a valid
    user or not.  The assoc_mgr locks should be unlocked before coming here.
@@ -641,6 +861,10 @@ extern int get_usage_for_list(mysql_conn_t *mysql_conn,
 	slurmdb_accounting_rec_t *accounting_rec = NULL;
 	hostlist_t hl = NULL;
 	char id[100];
+	List acct_list = NULL;
+	xhash_t *obj_hash = NULL;
+	usage_obj_idx_t *obj_idx = NULL;
+	uint32_t cache_gen = 0;
 
 	if (!object_list) {
 		error("We need an object to set data for getting usage");
@@ -715,11 +939,19 @@ extern int get_usage_for_list(mysql_conn_t *mysql_conn,
 		return SLURM_ERROR;
 	}
 
-	if (_get_object_usage(mysql_conn, type, my_usage_table, cluster_name,
-			      id_str, start, end, &usage_list)
-	    != SLURM_SUCCESS) {
-		xfree(id_str);
-		return SLURM_ERROR;
+	/* Reports ask for the same windows over and over, sum the usage over
+	 * the window in the database and keep it until the usage tables
+	 * change. */
+	if (!(usage_list = _usage_cache_get(type, cluster_name, my_usage_table,
+					    id_str, start, end, &cache_gen))) {
+		if (_get_object_usage(mysql_conn, type, my_usage_table,
+				      cluster_name, id_str, start, end, true,
+				      &usage_list) != SLURM_SUCCESS) {
+			xfree(id_str);
+			return SLURM_ERROR;
+		}
+		_usage_cache_add(type, cluster_name, my_usage_table, id_str,
+				 start, end, cache_gen, usage_list);
 	}
 
 	xfree(id_str);
@@ -729,13 +961,11 @@ extern int get_usage_for_list(mysql_conn_t *mysql_conn,
 		return SLURM_ERROR;
 	}
 
-	u_itr = list_iterator_create(usage_list);
+	/* Index the objects by id so each usage record is placed with one
+	 * lookup */
+	obj_hash = xhash_init(_usage_obj_idx_id, _usage_obj_idx_free, NULL, 0);
 	itr = list_iterator_create(object_list);
 	while ((object = list_next(itr))) {
-		int found = 0;
-		int id = 0;
-		List acct_list = NULL;
-
 		switch (type) {
 		case DBD_GET_ASSOC_USAGE:
 			assoc = (slurmdb_assoc_rec_t *)object;
@@ -743,7 +973,7 @@ extern int get_usage_for_list(mysql_conn_t *mysql_conn,
 				assoc->accounting_list = list_create(
 					slurmdb_destroy_accounting_rec);
 			acct_list = assoc->accounting_list;
-			id = assoc->id;
+			snprintf(id, sizeof(id), "%u", assoc->id);
 			break;
 		case DBD_GET_WCKEY_USAGE:
 			wckey = (slurmdb_wckey_rec_t *)object;
@@ -751,36 +981,31 @@ extern int get_usage_for_list(mysql_conn_t *mysql_conn,
 				wckey->accounting_list = list_create(
 					slurmdb_destroy_accounting_rec);
 			acct_list = wckey->accounting_list;
-			id = wckey->id;
+			snprintf(id, sizeof(id), "%u", wckey->id);
 			break;
 		default:
 			continue;
 			break;
 		}
 
-		while ((accounting_rec = list_next(u_itr))) {
-			if (id == accounting_rec->id) {
-				list_append(acct_list, accounting_rec);
-				list_remove(u_itr);
-				found = 1;
-			} else if (found) {
-				/* here we know the
-				   list is in id order so
-				   if the next record
-				   isn't the correct id
-				   just continue since
-				   there is no reason to
-				   go through the rest of
-				   the list when we know
-				   it isn't going to be
-				   the correct id */
-				break;
-			}
-		}
-		list_iterator_reset(u_itr);
+		if (xhash_get(obj_hash, id))
+			continue;
+		obj_idx = xmalloc(sizeof(usage_obj_idx_t));
+		obj_idx->acct_list = acct_list;
+		snprintf(obj_idx->id_str, sizeof(obj_idx->id_str), "%s", id);
+		xhash_add(obj_hash, obj_idx);
 	}
 	list_iterator_destroy(itr);
+
+	u_itr = list_iterator_create(usage_list);
+	while ((accounting_rec = list_next(u_itr))) {
+		snprintf(id, sizeof(id), "%u", accounting_rec->id);
+		if (!(obj_idx = xhash_get(obj_hash, id)))
+			continue;
+		list_append(obj_idx->acct_list, list_remove(u_itr));
+	}
 	list_iterator_destroy(u_itr);
+	xhash_free_ptr(&obj_hash);
 
 	if (list_count(usage_list))
 		error("we have %d records not added "
@@ -908,7 +1133,7 @@ is_user:
 	}
 
 	_get_object_usage(mysql_conn, type, my_usage_table, cluster_name,
-			  id_str, start, end, my_list);
+			  id_str, start, end, false, my_list);
 	xfree(id_str);
 
 	return rc;
@@ -936,7 +1161,7 @@ extern int as_mysql_roll_usage(mysql_conn_t *mysql_conn, time_t sent_start,
 	slurm_cond_init(&rolledup_cond, NULL);
 
 	//START_TIMER;
-	slurm_mutex_lock(&as_mysql_cluster_list_lock);
+	slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
 	itr = list_iterator_create(as_mysql_cluster_list);
 	while ((cluster_name = list_next(itr))) {
 		pthread_t rollup_tid;
@@ -984,7 +1209,7 @@ extern int as_mysql_roll_usage(mysql_conn_t *mysql_conn, time_t sent_start,
 	}
 	slurm_mutex_lock(&rolledup_lock);
 	list_iterator_destroy(itr);
-	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+	slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 
 	while (rolledup < roll_started) {
 		slurm_cond_wait(&rolledup_cond, &rolledup_lock);
@@ -997,6 +1222,7 @@ extern int as_mysql_roll_usage(mysql_conn_t *mysql_conn, time_t sent_start,
 	/* END_TIMER; */
 	/* info("total time was %s", TIME_STR); */
 
+	as_mysql_usage_cache_flush();
 	slurm_mutex_unlock(&usage_rollup_lock);
 
 	return rc;
@@ -2890,6 +2890,14 @@ extern List jobacct_storage_p_get_jobs_cond(void *db_conn, uid_t uid,
 		slurmdbd_free_list_msg(got_msg);
 	}
 
+	/* A SlurmDBD older than 17.11 ignores the page size and sends every
+	 * job at once, so there is no next page to ask for */
+	if (job_cond && job_cond->page_size &&
+	    (slurmdbd_conn_version() < SLURM_17_11_PROTOCOL_VERSION)) {
+		debug("slurmdbd: job paging not supported by SlurmDBD");
+		job_cond->page_size = 0;
+	}
+
 	return my_job_list;
 }
 
@@ -64,12 +64,16 @@
 #include "src/slurmd/common/proctrack.h"
 #include "hdf5_api.h"
 
-#define HDF5_CHUNK_SIZE 10
+/* Number of samples per chunk of the tables, also the number of samples
+ * buffered in memory before being appended to a table */
+#define HDF5_CHUNK_SIZE 64
 /* Compression level, a value of 0 through 9. Level 0 is faster but offers the
  * least compression; level 9 is slower but offers maximum compression.
  * A setting of -1 indicates that no compression is desired. */
-/* TODO: Make this configurable with a parameter */
-#define HDF5_COMPRESS 0
+#define HDF5_COMPRESS 1
+/* Seconds after which buffered samples are appended even if the chunk is not
+ * full, so the file does not lag too far behind the running step */
+#define HDF5_FLUSH_INTERVAL 300
 
 /*
  * These variables are required by the generic plugin interface.  If they
@@ -101,11 +105,16 @@ const char plugin_type[] = "acct_gather_profile/hdf5";
 const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 
 typedef struct {
+	uint32_t chunk_size;
+	int compress;
 	char *dir;
 	uint32_t def;
 } slurm_hdf5_conf_t;
 
 typedef struct {
+	uint8_t *buf;		/* samples not yet appended to the table */
+	size_t  buf_cnt;
+	time_t  buf_time;	/* time of the first buffered sample */
 	hid_t  table_id;
 	size_t type_size;
 } table_t;
@@ -135,10 +144,30 @@ static size_t   tables_cur_len = 0;
 
 static void _reset_slurm_profile_conf(void)
 {
+	hdf5_conf.chunk_size = HDF5_CHUNK_SIZE;
+	hdf5_conf.compress = HDF5_COMPRESS;
 	xfree(hdf5_conf.dir);
 	hdf5_conf.def = ACCT_GATHER_PROFILE_NONE;
 }
 
+/* Append the samples buffered for a table to it */
+static int _flush_table(table_t *ds)
+{
+	int rc = SLURM_SUCCESS;
+
+	if (!ds->buf_cnt)
+		return rc;
+
+	if (H5PTappend(ds->table_id, ds->buf_cnt, ds->buf) < 0) {
+		error("PROFILE: Impossible to add data to the table %"PRId64,
+		      (int64_t) ds->table_id);
+		rc = SLURM_ERROR;
+	}
+	ds->buf_cnt = 0;
+
+	return rc;
+}
+
 static uint32_t _determine_profile(void)
 {
 	uint32_t profile;
@@ -241,6 +270,8 @@ extern void acct_gather_profile_p_conf_options(s_p_options_t **full_options,
 					       int *full_options_cnt)
 {
 	s_p_options_t options[] = {
+		{"ProfileHDF5ChunkSize", S_P_UINT32},
+		{"ProfileHDF5Compress", S_P_STRING},
 		{"ProfileHDF5Dir", S_P_STRING},
 		{"ProfileHDF5Default", S_P_STRING},
 		{NULL} };
@@ -265,6 +296,25 @@ extern void acct_gather_profile_p_conf_set(s_p_hashtbl_t *tbl)
 			}
 			xfree(tmp);
 		}
+
+		s_p_get_uint32(&hdf5_conf.chunk_size, "ProfileHDF5ChunkSize",
+			       tbl);
+		if (!hdf5_conf.chunk_size)
+			fatal("ProfileHDF5ChunkSize must be greater than 0");
+
+		if (s_p_get_string(&tmp, "ProfileHDF5Compress", tbl)) {
+			if (!xstrcasecmp(tmp, "none"))
+				hdf5_conf.compress = -1;
+			else
+				hdf5_conf.compress = strtol(tmp, NULL, 10);
+			if ((hdf5_conf.compress < -1) ||
+			    (hdf5_conf.compress > 9)) {
+				fatal("ProfileHDF5Compress can not be set to "
+				      "%s, please specify none or a value "
+				      "from 0 to 9", tmp);
+			}
+			xfree(tmp);
+		}
 	}
 
 	if (!hdf5_conf.dir)
@@ -416,8 +466,11 @@ extern int acct_gather_profile_p_node_step_end(void)
 
 	/* close tables */
 	for (i = 0; i < tables_cur_len; ++i) {
+		_flush_table(&tables[i]);
 		H5PTclose(tables[i].table_id);
+		xfree(tables[i].buf);
 	}
+	tables_cur_len = 0;
 	/* close groups */
 	for (i = 0; i < groups_len; ++i) {
 		H5Gclose(groups[i]);
@@ -487,6 +540,7 @@ extern int acct_gather_profile_p_create_dataset(
 	hid_t dtype_id;
 	hid_t field_id;
 	hid_t table_id;
+	int compress = hdf5_conf.compress;
 	acct_gather_profile_dataset_t *dataset_loc = dataset;
 
 	if (g_profile_running <= ACCT_GATHER_PROFILE_NONE)
@@ -551,8 +605,13 @@ extern int acct_gather_profile_p_create_dataset(
 	/* create the table */
 	if (parent < 0)
 		parent = gid_node; /* default parent is the node group */
-	table_id = H5PTcreate_fl(parent, name, dtype_id, HDF5_CHUNK_SIZE,
-	                         HDF5_COMPRESS);
+	if ((compress >= 0) && (H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0)) {
+		debug("PROFILE: deflate filter not available, not compressing "
+		      "table %s", name);
+		compress = -1;
+	}
+	table_id = H5PTcreate_fl(parent, name, dtype_id,
+				 hdf5_conf.chunk_size, compress);
 	if (table_id < 0) {
 		error("PROFILE: Impossible to create the table %s", name);
 		H5Tclose(dtype_id);
@@ -569,8 +628,11 @@ extern int acct_gather_profile_p_create_dataset(
 	}
 
 	/* reserve a new table */
+	memset(&tables[tables_cur_len], 0, sizeof(table_t));
 	tables[tables_cur_len].table_id  = table_id;
 	tables[tables_cur_len].type_size = type_size;
+	tables[tables_cur_len].buf = xmalloc(type_size *
+					     hdf5_conf.chunk_size);
 	++tables_cur_len;
 
 	return tables_cur_len - 1;
@@ -579,8 +641,8 @@ extern int acct_gather_profile_p_create_dataset(
 extern int acct_gather_profile_p_add_sample_data(int table_id, void *data,
 						 time_t sample_time)
 {
-	table_t *ds = &tables[table_id];
-	uint8_t send_data[ds->type_size];
+	table_t *ds;
+	uint8_t *send_data;
 	int header_size = 0;
 	debug("acct_gather_profile_p_add_sample_data %d", table_id);
 
@@ -603,6 +665,12 @@ extern int acct_gather_profile_p_add_sample_data(int table_id, void *data,
 	if (g_profile_running <= ACCT_GATHER_PROFILE_NONE)
 		return SLURM_ERROR;
 
+	/* add the record to the samples buffered for the table */
+	ds = &tables[table_id];
+	send_data = ds->buf + (ds->buf_cnt * ds->type_size);
+	if (!ds->buf_cnt)
+		ds->buf_time = sample_time;
+
 	/* prepend timestampe and relative time */
 	((uint64_t *)send_data)[0] = difftime(sample_time, step_start_time);
 	header_size += sizeof(uint64_t);
@@ -611,12 +679,10 @@ extern int acct_gather_profile_p_add_sample_data(int table_id, void *data,
 
 	memcpy(send_data + header_size, data, ds->type_size - header_size);
 
-	/* append the record to the table */
-	if (H5PTappend(ds->table_id, 1, send_data) < 0) {
-		error("PROFILE: Impossible to add data to the table %d; "
-		      "maybe the table has not been created?", table_id);
-		return SLURM_ERROR;
-	}
+	/* append the buffered records to the table once a chunk is full */
+	if ((++ds->buf_cnt >= hdf5_conf.chunk_size) ||
+	    (difftime(sample_time, ds->buf_time) >= HDF5_FLUSH_INTERVAL))
+		return _flush_table(ds);
 
 	return SLURM_SUCCESS;
 }
@@ -627,6 +693,19 @@ extern void acct_gather_profile_p_conf_values(List *data)
 
 	xassert(*data);
 
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("ProfileHDF5ChunkSize");
+	key_pair->value = xstrdup_printf("%u", hdf5_conf.chunk_size);
+	list_append(*data, key_pair);
+
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("ProfileHDF5Compress");
+	if (hdf5_conf.compress < 0)
+		key_pair->value = xstrdup("none");
+	else
+		key_pair->value = xstrdup_printf("%d", hdf5_conf.compress);
+	list_append(*data, key_pair);
+
 	key_pair = xmalloc(sizeof(config_key_pair_t));
 	key_pair->name = xstrdup("ProfileHDF5Dir");
 	key_pair->value = xstrdup(hdf5_conf.dir);
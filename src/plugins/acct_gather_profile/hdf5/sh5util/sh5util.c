@@ -50,14 +50,18 @@
 #endif
 
 #include <dirent.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <unistd.h>
 
+#include "src/common/macros.h"
 #include "src/common/uid.h"
 #include "src/common/read_config.h"
 #include "src/common/proc_args.h"
@@ -67,6 +71,10 @@
 #include "sh5util.h"
 
 #define MAX_PROFILE_PATH 1024
+/* Node-step files larger than this are not read ahead in memory when
+ * merging, they are read by the HDF5 library from disk */
+#define MERGE_IMAGE_MAX_SIZE (256 * 1024 * 1024)
+#define MERGE_THREADS 4
 // #define MAX_ATTR_NAME 64
 #define MAX_GROUP_NAME 64
 // #define MAX_DATASET_NAME 64
@@ -115,11 +123,29 @@ typedef struct table {
 
 typedef struct {
 	char *file_name;
+	void *image;		/* file contents read ahead, if any */
+	size_t image_size;
 	int job_id;
+	bool loaded;		/* read ahead complete (or skipped) */
 	char *node_name;
 	int step_id;
 } sh5util_file_t;
 
+/* Read ahead of node-step files while merging. Reading the files is
+ * done by threads which do not call into the HDF5 library (which may not be
+ * thread safe), the merged file is written by the main thread from the file
+ * images in memory. */
+typedef struct {
+	pthread_cond_t cond;
+	int file_cnt;
+	sh5util_file_t **files;	/* in merge order */
+	pthread_mutex_t mutex;
+	int next_merge;		/* index of the next file to merge */
+	int next_read;		/* index of the next file to read */
+	char *step_dir;
+	int window;		/* max files read ahead of next_merge */
+} merge_prefetch_t;
+
 static FILE* output_file;
 static bool group_mode = false;
 static const char *current_step;
@@ -169,6 +195,8 @@ static void _help_msg(void)
 	       " -p, --profiledir     Profile directory location where node-step files exist\n"
 	       "		               default is what is set in acct_gather.conf\n"
 	       " -S, --savefiles      Don't remove node-step files after merging them \n"
+	       " -T, --threads        Number of threads reading node-step files ahead\n"
+	       "                      of the merge (default 4, 0 to disable)\n"
 	       " --user               User who profiled job. (Handy for root user, defaults to \n"
 	       "		               user running this command.)\n"
 	       " --usage              Display brief usage message\n");
@@ -231,6 +259,7 @@ static void _destroy_sh5util_file(void *arg)
 	object = (sh5util_file_t *)arg;
 
 	xfree(object->file_name);
+	free(object->image);
 	xfree(object->node_name);
 	xfree(object);
 }
@@ -308,6 +337,7 @@ static void _init_opts(void)
 	params.job_id = -1;
 	params.mode = SH5UTIL_MODE_MERGE;
 	params.step_id = -1;
+	params.threads = MERGE_THREADS;
 }
 
 static int _set_options(const int argc, char **argv)
@@ -332,6 +362,7 @@ static int _set_options(const int argc, char **argv)
 		{"profiledir", required_argument, 0, 'p'},
 		{"series", required_argument, 0, 's'},
 		{"savefiles", no_argument, 0, 'S'},
+		{"threads", required_argument, 0, 'T'},
 		{"usage", no_argument, 0, 'U'},
 		{"user", required_argument, 0, 'u'},
 		{"verbose", no_argument, 0, 'v'},
@@ -351,7 +382,7 @@ static int _set_options(const int argc, char **argv)
 
 	_init_opts();
 
-	while ((cc = getopt_long(argc, argv, "d:Ehi:Ij:l:LN:o:p:s:Su:UvV",
+	while ((cc = getopt_long(argc, argv, "d:Ehi:Ij:l:LN:o:p:s:ST:u:UvV",
 	                         long_options, &option_index)) != EOF) {
 		switch (cc) {
 		case 'd':
@@ -408,6 +439,14 @@ static int _set_options(const int argc, char **argv)
 		case 'S':
 			params.keepfiles = 1;
 			break;
+		case 'T':
+			params.threads = strtol(optarg, &next_str, 10);
+			if ((next_str[0] != '\0') || (params.threads < 0)) {
+				error("Bad value for --threads=\"%s\"",
+				      optarg);
+				return -1;
+			}
+			break;
 		case 'u':
 			if (uid_from_string(optarg, &u) < 0) {
 				error("No such user --uid=\"%s\"",
@@ -515,7 +554,13 @@ static int _merge_node_step_data(char* file_name, hid_t jgid_nodes,
 	char *group_name = NULL;
 	int rc = SLURM_SUCCESS;
 
-	fid_nodestep = H5Fopen(file_name, H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (sh5util_file->image) {
+		fid_nodestep = H5LTopen_file_image(
+			sh5util_file->image, sh5util_file->image_size,
+			H5LT_FILE_IMAGE_DONT_COPY |
+			H5LT_FILE_IMAGE_DONT_RELEASE);
+	} else
+		fid_nodestep = H5Fopen(file_name, H5F_ACC_RDONLY, H5P_DEFAULT);
 	if (fid_nodestep < 0) {
 		error("Failed to open %s",file_name);
 		return SLURM_ERROR;
@@ -543,6 +588,98 @@ endit:
 	return rc;
 }
 
+/* Read a whole node-step file into memory. On failure, or if the file is
+ * too large, no image is set and the file will be read from disk. */
+static void _read_file_image(char *path, sh5util_file_t *sh5util_file)
+{
+	struct stat st;
+	char *buf;
+	size_t offset = 0;
+	ssize_t len;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY)) < 0)
+		return;
+	if ((fstat(fd, &st) < 0) || (st.st_size <= 0) ||
+	    (st.st_size > MERGE_IMAGE_MAX_SIZE) ||
+	    !(buf = malloc(st.st_size))) {
+		close(fd);
+		return;
+	}
+	while (offset < st.st_size) {
+		len = read(fd, buf + offset, st.st_size - offset);
+		if (len < 0) {
+			if ((errno == EINTR) || (errno == EAGAIN))
+				continue;
+			break;
+		} else if (len == 0)
+			break;
+		offset += len;
+	}
+	close(fd);
+
+	if (offset != st.st_size) {
+		debug("Failed to read %s, reading it from disk", path);
+		free(buf);
+		return;
+	}
+	sh5util_file->image = buf;
+	sh5util_file->image_size = offset;
+}
+
+static void *_prefetch_thread(void *arg)
+{
+	merge_prefetch_t *pf = (merge_prefetch_t *) arg;
+	sh5util_file_t *sh5util_file;
+	char *path;
+
+	slurm_mutex_lock(&pf->mutex);
+	while (pf->next_read < pf->file_cnt) {
+		if ((pf->next_read - pf->next_merge) >= pf->window) {
+			slurm_cond_wait(&pf->cond, &pf->mutex);
+			continue;
+		}
+		sh5util_file = pf->files[pf->next_read++];
+		slurm_mutex_unlock(&pf->mutex);
+
+		path = xstrdup_printf("%s/%s", pf->step_dir,
+				      sh5util_file->file_name);
+		_read_file_image(path, sh5util_file);
+		xfree(path);
+
+		slurm_mutex_lock(&pf->mutex);
+		sh5util_file->loaded = true;
+		slurm_cond_broadcast(&pf->cond);
+	}
+	slurm_mutex_unlock(&pf->mutex);
+
+	return NULL;
+}
+
+/* Wait for a node-step file to be read ahead */
+static void _prefetch_wait(merge_prefetch_t *pf, sh5util_file_t *sh5util_file)
+{
+	if (!pf)
+		return;
+	slurm_mutex_lock(&pf->mutex);
+	while (!sh5util_file->loaded)
+		slurm_cond_wait(&pf->cond, &pf->mutex);
+	slurm_mutex_unlock(&pf->mutex);
+}
+
+/* Release a merged node-step file image and let the next file be read */
+static void _prefetch_done(merge_prefetch_t *pf, sh5util_file_t *sh5util_file)
+{
+	free(sh5util_file->image);
+	sh5util_file->image = NULL;
+	if (!pf)
+		return;
+	slurm_mutex_lock(&pf->mutex);
+	pf->next_merge++;
+	slurm_cond_broadcast(&pf->cond);
+	slurm_mutex_unlock(&pf->mutex);
+}
+
 /* Look for step and node files and merge them together into one job file */
 static int _merge_step_files(void)
 {
@@ -567,6 +704,9 @@ static int _merge_step_files(void)
 	ListIterator itr;
 	List file_list = NULL;
 	sh5util_file_t *sh5util_file = NULL;
+	merge_prefetch_t prefetch, *pf = NULL;
+	pthread_t *threads = NULL;
+	int i, thread_cnt = 0;
 
 	step_dir = xstrdup_printf("%s/%s", params.dir, params.user);
 
@@ -648,10 +788,44 @@ static int _merge_step_files(void)
 	/* sort the files so they are in step order */
 	list_sort(file_list, (ListCmpF) _sh5util_sort_files_dec);
 
+	/* start reading the files ahead of the merge */
+	if (params.threads > 0) {
+		pf = &prefetch;
+		memset(pf, 0, sizeof(merge_prefetch_t));
+		slurm_mutex_init(&pf->mutex);
+		slurm_cond_init(&pf->cond, NULL);
+		pf->file_cnt = list_count(file_list);
+		pf->files = xmalloc(sizeof(sh5util_file_t *) * pf->file_cnt);
+		pf->step_dir = step_dir;
+		pf->window = params.threads * 2;
+		i = 0;
+		itr = list_iterator_create(file_list);
+		while ((sh5util_file = list_next(itr)))
+			pf->files[i++] = sh5util_file;
+		list_iterator_destroy(itr);
+
+		thread_cnt = MIN(params.threads, pf->file_cnt);
+		threads = xmalloc(sizeof(pthread_t) * thread_cnt);
+		for (i = 0; i < thread_cnt; i++) {
+			if (pthread_create(&threads[i], NULL,
+					   _prefetch_thread, pf)) {
+				error("pthread_create: %m");
+				break;
+			}
+		}
+		thread_cnt = i;
+		if (!thread_cnt) {
+			/* read the files from disk as they are merged */
+			for (i = 0; i < pf->file_cnt; i++)
+				pf->files[i]->loaded = true;
+		}
+	}
+
 	node_cnt = 0;
 	itr = list_iterator_create(file_list);
 	while ((sh5util_file = list_next(itr))) {
 		//info("got file of %s", sh5util_file->file_name);
+		_prefetch_wait(pf, sh5util_file);
 
 		/* make a group for each step */
 		if (sh5util_file->step_id != last_step) {
@@ -680,6 +854,7 @@ static int _merge_step_files(void)
 				error("Failed to create %s",
 				      jgrp_step_name);
 				xfree(jgrp_step_name);
+				_prefetch_done(pf, sh5util_file);
 				continue;
 			}
 
@@ -693,6 +868,7 @@ static int _merge_step_files(void)
 				error("Failed to create %s",
 				      jgrp_nodes_name);
 				xfree(jgrp_nodes_name);
+				_prefetch_done(pf, sh5util_file);
 				continue;
 			}
 			xfree(jgrp_nodes_name);
@@ -706,7 +882,7 @@ static int _merge_step_files(void)
 		rc = _merge_node_step_data(
 			step_path, jgid_nodes, sh5util_file);
 		xfree(step_path);
-
+		_prefetch_done(pf, sh5util_file);
 	}
 	list_iterator_destroy(itr);
 
@@ -714,6 +890,15 @@ static int _merge_step_files(void)
 
 
 endit:
+	if (pf) {
+		/* all files were merged, the threads are done */
+		for (i = 0; i < thread_cnt; i++)
+			pthread_join(threads[i], NULL);
+		xfree(threads);
+		xfree(pf->files);
+		slurm_mutex_destroy(&pf->mutex);
+		slurm_cond_destroy(&pf->cond);
+	}
 	FREE_NULL_LIST(file_list);
 	xfree(file_name);
 	xfree(step_dir);
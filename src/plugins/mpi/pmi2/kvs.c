@@ -35,9 +35,18 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include "config.h"
+
 #include <stdlib.h>
+#include <sys/time.h>
 #include <unistd.h>
 
+#if HAVE_LIBZ
+#  include <zlib.h>
+#endif
+
+#include "src/common/timers.h"
+
 #include "kvs.h"
 #include "setup.h"
 #include "tree.h"
@@ -65,11 +74,17 @@ static uint32_t hash_size = 0;
 static char *temp_kvs_buf = NULL;
 static int temp_kvs_cnt = 0;
 static int temp_kvs_size = 0;
+static int temp_kvs_hdr_size = 0;	/* tree cmd header in temp_kvs_buf */
 
 static int no_dup_keys = 0;
 
+/* fence phase timestamps, for fence performance debugging */
+static struct timeval fence_start_tv, fence_send_tv;
+static bool fence_started = false;
+
 #define TASKS_PER_BUCKET 8
 #define TEMP_KVS_SIZE_INC 2048
+#define KVS_COMPRESS_MIN_SIZE 4096
 
 #define KEY_INDEX(i) (i * 2)
 #define VAL_INDEX(i) (i * 2 + 1)
@@ -130,8 +145,10 @@ temp_kvs_init(void)
 	}
 	memcpy(&temp_kvs_buf[temp_kvs_cnt], get_buf_data(buf), size);
 	temp_kvs_cnt += size;
+	temp_kvs_hdr_size = temp_kvs_cnt;
 	free_buf(buf);
 
+	fence_started = false;
 	tasks_to_wait = 0;
 	children_to_wait = 0;
 
@@ -147,6 +164,11 @@ temp_kvs_add(char *key, char *val)
 	if ( key == NULL || val == NULL )
 		return SLURM_SUCCESS;
 
+	if (!fence_started) {
+		gettimeofday(&fence_start_tv, NULL);
+		fence_started = true;
+	}
+
 	buf = init_buf(PMI2_MAX_KEYLEN + PMI2_MAX_VALLEN + 2 * sizeof(uint32_t));
 	packstr(key, buf);
 	packstr(val, buf);
@@ -175,6 +197,11 @@ temp_kvs_merge(Buf buf)
 	data = get_buf_data(buf);
 	offset = get_buf_offset(buf);
 
+	if (!fence_started) {
+		gettimeofday(&fence_start_tv, NULL);
+		fence_started = true;
+	}
+
 	if (temp_kvs_cnt + size > temp_kvs_size) {
 		temp_kvs_size += size;
 		xrealloc(temp_kvs_buf, temp_kvs_size);
@@ -185,19 +212,196 @@ temp_kvs_merge(Buf buf)
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Drop all but the last value put for each key from the merged temp kvs,
+ * the same result kvs_put() would produce on every node. Done in srun only,
+ * right before the merged kvs is broadcast to all nodes of the step.
+ */
+static void
+_temp_kvs_dedup(void)
+{
+	Buf buf;
+	char *val, *new_buf;
+	uint32_t i, j, len, pair_cnt = 0, pair_size = 0, tbl_size, dup_cnt = 0;
+	uint32_t *pair_off = NULL, *tbl = NULL;
+	char **keys = NULL;
+	bool *keep = NULL;
+	int new_cnt;
+
+	if (temp_kvs_cnt <= temp_kvs_hdr_size)
+		return;
+
+	/* buf borrows temp_kvs_buf, detached again before free_buf() */
+	buf = create_buf(temp_kvs_buf, temp_kvs_cnt);
+	set_buf_offset(buf, temp_kvs_hdr_size);
+	while (remaining_buf(buf) > 0) {
+		if (pair_cnt >= pair_size) {
+			pair_size += TEMP_KVS_SIZE_INC;
+			xrealloc(pair_off, (pair_size + 1) * sizeof(uint32_t));
+			xrealloc(keys, pair_size * sizeof(char *));
+		}
+		pair_off[pair_cnt] = get_buf_offset(buf);
+		if (unpackstr_ptr(&keys[pair_cnt], &len, buf) ||
+		    unpackstr_ptr(&val, &len, buf)) {
+			error("mpi/pmi2: failed to unpack temp kvs, "
+			      "skipping duplicate key removal");
+			goto fini;
+		}
+		pair_cnt++;
+	}
+	pair_off[pair_cnt] = get_buf_offset(buf);
+
+	/* open addressing table of pair indexes, scanned from the last put */
+	tbl_size = pair_cnt * 2 + 1;
+	tbl = xmalloc(tbl_size * sizeof(uint32_t));	/* 0 means empty */
+	keep = xmalloc(pair_cnt * sizeof(bool));
+	for (i = pair_cnt; i-- > 0; ) {
+		j = _hash(keys[i]) % tbl_size;
+		while (tbl[j] && xstrcmp(keys[tbl[j] - 1], keys[i]))
+			j = (j + 1) % tbl_size;
+		if (tbl[j]) {
+			dup_cnt++;
+			continue;
+		}
+		tbl[j] = i + 1;
+		keep[i] = true;
+	}
+	if (dup_cnt == 0)
+		goto fini;
+
+	new_buf = xmalloc(temp_kvs_size);
+	memcpy(new_buf, temp_kvs_buf, temp_kvs_hdr_size);
+	new_cnt = temp_kvs_hdr_size;
+	for (i = 0; i < pair_cnt; i++) {
+		if (!keep[i])
+			continue;
+		len = pair_off[i + 1] - pair_off[i];
+		memcpy(&new_buf[new_cnt], &temp_kvs_buf[pair_off[i]], len);
+		new_cnt += len;
+	}
+	debug("mpi/pmi2: removed %u duplicate keys from temp kvs, "
+	      "size %d -> %d", dup_cnt, temp_kvs_cnt, new_cnt);
+	xfree(temp_kvs_buf);
+	temp_kvs_buf = new_buf;
+	temp_kvs_cnt = new_cnt;
+
+fini:
+	buf->head = NULL;
+	free_buf(buf);
+	xfree(pair_off);
+	xfree(keys);
+	xfree(tbl);
+	xfree(keep);
+}
+
+#if HAVE_LIBZ
+/*
+ * Compress the merged temp kvs for the broadcast to stepds. The response is
+ * sent as TREE_CMD_KVS_FENCE_RESP_Z, holding the uncompressed size followed
+ * by the deflated TREE_CMD_KVS_FENCE_RESP body (seq and key-value pairs).
+ * RET: xmalloc'ed message or NULL if the kvs is not worth compressing
+ */
+static char *
+_temp_kvs_compress(uint32_t *msg_len)
+{
+	Buf buf;
+	char *body = temp_kvs_buf + sizeof(uint16_t);
+	uLong body_len = temp_kvs_cnt - sizeof(uint16_t);
+	uLongf z_len = compressBound(body_len);
+	uint32_t hdr_len;
+
+	if (body_len < KVS_COMPRESS_MIN_SIZE)
+		return NULL;
+
+	buf = init_buf(2 * sizeof(uint32_t) + z_len);
+	pack16(TREE_CMD_KVS_FENCE_RESP_Z, buf);
+	pack32((uint32_t) body_len, buf);
+	hdr_len = get_buf_offset(buf);
+	if (compress2((Bytef *) get_buf_data(buf) + hdr_len, &z_len,
+		      (Bytef *) body, body_len, Z_BEST_SPEED) != Z_OK) {
+		error("mpi/pmi2: failed to compress temp kvs");
+		free_buf(buf);
+		return NULL;
+	}
+	debug("mpi/pmi2: compressed temp kvs %lu -> %lu bytes",
+	      body_len, z_len);
+	*msg_len = hdr_len + z_len;
+	return xfer_buf_data(buf);
+}
+#endif
+
+extern int
+temp_kvs_uncompress(Buf buf, Buf *out_buf)
+{
+#if HAVE_LIBZ
+	uint32_t body_len;
+	uLongf len;
+	char *body;
+
+	safe_unpack32(&body_len, buf);
+	len = body_len;
+	body = xmalloc(body_len);
+	if (uncompress((Bytef *) body, &len,
+		       (Bytef *) get_buf_data(buf) + get_buf_offset(buf),
+		       remaining_buf(buf)) != Z_OK || len != body_len) {
+		error("mpi/pmi2: failed to uncompress kvs");
+		xfree(body);
+		return SLURM_ERROR;
+	}
+	*out_buf = create_buf(body, body_len);
+	return SLURM_SUCCESS;
+
+unpack_error:
+	return SLURM_ERROR;
+#else
+	error("mpi/pmi2: compressed kvs received, but no zlib support");
+	return SLURM_ERROR;
+#endif
+}
+
+extern long
+temp_kvs_send_usec(void)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	return (now.tv_sec - fence_send_tv.tv_sec) * 1000000 +
+		(now.tv_usec - fence_send_tv.tv_usec);
+}
+
 extern int
 temp_kvs_send(void)
 {
 	int rc = SLURM_ERROR, retry = 0;
 	unsigned int delay = 1;
-	char *nodelist = NULL;
-
-	if (!in_stepd())	/* srun */
+	char *nodelist = NULL, *msg = NULL;
+	uint32_t msg_len = 0;
+	long gather_usec = 0;
+	DEF_TIMERS;
+
+	START_TIMER;
+	fence_send_tv = tv1;
+	if (fence_started)
+		gather_usec = (tv1.tv_sec - fence_start_tv.tv_sec) * 1000000 +
+			(tv1.tv_usec - fence_start_tv.tv_usec);
+
+	if (!in_stepd()) {	/* srun */
 		nodelist = xstrdup(job_info.step_nodelist);
-	else if (tree_info.parent_node)
+		if (!getenv(PMI2_KVS_NO_DUP_KEYS_ENV))
+			_temp_kvs_dedup();
+#if HAVE_LIBZ
+		if (getenv(PMI2_KVS_COMPRESS_ENV))
+			msg = _temp_kvs_compress(&msg_len);
+#endif
+	} else if (tree_info.parent_node)
 		nodelist = xstrdup(tree_info.parent_node);
 
-	/* cmd included in temp_kvs_buf */
+	if (!msg) {
+		/* cmd included in temp_kvs_buf */
+		msg = temp_kvs_buf;
+		msg_len = temp_kvs_cnt;
+	}
+
 	kvs_seq++; /* expecting new kvs after now */
 
 	while (1) {
@@ -208,10 +412,9 @@ temp_kvs_send(void)
 			/* srun or non-first-level stepds */
 			rc = slurm_forward_data(&nodelist,
 						tree_sock_addr,
-						temp_kvs_cnt,
-						temp_kvs_buf);
+						msg_len, msg);
 		else		/* first level stepds */
-			rc = tree_msg_to_srun(temp_kvs_cnt, temp_kvs_buf);
+			rc = tree_msg_to_srun(msg_len, msg);
 
 		if (rc == SLURM_SUCCESS)
 			break;
@@ -222,6 +425,15 @@ temp_kvs_send(void)
 		sleep(delay);
 		delay *= 2;
 	}
+	END_TIMER;
+	debug("mpi/pmi2: fence seq %d: gathered %d bytes in %ld usec, "
+	      "sent %u bytes to %s in %s", kvs_seq - 1, temp_kvs_cnt,
+	      gather_usec, msg_len,
+	      !in_stepd() ? "stepds" : (tree_info.parent_node ?: "srun"),
+	      TIME_STR);
+
+	if (msg != temp_kvs_buf)
+		xfree(msg);
 	temp_kvs_init();	/* clear old temp kvs */
 
 	xfree(nodelist);
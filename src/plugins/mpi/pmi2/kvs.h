@@ -53,6 +53,8 @@ extern int   temp_kvs_init(void);
 extern int   temp_kvs_add(char *key, char *val);
 extern int   temp_kvs_merge(Buf buf);
 extern int   temp_kvs_send(void);
+extern int   temp_kvs_uncompress(Buf buf, Buf *out_buf);
+extern long  temp_kvs_send_usec(void);
 
 extern int   kvs_init(void);
 extern char *kvs_get(char *key);
@@ -237,6 +237,7 @@
 /* old PMIv1 envs */
 #define PMI2_PMI_DEBUGGED_ENV   "PMI_DEBUG"
 #define PMI2_KVS_NO_DUP_KEYS_ENV "SLURM_PMI_KVS_NO_DUP_KEYS"
+#define PMI2_KVS_COMPRESS_ENV    "SLURM_PMI_KVS_COMPRESS"
 
 
 extern int handle_pmi1_cmd(int fd, int lrank);
@@ -49,6 +49,7 @@
 #include "src/common/slurm_xlator.h"
 #include "src/common/slurm_protocol_interface.h"
 #include "src/common/slurm_protocol_api.h"
+#include "src/common/timers.h"
 #include "src/common/xmalloc.h"
 
 #include "kvs.h"
@@ -68,6 +69,7 @@ static int _handle_name_unpublish(int fd, Buf buf);
 static int _handle_name_lookup(int fd, Buf buf);
 static int _handle_ring(int fd, Buf buf);
 static int _handle_ring_resp(int fd, Buf buf);
+static int _handle_kvs_fence_resp_z(int fd, Buf buf);
 
 static uint32_t  spawned_srun_ports_size = 0;
 static uint16_t *spawned_srun_ports = NULL;
@@ -83,6 +85,7 @@ static int (*tree_cmd_handlers[]) (int fd, Buf buf) = {
 	_handle_name_lookup,
 	_handle_ring,
 	_handle_ring_resp,
+	_handle_kvs_fence_resp_z,
 	NULL
 };
 
@@ -96,6 +99,7 @@ static char *tree_cmd_names[] = {
 	"TREE_CMD_NAME_LOOKUP",
 	"TREE_CMD_RING",
 	"TREE_CMD_RING_RESP",
+	"TREE_CMD_KVS_FENCE_RESP_Z",
 	NULL,
 };
 
@@ -175,8 +179,11 @@ _handle_kvs_fence_resp(int fd, Buf buf)
 	char *key, *val, *errmsg = NULL;
 	int rc = SLURM_SUCCESS;
 	uint32_t temp32, seq;
+	long wait_usec;
+	DEF_TIMERS;
 
 	debug3("mpi/pmi2: in _handle_kvs_fence_resp");
+	wait_usec = temp_kvs_send_usec();
 
 	safe_unpack32(&seq, buf);
 	if( seq == kvs_seq - 2) {
@@ -199,6 +206,7 @@ _handle_kvs_fence_resp(int fd, Buf buf)
 
 	temp32 = remaining_buf(buf);
 	debug3("mpi/pmi2: buf length: %u", temp32);
+	START_TIMER;
 	/* put kvs into local hash */
 	while (remaining_buf(buf) > 0) {
 		safe_unpackstr_xmalloc(&key, &temp32, buf);
@@ -208,6 +216,9 @@ _handle_kvs_fence_resp(int fd, Buf buf)
 		xfree(key);
 		xfree(val);
 	}
+	END_TIMER;
+	debug("mpi/pmi2: fence seq %u: response received %ld usec after "
+	      "fence sent, kvs stored in %s", seq, wait_usec, TIME_STR);
 
 resp:
 	send_kvs_fence_resp_to_clients(rc, errmsg);
@@ -223,6 +234,27 @@ unpack_error:
 	goto resp;
 }
 
+/* called in stepd, compressed form of TREE_CMD_KVS_FENCE_RESP */
+static int
+_handle_kvs_fence_resp_z(int fd, Buf buf)
+{
+	Buf resp_buf = NULL;
+	int rc;
+
+	debug3("mpi/pmi2: in _handle_kvs_fence_resp_z");
+
+	if (temp_kvs_uncompress(buf, &resp_buf) != SLURM_SUCCESS) {
+		send_kvs_fence_resp_to_clients(
+			SLURM_ERROR, "mpi/pmi2: uncompress kvs error in "
+			"fence resp");
+		slurm_kill_job_step(job_info.jobid, job_info.stepid, SIGKILL);
+		return SLURM_ERROR;
+	}
+	rc = _handle_kvs_fence_resp(fd, resp_buf);
+	free_buf(resp_buf);
+	return rc;
+}
+
 /* only called in srun */
 static int
 _handle_spawn(int fd, Buf buf)
@@ -1420,6 +1420,8 @@ static void _update_all_node_features(
 					 &node_ptr->gres, &node_ptr->gres_list);
 	}
 
+	/* Node information responses need the new features and gres */
+	invalidate_node_pack(NULL);
 	xfree(prefix);
 }
 
@@ -1523,6 +1525,7 @@ static void _update_node_features(struct node_record *node_ptr,
 			    node_bitmap);
 	(void) node_features_p_node_update(node_ptr->features_act, node_bitmap);
 	FREE_NULL_BITMAP(node_bitmap);
+	invalidate_node_pack(node_ptr);
 }
 
 static void _make_uid_array(char *uid_str)
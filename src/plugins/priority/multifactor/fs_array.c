@@ -0,0 +1,350 @@
+/*****************************************************************************\
+ *  fs_array.c - Flat, level ordered copy of the association tree used to
+ *	compute effective usage and fair-share factors
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "src/common/list.h"
+#include "src/common/xmalloc.h"
+
+#include "fs_array.h"
+
+#define FS_ARRAY_ROOT_CHILD	0x01	/* fair-share parent is the root */
+#define FS_ARRAY_USE_PARENT	0x02	/* FairShare=parent */
+
+/* Weight of the parent's ratio in the depth oblivious algorithm */
+#define DEPTH_OBLIVIOUS_F	5.0
+
+/*
+ * Associations are processed in blocks small enough that the usage records
+ * read at the start of a block are still cached when results are stored.
+ */
+#define FS_ARRAY_BLOCK		256
+
+extern fs_array_t *fs_array_create(void)
+{
+	return xmalloc(sizeof(fs_array_t));
+}
+
+extern void fs_array_destroy(fs_array_t *fs_array)
+{
+	if (!fs_array)
+		return;
+
+	xfree(fs_array->level_start);
+	xfree(fs_array->assoc);
+	xfree(fs_array->usage);
+	xfree(fs_array->parent);
+	xfree(fs_array->list_parent);
+	xfree(fs_array->kind);
+	xfree(fs_array->share_frac);
+	xfree(fs_array->shares_norm);
+	xfree(fs_array->usage_raw);
+	xfree(fs_array->usage_norm);
+	xfree(fs_array->usage_efctv);
+	xfree(fs_array->parent_efctv);
+	xfree(fs_array->sib_usage);
+	xfree(fs_array->fs_factor);
+	xfree(fs_array);
+}
+
+static void _grow(fs_array_t *fs_array)
+{
+	uint32_t alloc = fs_array->alloc ? (fs_array->alloc * 2) : 1024;
+
+	xrealloc(fs_array->level_start, sizeof(uint32_t) * (alloc + 1));
+	xrealloc(fs_array->assoc, sizeof(slurmdb_assoc_rec_t *) * alloc);
+	xrealloc(fs_array->usage, sizeof(slurmdb_assoc_usage_t *) * alloc);
+	xrealloc(fs_array->parent, sizeof(uint32_t) * alloc);
+	xrealloc(fs_array->list_parent, sizeof(uint32_t) * alloc);
+	xrealloc(fs_array->kind, sizeof(uint8_t) * alloc);
+	xrealloc(fs_array->share_frac, sizeof(double) * alloc);
+	xrealloc(fs_array->shares_norm, sizeof(double) * alloc);
+	xrealloc(fs_array->usage_raw, sizeof(double) * alloc);
+	xrealloc(fs_array->usage_norm, sizeof(double) * alloc);
+	xrealloc(fs_array->usage_efctv, sizeof(double) * alloc);
+	xrealloc(fs_array->parent_efctv, sizeof(double) * alloc);
+	xrealloc(fs_array->sib_usage, sizeof(double) * alloc);
+	xrealloc(fs_array->fs_factor, sizeof(double) * alloc);
+	fs_array->alloc = alloc;
+}
+
+/*
+ * Find the index of the fair-share parent of an association listed in the
+ * children_list of association list_parent. The fair-share parent is
+ * list_parent itself or one of its ancestors, so already in the array.
+ */
+static uint32_t _fs_parent(fs_array_t *fs_array, slurmdb_assoc_rec_t *assoc,
+			   uint32_t list_parent)
+{
+	uint32_t inx = list_parent;
+
+	while (fs_array->assoc[inx] != assoc->usage->fs_assoc_ptr) {
+		if (!inx)
+			return list_parent;	/* Should never happen */
+		inx = fs_array->list_parent[inx];
+	}
+	return inx;
+}
+
+static void _append(fs_array_t *fs_array, slurmdb_assoc_rec_t *assoc,
+		    uint32_t list_parent, slurmdb_assoc_rec_t *root)
+{
+	slurmdb_assoc_usage_t *usage = assoc->usage;
+	uint32_t inx = fs_array->count;
+	uint8_t kind = 0;
+
+	if (inx == fs_array->alloc)
+		_grow(fs_array);
+
+	if (assoc != root) {
+		if (usage->fs_assoc_ptr == root)
+			kind |= FS_ARRAY_ROOT_CHILD;
+		if (assoc->shares_raw == SLURMDB_FS_USE_PARENT)
+			kind |= FS_ARRAY_USE_PARENT;
+	}
+
+	fs_array->assoc[inx] = assoc;
+	fs_array->usage[inx] = usage;
+	fs_array->list_parent[inx] = list_parent;
+	fs_array->parent[inx] = (assoc == root) ? 0 :
+				_fs_parent(fs_array, assoc, list_parent);
+	fs_array->kind[inx] = kind;
+	fs_array->shares_norm[inx] = usage->shares_norm;
+
+	/*
+	 * The classic effective usage is
+	 *	usage_norm + (parent_efctv - usage_norm) * share_frac
+	 * Fold the special cases into share_frac so it needs no branches:
+	 * children of root use their normalized usage, FairShare=parent and
+	 * levels without shares use their parent's effective usage.
+	 */
+	if (kind & FS_ARRAY_ROOT_CHILD)
+		fs_array->share_frac[inx] = 0.0;
+	else if ((kind & FS_ARRAY_USE_PARENT) || !usage->level_shares)
+		fs_array->share_frac[inx] = 1.0;
+	else
+		fs_array->share_frac[inx] = (double)assoc->shares_raw /
+					    (double)usage->level_shares;
+	fs_array->count++;
+}
+
+extern void fs_array_build(fs_array_t *fs_array, slurmdb_assoc_rec_t *root)
+{
+	slurmdb_assoc_rec_t *assoc, *child;
+	ListIterator itr;
+	uint32_t i, level_end = 1;
+
+	fs_array->count = 0;
+	fs_array->level_cnt = 0;
+	if (!root || !root->usage)
+		return;
+
+	_append(fs_array, root, 0, root);
+	fs_array->level_start[fs_array->level_cnt++] = 0;
+
+	/* The arrays double as the queue of the breadth first walk */
+	for (i = 0; i < fs_array->count; i++) {
+		if (i == level_end) {
+			fs_array->level_start[fs_array->level_cnt++] = i;
+			level_end = fs_array->count;
+		}
+		assoc = fs_array->assoc[i];
+		if (assoc->user || !assoc->usage->children_list)
+			continue;
+		itr = list_iterator_create(assoc->usage->children_list);
+		while ((child = list_next(itr)))
+			_append(fs_array, child, i, root);
+		list_iterator_destroy(itr);
+	}
+	fs_array->level_start[fs_array->level_cnt] = fs_array->count;
+}
+
+/* Read the raw usage of associations [start, end) and normalize it */
+static void _gather_usage(fs_array_t *fs_array, uint32_t start, uint32_t end,
+			  double root_raw)
+{
+	double *usage_raw = fs_array->usage_raw;
+	double *usage_norm = fs_array->usage_norm;
+	uint32_t i;
+
+	for (i = start; i < end; i++)
+		usage_raw[i] = (double)fs_array->usage[i]->usage_raw;
+
+	/* If root usage is 0, there is no usage anywhere. */
+	if (!root_raw) {
+		memset(usage_norm + start, 0, sizeof(double) * (end - start));
+		return;
+	}
+	for (i = start; i < end; i++) {
+		usage_norm[i] = usage_raw[i] / root_raw;
+		/* In case the half-life was lowered on the fly */
+		if (usage_norm[i] > 1.0)
+			usage_norm[i] = 1.0;
+	}
+}
+
+/* Effective usage of associations [start, end) with the classic algorithm */
+static void _calc_efctv_classic(fs_array_t *fs_array,
+				uint32_t start, uint32_t end)
+{
+	double *usage_norm = fs_array->usage_norm;
+	double *usage_efctv = fs_array->usage_efctv;
+	double *parent_efctv = fs_array->parent_efctv;
+	double *share_frac = fs_array->share_frac;
+	uint32_t i;
+
+	/* Gather first so the arithmetic loop can be vectorized */
+	for (i = start; i < end; i++)
+		parent_efctv[i] = usage_efctv[fs_array->parent[i]];
+	for (i = start; i < end; i++)
+		usage_efctv[i] = usage_norm[i] +
+			(parent_efctv[i] - usage_norm[i]) * share_frac[i];
+}
+
+/*
+ * Effective usage of associations [start, end) with the depth oblivious
+ * algorithm, see _depth_oblivious_set_usage_efctv() in priority_multifactor.c
+ */
+static void _calc_efctv_depth_oblivious(fs_array_t *fs_array,
+					uint32_t start, uint32_t end)
+{
+	double ratio_p, ratio_l, ratio_s, k;
+	double usage_norm, shares_norm, parent_efctv, parent_shares;
+	uint32_t i, parent;
+
+	for (i = start; i < end; i++) {
+		parent = fs_array->parent[i];
+		usage_norm = fs_array->usage_norm[i];
+		shares_norm = fs_array->shares_norm[i];
+		parent_efctv = fs_array->usage_efctv[parent];
+		parent_shares = fs_array->shares_norm[parent];
+
+		if (fs_array->kind[i] & FS_ARRAY_ROOT_CHILD) {
+			fs_array->usage_efctv[i] = usage_norm;
+			continue;
+		}
+		if (fs_array->kind[i] & FS_ARRAY_USE_PARENT) {
+			fs_array->usage_efctv[i] = parent_efctv;
+			continue;
+		}
+		if (!shares_norm || !parent_shares || !parent_efctv ||
+		    !usage_norm) {
+			fs_array->usage_efctv[i] = usage_norm;
+			continue;
+		}
+
+		ratio_p = parent_efctv / parent_shares;
+		ratio_s = fs_array->sib_usage[parent] / parent_shares;
+		ratio_l = (usage_norm / shares_norm) / ratio_s;
+		if (!ratio_p || !ratio_l || (log(ratio_p) * log(ratio_l) >= 0))
+			k = 1;
+		else
+			k = 1 / (1 + pow(DEPTH_OBLIVIOUS_F * log(ratio_p), 2));
+		fs_array->usage_efctv[i] = ratio_p * pow(ratio_l, k) *
+					   shares_norm;
+	}
+}
+
+/* Fair-share factor of associations [start, end) and store the results */
+static void _calc_fs_factor(fs_array_t *fs_array, uint32_t start,
+			    uint32_t end, double damp)
+{
+	double *usage_efctv = fs_array->usage_efctv;
+	double *shares_norm = fs_array->shares_norm;
+	double *fs_factor = fs_array->fs_factor;
+	slurmdb_assoc_usage_t *usage;
+	uint32_t i;
+
+	/* priority_fs = 2**(-(usage_efctv / shares_norm) / damp_factor) */
+	for (i = start; i < end; i++) {
+		fs_factor[i] = (shares_norm[i] > 0) ?
+			exp2(-(usage_efctv[i] / shares_norm[i]) / damp) : 0.0;
+	}
+
+	for (i = start; i < end; i++) {
+		usage = fs_array->usage[i];
+		usage->usage_norm = fs_array->usage_norm[i];
+		usage->usage_efctv = usage_efctv[i];
+		usage->fs_factor = fs_factor[i];
+	}
+}
+
+extern void fs_array_calc(fs_array_t *fs_array, bool depth_oblivious,
+			  uint16_t damp_factor)
+{
+	double root_raw, damp = damp_factor ? (double)damp_factor : 1.0;
+	uint32_t i, l, start, end, count = fs_array->count;
+
+	if (!count)
+		return;
+
+	root_raw = (double)fs_array->usage[0]->usage_raw;
+	_gather_usage(fs_array, 0, 1, root_raw);
+	fs_array->usage_efctv[0] = fs_array->usage_norm[0];
+
+	/*
+	 * Depth oblivious needs the usage of all siblings up front, which
+	 * as in _depth_oblivious_set_usage_efctv() are the associations in
+	 * the children_list of the fair-share parent
+	 */
+	if (depth_oblivious) {
+		_gather_usage(fs_array, 1, count, root_raw);
+		memset(fs_array->sib_usage, 0, sizeof(double) * count);
+		for (i = 1; i < count; i++) {
+			if (!(fs_array->kind[i] & FS_ARRAY_USE_PARENT))
+				fs_array->sib_usage[fs_array->list_parent[i]]
+					+= fs_array->usage_norm[i];
+		}
+	}
+
+	/* Each level only depends on the one above it */
+	for (l = 1; l < fs_array->level_cnt; l++) {
+		for (start = fs_array->level_start[l];
+		     start < fs_array->level_start[l + 1]; start = end) {
+			end = start + FS_ARRAY_BLOCK;
+			if (end > fs_array->level_start[l + 1])
+				end = fs_array->level_start[l + 1];
+			if (depth_oblivious) {
+				_calc_efctv_depth_oblivious(fs_array,
+							    start, end);
+			} else {
+				_gather_usage(fs_array, start, end, root_raw);
+				_calc_efctv_classic(fs_array, start, end);
+			}
+			_calc_fs_factor(fs_array, start, end, damp);
+		}
+	}
+}
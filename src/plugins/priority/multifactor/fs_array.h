@@ -0,0 +1,96 @@
+/*****************************************************************************\
+ *  fs_array.h - Flat, level ordered copy of the association tree used to
+ *	compute effective usage and fair-share factors
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _PRIORITY_MULTIFACTOR_FS_ARRAY_H
+#define _PRIORITY_MULTIFACTOR_FS_ARRAY_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "slurm/slurmdb.h"
+
+/*
+ * Struct of arrays mirroring the association tree (usage->children_list) in
+ * breadth first order, root first, so every association follows its
+ * fair-share parent (usage->fs_assoc_ptr). The static fields are copied when the array is
+ * built; usage fields are gathered, computed and scattered back on each
+ * fs_array_calc() call.
+ */
+typedef struct {
+	uint32_t count;		/* associations in the arrays */
+	uint32_t alloc;		/* allocated size of the arrays */
+	uint32_t level_cnt;	/* levels in the tree */
+	uint32_t *level_start;	/* index of first association of each level,
+				 * level_cnt + 1 entries */
+	slurmdb_assoc_rec_t **assoc;	/* association records */
+	slurmdb_assoc_usage_t **usage;	/* their usage records */
+	uint32_t *parent;	/* index of fair-share parent */
+	uint32_t *list_parent;	/* index of association whose children_list
+				 * holds it, siblings share it */
+	uint8_t  *kind;		/* FS_ARRAY_KIND_* */
+	double   *share_frac;	/* shares_raw / level_shares */
+	double   *shares_norm;	/* normalized shares */
+	double   *usage_raw;	/* raw usage */
+	double   *usage_norm;	/* normalized usage */
+	double   *usage_efctv;	/* effective usage */
+	double   *parent_efctv;	/* effective usage of parent */
+	double   *sib_usage;	/* sum of normalized usage in children_list */
+	double   *fs_factor;	/* fair-share factor */
+} fs_array_t;
+
+/* Allocate an empty array */
+extern fs_array_t *fs_array_create(void);
+
+/* Free an array and its contents */
+extern void fs_array_destroy(fs_array_t *fs_array);
+
+/*
+ * Rebuild the array from the association tree under root. Must be called
+ * again whenever associations are added or removed, reparented or have
+ * their shares changed.
+ * NOTE: Association read lock must be held.
+ */
+extern void fs_array_build(fs_array_t *fs_array, slurmdb_assoc_rec_t *root);
+
+/*
+ * Compute usage_norm, usage_efctv and fs_factor of every association but
+ * the root from its current usage_raw and store them in the association
+ * records, using the classic or the depth oblivious algorithm.
+ * NOTE: Association write lock must be held.
+ */
+extern void fs_array_calc(fs_array_t *fs_array, bool depth_oblivious,
+			  uint16_t damp_factor);
+
+#endif
@@ -61,6 +61,7 @@
 #include "src/common/parse_time.h"
 #include "src/common/slurm_mcs.h"
 #include "src/common/slurm_time.h"
+#include "src/common/timers.h"
 #include "src/common/xstring.h"
 #include "src/common/gres.h"
 
@@ -68,6 +69,7 @@
 #include "src/slurmctld/read_config.h"
 
 #include "fair_tree.h"
+#include "fs_array.h"
 
 #define SECS_PER_DAY	(24 * 60 * 60)
 #define SECS_PER_WEEK	(7 * SECS_PER_DAY)
@@ -147,12 +149,21 @@ static uint32_t prevflags;    /* Priority Flags before _internal_setup() resets
 			       * flags after a reconfigure */
 static time_t g_last_ran = 0; /* when the last poll ran */
 static double decay_factor = 1; /* The decay factor when decaying time. */
+static uint32_t static_epoch = 1; /* bumped when the factor weights change */
+static uint32_t prio_static_cnt = 0; /* jobs with static factors recalculated */
+static uint32_t prio_skip_cnt = 0;   /* jobs with no factor changed */
+static fs_array_t *fs_array = NULL;  /* flat copy of association tree */
+static uint32_t fs_array_gen = 0;    /* g_assoc_tree_gen when built */
+static bool fs_array_stale = true;   /* shares renormalized, rebuild */
 
 /* variables defined in prirority_multifactor.h */
 bool priority_debug = 0;
 
 static void _priority_p_set_assoc_usage_debug(slurmdb_assoc_rec_t *assoc);
 static void _set_assoc_usage_efctv(slurmdb_assoc_rec_t *assoc);
+static void _set_priority_factors(time_t start_time,
+				  struct job_record *job_ptr,
+				  bool assoc_locked);
 
 /*
  * apply decay factor to all associations usage_raw
@@ -424,11 +435,45 @@ static int _set_children_usage_efctv(List children_list)
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Calculate the normalized and effective usage of every association from
+ * a flat copy of the association tree, which is only rebuilt when the tree
+ * changes. With PriorityDebug the tree is walked as before so every
+ * calculation is logged. (Fair Tree calls a different function.)
+ *
+ * NOTE: acct_mgr_assoc_lock must be write locked before this is called.
+ */
+static void _set_all_usage_efctv(void)
+{
+	if (!assoc_mgr_root_assoc)
+		return;
+
+	if (priority_debug) {
+		_set_children_usage_efctv(
+			assoc_mgr_root_assoc->usage->children_list);
+		return;
+	}
+
+	if (!fs_array)
+		fs_array = fs_array_create();
+	if (fs_array_stale || (fs_array_gen != g_assoc_tree_gen) ||
+	    !fs_array->count || (fs_array->assoc[0] != assoc_mgr_root_assoc)) {
+		fs_array_build(fs_array, assoc_mgr_root_assoc);
+		fs_array_gen = g_assoc_tree_gen;
+		fs_array_stale = false;
+	}
+	fs_array_calc(fs_array, (flags & PRIORITY_FLAGS_DEPTH_OBLIVIOUS),
+		      damp_factor);
+}
+
 
 /* job_ptr should already have the partition priority and such added here
  * before had we will be adding to it
+ * IN assoc_locked - true if the caller already holds the assoc_mgr
+ *	association read lock
  */
-static double _get_fairshare_priority(struct job_record *job_ptr)
+static double _get_fairshare_priority(struct job_record *job_ptr,
+				      bool assoc_locked)
 {
 	slurmdb_assoc_rec_t *job_assoc;
 	slurmdb_assoc_rec_t *fs_assoc = NULL;
@@ -439,12 +484,14 @@ static double _get_fairshare_priority(struct job_record *job_ptr)
 	if (!calc_fairshare)
 		return 0;
 
-	assoc_mgr_lock(&locks);
+	if (!assoc_locked)
+		assoc_mgr_lock(&locks);
 
 	job_assoc = (slurmdb_assoc_rec_t *)job_ptr->assoc_ptr;
 
 	if (!job_assoc) {
-		assoc_mgr_unlock(&locks);
+		if (!assoc_locked)
+			assoc_mgr_unlock(&locks);
 		error("Job %u has no association.  Unable to "
 		      "compute fairshare.", job_ptr->job_id);
 		return 0;
@@ -480,19 +527,129 @@ static double _get_fairshare_priority(struct job_record *job_ptr)
 			     fs_assoc->usage->shares_norm, priority_fs);
 		}
 	}
-	assoc_mgr_unlock(&locks);
+	if (!assoc_locked)
+		assoc_mgr_unlock(&locks);
 
 	return priority_fs;
 }
 
+/* Return the age factor (0.0 -> 1.0) of a job */
+static double _get_age_factor(time_t start_time, struct job_record *job_ptr)
+{
+	uint32_t diff = 0;
+	time_t use_time;
+
+	if (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)
+		use_time = job_ptr->details->submit_time;
+	else
+		use_time = job_ptr->details->begin_time;
+
+	/* Only really add an age priority if the use_time is
+	   past the start_time.
+	*/
+	if (start_time > use_time)
+		diff = start_time - use_time;
+
+	if (job_ptr->details->begin_time
+	    || (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)) {
+		if (diff < max_age)
+			return (double)diff / (double)max_age;
+		return 1.0;
+	}
+	return 0.0;
+}
+
+#define FNV_PRIME 16777619U
+static uint32_t _sig_mix(uint32_t sig, uint64_t value)
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		sig ^= (uint32_t)(value & 0xff);
+		sig *= FNV_PRIME;
+		value >>= 8;
+	}
+	return sig;
+}
+
+/*
+ * Return a checksum of everything the job size, partition, QOS, TRES and
+ * nice components of a job's priority are calculated from. While it and
+ * static_epoch are unchanged only the age and fair-share factors need to be
+ * recalculated.
+ */
+static uint32_t _static_factors_sig(struct job_record *job_ptr)
+{
+	struct job_details *details = job_ptr->details;
+	struct part_record *part_ptr = job_ptr->part_ptr;
+	slurmdb_qos_rec_t *qos_ptr = (slurmdb_qos_rec_t *)job_ptr->qos_ptr;
+	uint32_t sig = 2166136261U;
+	int i;
 
-/* Returns the priority after applying the weight factors */
+	sig = _sig_mix(sig, job_ptr->total_cpus);
+	sig = _sig_mix(sig, job_ptr->time_limit);
+	sig = _sig_mix(sig, details->max_cpus);
+	sig = _sig_mix(sig, details->min_cpus);
+	sig = _sig_mix(sig, details->min_nodes);
+	sig = _sig_mix(sig, details->nice);
+	sig = _sig_mix(sig, cluster_cpus);
+	sig = _sig_mix(sig, node_record_count);
+	sig = _sig_mix(sig, part_max_priority);
+	sig = _sig_mix(sig, (uintptr_t)part_ptr);
+	if (part_ptr) {
+		sig = _sig_mix(sig, part_ptr->max_time);
+		sig = _sig_mix(sig, part_ptr->priority_job_factor);
+		sig = _sig_mix(sig, (uint64_t)(part_ptr->norm_priority *
+					       (double)0xffffffff));
+		if (part_ptr->tres_cnt) {
+			for (i = 0; i < slurmctld_tres_cnt; i++)
+				sig = _sig_mix(sig, part_ptr->tres_cnt[i]);
+		}
+	}
+	if (job_ptr->part_ptr_list) {
+		struct part_record *part_iter;
+		ListIterator itr = list_iterator_create(job_ptr->part_ptr_list);
+		while ((part_iter = list_next(itr))) {
+			sig = _sig_mix(sig, (uintptr_t)part_iter);
+			sig = _sig_mix(sig, part_iter->priority_job_factor);
+		}
+		list_iterator_destroy(itr);
+	}
+	sig = _sig_mix(sig, (uintptr_t)qos_ptr);
+	if (qos_ptr) {
+		sig = _sig_mix(sig, qos_ptr->priority);
+		if (qos_ptr->usage) {
+			sig = _sig_mix(sig, (uint64_t)
+				       (qos_ptr->usage->norm_priority *
+					(double)0xffffffff));
+		}
+	}
+	if (job_ptr->tres_alloc_cnt) {
+		for (i = 0; i < slurmctld_tres_cnt; i++)
+			sig = _sig_mix(sig, job_ptr->tres_alloc_cnt[i]);
+	} else if (job_ptr->tres_req_cnt) {
+		for (i = 0; i < slurmctld_tres_cnt; i++)
+			sig = _sig_mix(sig, job_ptr->tres_req_cnt[i]);
+	}
+
+	return sig;
+}
+
+
+/*
+ * Returns the priority after applying the weight factors
+ * IN assoc_locked - true if the caller already holds the assoc_mgr
+ *	association read lock
+ */
 static uint32_t _get_priority_internal(time_t start_time,
-				       struct job_record *job_ptr)
+				       struct job_record *job_ptr,
+				       bool assoc_locked)
 {
 	double priority	= 0.0;
 	priority_factors_object_t pre_factors;
+	priority_factors_object_t *prio_factors;
 	uint64_t tmp_64;
+	uint32_t sig;
 	double tmp_tres = 0.0;
 
 	if (job_ptr->direct_set_prio && (job_ptr->priority > 0)) {
@@ -518,7 +675,41 @@ static uint32_t _get_priority_internal(time_t start_time,
 		return 0;
 	}
 
-	set_priority_factors(start_time, job_ptr);
+	/*
+	 * The job size, partition, QOS and TRES factors only change when the
+	 * job or its partition and QOS change, so reuse their weighted values
+	 * from the last pass and recalculate only the age and fair-share
+	 * factors. If those did not change either, neither did the priority.
+	 */
+	sig = _static_factors_sig(job_ptr);
+	prio_factors = job_ptr->prio_factors;
+	if (!priority_debug && prio_factors &&
+	    (prio_factors->cache_epoch == static_epoch) &&
+	    (prio_factors->cache_sig == sig)) {
+		double priority_age = 0.0, priority_fs = 0.0;
+
+		if (weight_age) {
+			priority_age = _get_age_factor(start_time, job_ptr) *
+				       (double)weight_age;
+		}
+		if (job_ptr->assoc_ptr && weight_fs) {
+			priority_fs = _get_fairshare_priority(job_ptr,
+							      assoc_locked) *
+				      (double)weight_fs;
+		}
+		if ((priority_age == prio_factors->priority_age) &&
+		    (priority_fs == prio_factors->priority_fs)) {
+			prio_skip_cnt++;
+			return prio_factors->cache_prio;
+		}
+		prio_factors->priority_age = priority_age;
+		prio_factors->priority_fs  = priority_fs;
+		tmp_tres = prio_factors->cache_tres;
+		goto sum_factors;
+	}
+	prio_static_cnt++;
+
+	_set_priority_factors(start_time, job_ptr, assoc_locked);
 
 	if (priority_debug) {
 		memcpy(&pre_factors, job_ptr->prio_factors,
@@ -550,6 +741,11 @@ static uint32_t _get_priority_internal(time_t start_time,
 		}
 	}
 
+	job_ptr->prio_factors->cache_epoch = static_epoch;
+	job_ptr->prio_factors->cache_sig   = sig;
+	job_ptr->prio_factors->cache_tres  = tmp_tres;
+
+sum_factors:
 	priority = job_ptr->prio_factors->priority_age
 		+ job_ptr->prio_factors->priority_fs
 		+ job_ptr->prio_factors->priority_js
@@ -673,6 +869,8 @@ static uint32_t _get_priority_internal(time_t start_time,
 
 		xfree(pre_factors.priority_tres);
 	}
+	job_ptr->prio_factors->cache_prio = (uint32_t)priority;
+
 	return (uint32_t)priority;
 }
 
@@ -1144,17 +1342,14 @@ static int _apply_new_usage(struct job_record *job_ptr,
 }
 
 
-static int _decay_apply_new_usage_and_weighted_factors(
+static int _decay_apply_new_usage(
 	struct job_record *job_ptr,
 	time_t *start_time_ptr)
 {
 	/* Always return SUCCESS so that list_for_each will
 	 * continue processing list of jobs. */
 
-	if (!decay_apply_new_usage(job_ptr, start_time_ptr))
-		return SLURM_SUCCESS;
-
-	decay_apply_weighted_factors(job_ptr, start_time_ptr);
+	decay_apply_new_usage(job_ptr, start_time_ptr);
 
 	return SLURM_SUCCESS;
 }
@@ -1292,8 +1487,7 @@ static void *_decay_thread(void *no_data)
 		 * it handles these calculations during its tree traversal */
 		if (!(flags & PRIORITY_FLAGS_FAIR_TREE)) {
 			assoc_mgr_lock(&locks);
-			_set_children_usage_efctv(
-				assoc_mgr_root_assoc->usage->children_list);
+			_set_all_usage_efctv();
 			assoc_mgr_unlock(&locks);
 		}
 
@@ -1324,11 +1518,14 @@ static void *_decay_thread(void *no_data)
 
 		if (!(flags & PRIORITY_FLAGS_FAIR_TREE)) {
 			lock_slurmctld(job_write_lock);
-			list_for_each(
-				job_list,
-				(ListForF) _decay_apply_new_usage_and_weighted_factors,
-				&start_time
-				);
+			list_for_each(job_list,
+				      (ListForF) _decay_apply_new_usage,
+				      &start_time);
+			/* Fair-share factors include the new usage */
+			assoc_mgr_lock(&locks);
+			_set_all_usage_efctv();
+			assoc_mgr_unlock(&locks);
+			decay_apply_weighted_factors_all(job_list, start_time);
 			unlock_slurmctld(job_write_lock);
 		}
 
@@ -1429,6 +1626,7 @@ static void _internal_setup(void)
 	}
 	xfree(tres_weights_str);
 	flags = slurm_get_priority_flags();
+	static_epoch++;		/* invalidate cached job priority factors */
 
 	if (priority_debug) {
 		info("priority: Damp Factor is %u", damp_factor);
@@ -1689,6 +1887,8 @@ int fini ( void )
 		pthread_join(cleanup_handler_thread, NULL);
 
 	xfree(weight_tres);
+	fs_array_destroy(fs_array);
+	fs_array = NULL;
 
 	slurm_mutex_unlock(&decay_lock);
 
@@ -1697,7 +1897,7 @@ int fini ( void )
 
 extern uint32_t priority_p_set(uint32_t last_prio, struct job_record *job_ptr)
 {
-	uint32_t priority = _get_priority_internal(time(NULL), job_ptr);
+	uint32_t priority = _get_priority_internal(time(NULL), job_ptr, false);
 
 	debug2("initial priority for job %u is %u", job_ptr->job_id, priority);
 
@@ -1712,6 +1912,7 @@ extern void priority_p_reconfig(bool assoc_clear)
 	reconfig = 1;
 	prevflags = flags;
 	_internal_setup();
+	fs_array_stale = true;
 
 	/* Since Fair Tree uses a different shares calculation method, we
 	 * must reassign shares at reconfigure if the algorithm was switched to
@@ -1898,14 +2099,9 @@ extern bool decay_apply_new_usage(struct job_record *job_ptr,
 }
 
 
-extern int decay_apply_weighted_factors(struct job_record *job_ptr,
-					 time_t *start_time_ptr)
+/* Return true if the decay thread recalculates the priority of a job */
+static bool _job_prio_recalc(struct job_record *job_ptr)
 {
-	uint32_t new_prio;
-
-	/* Always return SUCCESS so that list_for_each will
-	 * continue processing list of jobs. */
-
 	/*
 	 * Priority 0 is reserved for held jobs. Also skip priority
 	 * re_calculation for non-pending jobs.
@@ -1914,9 +2110,16 @@ extern int decay_apply_weighted_factors(struct job_record *job_ptr,
 	    IS_JOB_POWER_UP_NODE(job_ptr) ||
 	    (!IS_JOB_PENDING(job_ptr) &&
 	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING)))
-		return SLURM_SUCCESS;
+		return false;
+	return true;
+}
+
+static void _apply_weighted_factors(struct job_record *job_ptr,
+				    time_t start_time, bool assoc_locked)
+{
+	uint32_t new_prio;
 
-	new_prio = _get_priority_internal(*start_time_ptr, job_ptr);
+	new_prio = _get_priority_internal(start_time, job_ptr, assoc_locked);
 	if (((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
 	    (job_ptr->priority < new_prio)) {
 		job_ptr->priority = new_prio;
@@ -1925,12 +2128,80 @@ extern int decay_apply_weighted_factors(struct job_record *job_ptr,
 
 	debug2("priority for job %u is now %u",
 	       job_ptr->job_id, job_ptr->priority);
+}
+
+extern int decay_apply_weighted_factors(struct job_record *job_ptr,
+					 time_t *start_time_ptr)
+{
+	/* Always return SUCCESS so that list_for_each will
+	 * continue processing list of jobs. */
+
+	if (_job_prio_recalc(job_ptr))
+		_apply_weighted_factors(job_ptr, *start_time_ptr, false);
 
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Recalculate the priority of every active job in a list, taking the
+ * association read lock once for the whole pass rather than once per job.
+ * Jobs whose static factors are unchanged only have their age and
+ * fair-share factors recalculated. Statistics are reported by sdiag.
+ * NOTE: The slurmctld job write lock must be held by the caller.
+ */
+extern void decay_apply_weighted_factors_all(List jobs, time_t start_time)
+{
+	struct job_record *job_ptr;
+	ListIterator itr;
+	uint32_t job_cnt = 0;
+	assoc_mgr_lock_t locks = { READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
+				   NO_LOCK, NO_LOCK, NO_LOCK };
+	DEF_TIMERS;
+
+	START_TIMER;
+	prio_static_cnt = 0;
+	prio_skip_cnt = 0;
+	assoc_mgr_lock(&locks);
+	itr = list_iterator_create(jobs);
+	while ((job_ptr = list_next(itr))) {
+		/* Don't need to handle finished jobs. */
+		if (IS_JOB_FINISHED(job_ptr) || IS_JOB_COMPLETING(job_ptr) ||
+		    !_job_prio_recalc(job_ptr))
+			continue;
+		job_cnt++;
+		_apply_weighted_factors(job_ptr, start_time, true);
+	}
+	list_iterator_destroy(itr);
+	assoc_mgr_unlock(&locks);
+	END_TIMER2("decay_apply_weighted_factors_all");
+
+	slurmctld_diag_stats.prio_cycle_counter++;
+	slurmctld_diag_stats.prio_cycle_last = DELTA_TIMER;
+	if (slurmctld_diag_stats.prio_cycle_last >
+	    slurmctld_diag_stats.prio_cycle_max) {
+		slurmctld_diag_stats.prio_cycle_max =
+			slurmctld_diag_stats.prio_cycle_last;
+	}
+	slurmctld_diag_stats.prio_last_jobs = job_cnt;
+	slurmctld_diag_stats.prio_last_static = prio_static_cnt;
+	slurmctld_diag_stats.prio_last_skip = prio_skip_cnt;
+
+	if (priority_debug) {
+		info("priority: %u jobs in %s, static factors recalculated "
+		     "for %u, %u unchanged",
+		     job_cnt, TIME_STR, prio_static_cnt, prio_skip_cnt);
+	}
+}
+
 
 extern void set_priority_factors(time_t start_time, struct job_record *job_ptr)
+{
+	_set_priority_factors(start_time, job_ptr, false);
+}
+
+static void _set_priority_factors(time_t start_time,
+				  struct job_record *job_ptr,
+				  bool assoc_locked)
 {
 	slurmdb_qos_rec_t *qos_ptr = NULL;
 
@@ -1949,33 +2220,13 @@ extern void set_priority_factors(time_t start_time, struct job_record *job_ptr)
 	qos_ptr = (slurmdb_qos_rec_t *)job_ptr->qos_ptr;
 
 	if (weight_age) {
-		uint32_t diff = 0;
-		time_t use_time;
-
-		if (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)
-			use_time = job_ptr->details->submit_time;
-		else
-			use_time = job_ptr->details->begin_time;
-
-		/* Only really add an age priority if the use_time is
-		   past the start_time.
-		*/
-		if (start_time > use_time)
-			diff = start_time - use_time;
-
-		if (job_ptr->details->begin_time
-		    || (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)) {
-			if (diff < max_age) {
-				job_ptr->prio_factors->priority_age =
-					(double)diff / (double)max_age;
-			} else
-				job_ptr->prio_factors->priority_age = 1.0;
-		}
+		job_ptr->prio_factors->priority_age =
+			_get_age_factor(start_time, job_ptr);
 	}
 
 	if (job_ptr->assoc_ptr && weight_fs) {
 		job_ptr->prio_factors->priority_fs =
-			_get_fairshare_priority(job_ptr);
+			_get_fairshare_priority(job_ptr, assoc_locked);
 	}
 
 	/* FIXME: this should work off the product of TRESBillingWeights */
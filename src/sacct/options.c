@@ -435,6 +435,7 @@ int get_data(void)
 	ListIterator itr_step = NULL;
 	slurmdb_job_cond_t *job_cond = params.job_cond;
 
+	FREE_NULL_LIST(jobs);
 	if (params.opt_completion) {
 		jobs = g_slurm_jobcomp_get_jobs(job_cond);
 		return SLURM_SUCCESS;
@@ -877,6 +878,10 @@ void parse_command_line(int argc, char **argv)
 				"SLURM accounting storage is disabled\n");
 			exit(1);
 		}
+		/* Print jobs a page at a time rather than holding them all */
+		if (!xstrcmp(acct_type, "accounting_storage/slurmdbd") ||
+		    !xstrcmp(acct_type, "accounting_storage/mysql"))
+			job_cond->page_size = SACCT_PAGE_SIZE;
 		xfree(acct_type);
 		acct_db_conn = slurmdb_connection_get();
 		if (errno != SLURM_SUCCESS) {
@@ -158,12 +158,19 @@ int main(int argc, char **argv)
 	switch (op) {
 	case SACCT_LIST:
 		print_fields_header(print_fields_list);
-		if (get_data() == SLURM_ERROR)
-			exit(errno);
-		if (params.opt_completion)
+		if (params.opt_completion) {
+			if (get_data() == SLURM_ERROR)
+				exit(errno);
 			do_list_completion();
-		else
+			break;
+		}
+		/* With paging each pass gets and prints the next page, the
+		 * page size is cleared if the SlurmDBD can not page */
+		do {
+			if (get_data() == SLURM_ERROR)
+				exit(errno);
 			do_list();
+		} while (params.job_cond->page_size && list_count(jobs));
 		break;
 	case SACCT_HELP:
 		do_help();
@@ -195,6 +195,17 @@ extern int sacctmgr_list_stats(int argc, char **argv)
 		       rollup_type, buf->rollup_count[i], roll_ave,
 		       buf->rollup_max_time[i], buf->rollup_time[i]);
 	}
+	if (buf->rollup_hours) {
+		char time_str[32];
+
+		/* Time spent per hour of usage rolled up */
+		roll_ave = buf->rollup_time[ROLLUP_HOUR] / buf->rollup_hours;
+		slurm_make_time_str(&buf->rollup_last_hour, time_str,
+				    sizeof(time_str));
+		printf("\t%-10s count:%-6"PRIu64" ave_time:%-6"PRIu64
+		       " last_hour:%s\n",
+		       "Hours", buf->rollup_hours, roll_ave, time_str);
+	}
 
 	if (argc) {
 		if (!strncasecmp(argv[0], "ave_time", 2))
@@ -56,10 +56,12 @@
 
 #define OPT_LONG_HELP   0x100
 #define OPT_LONG_USAGE  0x101
+#define OPT_LONG_WINDOW 0x102
 
 /* getopt_long options, integers but not characters */
 
 /* FUNCTIONS */
+static int      _get_width( char *buf, char *name );
 static void     _help( void );
 static uint32_t _map_size( char *buf );
 static void     _print_options( void );
@@ -84,6 +86,7 @@ extern void parse_command_line(int argc, char **argv)
 		{"timeout",   required_argument, 0, 't'},
 		{"verbose",   no_argument,       0, 'v'},
 		{"version",   no_argument,       0, 'V'},
+		{"window",    required_argument, 0, OPT_LONG_WINDOW},
 		{"help",      no_argument,       0, OPT_LONG_HELP},
 		{"usage",     no_argument,       0, OPT_LONG_USAGE},
 		{NULL,        0,                 0, 0}
@@ -103,7 +106,7 @@ extern void parse_command_line(int argc, char **argv)
 	if ((env_val = getenv("SBCAST_COMPRESS")))
 		params.compress = parse_compress_type(env_val);
 	if ( ( env_val = getenv("SBCAST_FANOUT") ) )
-		params.fanout = atoi(env_val);
+		params.fanout = _get_width(env_val, "SBCAST_FANOUT");
 	if (getenv("SBCAST_FORCE"))
 		params.force = true;
 
@@ -118,6 +121,8 @@ extern void parse_command_line(int argc, char **argv)
 		params.block_size = 8 * 1024 * 1024;
 	if ( ( env_val = getenv("SBCAST_TIMEOUT") ) )
 		params.timeout = (atoi(env_val) * 1000);
+	if ( ( env_val = getenv("SBCAST_WINDOW") ) )
+		params.window = atoi(env_val);
 
 	optind = 0;
 	while ((opt_char = getopt_long(argc, argv, "CfF:j:ps:t:vV",
@@ -135,7 +140,7 @@ extern void parse_command_line(int argc, char **argv)
 			params.force = true;
 			break;
 		case (int)'F':
-			params.fanout = atoi(optarg);
+			params.fanout = _get_width(optarg, "--fanout");
 			break;
 		case (int)'j':
 			params.job_id = strtol(optarg, &end_ptr, 10);
@@ -157,6 +162,9 @@ extern void parse_command_line(int argc, char **argv)
 		case (int) 'V':
 			print_slurm_version();
 			exit(0);
+		case (int) OPT_LONG_WINDOW:
+			params.window = atoi(optarg);
+			break;
 		case (int) OPT_LONG_HELP:
 			_help();
 			exit(0);
@@ -219,6 +227,21 @@ extern void parse_command_line(int argc, char **argv)
 #endif
 }
 
+/* map a fanout in string to number, exit if it is not a positive integer */
+static int _get_width( char *buf, char *name )
+{
+	long width;
+	char *end_ptr = NULL;
+
+	width = strtol(buf, &end_ptr, 10);
+	if ((end_ptr == buf) || (end_ptr[0] != '\0') || (width < 1) || (width > INT_MAX)) {
+		error("Invalid %s value: %s, must be a positive integer",
+		      name, buf);
+		exit(1);
+	}
+	return (int) width;
+}
+
 /* map size in string to number, interpret suffix of "k" or "m" */
 static uint32_t _map_size( char *buf )
 {
@@ -259,6 +282,7 @@ static void _print_options( void )
 	info("preserve   = %s", params.preserve ? "true" : "false");
 	info("timeout    = %d", params.timeout);
 	info("verbose    = %d", params.verbose);
+	info("window     = %d", params.window);
 	info("source     = %s", params.src_fname);
 	info("dest       = %s", params.dst_fname);
 	info("-----------------------------");
@@ -284,6 +308,7 @@ Usage: sbcast [OPTIONS] SOURCE DEST\n\
   -t, --timeout=secs   specify message timeout (seconds)\n\
   -v, --verbose        provide detailed event logging\n\
   -V, --version        print version information and exit\n\
+      --window=num     maximum number of blocks in flight\n\
 \nHelp options:\n\
   --help               show this help message\n\
   --usage              display brief usage message\n");
@@ -170,6 +170,18 @@ static int _print_stats(void)
 		       buf->bf_queue_len_sum / buf->bf_cycle_counter);
 	}
 
+	if (buf->prio_cycle_counter) {
+		printf("\nPriority calculation statistics (microseconds):\n");
+		printf("\tTotal cycles: %u\n", buf->prio_cycle_counter);
+		printf("\tLast cycle: %u\n", buf->prio_cycle_last);
+		printf("\tMax cycle:  %u\n", buf->prio_cycle_max);
+		printf("\tLast cycle jobs: %u\n", buf->prio_last_jobs);
+		printf("\tLast cycle jobs (static factors recalculated): %u\n",
+		       buf->prio_last_static);
+		printf("\tLast cycle jobs (unchanged): %u\n",
+		       buf->prio_last_skip);
+	}
+
 	printf("\nRemote Procedure Call statistics by message type\n");
 	for (i = 0; i < buf->rpc_type_size; i++) {
 		printf("\t%-40s(%5u) count:%-6u "
@@ -188,6 +200,23 @@ static int _print_stats(void)
 		       rpc_user_ave_time[i], buf->rpc_user_time[i]);
 	}
 
+	if (buf->rpc_comp_size) {
+		printf("\nRemote Procedure Call statistics by message "
+		       "aggregation collector\n");
+	}
+	for (i = 0; i < buf->rpc_comp_size; i++) {
+		printf("\t%-16s count:%-6u msgs:%-8u "
+		       "ave_msgs:%-6u ave_time:%-6"PRIu64" "
+		       "total_time:%"PRIu64"\n",
+		       buf->rpc_comp_host[i], buf->rpc_comp_cnt[i],
+		       buf->rpc_comp_msg_cnt[i],
+		       buf->rpc_comp_cnt[i] ?
+		       buf->rpc_comp_msg_cnt[i] / buf->rpc_comp_cnt[i] : 0,
+		       buf->rpc_comp_cnt[i] ?
+		       buf->rpc_comp_time[i] / buf->rpc_comp_cnt[i] : 0,
+		       buf->rpc_comp_time[i]);
+	}
+
 	return 0;
 }
 
@@ -0,0 +1,709 @@
+/*****************************************************************************\
+ *  cache.c - Cache of slurmctld's answers to read-only queries
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "config.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#include "slurm/slurm.h"
+
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/pack.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_auth.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/slurm_protocol_pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmcached/cache.h"
+
+/* Return code sending the client to slurmctld */
+#define CACHE_REFUSED ESLURM_NOT_SUPPORTED
+
+/*
+ * One answer of slurmctld. The job, node and partition information is kept
+ * as received and sent to clients without being packed again.
+ */
+typedef struct {
+	Buf buffer;		/* raw message, NULL if not kept */
+	uint32_t body_offset;	/* offset of the message body in buffer */
+	void *data;		/* unpacked message body */
+	time_t last_update;	/* time of the data */
+	uint16_t msg_type;	/* RESPONSE_* */
+	uint32_t *offsets;	/* offset of each job record in buffer */
+	int ref_cnt;		/* entry plus requests using it */
+} cache_snap_t;
+
+/* The latest answer to a query */
+typedef struct {
+	time_t fetch_time;	/* when slurmctld was last asked */
+	bool fetching;		/* slurmctld is being asked */
+	uint16_t msg_type;	/* REQUEST_* */
+	uint16_t show_flags;	/* flags of the query */
+	cache_snap_t *snap;	/* its answer, NULL if none */
+} cache_entry_t;
+
+static pthread_cond_t  cache_cond = PTHREAD_COND_INITIALIZER;
+static int             cache_interval = 5;
+static List            cache_list = NULL;
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint16_t        private_data = 0;
+
+/* Statistics, protected by cache_mutex */
+static uint32_t fetch_cnt = 0, refused_cnt = 0, served_cnt = 0;
+
+static uint16_t _resp_type(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case REQUEST_JOB_INFO:
+		return RESPONSE_JOB_INFO;
+	case REQUEST_NODE_INFO:
+		return RESPONSE_NODE_INFO;
+	case REQUEST_PARTITION_INFO:
+		return RESPONSE_PARTITION_INFO;
+	case REQUEST_PRIORITY_FACTORS:
+		return RESPONSE_PRIORITY_FACTORS;
+	case REQUEST_SHARE_INFO:
+		return RESPONSE_SHARE_INFO;
+	default:
+		return 0;
+	}
+}
+
+static void _snap_free(cache_snap_t *snap)
+{
+	if (snap->data)
+		slurm_free_msg_data(snap->msg_type, snap->data);
+	if (snap->buffer)
+		free_buf(snap->buffer);
+	xfree(snap->offsets);
+	xfree(snap);
+}
+
+/* Release a reference to a snapshot, cache_mutex must be locked */
+static void _snap_unref(cache_snap_t *snap)
+{
+	if (snap && (--snap->ref_cnt == 0))
+		_snap_free(snap);
+}
+
+static void _snap_release(cache_snap_t *snap)
+{
+	slurm_mutex_lock(&cache_mutex);
+	_snap_unref(snap);
+	slurm_mutex_unlock(&cache_mutex);
+}
+
+static void _entry_free(void *x)
+{
+	cache_entry_t *entry = (cache_entry_t *) x;
+
+	_snap_unref(entry->snap);
+	xfree(entry);
+}
+
+/*
+ * Send a request to slurmctld and receive its response, keeping the raw
+ * message in resp->buffer.
+ * RET 0 on success, -1 on failure
+ */
+static int _send_recv_ctld(slurm_msg_t *req, slurm_msg_t *resp)
+{
+	slurm_addr_t ctrl_addr;
+	bool use_backup = false;
+	int fd, rc;
+
+	if ((fd = slurm_open_controller_conn(&ctrl_addr, &use_backup)) < 0)
+		return -1;
+
+	if (slurm_send_node_msg(fd, req) < 0) {
+		(void) slurm_shutdown_msg_conn(fd);
+		return -1;
+	}
+
+	slurm_msg_t_init(resp);
+	resp->flags = SLURM_MSG_KEEP_BUFFER;
+	rc = slurm_receive_msg(fd, resp, 0);
+	(void) slurm_shutdown_msg_conn(fd);
+	if (rc) {
+		if (resp->buffer)
+			free_buf(resp->buffer);
+		return -1;
+	}
+	if (resp->auth_cred)
+		g_slurm_auth_destroy(resp->auth_cred);
+
+	return 0;
+}
+
+/*
+ * Ask slurmctld for the answer to a query
+ * IN last_update - time of the data we have
+ * OUT snap_ptr - the new answer
+ * RET SLURM_SUCCESS, SLURM_NO_CHANGE_IN_DATA or SLURM_ERROR
+ */
+static int _fetch(uint16_t msg_type, uint16_t show_flags, time_t last_update,
+		  cache_snap_t **snap_ptr)
+{
+	job_info_request_msg_t job_req;
+	node_info_request_msg_t node_req;
+	part_info_request_msg_t part_req;
+	priority_factors_request_msg_t prio_req;
+	shares_request_msg_t share_req;
+	slurm_msg_t req_msg, resp_msg;
+	job_info_msg_t *job_info = NULL;
+	cache_snap_t *snap;
+	int rc;
+
+	slurm_msg_t_init(&req_msg);
+	req_msg.msg_type = msg_type;
+	switch (msg_type) {
+	case REQUEST_JOB_INFO:
+		memset(&job_req, 0, sizeof(job_req));
+		job_req.last_update = last_update;
+		job_req.show_flags = show_flags;
+		req_msg.data = &job_req;
+		break;
+	case REQUEST_NODE_INFO:
+		memset(&node_req, 0, sizeof(node_req));
+		node_req.last_update = last_update;
+		node_req.show_flags = show_flags;
+		req_msg.data = &node_req;
+		break;
+	case REQUEST_PARTITION_INFO:
+		memset(&part_req, 0, sizeof(part_req));
+		part_req.last_update = last_update;
+		part_req.show_flags = show_flags;
+		req_msg.data = &part_req;
+		break;
+	case REQUEST_PRIORITY_FACTORS:
+		memset(&prio_req, 0, sizeof(prio_req));
+		req_msg.data = &prio_req;
+		break;
+	case REQUEST_SHARE_INFO:
+		memset(&share_req, 0, sizeof(share_req));
+		req_msg.data = &share_req;
+		break;
+	default:
+		return SLURM_ERROR;
+	}
+
+	if (_send_recv_ctld(&req_msg, &resp_msg) < 0) {
+		error("%s: %s: %m", __func__, rpc_num2string(msg_type));
+		return SLURM_ERROR;
+	}
+
+	if (resp_msg.msg_type == RESPONSE_SLURM_RC) {
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		slurm_free_return_code_msg(resp_msg.data);
+		free_buf(resp_msg.buffer);
+		if (rc == SLURM_NO_CHANGE_IN_DATA)
+			return rc;
+		error("%s: %s: %s", __func__, rpc_num2string(msg_type),
+		      slurm_strerror(rc));
+		return SLURM_ERROR;
+	}
+	if (resp_msg.msg_type != _resp_type(msg_type)) {
+		error("%s: %s: unexpected response %s", __func__,
+		      rpc_num2string(msg_type),
+		      rpc_num2string(resp_msg.msg_type));
+		slurm_free_msg_data(resp_msg.msg_type, resp_msg.data);
+		free_buf(resp_msg.buffer);
+		return SLURM_ERROR;
+	}
+
+	snap = xmalloc(sizeof(cache_snap_t));
+	snap->buffer = resp_msg.buffer;
+	snap->body_offset = get_buf_offset(resp_msg.buffer);
+	snap->data = resp_msg.data;
+	snap->msg_type = resp_msg.msg_type;
+	snap->ref_cnt = 1;
+	switch (msg_type) {
+	case REQUEST_JOB_INFO:
+		/* Unpack again, noting where each job record is */
+		snap->last_update = ((job_info_msg_t *) snap->data)->last_update;
+		slurm_free_job_info_msg(snap->data);
+		snap->data = NULL;
+		if (unpack_job_info_offsets(&job_info, &snap->offsets,
+					    snap->buffer,
+					    resp_msg.protocol_version)) {
+			error("%s: unable to unpack job information",
+			      __func__);
+			_snap_free(snap);
+			return SLURM_ERROR;
+		}
+		snap->data = job_info;
+		break;
+	case REQUEST_NODE_INFO:
+		snap->last_update = ((node_info_msg_t *) snap->data)->
+				    last_update;
+		break;
+	case REQUEST_PARTITION_INFO:
+		snap->last_update = ((partition_info_msg_t *) snap->data)->
+				    last_update;
+		break;
+	default:
+		/* Packed again for each client after filtering */
+		snap->last_update = time(NULL);
+		free_buf(snap->buffer);
+		snap->buffer = NULL;
+		break;
+	}
+
+	*snap_ptr = snap;
+	return SLURM_SUCCESS;
+}
+
+static int _find_entry(void *x, void *key)
+{
+	cache_entry_t *entry = (cache_entry_t *) x;
+	cache_entry_t *match = (cache_entry_t *) key;
+
+	if ((entry->msg_type == match->msg_type) &&
+	    (entry->show_flags == match->show_flags))
+		return 1;
+	return 0;
+}
+
+/*
+ * Get the answer to a query, asking slurmctld if the one we have is older
+ * than cache_interval. Concurrent requests for the same query wait for one
+ * request to slurmctld.
+ * RET the answer, release with _snap_release(), or NULL if none
+ */
+static cache_snap_t *_get_snap(uint16_t msg_type, uint16_t show_flags)
+{
+	cache_entry_t *entry, key;
+	cache_snap_t *snap = NULL;
+	time_t last_update, now;
+	int rc;
+
+	key.msg_type = msg_type;
+	key.show_flags = show_flags;
+
+	slurm_mutex_lock(&cache_mutex);
+	if (!(entry = list_find_first(cache_list, _find_entry, &key))) {
+		entry = xmalloc(sizeof(cache_entry_t));
+		entry->msg_type = msg_type;
+		entry->show_flags = show_flags;
+		list_append(cache_list, entry);
+	}
+	while (entry->fetching)
+		slurm_cond_wait(&cache_cond, &cache_mutex);
+
+	now = time(NULL);
+	if (now >= (entry->fetch_time + cache_interval)) {
+		entry->fetching = true;
+		last_update = entry->snap ? entry->snap->last_update : 0;
+		fetch_cnt++;
+		slurm_mutex_unlock(&cache_mutex);
+
+		rc = _fetch(msg_type, show_flags, last_update, &snap);
+
+		slurm_mutex_lock(&cache_mutex);
+		if (rc == SLURM_SUCCESS) {
+			_snap_unref(entry->snap);
+			entry->snap = snap;
+		} else if (rc != SLURM_NO_CHANGE_IN_DATA) {
+			/* Send clients to slurmctld until the next try */
+			_snap_unref(entry->snap);
+			entry->snap = NULL;
+		}
+		entry->fetch_time = now;
+		entry->fetching = false;
+		slurm_cond_broadcast(&cache_cond);
+	}
+
+	if ((snap = entry->snap))
+		snap->ref_cnt++;
+	slurm_mutex_unlock(&cache_mutex);
+
+	return snap;
+}
+
+/*
+ * Return true if every user sees the same jobs, nodes and partitions, i.e.
+ * no partition is hidden or restricted to some groups. Otherwise only
+ * queries with SHOW_ALL can be answered from the cache.
+ */
+static bool _parts_uniform(void)
+{
+	partition_info_msg_t *part_info;
+	partition_info_t *part;
+	cache_snap_t *snap;
+	bool uniform = true;
+	int i;
+
+	if (!(snap = _get_snap(REQUEST_PARTITION_INFO, SHOW_ALL)))
+		return false;
+
+	part_info = (partition_info_msg_t *) snap->data;
+	for (i = 0; i < part_info->record_count; i++) {
+		part = &part_info->partition_array[i];
+		if ((part->flags & PART_FLAG_HIDDEN) ||
+		    (part->allow_groups &&
+		     xstrcasecmp(part->allow_groups, "ALL"))) {
+			uniform = false;
+			break;
+		}
+	}
+	_snap_release(snap);
+
+	return uniform;
+}
+
+static void _send_resp(slurm_msg_t *msg, uint16_t msg_type, void *data,
+		       uint32_t data_size)
+{
+	slurm_msg_t resp_msg;
+
+	slurm_msg_t_init(&resp_msg);
+	resp_msg.flags = msg->flags;
+	resp_msg.protocol_version = msg->protocol_version;
+	resp_msg.address = msg->address;
+	resp_msg.conn = msg->conn;
+	resp_msg.msg_type = msg_type;
+	resp_msg.data = data;
+	resp_msg.data_size = data_size;
+
+	slurm_send_node_msg(msg->conn_fd, &resp_msg);
+}
+
+/* Same test as _filter_job() in slurmctld/job_mgr.c */
+static bool _job_match(job_info_t *job, void *arg)
+{
+	job_filter_args_t *args = (job_filter_args_t *) arg;
+
+	if (!job_filter_match(args, job->job_id, job->array_job_id,
+			      job->user_id, job->job_state, job->account))
+		return false;
+	if (args->part_cnt && !job_filter_part_match(args, job->partition))
+		return false;
+	return true;
+}
+
+/*
+ * Answer REQUEST_JOB_INFO and REQUEST_JOB_USER_INFO
+ * IN filter - jobs to send, NULL for all
+ * IN user_id - send only this user's jobs if not NO_VAL
+ */
+static int _job_info(slurm_msg_t *msg, time_t last_update,
+		     uint16_t show_flags, job_info_filter_t *filter,
+		     uint32_t user_id)
+{
+	job_info_filter_t user_filter;
+	job_filter_args_t args;
+	cache_snap_t *snap;
+	Buf buffer;
+
+	if (private_data & PRIVATE_DATA_JOBS)
+		return CACHE_REFUSED;
+	if (show_flags & ~(SHOW_ALL | SHOW_DETAIL))
+		return CACHE_REFUSED;
+	if (!(show_flags & SHOW_ALL) && !_parts_uniform())
+		return CACHE_REFUSED;
+	if (!(snap = _get_snap(REQUEST_JOB_INFO, show_flags)))
+		return CACHE_REFUSED;
+
+	if (last_update >= snap->last_update) {
+		_snap_release(snap);
+		return SLURM_NO_CHANGE_IN_DATA;
+	}
+
+	if (!filter && (user_id == NO_VAL)) {
+		_send_resp(msg, RESPONSE_JOB_INFO,
+			   get_buf_data(snap->buffer) + snap->body_offset,
+			   size_buf(snap->buffer) - snap->body_offset);
+		_snap_release(snap);
+		return SLURM_SUCCESS;
+	}
+
+	if (!filter) {
+		memset(&user_filter, 0, sizeof(user_filter));
+		user_filter.user_id_cnt = 1;
+		user_filter.user_ids = &user_id;
+		filter = &user_filter;
+	}
+	job_filter_args_init(&args, filter);
+	buffer = pack_job_info_records(snap->data, snap->buffer,
+				       snap->offsets, _job_match, &args);
+	_snap_release(snap);
+	job_filter_args_free(&args);
+
+	_send_resp(msg, RESPONSE_JOB_INFO, get_buf_data(buffer),
+		   get_buf_offset(buffer));
+	free_buf(buffer);
+
+	return SLURM_SUCCESS;
+}
+
+/* Answer REQUEST_NODE_INFO and REQUEST_PARTITION_INFO */
+static int _node_part_info(slurm_msg_t *msg, time_t last_update,
+			   uint16_t show_flags)
+{
+	cache_snap_t *snap;
+
+	if (msg->msg_type == REQUEST_NODE_INFO) {
+		if (private_data & PRIVATE_DATA_NODES)
+			return CACHE_REFUSED;
+		if (show_flags & ~(SHOW_ALL | SHOW_DETAIL | SHOW_MIXED))
+			return CACHE_REFUSED;
+	} else {
+		if (private_data & PRIVATE_DATA_PARTITIONS)
+			return CACHE_REFUSED;
+		if (show_flags & ~(SHOW_ALL | SHOW_DETAIL))
+			return CACHE_REFUSED;
+	}
+	if (!(show_flags & SHOW_ALL) && !_parts_uniform())
+		return CACHE_REFUSED;
+	if (!(snap = _get_snap(msg->msg_type, show_flags)))
+		return CACHE_REFUSED;
+
+	if (last_update >= snap->last_update) {
+		_snap_release(snap);
+		return SLURM_NO_CHANGE_IN_DATA;
+	}
+
+	_send_resp(msg, snap->msg_type,
+		   get_buf_data(snap->buffer) + snap->body_offset,
+		   size_buf(snap->buffer) - snap->body_offset);
+	_snap_release(snap);
+
+	return SLURM_SUCCESS;
+}
+
+static int _find_uint32(void *x, void *key)
+{
+	if (*(uint32_t *) x == *(uint32_t *) key)
+		return 1;
+	return 0;
+}
+
+static int _find_name(void *x, void *key)
+{
+	if (!xstrcasecmp((char *) x, (char *) key))
+		return 1;
+	return 0;
+}
+
+/* Same test as _filter_job() in priority/multifactor */
+static bool _prio_match(priority_factors_object_t *prio,
+			priority_factors_request_msg_t *req)
+{
+	if (req->job_id_list &&
+	    !list_find_first(req->job_id_list, _find_uint32, &prio->job_id))
+		return false;
+	if (req->uid_list &&
+	    !list_find_first(req->uid_list, _find_uint32, &prio->user_id))
+		return false;
+	return true;
+}
+
+/* Answer REQUEST_PRIORITY_FACTORS */
+static int _prio_info(slurm_msg_t *msg)
+{
+	priority_factors_request_msg_t *req =
+		(priority_factors_request_msg_t *) msg->data;
+	priority_factors_response_msg_t *snap_resp, resp;
+	priority_factors_object_t *prio;
+	ListIterator itr;
+	cache_snap_t *snap;
+
+	if (private_data & PRIVATE_DATA_JOBS)
+		return CACHE_REFUSED;
+	if (!(snap = _get_snap(REQUEST_PRIORITY_FACTORS, 0)))
+		return CACHE_REFUSED;
+
+	snap_resp = (priority_factors_response_msg_t *) snap->data;
+	memset(&resp, 0, sizeof(resp));
+	resp.priority_factors_list = list_create(NULL);
+	if (snap_resp->priority_factors_list) {
+		itr = list_iterator_create(snap_resp->priority_factors_list);
+		while ((prio = list_next(itr))) {
+			if (_prio_match(prio, req))
+				list_append(resp.priority_factors_list, prio);
+		}
+		list_iterator_destroy(itr);
+	}
+	_send_resp(msg, RESPONSE_PRIORITY_FACTORS, &resp, 0);
+	FREE_NULL_LIST(resp.priority_factors_list);
+	_snap_release(snap);
+
+	return SLURM_SUCCESS;
+}
+
+/* Same test as assoc_mgr_get_shares() */
+static bool _share_match(assoc_shares_object_t *share,
+			 shares_request_msg_t *req)
+{
+	char *acct = share->user ? share->parent : share->name;
+
+	if (share->user && req->user_list && list_count(req->user_list) &&
+	    !list_find_first(req->user_list, _find_name, share->name))
+		return false;
+	if (req->acct_list && list_count(req->acct_list) &&
+	    (!acct ||
+	     !list_find_first(req->acct_list, _find_name, acct)))
+		return false;
+	return true;
+}
+
+/* Answer REQUEST_SHARE_INFO */
+static int _share_info(slurm_msg_t *msg)
+{
+	shares_request_msg_t *req = (shares_request_msg_t *) msg->data;
+	shares_response_msg_t *snap_resp, resp;
+	assoc_shares_object_t *share;
+	ListIterator itr;
+	cache_snap_t *snap;
+
+	if (private_data & PRIVATE_DATA_USAGE)
+		return CACHE_REFUSED;
+	if (!(snap = _get_snap(REQUEST_SHARE_INFO, 0)))
+		return CACHE_REFUSED;
+
+	snap_resp = (shares_response_msg_t *) snap->data;
+	memcpy(&resp, snap_resp, sizeof(resp));
+	resp.assoc_shares_list = list_create(NULL);
+	if (snap_resp->assoc_shares_list) {
+		itr = list_iterator_create(snap_resp->assoc_shares_list);
+		while ((share = list_next(itr))) {
+			if (_share_match(share, req))
+				list_append(resp.assoc_shares_list, share);
+		}
+		list_iterator_destroy(itr);
+	}
+	_send_resp(msg, RESPONSE_SHARE_INFO, &resp, 0);
+	FREE_NULL_LIST(resp.assoc_shares_list);
+	_snap_release(snap);
+
+	return SLURM_SUCCESS;
+}
+
+static int _proc_req(slurm_msg_t *msg)
+{
+	job_info_request_msg_t *job_req;
+	job_user_id_msg_t *user_req;
+	node_info_request_msg_t *node_req;
+	part_info_request_msg_t *part_req;
+
+	/* Raw responses are in our protocol version */
+	if (msg->protocol_version != SLURM_PROTOCOL_VERSION)
+		return CACHE_REFUSED;
+
+	switch (msg->msg_type) {
+	case REQUEST_JOB_INFO:
+		job_req = (job_info_request_msg_t *) msg->data;
+		return _job_info(msg, job_req->last_update,
+				 job_req->show_flags, job_req->filter, NO_VAL);
+	case REQUEST_JOB_USER_INFO:
+		user_req = (job_user_id_msg_t *) msg->data;
+		return _job_info(msg, 0, user_req->show_flags, NULL,
+				 user_req->user_id);
+	case REQUEST_NODE_INFO:
+		node_req = (node_info_request_msg_t *) msg->data;
+		return _node_part_info(msg, node_req->last_update,
+				       node_req->show_flags);
+	case REQUEST_PARTITION_INFO:
+		part_req = (part_info_request_msg_t *) msg->data;
+		return _node_part_info(msg, part_req->last_update,
+				       part_req->show_flags);
+	case REQUEST_PRIORITY_FACTORS:
+		return _prio_info(msg);
+	case REQUEST_SHARE_INFO:
+		return _share_info(msg);
+	default:
+		return CACHE_REFUSED;
+	}
+}
+
+/*
+ * cache_init - Initialize the cache
+ * IN interval - seconds for which slurmctld's answer to a query is reused
+ */
+extern void cache_init(int interval)
+{
+	slurm_ctl_conf_t *conf;
+
+	conf = slurm_conf_lock();
+	private_data = conf->private_data;
+	slurm_conf_unlock();
+
+	slurm_mutex_lock(&cache_mutex);
+	cache_interval = interval;
+	if (!cache_list)
+		cache_list = list_create(_entry_free);
+	slurm_mutex_unlock(&cache_mutex);
+}
+
+/* cache_fini - Free all cached data */
+extern void cache_fini(void)
+{
+	slurm_mutex_lock(&cache_mutex);
+	info("%u queries answered, %u sent to slurmctld, %u slurmctld queries",
+	     served_cnt, refused_cnt, fetch_cnt);
+	FREE_NULL_LIST(cache_list);
+	slurm_mutex_unlock(&cache_mutex);
+}
+
+/*
+ * cache_proc_req - Answer a query received from a client, from the cache
+ *	when possible. Queries whose answer would depend upon the user making
+ *	them (e.g. with PrivateData configured) are refused, the client then
+ *	sends them to slurmctld.
+ * IN msg - the query
+ */
+extern void cache_proc_req(slurm_msg_t *msg)
+{
+	int rc = _proc_req(msg);
+
+	slurm_mutex_lock(&cache_mutex);
+	if (rc == CACHE_REFUSED)
+		refused_cnt++;
+	else
+		served_cnt++;
+	slurm_mutex_unlock(&cache_mutex);
+
+	if (rc != SLURM_SUCCESS) {
+		debug2("%s: %s: %s", __func__, rpc_num2string(msg->msg_type),
+		       slurm_strerror(rc));
+		slurm_send_rc_msg(msg, rc);
+	}
+}
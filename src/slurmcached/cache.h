@@ -0,0 +1,59 @@
+/*****************************************************************************\
+ *  cache.h - Cache of slurmctld's answers to read-only queries
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCACHED_CACHE_H
+#define _SLURMCACHED_CACHE_H
+
+#include "src/common/slurm_protocol_defs.h"
+
+/*
+ * cache_init - Initialize the cache
+ * IN interval - seconds for which slurmctld's answer to a query is reused
+ */
+extern void cache_init(int interval);
+
+/* cache_fini - Free all cached data */
+extern void cache_fini(void);
+
+/*
+ * cache_proc_req - Answer a query received from a client, from the cache
+ *	when possible. Queries whose answer would depend upon the user making
+ *	them (e.g. with PrivateData configured) are refused, the client then
+ *	sends them to slurmctld.
+ * IN msg - the query
+ */
+extern void cache_proc_req(slurm_msg_t *msg);
+
+#endif /* !_SLURMCACHED_CACHE_H */
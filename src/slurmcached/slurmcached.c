@@ -0,0 +1,349 @@
+/*****************************************************************************\
+ *  slurmcached.c - Answer read-only queries of the local host's clients
+ *	from a short lived cache of slurmctld's answers
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "config.h"
+
+#include <errno.h>
+#include <grp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "src/common/daemonize.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/proc_args.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_auth.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/uid.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xsignal.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmcached/cache.h"
+
+#define DEFAULT_INTERVAL	5	/* seconds */
+#define MAX_THREADS		64	/* queries answered at once */
+
+typedef struct {
+	int fd;
+	slurm_addr_t cli_addr;
+} conn_arg_t;
+
+static int    debug_level = 0;		/* incremented for -v on command line */
+static int    foreground = 0;		/* run process as a daemon */
+static int    interval = DEFAULT_INTERVAL;
+static log_options_t log_opts = 	/* Log to stderr & syslog */
+	LOG_OPTS_INITIALIZER;
+static char  *log_file = NULL;
+static volatile sig_atomic_t shutdown_flag = 0;
+static int    thread_cnt = 0;
+static pthread_cond_t  thread_cond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t thread_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void  _become_slurm_user(uid_t slurm_user_id, char *slurm_user_name);
+static void *_service_connection(void *arg);
+static void  _parse_commandline(int argc, char **argv);
+static void  _shutdown_handler(int signo);
+static void  _update_logging(void);
+static void  _usage(char *prog_name);
+
+/* main - slurmcached main function, accept and answer queries */
+int main(int argc, char **argv)
+{
+	slurm_ctl_conf_t *conf;
+	struct pollfd pfd;
+	pthread_attr_t thread_attr;
+	pthread_t thread_id;
+	conn_arg_t *conn_arg;
+	uint16_t port;
+	uid_t slurm_user_id;
+	char *slurm_user_name;
+	int listen_fd, fd;
+
+	log_init(argv[0], log_opts, LOG_DAEMON, NULL);
+	_parse_commandline(argc, argv);
+	slurm_conf_init(NULL);
+	_update_logging();
+
+	conf = slurm_conf_lock();
+	port = conf->slurmcached_port;
+	slurm_user_id = conf->slurm_user_id;
+	slurm_user_name = xstrdup(conf->slurm_user_name);
+	slurm_conf_unlock();
+	if (!port)
+		fatal("SlurmcachedPort is not configured");
+
+	if (slurm_auth_init(NULL) != SLURM_SUCCESS)
+		fatal("failed to initialize authentication plugin");
+
+	if (!foreground) {
+		if (daemon(1, 1))
+			error("daemon(): %m");
+		log_alter(log_opts, LOG_DAEMON, log_file);
+	}
+
+	xsignal(SIGINT, _shutdown_handler);
+	xsignal(SIGTERM, _shutdown_handler);
+	xsignal(SIGPIPE, SIG_IGN);
+
+	if ((listen_fd = slurm_init_msg_engine_port(port)) < 0)
+		fatal("slurm_init_msg_engine_port error %m");
+
+	/* Clients only trust answers of SlurmUser (or root) received on the
+	 * privileged SlurmcachedPort, give up root once it is bound */
+	_become_slurm_user(slurm_user_id, slurm_user_name);
+	xfree(slurm_user_name);
+
+	cache_init(interval);
+	info("slurmcached version %s started on port %hu", SLURM_VERSION_STRING,
+	     port);
+
+	slurm_attr_init(&thread_attr);
+	if (pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED))
+		error("pthread_attr_setdetachstate %m");
+
+	pfd.fd = listen_fd;
+	pfd.events = POLLIN;
+	while (!shutdown_flag) {
+		pfd.revents = 0;
+		if (poll(&pfd, 1, 1000) <= 0)
+			continue;	/* timeout, signal or error */
+
+		conn_arg = xmalloc(sizeof(conn_arg_t));
+		if ((fd = slurm_accept_msg_conn(listen_fd,
+						&conn_arg->cli_addr)) < 0) {
+			if (errno != EINTR)
+				error("slurm_accept_msg_conn: %m");
+			xfree(conn_arg);
+			continue;
+		}
+		conn_arg->fd = fd;
+
+		slurm_mutex_lock(&thread_mutex);
+		while (thread_cnt >= MAX_THREADS)
+			slurm_cond_wait(&thread_cond, &thread_mutex);
+		thread_cnt++;
+		slurm_mutex_unlock(&thread_mutex);
+
+		if (pthread_create(&thread_id, &thread_attr,
+				   _service_connection, conn_arg)) {
+			error("pthread_create: %m");
+			_service_connection(conn_arg);
+		}
+	}
+	slurm_attr_destroy(&thread_attr);
+	(void) slurm_shutdown_msg_engine(listen_fd);
+
+	/* Wait for the queries being answered */
+	slurm_mutex_lock(&thread_mutex);
+	while (thread_cnt)
+		slurm_cond_wait(&thread_cond, &thread_mutex);
+	slurm_mutex_unlock(&thread_mutex);
+
+	cache_fini();
+	info("slurmcached terminated");
+	slurm_auth_fini();
+	slurm_conf_destroy();
+	xfree(log_file);
+	log_fini();
+
+	return 0;
+}
+
+/* Receive a query and answer it */
+static void *_service_connection(void *arg)
+{
+	conn_arg_t *conn_arg = (conn_arg_t *) arg;
+	slurm_msg_t msg;
+
+	slurm_msg_t_init(&msg);
+	if (slurm_receive_msg(conn_arg->fd, &msg, 0) == 0) {
+		msg.conn_fd = conn_arg->fd;
+		msg.address = conn_arg->cli_addr;
+		cache_proc_req(&msg);
+	} else if (errno != SLURM_PROTOCOL_AUTHENTICATION_ERROR) {
+		debug("%s: slurm_receive_msg: %m", __func__);
+	} else {
+		error("%s: authentication failure", __func__);
+	}
+	slurm_free_msg_data(msg.msg_type, msg.data);
+	if (msg.auth_cred)
+		g_slurm_auth_destroy(msg.auth_cred);
+	(void) slurm_shutdown_msg_conn(conn_arg->fd);
+	xfree(conn_arg);
+
+	slurm_mutex_lock(&thread_mutex);
+	thread_cnt--;
+	slurm_cond_broadcast(&thread_cond);
+	slurm_mutex_unlock(&thread_mutex);
+
+	return NULL;
+}
+
+static void _become_slurm_user(uid_t slurm_user_id, char *slurm_user_name)
+{
+	gid_t slurm_user_gid;
+
+	/* Determine SlurmUser gid */
+	slurm_user_gid = gid_from_uid(slurm_user_id);
+	if (slurm_user_gid == (gid_t) -1)
+		fatal("Failed to determine gid of SlurmUser(%u)", slurm_user_id);
+
+	/* Initialize supplementary groups ID list for SlurmUser */
+	if (getuid() == 0) {
+		/* root does not need supplementary groups */
+		if ((slurm_user_id == 0) && (setgroups(0, NULL) != 0)) {
+			fatal("Failed to drop supplementary groups, "
+			      "setgroups: %m");
+		} else if ((slurm_user_id != getuid()) &&
+			   initgroups(slurm_user_name, slurm_user_gid)) {
+			fatal("Failed to set supplementary groups, "
+			      "initgroups: %m");
+		}
+	} else {
+		info("Not running as root. Can't drop supplementary groups");
+	}
+
+	/* Set GID to GID of SlurmUser */
+	if ((slurm_user_gid != getegid()) && (setgid(slurm_user_gid)))
+		fatal("Failed to set GID to %d", slurm_user_gid);
+
+	/* Set UID to UID of SlurmUser */
+	if ((slurm_user_id != getuid()) && (setuid(slurm_user_id))) {
+		fatal("Can not set uid to SlurmUser(%u): %m",
+		      slurm_user_id);
+	}
+}
+
+static void _shutdown_handler(int signo)
+{
+	shutdown_flag = 1;
+}
+
+/*
+ * _parse_commandline - parse and process any command line arguments
+ * IN argc - number of command line arguments
+ * IN argv - the command line arguments
+ */
+static void _parse_commandline(int argc, char **argv)
+{
+	int c = 0;
+	char *tmp_char;
+
+	opterr = 0;
+	while ((c = getopt(argc, argv, "Dhi:L:vV")) != -1)
+		switch (c) {
+		case 'D':
+			foreground = 1;
+			break;
+		case 'h':
+			_usage(argv[0]);
+			exit(0);
+			break;
+		case 'i':
+			if (!optarg) /* CLANG fix */
+				break;
+			interval = strtol(optarg, &tmp_char, 10);
+			if ((tmp_char[0] != '\0') || (interval < 1)) {
+				error("Invalid option for -i option (interval), "
+				      "using %d seconds", DEFAULT_INTERVAL);
+				interval = DEFAULT_INTERVAL;
+			}
+			break;
+		case 'L':
+			xfree(log_file);
+			log_file = xstrdup(optarg);
+			break;
+		case 'v':
+			debug_level++;
+			break;
+		case 'V':
+			print_slurm_version();
+			exit(0);
+			break;
+		default:
+			_usage(argv[0]);
+			exit(1);
+		}
+}
+
+/* _usage - print a message describing the command line arguments of
+ *	slurmcached */
+static void _usage(char *prog_name)
+{
+	fprintf(stderr, "Usage: %s [OPTIONS]\n", prog_name);
+	fprintf(stderr, "  -D         \t"
+		"Run daemon in foreground.\n");
+	fprintf(stderr, "  -h         \t"
+		"Print this help message.\n");
+	fprintf(stderr, "  -i seconds \t"
+		"Reuse slurmctld's answers for this many seconds "
+		"(default %d).\n", DEFAULT_INTERVAL);
+	fprintf(stderr, "  -L logfile \t"
+		"Log messages to the specified file.\n");
+	fprintf(stderr, "  -v         \t"
+		"Verbose mode. Multiple -v's increase verbosity.\n");
+	fprintf(stderr, "  -V         \t"
+		"Print version information and exit.\n");
+}
+
+/* Set slurmcached logging based upon command line arguments */
+static void _update_logging(void)
+{
+	log_level_t level = MIN(LOG_LEVEL_INFO + debug_level,
+				LOG_LEVEL_END - 1);
+
+	log_opts.stderr_level  = level;
+	log_opts.logfile_level = level;
+	log_opts.syslog_level  = level;
+
+	if (foreground)
+		log_opts.syslog_level = LOG_LEVEL_QUIET;
+	else {
+		log_opts.stderr_level = LOG_LEVEL_QUIET;
+		if (log_file)
+			log_opts.syslog_level = LOG_LEVEL_QUIET;
+	}
+
+	log_alter(log_opts, SYSLOG_FACILITY_DAEMON, log_file);
+}
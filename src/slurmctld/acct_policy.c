@@ -343,90 +343,20 @@ static void _set_qos_order(struct job_record *job_ptr,
 	return;
 }
 
-static int _find_used_limits_for_acct(void *x, void *key)
-{
-	slurmdb_used_limits_t *used_limits = (slurmdb_used_limits_t *)x;
-	char *account = (char *)key;
-
-	if (!xstrcmp(account, used_limits->acct))
-		return 1;
-
-	return 0;
-}
-
-/* Checks for record in *user_limit_list of user_id if
- * *user_limit_list doesn't exist it will create it, if the user_id
- * record doesn't exist it will add it to the list.
- * In all cases the user record is returned.
- */
+/* Return the used limits record of acct in the QOS, creating it if needed */
 static slurmdb_used_limits_t *_get_acct_used_limits(
-	List *acct_limit_list, char *acct)
-{
-	slurmdb_used_limits_t *used_limits;
-
-	xassert(acct_limit_list);
-
-	if (!*acct_limit_list)
-		*acct_limit_list = list_create(slurmdb_destroy_used_limits);
-
-	if (!(used_limits = list_find_first(*acct_limit_list,
-					    _find_used_limits_for_acct,
-					    acct))) {
-		int i = sizeof(uint64_t) * slurmctld_tres_cnt;
-
-		used_limits = xmalloc(sizeof(slurmdb_used_limits_t));
-		used_limits->acct = xstrdup(acct);
-
-		used_limits->tres = xmalloc(i);
-		used_limits->tres_run_mins = xmalloc(i);
-
-		list_append(*acct_limit_list, used_limits);
-	}
-
-	return used_limits;
-}
-
-static int _find_used_limits_for_user(void *x, void *key)
+	slurmdb_qos_usage_t *usage, char *acct)
 {
-	slurmdb_used_limits_t *used_limits = (slurmdb_used_limits_t *)x;
-	uint32_t user_id = *(uint32_t *)key;
-
-	if (used_limits->uid == user_id)
-		return 1;
-
-	return 0;
+	return slurmdb_get_acct_used_limits(usage, acct, slurmctld_tres_cnt);
 }
 
-/* Checks for record in *user_limit_list of user_id if
- * *user_limit_list doesn't exist it will create it, if the user_id
- * record doesn't exist it will add it to the list.
- * In all cases the user record is returned.
- */
+/* Return the used limits record of user_id in the QOS, creating it if
+ * needed */
 static slurmdb_used_limits_t *_get_user_used_limits(
-	List *user_limit_list, uint32_t user_id)
+	slurmdb_qos_usage_t *usage, uint32_t user_id)
 {
-	slurmdb_used_limits_t *used_limits;
-
-	xassert(user_limit_list);
-
-	if (!*user_limit_list)
-		*user_limit_list = list_create(slurmdb_destroy_used_limits);
-
-	if (!(used_limits = list_find_first(*user_limit_list,
-					    _find_used_limits_for_user,
-					    &user_id))) {
-		int i = sizeof(uint64_t) * slurmctld_tres_cnt;
-
-		used_limits = xmalloc(sizeof(slurmdb_used_limits_t));
-		used_limits->uid = user_id;
-
-		used_limits->tres = xmalloc(i);
-		used_limits->tres_run_mins = xmalloc(i);
-
-		list_append(*user_limit_list, used_limits);
-	}
-
-	return used_limits;
+	return slurmdb_get_user_used_limits(usage, user_id,
+					    slurmctld_tres_cnt);
 }
 
 static bool _valid_job_assoc(struct job_record *job_ptr)
@@ -471,10 +401,10 @@ static void _qos_adjust_limit_usage(int type, struct job_record *job_ptr,
 	if (!qos_ptr || !assoc_ptr)
 		return;
 
-	used_limits_a =	_get_acct_used_limits(&qos_ptr->usage->acct_limit_list,
+	used_limits_a =	_get_acct_used_limits(qos_ptr->usage,
 					      assoc_ptr->acct);
 
-	used_limits = _get_user_used_limits(&qos_ptr->usage->user_limit_list,
+	used_limits = _get_user_used_limits(qos_ptr->usage,
 					    job_ptr->user_id);
 
 	switch(type) {
@@ -1440,7 +1370,7 @@ static int _qos_policy_validate(job_desc_msg_t *job_desc,
 	    (qos_ptr->max_submit_jobs_pa != INFINITE)) {
 		slurmdb_used_limits_t *used_limits =
 			_get_acct_used_limits(
-				&qos_ptr->usage->acct_limit_list,
+				qos_ptr->usage,
 				assoc_ptr->acct);
 
 		qos_out_ptr->max_submit_jobs_pa = qos_ptr->max_submit_jobs_pa;
@@ -1462,7 +1392,7 @@ static int _qos_policy_validate(job_desc_msg_t *job_desc,
 	    (qos_ptr->max_submit_jobs_pu != INFINITE)) {
 		slurmdb_used_limits_t *used_limits =
 			_get_user_used_limits(
-				&qos_ptr->usage->user_limit_list,
+				qos_ptr->usage,
 				job_desc->user_id);
 
 		qos_out_ptr->max_submit_jobs_pu = qos_ptr->max_submit_jobs_pu;
@@ -1532,10 +1462,10 @@ static int _qos_job_runnable_pre_select(struct job_record *job_ptr,
 
 	wall_mins = qos_ptr->usage->grp_used_wall / 60;
 
-	used_limits_a =	_get_acct_used_limits(&qos_ptr->usage->acct_limit_list,
+	used_limits_a =	_get_acct_used_limits(qos_ptr->usage,
 					      assoc_ptr->acct);
 
-	used_limits = _get_user_used_limits(&qos_ptr->usage->user_limit_list,
+	used_limits = _get_user_used_limits(qos_ptr->usage,
 					    job_ptr->user_id);
 
 
@@ -1738,10 +1668,10 @@ static int _qos_job_runnable_post_select(struct job_record *job_ptr,
 			(uint64_t)(qos_ptr->usage->usage_tres_raw[i] / 60.0);
 	}
 
-	used_limits_a =	_get_acct_used_limits(&qos_ptr->usage->acct_limit_list,
+	used_limits_a =	_get_acct_used_limits(qos_ptr->usage,
 					      assoc_ptr->acct);
 
-	used_limits = _get_user_used_limits(&qos_ptr->usage->user_limit_list,
+	used_limits = _get_user_used_limits(qos_ptr->usage,
 					    job_ptr->user_id);
 
 	i = _validate_tres_usage_limits_for_qos(
@@ -46,6 +46,7 @@
 
 #include <errno.h>
 #include <grp.h>
+#include <poll.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
@@ -194,6 +195,25 @@ static pthread_cond_t server_thread_cond = PTHREAD_COND_INITIALIZER;
 static pid_t	slurmctld_pid;
 static char *	slurm_conf_filename;
 
+/*
+ * Persistent connections opened by slurmd daemons configured with
+ * CommunicationParameters=persist_node_conn. Idle connections are polled by
+ * _slurmctld_persist_node_mgr(), which hands each RPC received on them to a
+ * server thread, just like a new connection accepted by _slurmctld_rpc_mgr().
+ */
+typedef struct {
+	slurm_addr_t addr;	/* address of the slurmd */
+	bool busy;		/* RPC being processed by a server thread */
+	slurm_persist_conn_t *persist_conn;
+} persist_node_conn_t;
+
+static List		persist_node_conn_list = NULL;
+static int		persist_node_conn_max = 0;
+static bool		persist_node_mgr_running = false;
+static pthread_mutex_t	persist_node_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int		persist_node_pipe[2] = { -1, -1 };
+static pthread_t	thread_id_persist_node = (pthread_t) 0;
+
 /*
  * Static list of signals to block in this process
  * *Must be zero-terminated*
@@ -226,6 +246,10 @@ static void *       _service_connection(void *arg);
 static void         _set_work_dir(void);
 static int          _shutdown_backup_controller(int wait_time);
 static void *       _slurmctld_background(void *no_data);
+#ifdef MEMORY_LEAK_DEBUG
+static void         _persist_node_fini(void);
+#endif
+static void *       _slurmctld_persist_node_mgr(void *no_data);
 static void *       _slurmctld_rpc_mgr(void *no_data);
 static void *       _slurmctld_signal_hand(void *no_data);
 static void         _test_thread_limit(void);
@@ -546,6 +570,12 @@ int main(int argc, char **argv)
 			error("pthread_create error %m");
 			sleep(1);
 		}
+		while (pthread_create(&thread_id_persist_node,
+				      &thread_attr, _slurmctld_persist_node_mgr,
+				      NULL)) {
+			error("pthread_create error %m");
+			sleep(1);
+		}
 		slurm_attr_destroy(&thread_attr);
 
 		clusteracct_storage_g_register_ctld(
@@ -611,7 +641,9 @@ int main(int argc, char **argv)
 		shutdown_state_save();
 		pthread_join(slurmctld_config.thread_id_sig,  NULL);
 		pthread_join(slurmctld_config.thread_id_rpc,  NULL);
+		pthread_join(thread_id_persist_node, NULL);
 		pthread_join(slurmctld_config.thread_id_save, NULL);
+		thread_id_persist_node = (pthread_t) 0;
 		slurmctld_config.thread_id_sig  = (pthread_t) 0;
 		slurmctld_config.thread_id_rpc  = (pthread_t) 0;
 		slurmctld_config.thread_id_save = (pthread_t) 0;
@@ -694,6 +726,7 @@ int main(int argc, char **argv)
 	assoc_mgr_fini(slurmctld_conf.state_save_location);
 	reserve_port_config(NULL);
 	free_rpc_stats();
+	_persist_node_fini();
 
 	/* Some plugins are needed to purge job/node data structures,
 	 * unplug after other data structures are purged */
@@ -1128,6 +1161,300 @@ cleanup:
 	return return_code;
 }
 
+static void _persist_node_conn_free(void *x)
+{
+	persist_node_conn_t *node_conn = (persist_node_conn_t *) x;
+
+	if (node_conn) {
+		slurm_persist_conn_destroy(node_conn->persist_conn);
+		xfree(node_conn);
+	}
+}
+
+static int _find_persist_node_conn(void *x, void *key)
+{
+	return (x == key);
+}
+
+/* Remove a connection from persist_node_conn_list and free it.
+ * persist_node_mutex must be locked by the caller. */
+static void _persist_node_conn_del(persist_node_conn_t *node_conn)
+{
+	list_delete_all(persist_node_conn_list, _find_persist_node_conn,
+			node_conn);
+}
+
+/* Wake up _slurmctld_persist_node_mgr() to rebuild its poll set */
+static void _persist_node_mgr_wake(void)
+{
+	char c = 0;
+
+	if ((persist_node_pipe[1] >= 0) &&
+	    (write(persist_node_pipe[1], &c, 1) != 1) && (errno != EAGAIN))
+		error("%s: write: %m", __func__);
+}
+
+#ifdef MEMORY_LEAK_DEBUG
+/* Free the persistent node connection list and wake up pipe, kept by
+ * _slurmctld_persist_node_mgr() from one run to the next */
+static void _persist_node_fini(void)
+{
+	slurm_mutex_lock(&persist_node_mutex);
+	FREE_NULL_LIST(persist_node_conn_list);
+	if (persist_node_pipe[0] >= 0) {
+		(void) close(persist_node_pipe[0]);
+		(void) close(persist_node_pipe[1]);
+		persist_node_pipe[0] = persist_node_pipe[1] = -1;
+	}
+	slurm_mutex_unlock(&persist_node_mutex);
+}
+#endif
+
+/*
+ * persist_node_conn_add - Add a persistent connection opened by a slurmd
+ *	to the set serviced by slurmctld
+ * IN persist_conn - connection, owned by slurmctld on success
+ * IN addr - address of the slurmd
+ * OUT comment - reason for a failure, xfree'd by caller
+ * RET SLURM_SUCCESS or error code
+ */
+extern int persist_node_conn_add(slurm_persist_conn_t *persist_conn,
+				 slurm_addr_t *addr, char **comment)
+{
+	persist_node_conn_t *node_conn;
+	int rc = SLURM_SUCCESS;
+
+	slurm_mutex_lock(&persist_node_mutex);
+	if (!persist_node_mgr_running) {
+		*comment = xstrdup("persistent node connections not ready");
+		rc = SLURM_ERROR;
+	} else if (list_count(persist_node_conn_list) >=
+		   persist_node_conn_max) {
+		*comment = xstrdup_printf("persistent node connection limit "
+					  "(%d) reached",
+					  persist_node_conn_max);
+		rc = SLURM_ERROR;
+	} else {
+		node_conn = xmalloc(sizeof(persist_node_conn_t));
+		node_conn->persist_conn = persist_conn;
+		node_conn->addr = *addr;
+		list_append(persist_node_conn_list, node_conn);
+		debug2("%s: persistent node connection from %s (fd %d)",
+		       __func__, persist_conn->rem_host, persist_conn->fd);
+	}
+	slurm_mutex_unlock(&persist_node_mutex);
+
+	if (rc == SLURM_SUCCESS)
+		_persist_node_mgr_wake();
+	else
+		debug("%s: %s", __func__, *comment);
+
+	return rc;
+}
+
+/* Process one RPC received on a persistent node connection */
+static void *_service_persist_node_conn(void *arg)
+{
+	persist_node_conn_t *node_conn = (persist_node_conn_t *) arg;
+	slurm_persist_conn_t *persist_conn = node_conn->persist_conn;
+	persist_msg_t persist_msg;
+	slurm_msg_t msg;
+	Buf buffer;
+	int rc;
+
+#if HAVE_SYS_PRCTL_H
+	if (prctl(PR_SET_NAME, "srvpn", NULL, NULL, NULL) < 0) {
+		error("%s: cannot set my name to %s %m", __func__, "srvpn");
+	}
+#endif
+	if (!(buffer = slurm_persist_recv_msg(persist_conn))) {
+		/* Connection closed by the slurmd */
+		slurm_mutex_lock(&persist_node_mutex);
+		_persist_node_conn_del(node_conn);
+		slurm_mutex_unlock(&persist_node_mutex);
+		goto fini;
+	}
+	memset(&persist_msg, 0, sizeof(persist_msg_t));
+	rc = slurm_persist_msg_unpack(persist_conn, &persist_msg, buffer);
+	free_buf(buffer);
+	if (rc != SLURM_SUCCESS) {
+		error("%s: failed to unpack message from %s",
+		      __func__, persist_conn->rem_host);
+		slurm_mutex_lock(&persist_node_mutex);
+		_persist_node_conn_del(node_conn);
+		slurm_mutex_unlock(&persist_node_mutex);
+		goto fini;
+	}
+
+	slurm_msg_t_init(&msg);
+	msg.address = node_conn->addr;
+	msg.auth_cred = persist_conn->auth_cred;
+	msg.conn = persist_conn;
+	msg.conn_fd = persist_conn->fd;
+	msg.data = persist_msg.data;
+	msg.msg_type = persist_msg.msg_type;
+	msg.protocol_version = persist_conn->version;
+
+	if (slurm_persist_ctld_msg_type(msg.msg_type)) {
+		slurmctld_req(&msg, NULL);
+	} else {
+		error("%s: invalid RPC %s from %s", __func__,
+		      rpc_num2string(msg.msg_type), persist_conn->rem_host);
+		slurm_send_rc_msg(&msg, SLURM_UNEXPECTED_MSG_ERROR);
+	}
+	slurm_free_msg_data(msg.msg_type, msg.data);
+
+	slurm_mutex_lock(&persist_node_mutex);
+	if (!persist_node_mgr_running) {
+		/* _slurmctld_persist_node_mgr() only frees idle connections
+		 * when it exits */
+		_persist_node_conn_del(node_conn);
+	} else
+		node_conn->busy = false;
+	slurm_mutex_unlock(&persist_node_mutex);
+	_persist_node_mgr_wake();
+
+fini:
+	server_thread_decr();
+	return NULL;
+}
+
+/*
+ * _slurmctld_persist_node_mgr - Poll idle persistent node connections and
+ *	create a pthread for each RPC received on them
+ */
+static void *_slurmctld_persist_node_mgr(void *no_data)
+{
+	struct pollfd *ufds = NULL;
+	persist_node_conn_t **node_conns = NULL, *node_conn;
+	pthread_t thread_id;
+	pthread_attr_t thread_attr;
+	ListIterator itr;
+	char buf[64];
+	int i, nfds, size = 0;
+#ifdef RLIMIT_NOFILE
+	struct rlimit rlim;
+#endif
+
+#if HAVE_SYS_PRCTL_H
+	if (prctl(PR_SET_NAME, "pnodemgr", NULL, NULL, NULL) < 0) {
+		error("%s: cannot set my name to %s %m", __func__, "pnodemgr");
+	}
+#endif
+
+	slurm_attr_init(&thread_attr);
+	if (pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED))
+		fatal("pthread_attr_setdetachstate %m");
+
+	/* The pipe and list are kept when resuming control after having been
+	 * in standby mode */
+	slurm_mutex_lock(&persist_node_mutex);
+	if (persist_node_pipe[0] < 0) {
+		if (pipe(persist_node_pipe) < 0)
+			fatal("%s: pipe: %m", __func__);
+		fd_set_nonblocking(persist_node_pipe[0]);
+		fd_set_nonblocking(persist_node_pipe[1]);
+		fd_set_close_on_exec(persist_node_pipe[0]);
+		fd_set_close_on_exec(persist_node_pipe[1]);
+	}
+	/* Leave half of the file descriptors for regular connections */
+	persist_node_conn_max = max_server_threads;
+#ifdef RLIMIT_NOFILE
+	if ((getrlimit(RLIMIT_NOFILE, &rlim) == 0) &&
+	    (rlim.rlim_cur != RLIM_INFINITY))
+		persist_node_conn_max = rlim.rlim_cur / 2;
+#endif
+	if (!persist_node_conn_list)
+		persist_node_conn_list = list_create(_persist_node_conn_free);
+	persist_node_mgr_running = true;
+	slurm_mutex_unlock(&persist_node_mutex);
+
+	while (!slurmctld_config.shutdown_time) {
+		slurm_mutex_lock(&persist_node_mutex);
+		if ((list_count(persist_node_conn_list) + 1) > size) {
+			size = list_count(persist_node_conn_list) + 1;
+			xrealloc(ufds, sizeof(struct pollfd) * size);
+			xrealloc(node_conns, sizeof(persist_node_conn_t *) *
+				 size);
+		}
+		ufds[0].fd = persist_node_pipe[0];
+		ufds[0].events = POLLIN;
+		nfds = 1;
+		itr = list_iterator_create(persist_node_conn_list);
+		while ((node_conn = list_next(itr))) {
+			if (node_conn->busy)
+				continue;
+			ufds[nfds].fd = node_conn->persist_conn->fd;
+			ufds[nfds].events = POLLIN;
+			node_conns[nfds++] = node_conn;
+		}
+		list_iterator_destroy(itr);
+		slurm_mutex_unlock(&persist_node_mutex);
+
+		/* Timeout to notice shutdown */
+		if ((i = poll(ufds, nfds, 1000)) <= 0) {
+			if ((i < 0) && (errno != EINTR))
+				error("%s: poll: %m", __func__);
+			continue;
+		}
+		if (ufds[0].revents & POLLIN) {
+			while (read(persist_node_pipe[0], buf, sizeof(buf)) > 0)
+				;
+		}
+
+		for (i = 1; i < nfds; i++) {
+			if (!ufds[i].revents)
+				continue;
+			node_conn = node_conns[i];
+			slurm_mutex_lock(&persist_node_mutex);
+			if (!(ufds[i].revents & POLLIN)) {
+				/* POLLHUP, POLLERR or POLLNVAL */
+				debug2("%s: persistent node connection from %s "
+				       "closed", __func__,
+				       node_conn->persist_conn->rem_host);
+				_persist_node_conn_del(node_conn);
+				slurm_mutex_unlock(&persist_node_mutex);
+				continue;
+			}
+			node_conn->busy = true;
+			slurm_mutex_unlock(&persist_node_mutex);
+
+			if (!_wait_for_server_thread()) {
+				/* shutdown */
+				slurm_mutex_lock(&persist_node_mutex);
+				node_conn->busy = false;
+				slurm_mutex_unlock(&persist_node_mutex);
+				break;
+			}
+			if (pthread_create(&thread_id, &thread_attr,
+					   _service_persist_node_conn,
+					   (void *) node_conn)) {
+				error("pthread_create: %m");
+				slurmctld_diag_stats.proc_req_raw++;
+				_service_persist_node_conn((void *) node_conn);
+			}
+		}
+	}
+
+	debug3("%s shutting down", __func__);
+	/* Running RPCs free their connections when done with them, see
+	 * _service_persist_node_conn() */
+	slurm_mutex_lock(&persist_node_mutex);
+	persist_node_mgr_running = false;
+	itr = list_iterator_create(persist_node_conn_list);
+	while ((node_conn = list_next(itr))) {
+		if (!node_conn->busy)
+			list_delete_item(itr);
+	}
+	list_iterator_destroy(itr);
+	slurm_mutex_unlock(&persist_node_mutex);
+
+	slurm_attr_destroy(&thread_attr);
+	xfree(ufds);
+	xfree(node_conns);
+	return NULL;
+}
+
 /* Increment slurmctld_config.server_thread_count and don't return
  * until its value is no larger than MAX_SERVER_THREADS,
  * RET true unless shutdown in progress */
@@ -1780,12 +2107,15 @@ static void *_slurmctld_background(void *no_data)
 		}
 
 		if (slurmctld_conf.health_check_interval &&
-		    (difftime(now, last_health_check_time) >=
-		     slurmctld_conf.health_check_interval) &&
+		    ((difftime(now, last_health_check_time) >=
+		      slurmctld_conf.health_check_interval) ||
+		     is_health_check_pending()) &&
 		    is_ping_done()) {
 			if (slurmctld_conf.health_check_node_state &
 			     HEALTH_CHECK_CYCLE) {
 				/* Call run_health_check() on each cycle */
+			} else if (is_health_check_pending()) {
+				/* Continue HealthCheckJitter spread */
 			} else {
 				now = time(NULL);
 				last_health_check_time = now;
@@ -2215,6 +2545,7 @@ extern void set_cluster_tres(bool assoc_mgr_locked)
 				node_ptr->tres_cnt,
 				TRES_STR_CONVERT_UNITS,
 				true);
+		invalidate_node_pack(node_ptr);
 	}
 
 	/* FIXME: cluster_cpus probably needs to be removed and handled
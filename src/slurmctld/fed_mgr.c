@@ -51,6 +51,7 @@
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/slurmctld/fed_mgr.h"
+#include "src/slurmctld/job_scheduler.h"
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmdbd/read_config.h"
@@ -2482,8 +2483,10 @@ extern int fed_mgr_job_revoke(struct job_record *job_ptr, bool job_complete,
 
 	/* remove JOB_REVOKED for completed jobs so that job shows completed on
 	 * controller. */
-	if (job_complete)
+	if (job_complete) {
 		job_ptr->job_state &= ~JOB_REVOKED;
+		depend_job_update(job_ptr);
+	}
 
 	/* Don't remove the origin job */
 	if (origin_id == fed_mgr_cluster_rec->fed.id)
@@ -2755,6 +2758,7 @@ extern int fed_mgr_job_requeue(struct job_record *job_ptr)
 
 	job_ptr->job_state &= (~JOB_REQUEUE_FED);
 	job_ptr->job_state &= (~JOB_REVOKED);
+	depend_job_update(job_ptr);
 
 	return rc;
 }
@@ -140,7 +140,10 @@ static uint32_t job_id_sequence = 0;	/* first job_id to assign new job */
 static struct   job_record **job_hash = NULL;
 static struct   job_record **job_array_hash_j = NULL;
 static struct   job_record **job_array_hash_t = NULL;
+static struct   job_record **job_name_hash = NULL;
 static bool     kill_invalid_dep;
+static List    *node_reg_job_index = NULL;	/* running jobs by node */
+static bitstr_t *node_reg_job_bitmap = NULL;	/* nodes indexed above */
 static time_t   last_file_write_time = (time_t) 0;
 static uint32_t max_array_size = NO_VAL;
 static bool	purge_quit = false;
@@ -152,6 +155,7 @@ static int	select_serial = -1;
 /* Local functions */
 static void _add_job_hash(struct job_record *job_ptr);
 static void _add_job_array_hash(struct job_record *job_ptr);
+static void _add_job_name_hash(struct job_record *job_ptr);
 static int  _checkpoint_job_record (struct job_record *job_ptr,
 				    char *image_dir);
 static void _clear_job_gres_details(struct job_record *job_ptr);
@@ -212,6 +216,7 @@ static int   _read_data_from_file(int fd, char *file_name, char **data);
 static char *_read_job_ckpt_file(char *ckpt_file, int *size_ptr);
 static void _remove_defunct_batch_dirs(List batch_dirs);
 static void _remove_job_hash(struct job_record *job_ptr);
+static void _remove_job_name_hash(struct job_record *job_ptr);
 static int  _reset_detail_bitmaps(struct job_record *job_ptr);
 static void _reset_step_bitmaps(struct job_record *job_ptr);
 static void _resp_array_add(resp_array_struct_t **resp,
@@ -1808,6 +1813,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 	xfree(job_ptr->mcs_label);
 	job_ptr->mcs_label    = mcs_label;
 	mcs_label	      = NULL;   /* reused, nothing left to free */
+	_remove_job_name_hash(job_ptr);	/* in case duplicate record */
 	xfree(job_ptr->name);		/* in case duplicate record */
 	job_ptr->name         = name;
 	name                  = NULL;	/* reused, nothing left to free */
@@ -1925,6 +1931,7 @@ static int _load_job_state(Buf buffer, uint16_t protocol_version)
 
 	_add_job_hash(job_ptr);
 	_add_job_array_hash(job_ptr);
+	_add_job_name_hash(job_ptr);
 
 	memset(&assoc_rec, 0, sizeof(slurmdb_assoc_rec_t));
 
@@ -2429,6 +2436,97 @@ static void _remove_job_hash(struct job_record *job_entry)
 	job_entry->job_next = NULL;
 }
 
+/* _job_name_hash_inx - hash index for a user ID and job name pair */
+static int _job_name_hash_inx(uint32_t user_id, char *name)
+{
+	uint32_t hash = user_id;
+
+	if (name) {
+		for ( ; *name; name++)
+			hash = (hash * 31) + (unsigned char) *name;
+	}
+	return (int) (hash % hash_table_size);
+}
+
+/* _add_job_name_hash - add a job name hash entry for given job record,
+ *	user_id and name must already be set
+ * IN job_ptr - pointer to job record
+ * Globals: job name hash table updated
+ */
+static void _add_job_name_hash(struct job_record *job_ptr)
+{
+	int inx;
+
+	inx = _job_name_hash_inx(job_ptr->user_id, job_ptr->name);
+	job_ptr->job_name_next = job_name_hash[inx];
+	job_name_hash[inx] = job_ptr;
+}
+
+/* _remove_job_name_hash - remove a job name hash entry for given job record,
+ *	if present. Must be called before changing the job's user_id or name.
+ * IN job_ptr - pointer to job record
+ * Globals: job name hash table updated
+ */
+static void _remove_job_name_hash(struct job_record *job_entry)
+{
+	struct job_record *job_ptr, **job_pptr;
+
+	job_pptr = &job_name_hash[_job_name_hash_inx(job_entry->user_id,
+						     job_entry->name)];
+	while (((job_ptr = *job_pptr) != NULL) && (job_ptr != job_entry))
+		job_pptr = &job_ptr->job_name_next;
+	if (job_ptr)
+		*job_pptr = job_entry->job_name_next;
+	job_entry->job_name_next = NULL;
+}
+
+/* Return true if any job in the given job name hash chain blocks the
+ * singleton dependency of job_ptr */
+static bool _singleton_blocked(struct job_record *job_ptr, int inx,
+			       char *name)
+{
+	struct job_record *qjob_ptr;
+
+	for (qjob_ptr = job_name_hash[inx]; qjob_ptr;
+	     qjob_ptr = qjob_ptr->job_name_next) {
+		if ((qjob_ptr->user_id != job_ptr->user_id) ||
+		    (qjob_ptr == job_ptr))
+			continue;
+		if (name && qjob_ptr->name && xstrcmp(name, qjob_ptr->name))
+			continue;
+		if (!name && qjob_ptr->name)
+			continue;
+		/* already running/suspended job or previously
+		 * submitted pending job */
+		if (IS_JOB_RUNNING(qjob_ptr) ||
+		    IS_JOB_SUSPENDED(qjob_ptr) ||
+		    (IS_JOB_PENDING(qjob_ptr) &&
+		     (qjob_ptr->job_id < job_ptr->job_id)))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Return true if some other job of the same user and name prevents this
+ * job's singleton dependency from being satisfied (the other job is running,
+ * suspended, or pending with a lower job ID). Jobs lacking a name are
+ * considered to match any name.
+ */
+extern bool test_job_singleton_blocked(struct job_record *job_ptr)
+{
+	int inx, null_inx;
+
+	inx = _job_name_hash_inx(job_ptr->user_id, job_ptr->name);
+	if (_singleton_blocked(job_ptr, inx, job_ptr->name))
+		return true;
+	null_inx = _job_name_hash_inx(job_ptr->user_id, NULL);
+	if (job_ptr->name && (null_inx != inx) &&
+	    _singleton_blocked(job_ptr, null_inx, NULL))
+		return true;
+	return false;
+}
+
 /* _add_job_array_hash - add a job hash entry for given job record,
  *	array_job_id and array_task_id must already be set
  * IN job_ptr - pointer to job record
@@ -3532,6 +3630,8 @@ extern void rehash_jobs(void)
 			xmalloc(hash_table_size * sizeof(struct job_record *));
 		job_array_hash_t = (struct job_record **)
 			xmalloc(hash_table_size * sizeof(struct job_record *));
+		job_name_hash = (struct job_record **)
+			xmalloc(hash_table_size * sizeof(struct job_record *));
 	} else if (hash_table_size < (slurmctld_conf.max_job_cnt / 2)) {
 		/* If the MaxJobCount grows by too much, the hash table will
 		 * be ineffective without rebuilding. We don't presently bother
@@ -3651,6 +3751,8 @@ extern struct job_record *job_array_split(struct job_record *job_ptr)
 	job_ptr_pend->mail_user = xstrdup(job_ptr->mail_user);
 	job_ptr_pend->mcs_label = xstrdup(job_ptr->mcs_label);
 	job_ptr_pend->name = xstrdup(job_ptr->name);
+	job_ptr_pend->job_name_next = NULL;
+	_add_job_name_hash(job_ptr_pend);
 	job_ptr_pend->network = xstrdup(job_ptr->network);
 	job_ptr_pend->node_addr = NULL;
 	job_ptr_pend->node_bitmap = NULL;
@@ -3699,6 +3801,7 @@ extern struct job_record *job_array_split(struct job_record *job_ptr)
 	job_details = job_ptr->details;
 	details_new = job_ptr_pend->details;
 	memcpy(details_new, job_details, sizeof(struct job_details));
+	details_new->depend_test_seq = 0;
 	details_new->acctg_freq = xstrdup(job_details->acctg_freq);
 	if (job_details->argc) {
 		details_new->argv =
@@ -6945,6 +7048,8 @@ _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
 
 	job_ptr->user_id    = (uid_t) job_desc->user_id;
 	job_ptr->group_id   = (gid_t) job_desc->group_id;
+	_add_job_name_hash(job_ptr);
+	depend_job_update(job_ptr);
 	job_ptr->job_state  = JOB_PENDING;
 	job_ptr->time_limit = job_desc->time_limit;
 	job_ptr->deadline   = job_desc->deadline;
@@ -7925,6 +8030,9 @@ static void _list_delete_job(void *job_entry)
 		job_array_size = 1;
 	}
 
+	/* Remove the record from job name hash table */
+	_remove_job_name_hash(job_ptr);
+
 	/* Remove the record from job array hash tables, if applicable */
 	if (job_ptr->array_task_id != NO_VAL) {
 		job_pptr = &job_array_hash_j[
@@ -8170,6 +8278,50 @@ static bool _hide_job(struct job_record *job_ptr, uid_t uid,
 	return false;
 }
 
+/* Return true if the job's partition (any of them) is in the filter */
+static bool _job_part_match(struct job_record *job_ptr,
+			    job_filter_args_t *args)
+{
+	struct part_record *part_ptr;
+	ListIterator part_iterator;
+	bool match = false;
+
+	if (job_ptr->part_ptr_list) {
+		part_iterator = list_iterator_create(job_ptr->part_ptr_list);
+		while ((part_ptr = list_next(part_iterator))) {
+			if (job_filter_part_match(args, part_ptr->name)) {
+				match = true;
+				break;
+			}
+		}
+		list_iterator_destroy(part_iterator);
+		if (match)
+			return true;
+	}
+	if (job_ptr->part_ptr &&
+	    job_filter_part_match(args, job_ptr->part_ptr->name))
+		return true;
+
+	return job_filter_part_match(args, job_ptr->partition);
+}
+
+/*
+ * Return true if the job does not match the filter and should not be packed.
+ * The names of the filter were split once by the caller.
+ */
+static bool _filter_job(struct job_record *job_ptr, job_filter_args_t *args)
+{
+	if (!job_filter_match(args, job_ptr->job_id, job_ptr->array_job_id,
+			      job_ptr->user_id, job_ptr->job_state,
+			      job_ptr->account))
+		return true;
+
+	if (args->part_cnt && !_job_part_match(job_ptr, args))
+		return true;
+
+	return false;
+}
+
 /*
  * pack_all_jobs - dump all job information for all jobs in
  *	machine independent form (for network transmission)
@@ -8178,6 +8330,7 @@ static bool _hide_job(struct job_record *job_ptr, uid_t uid,
  * IN show_flags - job filtering options
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN filter - pack only jobs matching this filter if not NULL
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
  * NOTE: change _unpack_job_desc_msg() in common/slurm_protocol_pack.c
@@ -8185,11 +8338,12 @@ static bool _hide_job(struct job_record *job_ptr, uid_t uid,
  */
 extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
-			  uint16_t protocol_version)
+			  job_info_filter_t *filter, uint16_t protocol_version)
 {
 	ListIterator job_iterator;
 	struct job_record *job_ptr;
 	uint32_t jobs_packed = 0, tmp_offset;
+	job_filter_args_t args;
 	Buf buffer;
 
 	buffer_ptr[0] = NULL;
@@ -8202,12 +8356,21 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 	pack32(jobs_packed, buffer);
 	pack_time(time(NULL), buffer);
 
+	if (filter)
+		job_filter_args_init(&args, filter);
+
 	/* write individual job records */
 	part_filter_set(uid);
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
 		xassert (job_ptr->magic == JOB_MAGIC);
 
+		if ((filter_uid != NO_VAL) && (filter_uid != job_ptr->user_id))
+			continue;
+
+		if (filter && _filter_job(job_ptr, &args))
+			continue;
+
 		if (((show_flags & SHOW_ALL) == 0) && (uid != 0) &&
 		    _all_parts_hidden(job_ptr))
 			continue;
@@ -8215,14 +8378,13 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 		if (_hide_job(job_ptr, uid, show_flags))
 			continue;
 
-		if ((filter_uid != NO_VAL) && (filter_uid != job_ptr->user_id))
-			continue;
-
 		pack_job(job_ptr, show_flags, buffer, protocol_version, uid);
 		jobs_packed++;
 	}
 	list_iterator_destroy(job_iterator);
 	part_filter_clear();
+	if (filter)
+		job_filter_args_free(&args);
 
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
@@ -10934,8 +11096,11 @@ static int _update_job(struct job_record *job_ptr, job_desc_msg_t * job_specs,
 			debug("sched: update_job: new name identical to "
 			      "old name %u", job_ptr->job_id);
 		} else {
+			_remove_job_name_hash(job_ptr);
 			xfree(job_ptr->name);
 			job_ptr->name = xstrdup(job_specs->name);
+			_add_job_name_hash(job_ptr);
+			depend_flush();
 
 			info("sched: update_job: setting name to %s for "
 			     "job_id %u", job_ptr->name, job_ptr->job_id);
@@ -12055,6 +12220,61 @@ validate_jobs_on_node(slurm_node_registration_status_msg_t *reg_msg)
 	return;
 }
 
+/*
+ * validate_jobs_batch_begin - prepare to validate the jobs on a batch of
+ *	registering nodes with validate_jobs_on_node(). The running jobs on
+ *	each of the nodes are indexed with one pass over the job list rather
+ *	than a pass per registering node.
+ * IN node_bitmap - nodes whose registrations are in the batch
+ * NOTE: WRITE lock_slurmctld job and node must be held until the matching
+ *	validate_jobs_batch_end() call
+ */
+extern void validate_jobs_batch_begin(bitstr_t *node_bitmap)
+{
+	ListIterator job_iterator;
+	struct job_record *job_ptr;
+	int i, i_first, i_last;
+
+	validate_jobs_batch_end();
+	node_reg_job_index = xmalloc(sizeof(List) * node_record_count);
+	node_reg_job_bitmap = bit_copy(node_bitmap);
+
+	/* Index all running jobs, the job state is tested again when used
+	 * since it may change while earlier nodes in the batch validate */
+	job_iterator = list_iterator_create(job_list);
+	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
+		if ((!IS_JOB_RUNNING(job_ptr) && !IS_JOB_SUSPENDED(job_ptr)) ||
+		    !job_ptr->node_bitmap ||
+		    !bit_overlap(job_ptr->node_bitmap, node_reg_job_bitmap))
+			continue;
+		i_first = bit_ffs(job_ptr->node_bitmap);
+		i_last  = bit_fls(job_ptr->node_bitmap);
+		for (i = i_first; (i >= 0) && (i <= i_last); i++) {
+			if (!bit_test(job_ptr->node_bitmap, i) ||
+			    !bit_test(node_reg_job_bitmap, i))
+				continue;
+			if (!node_reg_job_index[i])
+				node_reg_job_index[i] = list_create(NULL);
+			list_append(node_reg_job_index[i], job_ptr);
+		}
+	}
+	list_iterator_destroy(job_iterator);
+}
+
+/* validate_jobs_batch_end - release the index built by
+ *	validate_jobs_batch_begin() */
+extern void validate_jobs_batch_end(void)
+{
+	int i;
+
+	if (!node_reg_job_index)
+		return;
+	for (i = 0; i < node_record_count; i++)
+		FREE_NULL_LIST(node_reg_job_index[i]);
+	xfree(node_reg_job_index);
+	FREE_NULL_BITMAP(node_reg_job_bitmap);
+}
+
 /* Purge any batch job that should have its script running on node
  * node_inx, but is not. Allow BatchStartTimeout + ResumeTimeout seconds
  * for startup.
@@ -12081,7 +12301,14 @@ static void _purge_missing_jobs(int node_inx, time_t now)
 	batch_startup_time  = now - batch_start_timeout;
 	batch_startup_time -= MIN(DEFAULT_MSG_TIMEOUT, msg_timeout);
 
-	job_iterator = list_iterator_create(job_list);
+	if (node_reg_job_bitmap && bit_test(node_reg_job_bitmap, node_inx)) {
+		/* Registration batch, only this node's jobs need testing */
+		if (!node_reg_job_index[node_inx])
+			return;
+		job_iterator = list_iterator_create(
+				node_reg_job_index[node_inx]);
+	} else
+		job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
 		if ((IS_JOB_CONFIGURING(job_ptr) ||
 		    (!IS_JOB_RUNNING(job_ptr) && !IS_JOB_SUSPENDED(job_ptr))) ||
@@ -12751,6 +12978,7 @@ void job_fini (void)
 	xfree(job_hash);
 	xfree(job_array_hash_j);
 	xfree(job_array_hash_t);
+	xfree(job_name_hash);
 	FREE_NULL_BITMAP(requeue_exit);
 	FREE_NULL_BITMAP(requeue_exit_hold);
 }
@@ -12834,6 +13062,7 @@ extern void job_completion_logger(struct job_record *job_ptr, bool requeue)
 
 	xassert(job_ptr);
 
+	depend_job_update(job_ptr);
 	acct_policy_remove_job_submit(job_ptr);
 	if (job_ptr->nodes) {
 		(void) bb_g_job_start_stage_out(job_ptr);
@@ -13699,8 +13928,10 @@ static int _job_requeue(uid_t uid, struct job_record *job_ptr, bool preempt,
 		return ESLURM_ACCESS_DENIED;
 	}
 
-	if (state & JOB_RECONFIG_FAIL)
+	if (state & JOB_RECONFIG_FAIL) {
 		node_features_g_get_node(job_ptr->nodes);
+		invalidate_node_pack(NULL);
+	}
 
 	/* If the partition was removed don't allow the job to be
 	 * requeued.  If it doesn't have details then something is very
@@ -13851,6 +14082,7 @@ reply:
 		job_ptr->state_desc =
 			xstrdup("job requeued in special exit state");
 		job_ptr->priority = 0;
+		depend_job_update(job_ptr);
 	}
 	if (state & JOB_REQUEUE_HOLD) {
 		job_ptr->state_reason = WAIT_HELD_USER;
@@ -15246,6 +15478,7 @@ extern bool job_hold_requeue(struct job_record *job_ptr)
 		job_ptr->job_state |= JOB_SPECIAL_EXIT;
 		job_ptr->state_reason = WAIT_HELD_USER;
 		job_ptr->priority = 0;
+		depend_job_update(job_ptr);
 	}
 
 	job_ptr->job_state &= ~JOB_REQUEUE;
@@ -133,6 +133,8 @@ static int sched_pend_thread = 0;
 static bool sched_running = false;
 static struct timeval sched_last = {0, 0};
 static uint32_t max_array_size = NO_VAL;
+static uint64_t depend_event_seq = 1;	/* bumped on dependency events */
+static uint64_t depend_flush_seq = 0;	/* depend_event_seq at last flush */
 #ifdef HAVE_ALPS_CRAY
 static int sched_min_interval = 1000000;
 #else
@@ -193,36 +195,6 @@ static double _get_system_usage()
 	return sys_usage_per;
 }
 
-/*
- * _build_user_job_list - build list of jobs for a given user
- *			  and an optional job name
- * IN  user_id - user id
- * IN  job_name - job name constraint
- * RET the job queue
- * NOTE: the caller must call FREE_NULL_LIST() on RET value to free memory
- */
-static List _build_user_job_list(uint32_t user_id, char* job_name)
-{
-	List job_queue;
-	ListIterator job_iterator;
-	struct job_record *job_ptr = NULL;
-
-	job_queue = list_create(NULL);
-	job_iterator = list_iterator_create(job_list);
-	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
-		xassert (job_ptr->magic == JOB_MAGIC);
-		if (job_ptr->user_id != user_id)
-			continue;
-		if (job_name && job_ptr->name &&
-		    xstrcmp(job_name, job_ptr->name))
-			continue;
-		list_append(job_queue, job_ptr);
-	}
-	list_iterator_destroy(job_iterator);
-
-	return job_queue;
-}
-
 static void _job_queue_append(List job_queue, struct job_record *job_ptr,
 			      struct part_record *part_ptr, uint32_t prio)
 {
@@ -2531,6 +2503,106 @@ static void _depend_list2str(struct job_record *job_ptr, bool set_or_flag)
 	list_iterator_destroy(depend_iter);
 }
 
+/*
+ * Note a state change of a job which other jobs may depend upon (creation,
+ * start, completion, requeue). Dependent jobs re-evaluate their dependencies
+ * on their next test, all others skip the evaluation.
+ * NOTE: job write lock must be locked before calling this
+ */
+extern void depend_job_update(struct job_record *job_ptr)
+{
+	struct job_record *meta_job_ptr;
+
+	job_ptr->depend_seq = ++depend_event_seq;
+
+	/* Dependencies on a job array as a whole reference the record
+	 * holding the array's job ID, so record task events there too */
+	if (job_ptr->array_job_id &&
+	    (job_ptr->array_job_id != job_ptr->job_id)) {
+		meta_job_ptr = find_job_record(job_ptr->array_job_id);
+		if (meta_job_ptr)
+			meta_job_ptr->depend_seq = depend_event_seq;
+	}
+}
+
+/*
+ * Force all jobs to fully re-evaluate their dependencies on the next test
+ * (e.g. a job's name changed, altering singleton dependencies).
+ */
+extern void depend_flush(void)
+{
+	depend_flush_seq = ++depend_event_seq;
+}
+
+/*
+ * Return true if none of the jobs this job depends upon changed state since
+ * its dependencies were last found unmet, so the previous result still holds.
+ * Each dependency costs a hash table lookup, singleton dependencies a walk of
+ * the jobs with the same user and name.
+ */
+static bool _depend_unchanged(struct job_record *job_ptr)
+{
+	struct job_details *detail_ptr = job_ptr->details;
+	ListIterator depend_iter;
+	struct depend_spec *dep_ptr;
+	struct job_record *djob_ptr;
+	bool unchanged = true;
+
+	if (detail_ptr->depend_test_seq == 0)
+		return false;
+	if (detail_ptr->depend_test_seq == depend_event_seq)
+		return true;	/* Nothing happened since last test */
+	if (detail_ptr->depend_test_seq < depend_flush_seq)
+		return false;
+
+	depend_iter = list_iterator_create(detail_ptr->depend_list);
+	while ((dep_ptr = list_next(depend_iter))) {
+		if (dep_ptr->depend_type == SLURM_DEPEND_EXPAND) {
+			/* Test has side effects on the job's limits */
+			unchanged = false;
+			break;
+		}
+		if (dep_ptr->depend_type == SLURM_DEPEND_SINGLETON) {
+			if (!job_ptr->name ||
+			    !test_job_singleton_blocked(job_ptr)) {
+				unchanged = false;
+				break;
+			}
+			continue;
+		}
+		if (dep_ptr->array_task_id == INFINITE) {
+			djob_ptr = find_job_record(dep_ptr->job_id);
+			if (djob_ptr && (dep_ptr->depend_type ==
+					 SLURM_DEPEND_AFTER_CORRESPOND) &&
+			    (job_ptr->array_task_id != NO_VAL) &&
+			    (job_ptr->array_task_id != INFINITE)) {
+				/* Test the corresponding task's record */
+				struct job_record *dcjob_ptr;
+				dcjob_ptr = find_job_array_rec(dep_ptr->job_id,
+							job_ptr->array_task_id);
+				if (dcjob_ptr && (dcjob_ptr->depend_seq >
+						  detail_ptr->depend_test_seq)) {
+					unchanged = false;
+					break;
+				}
+			}
+		} else {
+			djob_ptr = find_job_array_rec(dep_ptr->job_id,
+						      dep_ptr->array_task_id);
+		}
+		if (!djob_ptr ||
+		    (djob_ptr->depend_seq > detail_ptr->depend_test_seq)) {
+			unchanged = false;
+			break;
+		}
+	}
+	list_iterator_destroy(depend_iter);
+
+	if (unchanged)
+		detail_ptr->depend_test_seq = depend_event_seq;
+	return unchanged;
+}
+
 /*
  * Determine if a job's dependencies are met
  * RET: 0 = no dependencies
@@ -2539,51 +2611,33 @@ static void _depend_list2str(struct job_record *job_ptr, bool set_or_flag)
  */
 extern int test_job_dependency(struct job_record *job_ptr)
 {
-	ListIterator depend_iter, job_iterator;
+	ListIterator depend_iter;
 	struct depend_spec *dep_ptr;
 	bool failure = false, depends = false, rebuild_str = false;
 	bool or_satisfied = false;
- 	List job_queue = NULL;
- 	bool run_now;
 	int results = 0;
-	struct job_record *qjob_ptr, *djob_ptr, *dcjob_ptr;
+	struct job_record *djob_ptr, *dcjob_ptr;
 
 	if ((job_ptr->details == NULL) ||
 	    (job_ptr->details->depend_list == NULL) ||
 	    (list_count(job_ptr->details->depend_list) == 0))
 		return 0;
 
+	if (_depend_unchanged(job_ptr))
+		return 1;
+
 	depend_iter = list_iterator_create(job_ptr->details->depend_list);
 	while ((dep_ptr = list_next(depend_iter))) {
 		bool clear_dep = false;
 		dep_ptr->job_ptr = find_job_array_rec(dep_ptr->job_id,
 						      dep_ptr->array_task_id);
 		djob_ptr = dep_ptr->job_ptr;
- 		if ((dep_ptr->depend_type == SLURM_DEPEND_SINGLETON) &&
- 		    job_ptr->name) {
- 			/* get user jobs with the same user and name */
- 			job_queue = _build_user_job_list(job_ptr->user_id,
-							 job_ptr->name);
- 			run_now = true;
-			job_iterator = list_iterator_create(job_queue);
-			while ((qjob_ptr = (struct job_record *)
-					   list_next(job_iterator))) {
-				/* already running/suspended job or previously
-				 * submitted pending job */
-				if (IS_JOB_RUNNING(qjob_ptr) ||
-				    IS_JOB_SUSPENDED(qjob_ptr) ||
-				    (IS_JOB_PENDING(qjob_ptr) &&
-				     (qjob_ptr->job_id < job_ptr->job_id))) {
-					run_now = false;
-					break;
- 				}
- 			}
-			list_iterator_destroy(job_iterator);
-			FREE_NULL_LIST(job_queue);
+		if ((dep_ptr->depend_type == SLURM_DEPEND_SINGLETON) &&
+		    job_ptr->name) {
 			/* job can run now, delete dependency */
- 			if (run_now)
- 				list_delete_item(depend_iter);
- 			else
+			if (!test_job_singleton_blocked(job_ptr))
+				list_delete_item(depend_iter);
+			else
 				depends = true;
 		} else if ((djob_ptr == NULL) ||
 			   (djob_ptr->magic != JOB_MAGIC) ||
@@ -2742,6 +2796,11 @@ extern int test_job_dependency(struct job_record *job_ptr)
 	else if (depends)
 		results = 1;
 
+	if (results == 1)
+		job_ptr->details->depend_test_seq = depend_event_seq;
+	else
+		job_ptr->details->depend_test_seq = 0;
+
 	return results;
 }
 
@@ -2840,6 +2899,7 @@ extern int update_job_dependency(struct job_record *job_ptr, char *new_depend)
 
 	/* Clear dependencies on NULL, "0", or empty dependency input */
 	job_ptr->details->expanding_jobid = 0;
+	job_ptr->details->depend_test_seq = 0;
 	if ((new_depend == NULL) || (new_depend[0] == '\0') ||
 	    ((new_depend[0] == '0') && (new_depend[1] == '\0'))) {
 		xfree(job_ptr->details->dependency);
@@ -207,6 +207,20 @@ extern void sort_job_queue(List job_queue);
  *	in order of decreasing priority */
 extern int sort_job_queue2(void *x, void *y);
 
+/*
+ * Note a state change of a job which other jobs may depend upon (creation,
+ * start, completion, requeue). Dependent jobs re-evaluate their dependencies
+ * on their next test, all others skip the evaluation.
+ * NOTE: job write lock must be locked before calling this
+ */
+extern void depend_job_update(struct job_record *job_ptr);
+
+/*
+ * Force all jobs to fully re-evaluate their dependencies on the next test
+ * (e.g. a job's name changed, altering singleton dependencies).
+ */
+extern void depend_flush(void);
+
 /*
  * Determine if a job's dependencies are met
  * RET: 0 = no dependencies
@@ -98,6 +98,8 @@ bitstr_t *power_node_bitmap = NULL;	/* bitmap of powered down nodes */
 bitstr_t *share_node_bitmap = NULL;  	/* bitmap of sharable nodes */
 bitstr_t *up_node_bitmap    = NULL;  	/* bitmap of non-down nodes */
 
+static uint32_t node_pack_epoch = 1;	/* see invalidate_node_pack() */
+
 static void 	_dump_node_state (struct node_record *dump_node_ptr,
 				  Buf buffer);
 static front_end_record_t * _front_end_reg(
@@ -107,6 +109,9 @@ static void 	_make_node_down(struct node_record *node_ptr,
 				time_t event_time);
 static bool	_node_is_hidden(struct node_record *node_ptr, uid_t uid);
 static int	_open_node_state_file(char **state_file);
+static void	_pack_node_cached(struct node_record *dump_node_ptr,
+				  Buf buffer, uint16_t protocol_version,
+				  uint16_t show_flags);
 static void 	_pack_node(struct node_record *dump_node_ptr, Buf buffer,
 			   uint16_t protocol_version, uint16_t show_flags);
 static void	_sync_bitmaps(struct node_record *node_ptr, int job_count);
@@ -304,6 +309,8 @@ extern int load_all_node_state ( bool state_only )
 	bool power_save_mode = false;
 	uint16_t protocol_version = (uint16_t)NO_VAL;
 
+	invalidate_node_pack(NULL);
+
 	if (slurmctld_conf.suspend_program && slurmctld_conf.resume_program)
 		power_save_mode = true;
 
@@ -917,28 +924,91 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
 }
 
 /*
- * _pack_node - dump all configuration information about a specific node in
- *	machine independent form (for network transmission)
- * IN dump_node_ptr - pointer to node for which information is requested
- * IN/OUT buffer - buffer where data is placed, pointers automatically updated
- * IN protocol_version - slurm protocol version of client
- * IN show_flags -
- * NOTE: if you make any changes here be sure to make the corresponding changes
- * 	to _unpack_node_info_members() in common/slurm_protocol_pack.c
- * NOTE: READ lock_slurmctld config before entry
+ * invalidate_node_pack - discard the packed copy of a node's rarely changing
+ *	fields kept for node information responses
+ * IN node_ptr - node whose fields changed, NULL to invalidate all nodes
+ * NOTE: call after changing any field packed by _pack_node_static()
  */
-static void _pack_node (struct node_record *dump_node_ptr, Buf buffer,
-			uint16_t protocol_version, uint16_t show_flags)
+extern void invalidate_node_pack(struct node_record *node_ptr)
+{
+	if (node_ptr) {
+		if (node_ptr->pack_cache)
+			node_ptr->pack_cache->epoch = 0;
+	} else if (++node_pack_epoch == 0) {
+		node_pack_epoch = 1;
+	}
+}
+
+/* Pack the fields of a node record which change often (state, load, job
+ * allocations, etc.) and precede static segment "seg" of the record */
+static void _pack_node_dynamic(struct node_record *dump_node_ptr, Buf buffer,
+			       uint16_t protocol_version, uint16_t show_flags,
+			       int seg)
 {
 	char *gres_drain = NULL, *gres_used = NULL;
 
-	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
-		packstr (dump_node_ptr->name, buffer);
-		packstr (dump_node_ptr->node_hostname, buffer);
-		packstr (dump_node_ptr->comm_name, buffer);
-		pack16(dump_node_ptr->port, buffer);
+	switch (seg) {
+	case 0:
+		packstr(dump_node_ptr->name, buffer);
+		break;
+	case 1:
 		pack32(dump_node_ptr->node_state, buffer);
-		packstr (dump_node_ptr->version, buffer);
+		break;
+	case 2:
+		packstr(dump_node_ptr->mcs_label, buffer);
+		pack32(dump_node_ptr->owner, buffer);
+		break;
+	case 3:
+		pack32(dump_node_ptr->cpu_load, buffer);
+		pack64(dump_node_ptr->free_mem, buffer);
+		pack32(dump_node_ptr->config_ptr->weight, buffer);
+		pack32(dump_node_ptr->reason_uid, buffer);
+
+		pack_time(dump_node_ptr->boot_time, buffer);
+		pack_time(dump_node_ptr->reason_time, buffer);
+		pack_time(dump_node_ptr->slurmd_start_time, buffer);
+
+		select_g_select_nodeinfo_pack(dump_node_ptr->select_nodeinfo,
+					      buffer, protocol_version);
+		break;
+	case 4:
+		/* Gathering GRES details is slow, so don't by default */
+		if (show_flags & SHOW_DETAIL) {
+			gres_drain =
+				gres_get_node_drain(dump_node_ptr->gres_list);
+			gres_used  =
+				gres_get_node_used(dump_node_ptr->gres_list);
+		}
+		packstr(gres_drain, buffer);
+		packstr(gres_used, buffer);
+		xfree(gres_drain);
+		xfree(gres_used);
+
+		packstr(dump_node_ptr->os, buffer);
+		packstr(dump_node_ptr->reason, buffer);
+		acct_gather_energy_pack(dump_node_ptr->energy, buffer,
+					protocol_version);
+		ext_sensors_data_pack(dump_node_ptr->ext_sensors, buffer,
+				      protocol_version);
+		power_mgmt_data_pack(dump_node_ptr->power, buffer,
+				     protocol_version);
+		break;
+	}
+}
+
+/* Pack static segment "seg" of a node record, fields which change only on
+ * node registration, reconfiguration or administrator update */
+static void _pack_node_static(struct node_record *dump_node_ptr, Buf buffer,
+			      int seg)
+{
+	switch (seg) {
+	case 0:
+		packstr(dump_node_ptr->node_hostname, buffer);
+		packstr(dump_node_ptr->comm_name, buffer);
+		pack16(dump_node_ptr->port, buffer);
+		break;
+	case 1:
+		packstr(dump_node_ptr->version, buffer);
 		/* On a bluegene system always use the regular node
 		* infomation not what is in the config_ptr. */
 #ifndef HAVE_BG
@@ -964,24 +1034,13 @@ static void _pack_node (struct node_record *dump_node_ptr, Buf buffer,
 #ifndef HAVE_BG
 		}
 #endif
-		packstr(dump_node_ptr->mcs_label, buffer);
-		pack32(dump_node_ptr->owner, buffer);
+		break;
+	case 2:
 		pack16(dump_node_ptr->core_spec_cnt, buffer);
 		pack64(dump_node_ptr->mem_spec_limit, buffer);
 		packstr(dump_node_ptr->cpu_spec_list, buffer);
-
-		pack32(dump_node_ptr->cpu_load, buffer);
-		pack64(dump_node_ptr->free_mem, buffer);
-		pack32(dump_node_ptr->config_ptr->weight, buffer);
-		pack32(dump_node_ptr->reason_uid, buffer);
-
-		pack_time(dump_node_ptr->boot_time, buffer);
-		pack_time(dump_node_ptr->reason_time, buffer);
-		pack_time(dump_node_ptr->slurmd_start_time, buffer);
-
-		select_g_select_nodeinfo_pack(dump_node_ptr->select_nodeinfo,
-					      buffer, protocol_version);
-
+		break;
+	case 3:
 		packstr(dump_node_ptr->arch, buffer);
 		packstr(dump_node_ptr->features, buffer);
 		packstr(dump_node_ptr->features_act, buffer);
@@ -989,29 +1048,84 @@ static void _pack_node (struct node_record *dump_node_ptr, Buf buffer,
 			packstr(dump_node_ptr->gres, buffer);
 		else
 			packstr(dump_node_ptr->config_ptr->gres, buffer);
+		break;
+	case 4:
+		packstr(dump_node_ptr->tres_fmt_str, buffer);
+		break;
+	}
+}
 
-		/* Gathering GRES details is slow, so don't by default */
-		if (show_flags & SHOW_DETAIL) {
-			gres_drain =
-				gres_get_node_drain(dump_node_ptr->gres_list);
-			gres_used  =
-				gres_get_node_used(dump_node_ptr->gres_list);
+/*
+ * _pack_node_cached - pack a node record for protocol version 17.02 or
+ *	later, alternating the fields which change often with copies of the
+ *	node's packed static segments, which are rebuilt only when the node
+ *	has been invalidated (see invalidate_node_pack())
+ */
+static void _pack_node_cached(struct node_record *dump_node_ptr, Buf buffer,
+			      uint16_t protocol_version, uint16_t show_flags)
+{
+	node_pack_cache_t *cache = dump_node_ptr->pack_cache;
+	uint32_t seg_start, seg_size, cache_size = 0;
+	bool rebuild;
+	int seg;
+
+	if (!cache) {
+		cache = xmalloc(sizeof(node_pack_cache_t));
+		dump_node_ptr->pack_cache = cache;
+	}
+	rebuild = ((cache->epoch != node_pack_epoch) ||
+		   (cache->fast_schedule != slurmctld_conf.fast_schedule));
+
+	for (seg = 0; seg < NODE_PACK_SEG_CNT; seg++) {
+		_pack_node_dynamic(dump_node_ptr, buffer, protocol_version,
+				   show_flags, seg);
+		seg_start = seg ? cache->seg_end[seg - 1] : 0;
+		if (rebuild) {
+			uint32_t offset = get_buf_offset(buffer);
+			_pack_node_static(dump_node_ptr, buffer, seg);
+			seg_size = get_buf_offset(buffer) - offset;
+			if (seg_start + seg_size > cache_size) {
+				cache_size = seg_start + seg_size + 256;
+				xrealloc(cache->data, cache_size);
+			}
+			memcpy(cache->data + seg_start,
+			       get_buf_data(buffer) + offset, seg_size);
+			cache->seg_end[seg] = seg_start + seg_size;
+		} else {
+			seg_size = cache->seg_end[seg] - seg_start;
+			if (remaining_buf(buffer) < seg_size)
+				grow_buf(buffer, seg_size);
+			memcpy(get_buf_data(buffer) + get_buf_offset(buffer),
+			       cache->data + seg_start, seg_size);
+			set_buf_offset(buffer,
+				       get_buf_offset(buffer) + seg_size);
 		}
-		packstr(gres_drain, buffer);
-		packstr(gres_used, buffer);
-		xfree(gres_drain);
-		xfree(gres_used);
+	}
+	if (rebuild) {
+		cache->epoch = node_pack_epoch;
+		cache->fast_schedule = slurmctld_conf.fast_schedule;
+	}
+}
 
-		packstr(dump_node_ptr->os, buffer);
-		packstr(dump_node_ptr->reason, buffer);
-		acct_gather_energy_pack(dump_node_ptr->energy, buffer,
-					protocol_version);
-		ext_sensors_data_pack(dump_node_ptr->ext_sensors, buffer,
-				      protocol_version);
-		power_mgmt_data_pack(dump_node_ptr->power, buffer,
-				     protocol_version);
+/*
+ * _pack_node - dump all configuration information about a specific node in
+ *	machine independent form (for network transmission)
+ * IN dump_node_ptr - pointer to node for which information is requested
+ * IN/OUT buffer - buffer where data is placed, pointers automatically updated
+ * IN protocol_version - slurm protocol version of client
+ * IN show_flags -
+ * NOTE: if you make any changes here be sure to make the corresponding changes
+ * 	to _unpack_node_info_members() in common/slurm_protocol_pack.c
+ * NOTE: READ lock_slurmctld config before entry
+ */
+static void _pack_node (struct node_record *dump_node_ptr, Buf buffer,
+			uint16_t protocol_version, uint16_t show_flags)
+{
+	char *gres_drain = NULL, *gres_used = NULL;
 
-		packstr(dump_node_ptr->tres_fmt_str,buffer);
+	if (protocol_version >= SLURM_17_02_PROTOCOL_VERSION) {
+		_pack_node_cached(dump_node_ptr, buffer, protocol_version,
+				  show_flags);
 	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		packstr (dump_node_ptr->name, buffer);
 		packstr (dump_node_ptr->node_hostname, buffer);
@@ -1115,6 +1229,7 @@ void set_slurmd_addr (void)
 	DEF_TIMERS;
 
 	START_TIMER;
+	invalidate_node_pack(NULL);
 	for (i = 0; i < node_record_count; i++, node_ptr++) {
 		if ((node_ptr->name == NULL) ||
 		    (node_ptr->name[0] == '\0'))
@@ -1219,6 +1334,7 @@ int update_node ( update_node_msg_t * update_node_msg )
 	uint32_t base_state = 0, node_flags, state_val;
 	time_t now = time(NULL);
 
+	invalidate_node_pack(NULL);
 	if (update_node_msg->node_names == NULL ) {
 		info("update_node: invalid node name  %s",
 		       update_node_msg -> node_names );
@@ -1625,6 +1741,7 @@ extern void restore_node_features(int recover)
 	int i;
 	struct node_record *node_ptr;
 
+	invalidate_node_pack(NULL);
 	for (i=0, node_ptr=node_record_table_ptr; i<node_record_count;
 	     i++, node_ptr++) {
 		if (node_ptr->weight != node_ptr->config_ptr->weight) {
@@ -1774,6 +1891,7 @@ static int _update_node_active_features(char *node_names, char *active_features)
 	}
 	update_feature_list(active_feature_list, active_features, node_bitmap);
 	(void) node_features_g_node_update(active_features, node_bitmap);
+	invalidate_node_pack(NULL);
 	FREE_NULL_BITMAP(node_bitmap);
 
 	info("%s: nodes %s active features set to: %s",
@@ -2204,6 +2322,7 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg,
 		return ENOENT;
 	node_inx = node_ptr - node_record_table_ptr;
 	orig_node_avail = bit_test(avail_node_bitmap, node_inx);
+	invalidate_node_pack(node_ptr);
 
 	config_ptr = node_ptr->config_ptr;
 	error_code = SLURM_SUCCESS;
@@ -2730,6 +2849,7 @@ extern int validate_nodes_via_front_end(
 	front_end_ptr = _front_end_reg(reg_msg);
 	if (front_end_ptr == NULL)
 		return ESLURM_INVALID_NODE_NAME;
+	invalidate_node_pack(NULL);
 
 	front_end_ptr->protocol_version = protocol_version;
 	xfree(front_end_ptr->version);
@@ -3172,6 +3292,31 @@ void node_did_resp (char *name)
 	debug2("node_did_resp %s",name);
 }
 
+/*
+ * node_msg_received - record that an RPC was received from the slurmd on
+ *	the specified node, so ping_nodes() need not ping it again soon.
+ *	Unlike node_did_resp() this does not change the node's state, a node
+ *	not responding is still left for ping_nodes() or registration to
+ *	return to service.
+ * IN name - name of the node
+ * NOTE: WRITE lock_slurmctld node before entry
+ */
+extern void node_msg_received(char *name)
+{
+#ifdef HAVE_FRONT_END
+	front_end_record_t *node_ptr;
+	if (!name || !(node_ptr = find_front_end_record(name)))
+		return;
+#else
+	struct node_record *node_ptr;
+	if (!name || !(node_ptr = find_node_record(name)))
+		return;
+#endif
+	if (IS_NODE_NO_RESPOND(node_ptr))
+		return;
+	node_ptr->last_response = MAX(time(NULL), node_ptr->last_response);
+}
+
 /*
  * node_not_resp - record that the specified node is not responding
  * IN name - name of the node
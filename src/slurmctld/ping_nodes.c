@@ -61,6 +61,10 @@ static pthread_mutex_t lock_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int ping_count = 0;
 static time_t ping_start = 0;
 
+/* Start of the HealthCheckJitter spread health check now in progress,
+ * only used by the slurmctld background thread */
+static time_t jitter_start_time = (time_t) 0;
+
 /*
  * is_ping_done - test if the last node ping cycle has completed.
  *	Use this to avoid starting a new set of ping requests before the
@@ -370,6 +374,27 @@ void ping_nodes (void)
 	}
 }
 
+/* Offset in seconds into the HealthCheckJitter span at which the health
+ * check of the node at node_inx is started. Consecutive nodes are scattered
+ * across the span so nodes sharing a switch are not all checked at once. */
+static int _health_check_offset(int node_inx, int jitter)
+{
+	return (int) (((uint32_t) node_inx * 2654435761U) % jitter);
+}
+
+/*
+ * is_health_check_pending - test if a health check spread over
+ *	HealthCheckJitter still has nodes to start. If so run_health_check()
+ *	should be called again before the next HealthCheckInterval.
+ */
+extern bool is_health_check_pending(void)
+{
+	if (!slurmctld_conf.health_check_jitter ||
+	    (slurmctld_conf.health_check_node_state & HEALTH_CHECK_CYCLE))
+		return false;
+	return (jitter_start_time != (time_t) 0);
+}
+
 /* Spawn health check function for every node that is not DOWN */
 extern void run_health_check(void)
 {
@@ -378,7 +403,8 @@ extern void run_health_check(void)
 #else
 	struct node_record *node_ptr;
 	int node_test_cnt = 0, node_limit, node_states, run_cyclic;
-	static int base_node_loc = -1;
+	int jitter = 0, jitter_now = 0, offset;
+	static int base_node_loc = -1, jitter_done = -1;
 	static time_t cycle_start_time = (time_t) 0;
 #endif
 	int i;
@@ -433,6 +459,21 @@ extern void run_health_check(void)
 		node_limit = (node_record_count * 2) /
 			     slurmctld_conf.health_check_interval;
 		node_limit = MAX(node_limit, 10);
+	} else if (slurmctld_conf.health_check_jitter) {
+		/* Start the nodes whose offset into the jitter span has
+		 * been reached since the previous call */
+		time_t now = time(NULL);
+		jitter = MIN(slurmctld_conf.health_check_jitter,
+			     slurmctld_conf.health_check_interval);
+		if (jitter_start_time == (time_t) 0) {
+			jitter_start_time = now;
+			jitter_done = -1;
+		}
+		jitter_now = (int) difftime(now, jitter_start_time);
+		if (jitter_now >= (jitter - 1)) {
+			jitter_now = jitter - 1;
+			jitter_start_time = (time_t) 0;
+		}
 	}
 	if ((node_states != HEALTH_CHECK_NODE_ANY) &&
 	    (node_states != HEALTH_CHECK_NODE_IDLE)) {
@@ -457,6 +498,12 @@ extern void run_health_check(void)
 			node_ptr = node_record_table_ptr + base_node_loc;
 		} else {
 			node_ptr = node_record_table_ptr + i;
+			if (jitter) {
+				offset = _health_check_offset(i, jitter);
+				if ((offset <= jitter_done) ||
+				    (offset > jitter_now))
+					continue;
+			}
 		}
 		if (IS_NODE_NO_RESPOND(node_ptr) || IS_NODE_FUTURE(node_ptr) ||
 		    IS_NODE_POWER_SAVE(node_ptr))
@@ -506,6 +553,8 @@ extern void run_health_check(void)
 	}
 	if (run_cyclic && (i >= node_record_count))
 		base_node_loc = -1;
+	if (jitter)
+		jitter_done = jitter_now;
 #endif
 
 	if (check_agent_args->node_count == 0) {
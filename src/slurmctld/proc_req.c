@@ -107,10 +107,28 @@ static int rpc_user_size = 0;	/* Size of rpc_user_* arrays */
 static uint32_t *rpc_user_id = NULL;
 static uint32_t *rpc_user_cnt = NULL;
 static uint64_t *rpc_user_time = NULL;
+static int rpc_comp_size = 0;	/* Size of rpc_comp_* arrays */
+static char **rpc_comp_host = NULL;
+static uint32_t *rpc_comp_cnt = NULL;
+static uint32_t *rpc_comp_msg_cnt = NULL;
+static uint64_t *rpc_comp_time = NULL;
 
 static pthread_mutex_t throttle_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t throttle_cond = PTHREAD_COND_INITIALIZER;
 
+/* Node registrations waiting to be validated as a batch, see
+ * _node_reg_batch() */
+typedef struct {
+	slurm_msg_t *msg;
+	int error_code;
+	bool newly_up;
+	bool done;
+} node_reg_rec_t;
+static pthread_mutex_t node_reg_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t node_reg_cond = PTHREAD_COND_INITIALIZER;
+static List node_reg_queue = NULL;
+static bool node_reg_active = false;
+
 static void         _fill_ctld_conf(slurm_ctl_conf_t * build_ptr);
 static void         _kill_job_on_msg_fail(uint32_t job_id);
 static int          _is_prolog_finished(uint32_t job_id);
@@ -169,6 +187,9 @@ inline static void  _slurm_rpc_job_will_run(slurm_msg_t * msg, bool allow_sibs);
 inline static void  _slurm_rpc_job_alloc_info(slurm_msg_t * msg);
 inline static void  _slurm_rpc_job_alloc_info_lite(slurm_msg_t * msg);
 inline static void  _slurm_rpc_kill_job2(slurm_msg_t *msg);
+static void         _node_reg_batch(node_reg_rec_t *reg_rec);
+static bitstr_t *   _node_reg_bitmap(List batch);
+static void         _node_reg_validate(node_reg_rec_t *reg_rec);
 inline static void  _slurm_rpc_node_registration(slurm_msg_t *msg,
 						 bool running_composite);
 inline static void  _slurm_rpc_ping(slurm_msg_t * msg);
@@ -702,6 +723,7 @@ static void _fill_ctld_conf(slurm_ctl_conf_t * conf_ptr)
 	conf_ptr->checkpoint_type     = xstrdup(conf->checkpoint_type);
 	conf_ptr->chos_loc            = xstrdup(conf->chos_loc);
 	conf_ptr->cluster_name        = xstrdup(conf->cluster_name);
+	conf_ptr->comm_params         = xstrdup(conf->comm_params);
 	conf_ptr->complete_wait       = conf->complete_wait;
 	conf_ptr->control_addr        = xstrdup(conf->control_addr);
 	conf_ptr->control_machine     = xstrdup(conf->control_machine);
@@ -734,6 +756,7 @@ static void _fill_ctld_conf(slurm_ctl_conf_t * conf_ptr)
 
 	conf_ptr->hash_val            = conf->hash_val;
 	conf_ptr->health_check_interval = conf->health_check_interval;
+	conf_ptr->health_check_jitter   = conf->health_check_jitter;
 	conf_ptr->health_check_node_state = conf->health_check_node_state;
 	conf_ptr->health_check_program = xstrdup(conf->health_check_program);
 
@@ -857,6 +880,7 @@ static void _fill_ctld_conf(slurm_ctl_conf_t * conf_ptr)
 	conf_ptr->select_type_param   = conf->select_type_param;
 	conf_ptr->slurm_user_id       = conf->slurm_user_id;
 	conf_ptr->slurm_user_name     = xstrdup(conf->slurm_user_name);
+	conf_ptr->slurmcached_port    = conf->slurmcached_port;
 	conf_ptr->slurmctld_debug     = conf->slurmctld_debug;
 	conf_ptr->slurmctld_logfile   = xstrdup(conf->slurmctld_logfile);
 	conf_ptr->slurmctld_pidfile   = xstrdup(conf->slurmctld_pidfile);
@@ -1340,6 +1364,7 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 	} else {
 		pack_all_jobs(&dump, &dump_size,
 			      job_info_request_msg->show_flags, uid, NO_VAL,
+			      job_info_request_msg->filter,
 			      msg->protocol_version);
 		unlock_slurmctld(job_read_lock);
 		END_TIMER2("_slurm_rpc_dump_jobs");
@@ -1382,7 +1407,8 @@ static void _slurm_rpc_dump_jobs_user(slurm_msg_t * msg)
 	debug3("Processing RPC: REQUEST_JOB_USER_INFO from uid=%d", uid);
 	lock_slurmctld(job_read_lock);
 	pack_all_jobs(&dump, &dump_size, job_info_request_msg->show_flags, uid,
-		      job_info_request_msg->user_id, msg->protocol_version);
+		      job_info_request_msg->user_id, NULL,
+		      msg->protocol_version);
 	unlock_slurmctld(job_read_lock);
 	END_TIMER2("_slurm_rpc_dump_job_user");
 #if 0
@@ -1840,6 +1866,7 @@ static void  _slurm_rpc_epilog_complete(slurm_msg_t *msg,
 		     "node_name = %s, job_id = %u", epilog_msg->node_name,
 		     epilog_msg->job_id);
 
+	node_msg_received(epilog_msg->node_name);
 	if (job_epilog_complete(epilog_msg->job_id, epilog_msg->node_name,
 				epilog_msg->return_code))
 		*run_scheduler = true;
@@ -2138,6 +2165,7 @@ static void _slurm_rpc_complete_batch_script(slurm_msg_t *msg,
 		lock_slurmctld(job_write_lock);
 	}
 
+	node_msg_received(comp_msg->node_name);
 	job_ptr = find_job_record(comp_msg->job_id);
 
 	if (job_ptr && job_ptr->batch_host && comp_msg->node_name &&
@@ -2688,6 +2716,126 @@ static void _slurm_rpc_event_log(slurm_msg_t * msg)
 	slurm_send_rc_msg(msg, error_code);
 }
 
+/* Validate one node registration message.
+ * NOTE: Read config, write job and write node locks must be held */
+static void _node_reg_validate(node_reg_rec_t *reg_rec)
+{
+	slurm_node_registration_status_msg_t *node_reg_stat_msg =
+		(slurm_node_registration_status_msg_t *) reg_rec->msg->data;
+
+#ifdef HAVE_FRONT_END		/* Operates only on front-end */
+	reg_rec->error_code = validate_nodes_via_front_end(
+					node_reg_stat_msg,
+					reg_rec->msg->protocol_version,
+					&reg_rec->newly_up);
+#else
+	validate_jobs_on_node(node_reg_stat_msg);
+	reg_rec->error_code = validate_node_specs(node_reg_stat_msg,
+						  reg_rec->msg->protocol_version,
+						  &reg_rec->newly_up);
+#endif
+}
+
+/* Build a bitmap of the nodes in a batch of registrations to validate the
+ * jobs on them together, NULL if not worthwhile.
+ * NOTE: Read node lock must be held */
+static bitstr_t *_node_reg_bitmap(List batch)
+{
+#ifdef HAVE_FRONT_END
+	return NULL;	/* Operates only on front-end */
+#else
+	slurm_node_registration_status_msg_t *node_reg_stat_msg;
+	struct node_record *node_ptr;
+	bitstr_t *node_bitmap;
+	ListIterator iter;
+	node_reg_rec_t *rec;
+
+	if (list_count(batch) < 2)
+		return NULL;
+
+	node_bitmap = bit_alloc(node_record_count);
+	iter = list_iterator_create(batch);
+	while ((rec = (node_reg_rec_t *) list_next(iter))) {
+		node_reg_stat_msg = (slurm_node_registration_status_msg_t *)
+				    rec->msg->data;
+		node_ptr = find_node_record(node_reg_stat_msg->node_name);
+		if (node_ptr)
+			bit_set(node_bitmap, node_ptr - node_record_table_ptr);
+	}
+	list_iterator_destroy(iter);
+	return node_bitmap;
+#endif
+}
+
+/*
+ * Validate a node registration together with any others which arrive while
+ * registrations are being validated (e.g. all nodes registering after a
+ * slurmctld restart or reconfiguration). The first thread to find no batch
+ * in progress validates every queued registration under one acquisition of
+ * the slurmctld locks while the other threads wait for their result.
+ */
+static void _node_reg_batch(node_reg_rec_t *reg_rec)
+{
+	/* Locks: Read config, write job, write node */
+	slurmctld_lock_t job_write_lock = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
+	bitstr_t *node_bitmap;
+	ListIterator iter;
+	node_reg_rec_t *rec;
+	List batch;
+	int batch_cnt;
+	DEF_TIMERS;
+
+	slurm_mutex_lock(&node_reg_mutex);
+	if (!node_reg_queue)
+		node_reg_queue = list_create(NULL);
+	list_append(node_reg_queue, reg_rec);
+	while (!reg_rec->done) {
+		if (node_reg_active) {
+			slurm_cond_wait(&node_reg_cond, &node_reg_mutex);
+			continue;
+		}
+		node_reg_active = true;
+		batch = node_reg_queue;
+		node_reg_queue = list_create(NULL);
+		slurm_mutex_unlock(&node_reg_mutex);
+
+		START_TIMER;
+		batch_cnt = list_count(batch);
+		lock_slurmctld(job_write_lock);
+		node_bitmap = _node_reg_bitmap(batch);
+		if (node_bitmap) {
+			/* Test the jobs on all of these nodes with one pass
+			 * over the job list */
+			validate_jobs_batch_begin(node_bitmap);
+		}
+		iter = list_iterator_create(batch);
+		while ((rec = (node_reg_rec_t *) list_next(iter)))
+			_node_reg_validate(rec);
+		list_iterator_destroy(iter);
+		if (node_bitmap) {
+			validate_jobs_batch_end();
+			FREE_NULL_BITMAP(node_bitmap);
+		}
+		unlock_slurmctld(job_write_lock);
+		END_TIMER;
+		if (batch_cnt > 1) {
+			debug("%s: validated %d node registrations %s",
+			      __func__, batch_cnt, TIME_STR);
+		}
+
+		slurm_mutex_lock(&node_reg_mutex);
+		iter = list_iterator_create(batch);
+		while ((rec = (node_reg_rec_t *) list_next(iter)))
+			rec->done = true;
+		list_iterator_destroy(iter);
+		FREE_NULL_LIST(batch);
+		node_reg_active = false;
+		slurm_cond_broadcast(&node_reg_cond);
+	}
+	slurm_mutex_unlock(&node_reg_mutex);
+}
+
 /* _slurm_rpc_node_registration - process RPC to determine if a node's
  *	actual configuration satisfies the configured specification */
 static void _slurm_rpc_node_registration(slurm_msg_t * msg,
@@ -2697,11 +2845,9 @@ static void _slurm_rpc_node_registration(slurm_msg_t * msg,
 	DEF_TIMERS;
 	int error_code = SLURM_SUCCESS;
 	bool newly_up = false;
+	node_reg_rec_t reg_rec = { NULL, SLURM_SUCCESS, false, false };
 	slurm_node_registration_status_msg_t *node_reg_stat_msg =
 		(slurm_node_registration_status_msg_t *) msg->data;
-	/* Locks: Read config, write job, write node */
-	slurmctld_lock_t job_write_lock = {
-		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred,
 					 slurmctld_config.auth_info);
 
@@ -2731,20 +2877,13 @@ static void _slurm_rpc_node_registration(slurm_msg_t * msg,
 			      "set DebugFlags=NO_CONF_HASH in your slurm.conf.",
 			      node_reg_stat_msg->node_name);
 		}
-		if (!running_composite)
-			lock_slurmctld(job_write_lock);
-#ifdef HAVE_FRONT_END		/* Operates only on front-end */
-		error_code = validate_nodes_via_front_end(node_reg_stat_msg,
-							  msg->protocol_version,
-							  &newly_up);
-#else
-		validate_jobs_on_node(node_reg_stat_msg);
-		error_code = validate_node_specs(node_reg_stat_msg,
-						 msg->protocol_version,
-						 &newly_up);
-#endif
-		if (!running_composite)
-			unlock_slurmctld(job_write_lock);
+		reg_rec.msg = msg;
+		if (running_composite)	/* Locks already held */
+			_node_reg_validate(&reg_rec);
+		else
+			_node_reg_batch(&reg_rec);
+		error_code = reg_rec.error_code;
+		newly_up = reg_rec.newly_up;
 		END_TIMER2("_slurm_rpc_node_registration");
 		if (newly_up) {
 			queue_job_scheduler();
@@ -5651,6 +5790,66 @@ static void _clear_rpc_stats(void)
 		rpc_user_id[i] = 0;
 		rpc_user_time[i] = 0;
 	}
+	for (i = 0; i < rpc_comp_size; i++) {
+		xfree(rpc_comp_host[i]);
+		rpc_comp_cnt[i] = 0;
+		rpc_comp_msg_cnt[i] = 0;
+		rpc_comp_time[i] = 0;
+	}
+	slurm_mutex_unlock(&rpc_mutex);
+}
+
+/* Return the count of messages in a composite message, including those
+ * in embedded composite messages */
+static uint32_t _comp_msg_count(composite_msg_t *comp_msg)
+{
+	ListIterator itr;
+	slurm_msg_t *next_msg;
+	uint32_t cnt = 0;
+
+	if (!comp_msg->msg_list)
+		return 0;
+
+	itr = list_iterator_create(comp_msg->msg_list);
+	while ((next_msg = list_next(itr))) {
+		if (next_msg->msg_type == MESSAGE_COMPOSITE)
+			cnt += _comp_msg_count(next_msg->data);
+		else
+			cnt++;
+	}
+	list_iterator_destroy(itr);
+
+	return cnt;
+}
+
+/* Record a composite message from a message aggregation collector */
+static void _update_comp_stats(composite_msg_t *comp_msg, uint32_t msg_cnt,
+			       uint64_t usec)
+{
+	char host[32];
+	uint16_t port;
+	int i;
+
+	slurm_get_ip_str(&comp_msg->sender, &port, host, sizeof(host));
+
+	slurm_mutex_lock(&rpc_mutex);
+	if (rpc_comp_size == 0) {
+		rpc_comp_size = 200;  /* Capture info for first 200 collectors */
+		rpc_comp_host    = xmalloc(sizeof(char *) * rpc_comp_size);
+		rpc_comp_cnt     = xmalloc(sizeof(uint32_t) * rpc_comp_size);
+		rpc_comp_msg_cnt = xmalloc(sizeof(uint32_t) * rpc_comp_size);
+		rpc_comp_time    = xmalloc(sizeof(uint64_t) * rpc_comp_size);
+	}
+	for (i = 0; i < rpc_comp_size; i++) {
+		if (!rpc_comp_host[i])
+			rpc_comp_host[i] = xstrdup(host);
+		else if (xstrcmp(rpc_comp_host[i], host))
+			continue;
+		rpc_comp_cnt[i]++;
+		rpc_comp_msg_cnt[i] += msg_cnt;
+		rpc_comp_time[i] += usec;
+		break;
+	}
 	slurm_mutex_unlock(&rpc_mutex);
 }
 
@@ -5680,6 +5879,18 @@ static void _pack_rpc_stats(int resp, char **buffer_ptr, int *buffer_size,
 	pack32_array(rpc_user_id,   i, buffer);
 	pack32_array(rpc_user_cnt,  i, buffer);
 	pack64_array(rpc_user_time, i, buffer);
+
+	if (protocol_version >= SLURM_17_11_PROTOCOL_VERSION) {
+		for (i = 0; i < rpc_comp_size; i++) {
+			if (!rpc_comp_host[i])
+				break;
+		}
+		pack32(i, buffer);
+		packstr_array(rpc_comp_host,    i, buffer);
+		pack32_array(rpc_comp_cnt,     i, buffer);
+		pack32_array(rpc_comp_msg_cnt, i, buffer);
+		pack64_array(rpc_comp_time,    i, buffer);
+	}
 	slurm_mutex_unlock(&rpc_mutex);
 
 	*buffer_size = get_buf_offset(buffer);
@@ -5791,6 +6002,8 @@ _slurm_rpc_dump_licenses(slurm_msg_t * msg)
 /* Free memory used to track RPC usage by type and user */
 extern void free_rpc_stats(void)
 {
+	int i;
+
 	slurm_mutex_lock(&rpc_mutex);
 	xfree(rpc_type_cnt);
 	xfree(rpc_type_id);
@@ -5801,6 +6014,14 @@ extern void free_rpc_stats(void)
 	xfree(rpc_user_id);
 	xfree(rpc_user_time);
 	rpc_user_size = 0;
+
+	for (i = 0; i < rpc_comp_size; i++)
+		xfree(rpc_comp_host[i]);
+	xfree(rpc_comp_host);
+	xfree(rpc_comp_cnt);
+	xfree(rpc_comp_msg_cnt);
+	xfree(rpc_comp_time);
+	rpc_comp_size = 0;
 	slurm_mutex_unlock(&rpc_mutex);
 }
 
@@ -5892,15 +6113,19 @@ static void  _slurm_rpc_composite_msg(slurm_msg_t *msg)
 	struct timeval start_tv;
 	bool run_scheduler = false;
 	composite_msg_t *comp_msg, comp_resp_msg;
+	uint32_t msg_cnt;
 	/* Locks: Read configuration, write job, write node */
 	slurmctld_lock_t job_write_lock = {
 		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
+	DEF_TIMERS;
 
+	START_TIMER;
 	memset(&comp_resp_msg, 0, sizeof(composite_msg_t));
 	comp_resp_msg.msg_list = list_create(_slurmctld_free_comp_msg_list);
 
 	comp_msg = (composite_msg_t *) msg->data;
 
+	msg_cnt = _comp_msg_count(comp_msg);
 	if (slurmctld_conf.debug_flags & DEBUG_FLAG_ROUTE)
 		info("Processing RPC: MESSAGE_COMPOSITE msg with %d messages",
 		     comp_msg->msg_list ? list_count(comp_msg->msg_list) : 0);
@@ -5954,6 +6179,8 @@ static void  _slurm_rpc_composite_msg(slurm_msg_t *msg)
 		slurm_send_only_node_msg(&resp_msg);
 	}
 	FREE_NULL_LIST(comp_resp_msg.msg_list);
+	END_TIMER;
+	_update_comp_stats(comp_msg, msg_cnt, DELTA_TIMER);
 
 	/* Functions below provide their own locking */
 	if (run_scheduler) {
@@ -6210,8 +6437,13 @@ static void _slurm_rpc_persist_init(slurm_msg_t *msg, connection_arg_t *arg)
 	persist_conn->version = persist_init->version;
 	memcpy(&p_tmp, persist_conn, sizeof(slurm_persist_conn_t));
 
-	if ((rc = fed_mgr_add_sibling_conn(persist_conn, &comment))
-	    != SLURM_SUCCESS)
+	/* Connections from our own cluster are opened by slurmd daemons */
+	if (!xstrcmp(persist_conn->cluster_name, slurmctld_conf.cluster_name))
+		rc = persist_node_conn_add(persist_conn, &arg->cli_addr,
+					   &comment);
+	else
+		rc = fed_mgr_add_sibling_conn(persist_conn, &comment);
+	if (rc != SLURM_SUCCESS)
 		slurm_persist_conn_destroy(persist_conn);
 end_it:
 
@@ -1114,6 +1114,7 @@ int read_slurm_conf(int recover, bool reconfig)
 	if (node_features_g_count() > 0) {
 		if (node_features_g_get_node(NULL) != SLURM_SUCCESS)
 			error("failed to initialize node features");
+		invalidate_node_pack(NULL);
 	}
 	if ((rc = _build_bitmaps())) /* must follow node_features_g_get_node()
 				      * and preceed build_features_list_*() */
@@ -66,6 +66,7 @@
 #include "src/common/slurm_time.h"
 #include "src/common/uid.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -80,6 +81,10 @@
 #define ONE_YEAR	(365 * 24 * 60 * 60)
 #define RESV_MAGIC	0x3b82
 
+/* Number of time windows for which the nodes and cores available to jobs
+ * without a reservation are cached, see _resv_avail_cache_get() */
+#define RESV_AVAIL_CACHE_SIZE	16
+
 /* Permit sufficient time for slurmctld failover or other long delay before
  * considering a reservation time specification being invalid */
 #define MAX_RESV_DELAY	600
@@ -97,6 +102,45 @@ List      resv_list = (List) NULL;
 uint32_t  resv_over_run;
 uint32_t  top_suffix = 0;
 
+/* Reservations indexed by name */
+static xhash_t *resv_name_hash = NULL;
+
+/*
+ * Reservations with nodes sorted by start time, with the start and end times
+ * resolved when the index was built (floating reservations move with the
+ * current time). Rebuilt when reservations change or time advances.
+ */
+typedef struct resv_time_rec {
+	slurmctld_resv_t *resv_ptr;
+	time_t start_relative;
+	time_t end_relative;
+} resv_time_rec_t;
+static resv_time_rec_t *resv_time_index = NULL;
+static int    resv_time_cnt = 0;
+static int    resv_time_size = 0;
+static time_t resv_time_built = (time_t) 0;
+static time_t resv_time_update = (time_t) 0;
+static bool   resv_time_valid = false;
+
+/*
+ * Nodes usable and cores to exclude for jobs lacking a reservation, required
+ * nodes and licenses, by time window. Valid as long as the time index is.
+ */
+typedef struct resv_avail_cache {
+	time_t start_time;
+	time_t end_time;
+	bool move_time;
+	bool whole_node;
+	int rc;
+	bool when_set;
+	time_t when;
+	bitstr_t *node_bitmap;
+	bitstr_t *exc_core_bitmap;
+} resv_avail_cache_t;
+static resv_avail_cache_t resv_avail_cache[RESV_AVAIL_CACHE_SIZE];
+static int resv_avail_cache_cnt = 0;
+static int resv_avail_cache_next = 0;
+
 #ifdef HAVE_BG
 uint32_t  cpu_mult = 0;
 uint32_t  cnodes_per_mp = 0;
@@ -142,7 +186,6 @@ static slurmctld_resv_t *_copy_resv(slurmctld_resv_t *resv_orig_ptr);
 static void _del_resv_rec(void *x);
 static void _dump_resv_req(resv_desc_msg_t *resv_ptr, char *mode);
 static int  _find_resv_id(void *x, void *key);
-static int  _find_resv_name(void *x, void *key);
 static void *_fork_script(void *x);
 static void _free_script_arg(resv_thread_args_t *args);
 static void _generate_resv_id(void);
@@ -169,6 +212,9 @@ static int  _post_resv_delete(slurmctld_resv_t *resv_ptr);
 static int  _post_resv_update(slurmctld_resv_t *resv_ptr,
 			      slurmctld_resv_t *old_resv_ptr);
 static int  _resize_resv(slurmctld_resv_t *resv_ptr, uint32_t node_cnt);
+static void _resv_avail_cache_clear(void);
+static void _resv_list_append(slurmctld_resv_t *resv_ptr);
+static void _resv_name_hash_remove(slurmctld_resv_t *resv_ptr);
 static void _restore_resv(slurmctld_resv_t *dest_resv,
 			  slurmctld_resv_t *src_resv);
 static bool _resv_overlap(time_t start_time, time_t end_time,
@@ -378,9 +424,12 @@ static void _restore_resv(slurmctld_resv_t *dest_resv,
 	dest_resv->magic = src_resv->magic;
 	dest_resv->flags_set_node = src_resv->flags_set_node;
 
+	_resv_name_hash_remove(dest_resv);
 	xfree(dest_resv->name);
 	dest_resv->name = src_resv->name;
 	src_resv->name = NULL;
+	if (resv_name_hash && dest_resv->name)
+		xhash_add(resv_name_hash, dest_resv);
 
 	FREE_NULL_BITMAP(dest_resv->node_bitmap);
 	dest_resv->node_bitmap = src_resv->node_bitmap;
@@ -429,6 +478,8 @@ static void _del_resv_rec(void *x)
 	if (resv_ptr) {
 		xassert(resv_ptr->magic == RESV_MAGIC);
 		resv_ptr->magic = 0;
+		_resv_name_hash_remove(resv_ptr);
+		resv_time_valid = false;
 		xfree(resv_ptr->accounts);
 		for (i = 0; i < resv_ptr->account_cnt; i++)
 			xfree(resv_ptr->account_list[i]);
@@ -465,16 +516,33 @@ static int _find_resv_id(void *x, void *key)
 		return 1;	/* match */
 }
 
-static int _find_resv_name(void *x, void *key)
+static const char *_resv_name_hash_id(void *item)
 {
-	slurmctld_resv_t *resv_ptr = (slurmctld_resv_t *) x;
+	slurmctld_resv_t *resv_ptr = (slurmctld_resv_t *) item;
 
-	xassert(resv_ptr->magic == RESV_MAGIC);
+	return resv_ptr->name;
+}
 
-	if (xstrcmp(resv_ptr->name, (char *) key))
-		return 0;
-	else
-		return 1;	/* match */
+/* Remove a reservation from the name index if it is indexed */
+static void _resv_name_hash_remove(slurmctld_resv_t *resv_ptr)
+{
+	if (!resv_name_hash || !resv_ptr->name)
+		return;
+	if (xhash_get(resv_name_hash, resv_ptr->name) == resv_ptr)
+		xhash_pop(resv_name_hash, resv_ptr->name);
+}
+
+/* Add a reservation record to resv_list and its indexes */
+static void _resv_list_append(slurmctld_resv_t *resv_ptr)
+{
+	list_append(resv_list, resv_ptr);
+	if (!resv_name_hash) {
+		resv_name_hash = xhash_init(_resv_name_hash_id, NULL,
+					    NULL, 0);
+	}
+	if (resv_ptr->name)
+		xhash_add(resv_name_hash, resv_ptr);
+	resv_time_valid = false;
 }
 
 static void _dump_resv_req(resv_desc_msg_t *resv_ptr, char *mode)
@@ -2268,8 +2336,7 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 
 	_generate_resv_id();
 	if (resv_desc_ptr->name) {
-		resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-				_find_resv_name, resv_desc_ptr->name);
+		resv_ptr = find_resv_name(resv_desc_ptr->name);
 		if (resv_ptr) {
 			info("Reservation request name duplication (%s)",
 			     resv_desc_ptr->name);
@@ -2279,9 +2346,7 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 	} else {
 		while (1) {
 			_generate_resv_name(resv_desc_ptr);
-			resv_ptr = (slurmctld_resv_t *)
-					list_find_first (resv_list,
-					_find_resv_name, resv_desc_ptr->name);
+			resv_ptr = find_resv_name(resv_desc_ptr->name);
 			if (!resv_ptr)
 				break;
 			_generate_resv_id();	/* makes new suffix */
@@ -2348,7 +2413,7 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 
 	_set_tres_cnt(resv_ptr, NULL);
 
-	list_append(resv_list, resv_ptr);
+	_resv_list_append(resv_ptr);
 	last_resv_update = now;
 	schedule_resv_save();
 
@@ -2370,6 +2435,11 @@ extern int create_resv(resv_desc_msg_t *resv_desc_ptr)
 extern void resv_fini(void)
 {
 	FREE_NULL_LIST(resv_list);
+	xhash_free(resv_name_hash);
+	_resv_avail_cache_clear();
+	xfree(resv_time_index);
+	resv_time_cnt = resv_time_size = 0;
+	resv_time_valid = false;
 }
 
 /* Update an exiting resource reservation */
@@ -2387,8 +2457,7 @@ extern int update_resv(resv_desc_msg_t *resv_desc_ptr)
 	if (!resv_desc_ptr->name)
 		return ESLURM_RESERVATION_INVALID;
 
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, resv_desc_ptr->name);
+	resv_ptr = find_resv_name(resv_desc_ptr->name);
 	if (!resv_ptr)
 		return ESLURM_RESERVATION_INVALID;
 
@@ -2849,10 +2918,9 @@ extern int delete_resv(reservation_name_msg_t *resv_desc_ptr)
 /* Return pointer to the named reservation or NULL if not found */
 extern slurmctld_resv_t *find_resv_name(char *resv_name)
 {
-	slurmctld_resv_t *resv_ptr;
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, resv_name);
-	return resv_ptr;
+	if (!resv_name_hash || !resv_name)
+		return NULL;
+	return (slurmctld_resv_t *) xhash_get(resv_name_hash, resv_name);
 }
 
 /* Dump the reservation records to a buffer */
@@ -3223,10 +3291,7 @@ static void _validate_all_reservations(void)
 
 		if ((job_ptr->resv_ptr == NULL) ||
 		    (job_ptr->resv_ptr->magic != RESV_MAGIC)) {
-			job_ptr->resv_ptr = (slurmctld_resv_t *)
-					list_find_first(resv_list,
-							_find_resv_name,
-							job_ptr->resv_name);
+			job_ptr->resv_ptr = find_resv_name(job_ptr->resv_name);
 		}
 		if (!job_ptr->resv_ptr) {
 			error("JobId %u linked to defunct reservation %s",
@@ -3503,7 +3568,7 @@ extern int load_all_resv_state(int recover)
 		if (!resv_ptr)
 			break;
 
-		list_append(resv_list, resv_ptr);
+		_resv_list_append(resv_ptr);
 		info("Recovered state of reservation %s", resv_ptr->name);
 	}
 
@@ -3547,8 +3612,7 @@ extern int validate_job_resv(struct job_record *job_ptr)
 		return ESLURM_RESERVATION_INVALID;
 
 	/* Find the named reservation */
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, job_ptr->resv_name);
+	resv_ptr = find_resv_name(job_ptr->resv_name);
 	rc = _valid_job_access_resv(job_ptr, resv_ptr);
 	if (rc == SLURM_SUCCESS) {
 		job_ptr->resv_id    = resv_ptr->resv_id;
@@ -4232,8 +4296,7 @@ extern int job_test_resv_now(struct job_record *job_ptr)
 	if (job_ptr->resv_name == NULL)
 		return SLURM_SUCCESS;
 
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, job_ptr->resv_name);
+	resv_ptr = find_resv_name(job_ptr->resv_name);
 	job_ptr->resv_ptr = resv_ptr;
 	rc = _valid_job_access_resv(job_ptr, resv_ptr);
 	if (rc != SLURM_SUCCESS)
@@ -4270,8 +4333,7 @@ extern void job_claim_resv(struct job_record *job_ptr)
 	if (job_ptr->resv_name == NULL)
 		return;
 
-	resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-			_find_resv_name, job_ptr->resv_name);
+	resv_ptr = find_resv_name(job_ptr->resv_name);
 	if (!resv_ptr ||
 	    (!resv_ptr->full_nodes && (resv_ptr->node_cnt > 1)) ||
 	    !(resv_ptr->flags & RESERVE_FLAG_REPLACE) ||
@@ -4777,6 +4839,253 @@ extern uint32_t job_test_watts_resv(struct job_record *job_ptr, time_t when,
 	return resv_cnt;
 }
 
+static int _resv_time_cmp(const void *x, const void *y)
+{
+	const resv_time_rec_t *rec1 = (const resv_time_rec_t *) x;
+	const resv_time_rec_t *rec2 = (const resv_time_rec_t *) y;
+
+	if (rec1->start_relative < rec2->start_relative)
+		return -1;
+	if (rec1->start_relative > rec2->start_relative)
+		return 1;
+	return 0;
+}
+
+static void _resv_avail_cache_clear(void)
+{
+	int i;
+
+	for (i = 0; i < resv_avail_cache_cnt; i++) {
+		FREE_NULL_BITMAP(resv_avail_cache[i].node_bitmap);
+		FREE_NULL_BITMAP(resv_avail_cache[i].exc_core_bitmap);
+	}
+	resv_avail_cache_cnt = 0;
+	resv_avail_cache_next = 0;
+}
+
+/*
+ * Build the time index of reservations with nodes, unless the existing one
+ * was built at this time and no reservation changed since then (changes
+ * within the current second always force a rebuild, last_resv_update only
+ * has a resolution of one second). Reservations which ended are advanced
+ * (if recurring) in the process.
+ */
+static void _resv_time_index_build(time_t now)
+{
+	slurmctld_resv_t *resv_ptr;
+	resv_time_rec_t *rec;
+	ListIterator iter;
+	time_t start_relative, end_relative;
+
+	if (resv_time_valid && (resv_time_built == now) &&
+	    (resv_time_update == last_resv_update) &&
+	    (last_resv_update < now))
+		return;
+
+	_resv_avail_cache_clear();
+	resv_time_cnt = 0;
+	iter = list_iterator_create(resv_list);
+	while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
+		if (resv_ptr->flags & RESERVE_FLAG_TIME_FLOAT) {
+			start_relative = resv_ptr->start_time + now;
+			if (resv_ptr->duration == INFINITE)
+				end_relative = start_relative + ONE_YEAR;
+			else if (resv_ptr->duration &&
+				 (resv_ptr->duration != NO_VAL)) {
+				end_relative = start_relative +
+					resv_ptr->duration * 60;
+			} else {
+				end_relative = resv_ptr->end_time;
+				if (start_relative > end_relative)
+					start_relative = end_relative;
+			}
+		} else {
+			if (resv_ptr->end_time <= now)
+				_advance_resv_time(resv_ptr);
+			start_relative = resv_ptr->start_time_first;
+			end_relative = resv_ptr->end_time;
+		}
+		if (resv_ptr->node_bitmap == NULL)
+			continue;
+
+		if (resv_time_cnt >= resv_time_size) {
+			resv_time_size = MAX(16, resv_time_size * 2);
+			xrealloc(resv_time_index,
+				 sizeof(resv_time_rec_t) * resv_time_size);
+		}
+		rec = &resv_time_index[resv_time_cnt++];
+		rec->resv_ptr = resv_ptr;
+		rec->start_relative = start_relative;
+		rec->end_relative = end_relative;
+	}
+	list_iterator_destroy(iter);
+
+	if (resv_time_cnt > 1) {
+		qsort(resv_time_index, resv_time_cnt, sizeof(resv_time_rec_t),
+		      _resv_time_cmp);
+	}
+	resv_time_built = now;
+	resv_time_update = last_resv_update;
+	resv_time_valid = true;
+}
+
+/*
+ * Test the reservations overlapping the time window [start_time, end_time)
+ * for a job without a reservation.
+ * IN/OUT node_bitmap - nodes reserved by others are cleared
+ * OUT exc_core_bitmap - cores of partial node reservations to exclude,
+ *	allocated if needed
+ * OUT lic_resv_time - earliest end of a reservation holding the job's
+ *	licenses, unchanged if none
+ * RET SLURM_SUCCESS or ESLURM_NODES_BUSY, *when set to the end of the
+ *	reservation making the nodes busy
+ */
+static int _resv_test_window(struct job_record *job_ptr, time_t start_time,
+			     time_t end_time, bool move_time, time_t *when,
+			     bitstr_t *node_bitmap, bitstr_t **exc_core_bitmap,
+			     time_t *lic_resv_time)
+{
+	slurmctld_resv_t *resv_ptr;
+	resv_time_rec_t *rec;
+	int lo = 0, hi = resv_time_cnt, mid, i;
+
+	/* Reservations starting at or after end_time can not overlap */
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (resv_time_index[mid].start_relative < end_time)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (i = 0; i < lo; i++) {
+		rec = &resv_time_index[i];
+		resv_ptr = rec->resv_ptr;
+		if (rec->end_relative <= start_time)
+			continue;
+
+		if (resv_ptr->flags & RESERVE_FLAG_ALL_NODES) {
+			if (move_time)
+				*when = resv_ptr->end_time;
+			return ESLURM_NODES_BUSY;
+		}
+
+		if (job_ptr->details->req_node_bitmap &&
+		    bit_overlap(job_ptr->details->req_node_bitmap,
+				resv_ptr->node_bitmap) &&
+		    (!resv_ptr->tres_str ||
+		     job_ptr->details->whole_node == 1)) {
+			*when = resv_ptr->end_time;
+			return ESLURM_NODES_BUSY;
+		}
+		/* FIXME: This only tracks when ANY licenses required
+		 * by the job are freed by any reservation without
+		 * counting them, so the results are not accurate. */
+		if (license_list_overlap(job_ptr->license_list,
+					 resv_ptr->license_list)) {
+			if ((*lic_resv_time == (time_t) 0) ||
+			    (*lic_resv_time > resv_ptr->end_time))
+				*lic_resv_time = resv_ptr->end_time;
+		}
+
+		if ((resv_ptr->full_nodes) ||
+		    (job_ptr->details->whole_node == 1)) {
+#if _DEBUG
+			info("reservation %s uses full nodes or job %u "
+			     "will not share nodes",
+			     resv_ptr->name, job_ptr->job_id);
+#endif
+			bit_not(resv_ptr->node_bitmap);
+			bit_and(node_bitmap, resv_ptr->node_bitmap);
+			bit_not(resv_ptr->node_bitmap);
+		} else {
+#if _DEBUG
+			info("job_test_resv: reservation %s uses "
+			     "partial nodes", resv_ptr->name);
+#endif
+			if (resv_ptr->core_bitmap == NULL) {
+				;
+			} else if (*exc_core_bitmap == NULL) {
+				*exc_core_bitmap =
+					bit_copy(resv_ptr->core_bitmap);
+			} else {
+				bit_or(*exc_core_bitmap,
+				       resv_ptr->core_bitmap);
+			}
+		}
+	}
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Look up the result of _resv_test_window() for a job lacking required nodes
+ * and licenses in the cache.
+ * RET true if found, node_bitmap, exc_core_bitmap, rc and when are set
+ */
+static bool _resv_avail_cache_get(struct job_record *job_ptr,
+				  time_t start_time, time_t end_time,
+				  bool move_time, int *rc, time_t *when,
+				  bitstr_t *node_bitmap,
+				  bitstr_t **exc_core_bitmap)
+{
+	resv_avail_cache_t *cache;
+	bool whole_node = (job_ptr->details->whole_node == 1);
+	int i;
+
+	for (i = 0; i < resv_avail_cache_cnt; i++) {
+		cache = &resv_avail_cache[i];
+		if ((cache->start_time != start_time) ||
+		    (cache->end_time != end_time) ||
+		    (cache->move_time != move_time) ||
+		    (cache->whole_node != whole_node) ||
+		    (bit_size(cache->node_bitmap) != bit_size(node_bitmap)))
+			continue;
+		bit_and(node_bitmap, cache->node_bitmap);
+		if (cache->exc_core_bitmap)
+			*exc_core_bitmap = bit_copy(cache->exc_core_bitmap);
+		if (cache->when_set)
+			*when = cache->when;
+		*rc = cache->rc;
+		return true;
+	}
+
+	return false;
+}
+
+/* Record the result of _resv_test_window() for a job lacking required nodes
+ * and licenses */
+static void _resv_avail_cache_add(struct job_record *job_ptr,
+				  time_t start_time, time_t end_time,
+				  bool move_time, int rc, time_t *when,
+				  bitstr_t *node_bitmap,
+				  bitstr_t *exc_core_bitmap)
+{
+	resv_avail_cache_t *cache;
+
+	cache = &resv_avail_cache[resv_avail_cache_next];
+	if (resv_avail_cache_next < resv_avail_cache_cnt) {
+		FREE_NULL_BITMAP(cache->node_bitmap);
+		FREE_NULL_BITMAP(cache->exc_core_bitmap);
+	} else
+		resv_avail_cache_cnt++;
+	resv_avail_cache_next = (resv_avail_cache_next + 1) %
+				RESV_AVAIL_CACHE_SIZE;
+
+	cache->start_time = start_time;
+	cache->end_time = end_time;
+	cache->move_time = move_time;
+	cache->whole_node = (job_ptr->details->whole_node == 1);
+	cache->rc = rc;
+	cache->when_set = (rc != SLURM_SUCCESS) && move_time;
+	cache->when = *when;
+	cache->node_bitmap = bit_copy(node_bitmap);
+	if (exc_core_bitmap)
+		cache->exc_core_bitmap = bit_copy(exc_core_bitmap);
+	else
+		cache->exc_core_bitmap = NULL;
+}
+
 /*
  * Determine which nodes a job can use based upon reservations
  * IN job_ptr      - job to test
@@ -4805,10 +5114,10 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 {
 	slurmctld_resv_t * resv_ptr, *res2_ptr;
 	time_t job_start_time, job_end_time, lic_resv_time;
-	time_t start_relative, end_relative;
 	time_t now = time(NULL);
 	ListIterator iter;
 	int i, rc = SLURM_SUCCESS, rc2;
+	bool cacheable;
 
 	*resv_overlap = false;	/* initialize to false */
 	job_start_time = *when;
@@ -4816,8 +5125,7 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 	*node_bitmap = (bitstr_t *) NULL;
 
 	if (job_ptr->resv_name) {
-		resv_ptr = (slurmctld_resv_t *) list_find_first (resv_list,
-				_find_resv_name, job_ptr->resv_name);
+		resv_ptr = find_resv_name(job_ptr->resv_name);
 		job_ptr->resv_ptr = resv_ptr;
 		rc2 = _valid_job_access_resv(job_ptr, resv_ptr);
 		if (rc2 != SLURM_SUCCESS)
@@ -4921,89 +5229,37 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 
 	/* Job has no reservation, try to find time when this can
 	 * run and get it's required nodes (if any) */
+	_resv_time_index_build(now);
+	cacheable = (job_ptr->details->req_node_bitmap == NULL) &&
+		    (job_ptr->license_list == NULL);
 	for (i = 0; ; i++) {
+		bitstr_t *exc_core_tmp = NULL;
 		lic_resv_time = (time_t) 0;
 
-		iter = list_iterator_create(resv_list);
-		while ((resv_ptr = (slurmctld_resv_t *) list_next(iter))) {
-			if (resv_ptr->flags & RESERVE_FLAG_TIME_FLOAT) {
-				start_relative = resv_ptr->start_time + now;
-				if (resv_ptr->duration == INFINITE)
-					end_relative = start_relative+ONE_YEAR;
-				else if (resv_ptr->duration &&
-					 (resv_ptr->duration != NO_VAL)) {
-					end_relative = start_relative +
-						resv_ptr->duration * 60;
-				} else {
-					end_relative = resv_ptr->end_time;
-					if (start_relative > end_relative)
-						start_relative = end_relative;
-				}
-			} else {
-				if (resv_ptr->end_time <= now)
-					_advance_resv_time(resv_ptr);
-				start_relative = resv_ptr->start_time_first;
-				end_relative = resv_ptr->end_time;
-			}
-
-			if ((resv_ptr->node_bitmap == NULL) ||
-			    (start_relative >= job_end_time) ||
-			    (end_relative   <= job_start_time))
-				continue;
-
-			if (resv_ptr->flags & RESERVE_FLAG_ALL_NODES) {
-				rc = ESLURM_NODES_BUSY;
-				if (move_time)
-					*when = resv_ptr->end_time;
-				break;
-			}
-
-			if (job_ptr->details->req_node_bitmap &&
-			    bit_overlap(job_ptr->details->req_node_bitmap,
-					resv_ptr->node_bitmap) &&
-			    (!resv_ptr->tres_str ||
-			     job_ptr->details->whole_node == 1)) {
-				*when = resv_ptr->end_time;
-				rc = ESLURM_NODES_BUSY;
-				break;
-			}
-			/* FIXME: This only tracks when ANY licenses required
-			 * by the job are freed by any reservation without
-			 * counting them, so the results are not accurate. */
-			if (license_list_overlap(job_ptr->license_list,
-						 resv_ptr->license_list)) {
-				if ((lic_resv_time == (time_t) 0) ||
-				    (lic_resv_time > resv_ptr->end_time))
-					lic_resv_time = resv_ptr->end_time;
+		if (!cacheable ||
+		    !_resv_avail_cache_get(job_ptr, job_start_time,
+					   job_end_time, move_time, &rc, when,
+					   *node_bitmap, &exc_core_tmp)) {
+			rc = _resv_test_window(job_ptr, job_start_time,
+					       job_end_time, move_time, when,
+					       *node_bitmap, &exc_core_tmp,
+					       &lic_resv_time);
+			if (cacheable) {
+				_resv_avail_cache_add(job_ptr, job_start_time,
+						      job_end_time, move_time,
+						      rc, when, *node_bitmap,
+						      exc_core_tmp);
 			}
-
-			if ((resv_ptr->full_nodes) ||
-			    (job_ptr->details->whole_node == 1)) {
-#if _DEBUG
-				info("reservation %s uses full nodes or job %u "
-				     "will not share nodes",
-				     resv_ptr->name, job_ptr->job_id);
-#endif
-				bit_not(resv_ptr->node_bitmap);
-				bit_and(*node_bitmap, resv_ptr->node_bitmap);
-				bit_not(resv_ptr->node_bitmap);
+		}
+		if (exc_core_tmp && exc_core_bitmap) {
+			if (*exc_core_bitmap == NULL) {
+				*exc_core_bitmap = exc_core_tmp;
+				exc_core_tmp = NULL;
 			} else {
-#if _DEBUG
-				info("job_test_resv: reservation %s uses "
-				     "partial nodes", resv_ptr->name);
-#endif
-				if (resv_ptr->core_bitmap == NULL) {
-					;
-				} else if (*exc_core_bitmap == NULL) {
-					*exc_core_bitmap =
-						bit_copy(resv_ptr->core_bitmap);
-				} else {
-					bit_or(*exc_core_bitmap,
-					       resv_ptr->core_bitmap);
-				}
+				bit_or(*exc_core_bitmap, exc_core_tmp);
 			}
 		}
-		list_iterator_destroy(iter);
+		FREE_NULL_BITMAP(exc_core_tmp);
 
 		if ((rc == SLURM_SUCCESS) && move_time) {
 			if (license_job_test(job_ptr, job_start_time)
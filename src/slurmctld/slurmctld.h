@@ -181,6 +181,13 @@ typedef struct diag_stats {
 	uint32_t bf_queue_len_sum;
 	time_t   bf_when_last_cycle;
 	uint32_t bf_active;
+
+	uint32_t prio_cycle_counter;
+	uint32_t prio_cycle_last;
+	uint32_t prio_cycle_max;
+	uint32_t prio_last_jobs;
+	uint32_t prio_last_static;
+	uint32_t prio_last_skip;
 } diag_stats_t;
 
 /* This is used to point out constants that exist in the
@@ -482,6 +489,8 @@ struct job_details {
 	uint16_t cpus_per_task;		/* number of processors required for
 					 * each task */
 	List depend_list;		/* list of job_ptr:state pairs */
+	uint64_t depend_test_seq;	/* depend_event_seq when dependencies
+					 * were last found unmet, 0 if not */
 	char *dependency;		/* wait for other jobs */
 	char *orig_dependency;		/* original value (for archiving) */
 	uint16_t env_cnt;		/* size of env_sup (see below) */
@@ -622,6 +631,8 @@ struct job_record {
 	uint64_t db_index;              /* used only for database plugins */
 	time_t deadline;		/* deadline */
 	uint32_t delay_boot;		/* Delay boot for desired node mode */
+	uint64_t depend_seq;		/* depend_event_seq of last state change
+					 * relevant to dependent jobs */
 	uint32_t derived_ec;		/* highest exit code of all job steps */
 	struct job_details *details;	/* job details */
 	uint16_t direct_set_prio;	/* Priority set directly if
@@ -670,6 +681,8 @@ struct job_record {
 	uint32_t magic;			/* magic cookie for data integrity */
 	char *mcs_label;		/* mcs_label if mcs plugin in use */
 	char *name;			/* name of the job */
+	struct job_record *job_name_next; /* next entry with same user and
+					 * job name hash index */
 	char *network;			/* network/switch requirement spec */
 	uint32_t next_step_id;		/* next step id to be used */
 	char *nodes;			/* list of nodes allocated to job */
@@ -1178,6 +1191,13 @@ extern int init_part_conf (void);
  */
 extern void init_requeue_policy(void);
 
+/*
+ * invalidate_node_pack - discard the packed copy of a node's rarely changing
+ *	fields kept for node information responses
+ * IN node_ptr - node whose fields changed, NULL to invalidate all nodes
+ */
+extern void invalidate_node_pack(struct node_record *node_ptr);
+
 /*
  * is_node_down - determine if the specified node's state is DOWN
  * IN name - name of the node
@@ -1743,6 +1763,13 @@ extern void node_fini (void);
  * IN name - name of the node */
 extern void node_did_resp (char *name);
 
+/*
+ * node_msg_received - record that an RPC was received from the slurmd on
+ *	the specified node, so ping_nodes() need not ping it again soon
+ * IN name - name of the node
+ */
+extern void node_msg_received(char *name);
+
 /*
  * node_not_resp - record that the specified node is not responding
  * IN name - name of the node
@@ -1768,6 +1795,7 @@ extern int num_pending_job_array_tasks(uint32_t array_job_id);
  * IN show_flags - job filtering options
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN filter - pack only jobs matching this filter if not NULL
  * IN protocol_version - slurm protocol version of client
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
@@ -1776,7 +1804,7 @@ extern int num_pending_job_array_tasks(uint32_t array_job_id);
  */
 extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
-			  uint16_t protocol_version);
+			  job_info_filter_t *filter, uint16_t protocol_version);
 
 /*
  * pack_all_node - dump all configuration and node information for all nodes
@@ -2026,6 +2054,13 @@ extern void run_backup(slurm_trigger_callbacks_t *callbacks);
 /* Spawn health check function for every node that is not DOWN */
 extern void run_health_check(void);
 
+/*
+ * is_health_check_pending - test if a health check spread over
+ *	HealthCheckJitter still has nodes to start. If so run_health_check()
+ *	should be called again before the next HealthCheckInterval.
+ */
+extern bool is_health_check_pending(void);
+
 /* save_all_state - save entire slurmctld state for later recovery */
 extern void save_all_state(void);
 
@@ -2056,6 +2091,17 @@ extern void server_thread_decr(void);
 /* Increment slurmctld thread count (as applies to thread limit) */
 extern void server_thread_incr(void);
 
+/*
+ * persist_node_conn_add - Add a persistent connection opened by a slurmd
+ *	to the set serviced by slurmctld
+ * IN persist_conn - connection, owned by slurmctld on success
+ * IN addr - address of the slurmd
+ * OUT comment - reason for a failure, xfree'd by caller
+ * RET SLURM_SUCCESS or error code
+ */
+extern int persist_node_conn_add(slurm_persist_conn_t *persist_conn,
+				 slurm_addr_t *addr, char **comment);
+
 /* Set a job's alias_list string */
 extern void set_job_alias_list(struct job_record *job_ptr);
 
@@ -2214,6 +2260,14 @@ extern bool test_job_array_finished(uint32_t array_job_id);
 /* Return true if ANY tasks of specific array job ID are pending */
 extern bool test_job_array_pending(uint32_t array_job_id);
 
+/*
+ * Return true if some other job of the same user and name prevents this
+ * job's singleton dependency from being satisfied (the other job is running,
+ * suspended, or pending with a lower job ID). Uses the job name hash table
+ * rather than scanning the job list.
+ */
+extern bool test_job_singleton_blocked(struct job_record *job_ptr);
+
 /*
  * Synchronize the batch job in the system with their files.
  * All pending batch jobs must have script and environment files
@@ -2342,6 +2396,20 @@ extern int validate_job_create_req(job_desc_msg_t * job_desc, uid_t submit_uid,
  */
 extern void validate_jobs_on_node(slurm_node_registration_status_msg_t *reg_msg);
 
+/*
+ * validate_jobs_batch_begin - prepare to validate the jobs on a batch of
+ *	registering nodes with validate_jobs_on_node(), indexing their
+ *	running jobs with a single pass over the job list
+ * IN node_bitmap - nodes whose registrations are in the batch
+ * NOTE: WRITE lock_slurmctld job and node must be held until the matching
+ *	validate_jobs_batch_end() call
+ */
+extern void validate_jobs_batch_begin(bitstr_t *node_bitmap);
+
+/* validate_jobs_batch_end - release the index built by
+ *	validate_jobs_batch_begin() */
+extern void validate_jobs_batch_end(void);
+
 /*
  * validate_node_specs - validate the node's specifications as valid,
  *	if not set state to down, in any case update last_response
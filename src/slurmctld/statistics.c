@@ -111,6 +111,21 @@ extern void pack_all_stat(int resp, char **buffer_ptr, int *buffer_size,
 			pack32(slurmctld_diag_stats.bf_depth_try_sum, buffer);
 			pack32(slurmctld_diag_stats.bf_queue_len_sum, buffer);
 			pack32(slurmctld_diag_stats.bf_active,	 buffer);
+
+			if (protocol_version >= SLURM_17_11_PROTOCOL_VERSION) {
+				pack32(slurmctld_diag_stats.prio_cycle_counter,
+				       buffer);
+				pack32(slurmctld_diag_stats.prio_cycle_last,
+				       buffer);
+				pack32(slurmctld_diag_stats.prio_cycle_max,
+				       buffer);
+				pack32(slurmctld_diag_stats.prio_last_jobs,
+				       buffer);
+				pack32(slurmctld_diag_stats.prio_last_static,
+				       buffer);
+				pack32(slurmctld_diag_stats.prio_last_skip,
+				       buffer);
+			}
 		}
 	}
 
@@ -150,6 +165,8 @@ extern void reset_stats(int level)
 	slurmctld_diag_stats.bf_last_depth = 0;
 	slurmctld_diag_stats.bf_last_depth_try = 0;
 	slurmctld_diag_stats.bf_active = 0;
+	slurmctld_diag_stats.prio_cycle_counter = 0;
+	slurmctld_diag_stats.prio_cycle_max = 0;
 
 	last_proc_req_start = time(NULL);
 }
@@ -55,6 +55,7 @@
 #include "src/common/slurmdbd_defs.h"
 #include "src/common/slurm_protocol_defs.h"
 #include "src/common/uid.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -64,6 +65,7 @@
 #include "src/slurmctld/trigger_mgr.h"
 
 #define MAX_PROG_TIME 300	/* maximum run time for program */
+#define MAX_PROG_CNT  32	/* maximum number of programs run at once */
 
 /* Change TRIGGER_STATE_VERSION value when changing the state save format */
 #define TRIGGER_STATE_VERSION        "PROTOCOL_VERSION"
@@ -118,8 +120,31 @@ typedef struct trig_mgr_info {
 	bitstr_t *orig_bitmap;	/* bitmap of requested nodes (if applicable) */
 	char *   orig_res_id;	/* original node name or job_id (string) */
 	time_t   orig_time;	/* offset (pending) or time stamp (complete) */
+
+	bool     purge;		/* remove from trigger_list */
 } trig_mgr_info_t;
 
+/* Pending job triggers grouped by job ID */
+typedef struct trig_job_group {
+	char     job_key[16];	/* job ID as string, trig_job_hash key */
+	List     trig_list;	/* pending triggers of the job, not freed */
+} trig_job_group_t;
+
+/*
+ * Every trigger is in trigger_list, which owns the records. In addition each
+ * trigger is in exactly one of the lists below, so that trigger_process()
+ * need not scan all triggers on each pass:
+ * trig_job_groups - pending (state 0) job triggers, grouped by job ID
+ * trig_pend_list  - pending (state 0) triggers on nodes or daemons
+ * trig_run_list   - pulled (state 1) and completed (state 2) triggers
+ */
+static List trig_job_groups = NULL;
+static xhash_t *trig_job_hash = NULL;
+static List trig_pend_list = NULL;
+static List trig_run_list = NULL;
+static time_t trig_job_update = (time_t) 0; /* last_job_update at last test */
+static time_t trig_job_time = (time_t) 0;   /* next time trigger to test */
+
 /* Prototype for ListDelF */
 void _trig_del(void *x) {
 	trig_mgr_info_t * tmp = (trig_mgr_info_t *) x;
@@ -131,6 +156,83 @@ void _trig_del(void *x) {
 	xfree(tmp);
 }
 
+static void _trig_job_group_del(void *x)
+{
+	trig_job_group_t *group = (trig_job_group_t *) x;
+
+	FREE_NULL_LIST(group->trig_list);
+	xfree(group);
+}
+
+static const char *_trig_job_group_id(void *x)
+{
+	return ((trig_job_group_t *) x)->job_key;
+}
+
+static int _find_trig_rec(void *x, void *key)
+{
+	return (x == key);
+}
+
+/* Add a trigger to the index list matching its state and type */
+static void _trig_index(trig_mgr_info_t *trig_ptr)
+{
+	trig_job_group_t *group;
+	char job_key[16];
+
+	if (trig_run_list == NULL) {
+		trig_job_groups = list_create(_trig_job_group_del);
+		trig_job_hash = xhash_init(_trig_job_group_id, NULL, NULL, 0);
+		trig_pend_list = list_create(NULL);
+		trig_run_list = list_create(NULL);
+	}
+
+	if (trig_ptr->state != 0) {
+		list_append(trig_run_list, trig_ptr);
+	} else if (trig_ptr->res_type == TRIGGER_RES_TYPE_JOB) {
+		snprintf(job_key, sizeof(job_key), "%u", trig_ptr->job_id);
+		if (!(group = xhash_get(trig_job_hash, job_key))) {
+			group = xmalloc(sizeof(trig_job_group_t));
+			strcpy(group->job_key, job_key);
+			group->trig_list = list_create(NULL);
+			xhash_add(trig_job_hash, group);
+			list_append(trig_job_groups, group);
+		}
+		list_append(group->trig_list, trig_ptr);
+		trig_job_update = (time_t) 0;	/* test it on next pass */
+	} else {
+		list_append(trig_pend_list, trig_ptr);
+	}
+}
+
+/* Remove a trigger from its index list prior to deleting it. Empty job
+ * groups are removed by the next pass over the job triggers. */
+static void _trig_unindex(trig_mgr_info_t *trig_ptr)
+{
+	trig_job_group_t *group;
+	char job_key[16];
+
+	if (trig_run_list == NULL)
+		return;
+
+	if (trig_ptr->state != 0) {
+		list_delete_all(trig_run_list, _find_trig_rec, trig_ptr);
+	} else if (trig_ptr->res_type == TRIGGER_RES_TYPE_JOB) {
+		snprintf(job_key, sizeof(job_key), "%u", trig_ptr->job_id);
+		if ((group = xhash_get(trig_job_hash, job_key))) {
+			list_delete_all(group->trig_list, _find_trig_rec,
+					trig_ptr);
+		}
+	} else {
+		list_delete_all(trig_pend_list, _find_trig_rec, trig_ptr);
+	}
+}
+
+static int _trig_purged(void *x, void *key)
+{
+	return ((trig_mgr_info_t *) x)->purge;
+}
+
 static int _trig_offset(uint16_t offset)
 {
 	static int rc;
@@ -321,6 +423,7 @@ extern int trigger_clear(uid_t uid, trigger_info_msg_t *msg)
 			rc = ESLURM_ACCESS_DENIED;
 			continue;
 		}
+		_trig_unindex(trig_test);
 		list_delete_item(trig_iter);
 		rc = SLURM_SUCCESS;
 	}
@@ -374,27 +477,40 @@ extern trigger_info_msg_t * trigger_get(uid_t uid, trigger_info_msg_t *msg)
 	return resp_data;
 }
 
-static bool _duplicate_trigger(trigger_info_t *trig_desc)
+static int _match_dup_trigger(void *x, void *key)
 {
-	bool found_dup = false;
-	ListIterator trig_iter;
-	trig_mgr_info_t *trig_rec;
+	trig_mgr_info_t *trig_rec = (trig_mgr_info_t *) x;
+	trigger_info_t *trig_desc = (trigger_info_t *) key;
+
+	if ((trig_desc->flags     == trig_rec->flags)      &&
+	    (trig_desc->res_type  == trig_rec->res_type)   &&
+	    (trig_desc->trig_type == trig_rec->trig_type)  &&
+	    (trig_desc->offset    == trig_rec->trig_time)  &&
+	    (trig_desc->user_id   == trig_rec->user_id)    &&
+	    !xstrcmp(trig_desc->program, trig_rec->program) &&
+	    !xstrcmp(trig_desc->res_id, trig_rec->res_id))
+		return 1;
+	return 0;
+}
 
-	trig_iter = list_iterator_create(trigger_list);
-	while ((trig_rec = list_next(trig_iter))) {
-		if ((trig_desc->flags     == trig_rec->flags)      &&
-		    (trig_desc->res_type  == trig_rec->res_type)   &&
-		    (trig_desc->trig_type == trig_rec->trig_type)  &&
-		    (trig_desc->offset    == trig_rec->trig_time)  &&
-		    (trig_desc->user_id   == trig_rec->user_id)    &&
-		    !xstrcmp(trig_desc->program, trig_rec->program) &&
-		    !xstrcmp(trig_desc->res_id, trig_rec->res_id)) {
-			found_dup = true;
-			break;
-		}
-	}
-	list_iterator_destroy(trig_iter);
-	return found_dup;
+static bool _duplicate_trigger(trigger_info_t *trig_desc)
+{
+	trig_job_group_t *group;
+	char job_key[16];
+
+	if ((trig_desc->res_type != TRIGGER_RES_TYPE_JOB) || !trig_job_hash)
+		return (list_find_first(trigger_list, _match_dup_trigger,
+					trig_desc) != NULL);
+
+	/* A duplicate job trigger is either pending, in its job's group,
+	 * or already pulled */
+	snprintf(job_key, sizeof(job_key), "%u",
+		 (uint32_t) atol(trig_desc->res_id));
+	if ((group = xhash_get(trig_job_hash, job_key)) &&
+	    list_find_first(group->trig_list, _match_dup_trigger, trig_desc))
+		return true;
+	return (list_find_first(trig_run_list, _match_dup_trigger,
+				trig_desc) != NULL);
 }
 
 extern int trigger_set(uid_t uid, gid_t gid, trigger_info_msg_t *msg)
@@ -496,6 +612,7 @@ extern int trigger_set(uid_t uid, gid_t gid, trigger_info_msg_t *msg)
 			continue;
 		}
 		list_append(trigger_list, trig_add);
+		_trig_index(trig_add);
 		schedule_trigger_save();
 	}
 
@@ -788,6 +905,7 @@ static int _load_trigger_state(Buf buffer, uint16_t protocol_version)
 	if (trigger_list == NULL)
 		trigger_list = list_create(_trig_del);
 	list_append(trigger_list, trig_ptr);
+	_trig_index(trig_ptr);
 	next_trigger_id = MAX(next_trigger_id, trig_ptr->trig_id + 1);
 	slurm_mutex_unlock(&trigger_mutex);
 
@@ -976,8 +1094,16 @@ extern void trigger_state_restore(void)
 	xfree(ver_str);
 
 	safe_unpack_time(&buf_time, buffer);
+	/* The indexes point into trigger_list, drop them before its records
+	 * (they are rebuilt as the records are loaded) */
+	slurm_mutex_lock(&trigger_mutex);
+	FREE_NULL_LIST(trig_run_list);
+	FREE_NULL_LIST(trig_pend_list);
+	xhash_free(trig_job_hash);
+	FREE_NULL_LIST(trig_job_groups);
 	if (trigger_list)
 		list_delete_all (trigger_list, _match_all_triggers, NULL);
+	slurm_mutex_unlock(&trigger_mutex);
 	while (remaining_buf(buffer) > 0) {
 		if (_load_trigger_state(buffer, protocol_version) !=
 		    SLURM_SUCCESS)
@@ -1631,6 +1757,68 @@ static void _trigger_clone(trig_mgr_info_t *trig_in)
 	trig_add->group_id  = trig_in->group_id;
 	trig_add->program   = xstrdup(trig_in->program);;
 	list_prepend(trigger_list, trig_add);
+	_trig_index(trig_add);
+}
+
+/* Test if any pending job trigger may have been pulled since the last
+ * pass: a job changed state, a job's time trigger is due or some node
+ * changed state */
+static bool _job_trigger_test(time_t now)
+{
+	if (list_count(trig_job_groups) == 0)
+		return false;
+	if (trig_job_update != last_job_update)
+		return true;
+	if (trig_job_time && (trig_job_time <= now))
+		return true;
+	if ((trigger_down_front_end_bitmap &&
+	     (bit_ffs(trigger_down_front_end_bitmap) != -1)) ||
+	    (trigger_down_nodes_bitmap &&
+	     (bit_ffs(trigger_down_nodes_bitmap) != -1))	||
+	    (trigger_fail_nodes_bitmap &&
+	     (bit_ffs(trigger_fail_nodes_bitmap) != -1))	||
+	    (trigger_up_nodes_bitmap &&
+	     (bit_ffs(trigger_up_nodes_bitmap) != -1)))
+		return true;
+	return false;
+}
+
+/* Test each job's pending triggers, moving pulled ones to trig_run_list */
+static void _trigger_job_groups(time_t now)
+{
+	ListIterator group_iter, trig_iter;
+	trig_job_group_t *group;
+	trig_mgr_info_t *trig_in;
+	time_t fire_time;
+
+	trig_job_update = last_job_update;
+	trig_job_time = (time_t) 0;
+	group_iter = list_iterator_create(trig_job_groups);
+	while ((group = list_next(group_iter))) {
+		trig_iter = list_iterator_create(group->trig_list);
+		while ((trig_in = list_next(trig_iter))) {
+			_trigger_job_event(trig_in, now);
+			if (trig_in->state != 0) {
+				list_remove(trig_iter);
+				list_append(trig_run_list, trig_in);
+				continue;
+			}
+			if (!(trig_in->trig_type & TRIGGER_TYPE_TIME) ||
+			    IS_JOB_PENDING(trig_in->job_ptr))
+				continue;
+			/* Time at which the job's end is within offset */
+			fire_time = trig_in->job_ptr->end_time -
+				    (0x8000 - trig_in->trig_time);
+			if (!trig_job_time || (fire_time < trig_job_time))
+				trig_job_time = fire_time;
+		}
+		list_iterator_destroy(trig_iter);
+		if (list_count(group->trig_list) == 0) {
+			xhash_pop(trig_job_hash, group->job_key);
+			list_delete_item(group_iter);
+		}
+	}
+	list_iterator_destroy(group_iter);
 }
 
 extern void trigger_process(void)
@@ -1640,36 +1828,58 @@ extern void trigger_process(void)
 	time_t now = time(NULL);
 	bool state_change = false;
 	pid_t rc;
-	int prog_stat;
+	int prog_stat, prog_cnt = 0, purge_cnt = 0;
 
 	slurm_mutex_lock(&trigger_mutex);
 	if (trigger_list == NULL)
 		trigger_list = list_create(_trig_del);
+	if (trig_run_list == NULL) {
+		_clear_event_triggers();
+		slurm_mutex_unlock(&trigger_mutex);
+		return;		/* No triggers yet */
+	}
 
-	trig_iter = list_iterator_create(trigger_list);
+	trig_iter = list_iterator_create(trig_pend_list);
 	while ((trig_in = list_next(trig_iter))) {
-		if (trig_in->state == 0) {
-			if (trig_in->res_type == TRIGGER_RES_TYPE_OTHER)
-				_trigger_other_event(trig_in, now);
-			else if (trig_in->res_type == TRIGGER_RES_TYPE_JOB)
-				_trigger_job_event(trig_in, now);
-			else if (trig_in->res_type == TRIGGER_RES_TYPE_NODE)
-				_trigger_node_event(trig_in, now);
-			else if (trig_in->res_type ==
-				 TRIGGER_RES_TYPE_SLURMCTLD)
-				_trigger_slurmctld_event(trig_in, now);
-			else if (trig_in->res_type ==
-				 TRIGGER_RES_TYPE_SLURMDBD)
-				_trigger_slurmdbd_event(trig_in, now);
-			else if (trig_in->res_type ==
-				 TRIGGER_RES_TYPE_DATABASE)
-			 	_trigger_database_event(trig_in, now);
-			else if (trig_in->res_type ==
-				 TRIGGER_RES_TYPE_FRONT_END)
-			 	_trigger_front_end_event(trig_in, now);
+		if (trig_in->res_type == TRIGGER_RES_TYPE_OTHER)
+			_trigger_other_event(trig_in, now);
+		else if (trig_in->res_type == TRIGGER_RES_TYPE_NODE)
+			_trigger_node_event(trig_in, now);
+		else if (trig_in->res_type == TRIGGER_RES_TYPE_SLURMCTLD)
+			_trigger_slurmctld_event(trig_in, now);
+		else if (trig_in->res_type == TRIGGER_RES_TYPE_SLURMDBD)
+			_trigger_slurmdbd_event(trig_in, now);
+		else if (trig_in->res_type == TRIGGER_RES_TYPE_DATABASE)
+			_trigger_database_event(trig_in, now);
+		else if (trig_in->res_type == TRIGGER_RES_TYPE_FRONT_END)
+			_trigger_front_end_event(trig_in, now);
+		if (trig_in->state != 0) {
+			list_remove(trig_iter);
+			list_append(trig_run_list, trig_in);
 		}
+	}
+	list_iterator_destroy(trig_iter);
+
+	if (_job_trigger_test(now))
+		_trigger_job_groups(now);
+
+	/* Programs still running limit how many more may be started */
+	trig_iter = list_iterator_create(trig_run_list);
+	while ((trig_in = list_next(trig_iter))) {
+		if ((trig_in->state == 2) && trig_in->child_pid)
+			prog_cnt++;
+	}
+	list_iterator_reset(trig_iter);
+	while ((trig_in = list_next(trig_iter))) {
 		if ((trig_in->state == 1) &&
-		    (trig_in->trig_time <= now)) {
+		    (trig_in->trig_time <= now) &&
+		    (prog_cnt >= MAX_PROG_CNT)) {
+			if (slurmctld_conf.debug_flags & DEBUG_FLAG_TRIGGERS) {
+				info("trigger[%u] deferred, %d programs "
+				     "running", trig_in->trig_id, prog_cnt);
+			}
+		} else if ((trig_in->state == 1) &&
+			   (trig_in->trig_time <= now)) {
 			if (slurmctld_conf.debug_flags & DEBUG_FLAG_TRIGGERS) {
 				info("launching program for trigger[%u]",
 				     trig_in->trig_id);
@@ -1684,6 +1894,8 @@ extern void trigger_process(void)
 			trig_in->trig_time = now;
 			state_change = true;
 			_trigger_run_program(trig_in);
+			if (trig_in->child_pid)
+				prog_cnt++;
 		} else if ((trig_in->state == 2) &&
 			   (difftime(now, trig_in->trig_time) >
 			    MAX_PROG_TIME)) {
@@ -1701,8 +1913,10 @@ extern void trigger_process(void)
 					     WTERMSIG(prog_stat));
 				}
 				if ((rc == trig_in->child_pid) ||
-				    ((rc == -1) && (errno == ECHILD)))
+				    ((rc == -1) && (errno == ECHILD))) {
 					trig_in->child_pid = 0;
+					prog_cnt--;
+				}
 			}
 
 			if (trig_in->child_pid == 0) {
@@ -1711,7 +1925,9 @@ extern void trigger_process(void)
 					info("purging trigger[%u]",
 					     trig_in->trig_id);
 				}
-				list_delete_item(trig_iter);
+				list_remove(trig_iter);
+				trig_in->purge = true;
+				purge_cnt++;
 				state_change = true;
 			}
 		} else if (trig_in->state == 2) {
@@ -1726,12 +1942,17 @@ extern void trigger_process(void)
 				     WIFEXITED(prog_stat),
 				     WTERMSIG(prog_stat));
 			}
-			if ((rc == trig_in->child_pid) ||
-			    ((rc == -1) && (errno == ECHILD)))
+			if (trig_in->child_pid &&
+			    ((rc == trig_in->child_pid) ||
+			     ((rc == -1) && (errno == ECHILD)))) {
 				trig_in->child_pid = 0;
+				prog_cnt--;
+			}
 		}
 	}
 	list_iterator_destroy(trig_iter);
+	if (purge_cnt)
+		list_delete_all(trigger_list, _trig_purged, NULL);
 	_clear_event_triggers();
 	slurm_mutex_unlock(&trigger_mutex);
 	if (state_change)
@@ -1741,6 +1962,10 @@ extern void trigger_process(void)
 /* Free all allocated memory */
 extern void trigger_fini(void)
 {
+	FREE_NULL_LIST(trig_run_list);
+	FREE_NULL_LIST(trig_pend_list);
+	xhash_free(trig_job_hash);
+	FREE_NULL_LIST(trig_job_groups);
 	FREE_NULL_LIST(trigger_list);
 	FREE_NULL_BITMAP(trigger_down_front_end_bitmap);
 	FREE_NULL_BITMAP(trigger_up_front_end_bitmap);
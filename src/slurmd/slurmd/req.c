@@ -222,7 +222,7 @@ static int  _waiter_complete (uint32_t jobid);
 static void _send_back_fd(int socket, int fd);
 static bool _steps_completed_now(uint32_t jobid);
 static int  _valid_sbcast_cred(file_bcast_msg_t *req, uid_t req_uid,
-			       uint16_t block_no, uint32_t *job_id);
+			       uint32_t block_no, uint32_t *job_id);
 static void _wait_state_completed(uint32_t jobid, int max_delay);
 static uid_t _get_job_uid(uint32_t jobid);
 
@@ -3793,7 +3793,7 @@ static void  _rpc_pid2jid(slurm_msg_t *msg)
  * Munge without generating a credential replay error
  * RET SLURM_SUCCESS or an error code */
 static int
-_valid_sbcast_cred(file_bcast_msg_t *req, uid_t req_uid, uint16_t block_no,
+_valid_sbcast_cred(file_bcast_msg_t *req, uid_t req_uid, uint32_t block_no,
 		   uint32_t *job_id)
 {
 	int rc = SLURM_SUCCESS;
@@ -3944,6 +3944,7 @@ void file_bcast_purge(void)
 static int _rpc_file_bcast(slurm_msg_t *msg)
 {
 	int rc, offset, inx;
+	bool complete = false;
 	file_bcast_info_t *file_info;
 	file_bcast_msg_t *req = msg->data;
 	file_bcast_info_t key;
@@ -3999,10 +4000,26 @@ static int _rpc_file_bcast(slurm_msg_t *msg)
 		return SLURM_FAILURE;
 	}
 
+	if ((msg->protocol_version >= SLURM_17_11_PROTOCOL_VERSION) &&
+	    (bcast_block_cksum(req->block, req->block_len) !=
+	     req->block_cksum)) {
+		error("sbcast: checksum mismatch in block %u for UID %u, file %s",
+		      req->block_no, key.uid, key.fname);
+		_fb_rdunlock();
+		return ESLURMD_BCAST_CHECKSUM_ERROR;
+	}
+
+	/* Newer clients may have several blocks in flight, so write each
+	 * block at its own offset rather than appending */
 	offset = 0;
 	while (req->block_len - offset) {
-		inx = write(file_info->fd, &req->block[offset],
-			    (req->block_len - offset));
+		if (msg->protocol_version >= SLURM_17_11_PROTOCOL_VERSION)
+			inx = pwrite(file_info->fd, &req->block[offset],
+				     (req->block_len - offset),
+				     req->block_offset + offset);
+		else
+			inx = write(file_info->fd, &req->block[offset],
+				    (req->block_len - offset));
 		if (inx == -1) {
 			if ((errno == EINTR) || (errno == EAGAIN))
 				continue;
@@ -4014,17 +4031,24 @@ static int _rpc_file_bcast(slurm_msg_t *msg)
 		offset += inx;
 	}
 
+	/* The last block may arrive before others still being written, the
+	 * transfer is complete once every byte of the file has been written */
+	slurm_mutex_lock(&file_bcast_mutex);
 	file_info->last_update = time(NULL);
+	file_info->received_bytes += req->block_len;
+	if (file_info->received_bytes >= file_info->file_size)
+		complete = true;
+	slurm_mutex_unlock(&file_bcast_mutex);
 
-	if (req->last_block && fchmod(file_info->fd, (req->modes & 0777))) {
+	if (complete && fchmod(file_info->fd, (req->modes & 0777))) {
 		error("sbcast: uid:%u can't chmod `%s`: %m",
 		      key.uid, key.fname);
 	}
-	if (req->last_block && fchown(file_info->fd, key.uid, key.gid)) {
+	if (complete && fchown(file_info->fd, key.uid, key.gid)) {
 		error("sbcast: uid:%u gid:%u can't chown `%s`: %m",
 		      key.uid, key.gid, key.fname);
 	}
-	if (req->last_block && req->atime) {
+	if (complete && req->atime) {
 		struct utimbuf time_buf;
 		time_buf.actime  = req->atime;
 		time_buf.modtime = req->mtime;
@@ -4036,7 +4060,7 @@ static int _rpc_file_bcast(slurm_msg_t *msg)
 
 	_fb_rdunlock();
 
-	if (req->last_block) {
+	if (complete) {
 		_file_bcast_close_file(&key);
 	}
 	return SLURM_SUCCESS;
@@ -4145,6 +4169,7 @@ static int _file_bcast_register_file(slurm_msg_t *msg,
 		file_info->uid = key->uid;
 		file_info->gid = key->gid;
 		file_info->job_id = key->job_id;
+		file_info->file_size = req->file_size;
 		file_info->start_time = time(NULL);
 
 		//TODO: mmap the file here
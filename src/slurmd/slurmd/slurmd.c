@@ -802,7 +802,7 @@ _massage_pathname(char **path)
 static void
 _read_config(void)
 {
-	char *path_pubkey = NULL;
+	char *path_pubkey = NULL, *comm_params;
 	slurm_ctl_conf_t *cf = NULL;
 	int cc;
 #ifndef HAVE_FRONT_END
@@ -1042,6 +1042,13 @@ _read_config(void)
 
 	slurm_mutex_unlock(&conf->config_mutex);
 	slurm_conf_unlock();
+
+	/* Reopen to pick up any change of controller address */
+	slurm_persist_ctld_conn_fini();
+	comm_params = slurm_get_comm_params();
+	if (xstrcasestr(comm_params, "persist_node_conn"))
+		slurm_persist_ctld_conn_init();
+	xfree(comm_params);
 }
 
 static void
@@ -1729,6 +1736,7 @@ _slurmd_fini(void)
 	acct_gather_conf_destroy();
 	fini_system_cgroup();
 	route_fini();
+	slurm_persist_ctld_conn_fini();
 
 	return SLURM_SUCCESS;
 }
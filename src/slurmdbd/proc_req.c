@@ -62,6 +62,13 @@
 #include "src/slurmdbd/slurmdbd.h"
 #include "src/slurmctld/slurmctld.h"
 
+/* Queries from clients (sacct, sacctmgr list, sreport) can run for a long
+ * time.  Only MaxQueryRPCs of them are processed at once so they can't
+ * tie up the database while the slurmctlds are sending job records. */
+static pthread_mutex_t query_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  query_cond = PTHREAD_COND_INITIALIZER;
+static int query_cnt = 0;
+
 /* Local functions */
 static int   _unpack_persist_init(slurmdbd_conn_t *slurmdbd_conn,
 				  persist_msg_t *msg, Buf *out_buffer,
@@ -231,6 +238,67 @@ static int   _step_complete(slurmdbd_conn_t *slurmdbd_conn,
 static int   _step_start(slurmdbd_conn_t *slurmdbd_conn,
 			 persist_msg_t *msg, Buf *out_buffer, uint32_t *uid);
 
+/* Return true if msg_type only reads from the database */
+static bool _is_query_rpc(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case DBD_GET_ACCOUNTS:
+	case DBD_GET_TRES:
+	case DBD_GET_ASSOCS:
+	case DBD_GET_ASSOC_USAGE:
+	case DBD_GET_WCKEY_USAGE:
+	case DBD_GET_CLUSTER_USAGE:
+	case DBD_GET_CLUSTERS:
+	case DBD_GET_FEDERATIONS:
+	case DBD_GET_EVENTS:
+	case DBD_GET_JOBS_COND:
+	case DBD_GET_PROBS:
+	case DBD_GET_QOS:
+	case DBD_GET_RES:
+	case DBD_GET_TXN:
+	case DBD_GET_WCKEYS:
+	case DBD_GET_RESVS:
+	case DBD_GET_USERS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Wait for a query slot if this is a query from a client and MaxQueryRPCs
+ * is set.  Requests from the SlurmUser (the slurmctlds) and anything that
+ * writes to the database are never held back.
+ * RET true if a slot was taken, release it with _query_slot_put() */
+static bool _query_slot_get(slurmdbd_conn_t *slurmdbd_conn,
+			    persist_msg_t *msg, uint32_t uid)
+{
+	if (!slurmdbd_conf->max_query_rpcs ||
+	    (uid == slurmdbd_conf->slurm_user_id) ||
+	    !_is_query_rpc(msg->msg_type))
+		return false;
+
+	slurm_mutex_lock(&query_lock);
+	if (query_cnt >= slurmdbd_conf->max_query_rpcs)
+		debug2("CONN:%u %s waiting on %d running queries",
+		       slurmdbd_conn->conn->fd,
+		       slurmdbd_msg_type_2_str(msg->msg_type, 1), query_cnt);
+	while (slurmdbd_conf->max_query_rpcs &&
+	       (query_cnt >= slurmdbd_conf->max_query_rpcs))
+		slurm_cond_wait(&query_cond, &query_lock);
+	query_cnt++;
+	slurm_mutex_unlock(&query_lock);
+
+	return true;
+}
+
+static void _query_slot_put(void)
+{
+	slurm_mutex_lock(&query_lock);
+	query_cnt--;
+	slurm_cond_signal(&query_cond);
+	slurm_mutex_unlock(&query_lock);
+}
+
 /* Process an incoming RPC
  * slurmdbd_conn IN/OUT - in will that the conn.fd set before
  *       calling and db_conn and conn.version will be filled in with the init.
@@ -248,9 +316,11 @@ proc_req(void *conn, persist_msg_t *msg,
 	int rc = SLURM_SUCCESS;
 	char *comment = NULL;
 	int i, rpc_type_index = -1, rpc_user_index = -1;
+	bool query_slot;
 
 	DEF_TIMERS;
 	START_TIMER;
+	query_slot = _query_slot_get(slurmdbd_conn, msg, *uid);
 	switch (msg->msg_type) {
 	case REQUEST_PERSIST_INIT:
 		rc = _unpack_persist_init(
@@ -539,6 +609,9 @@ proc_req(void *conn, persist_msg_t *msg,
 		break;
 	}
 
+	if (query_slot)
+		_query_slot_put();
+
 	if (rc == ESLURM_ACCESS_DENIED)
 		error("CONN:%u Security violation, %s",
 		      slurmdbd_conn->conn->fd,
@@ -3215,6 +3288,9 @@ static int   _roll_usage(slurmdbd_conn_t *slurmdbd_conn,
 			MAX(rpc_stats.rollup_max_time[i],
 			    rollup_stats.rollup_time[i]);
 	}
+	rpc_stats.rollup_hours += rollup_stats.rollup_hours;
+	rpc_stats.rollup_last_hour = MAX(rpc_stats.rollup_last_hour,
+					 rollup_stats.rollup_last_hour);
 	slurm_mutex_unlock(&rpc_mutex);
 
 end_it:
@@ -3521,6 +3597,8 @@ static int  _clear_stats(slurmdbd_conn_t *slurmdbd_conn,
 		rpc_stats.rollup_time[i] = 0;
 		rpc_stats.rollup_max_time[i] = 0;
 	}
+	rpc_stats.rollup_hours = 0;
+	rpc_stats.rollup_last_hour = 0;
 	for (i = 0; i < rpc_stats.type_cnt; i++) {
 		rpc_stats.rpc_type_cnt[i] = 0;
 		rpc_stats.rpc_type_time[i] = 0;
@@ -86,6 +86,7 @@ extern void free_slurmdbd_conf(void)
 static void _clear_slurmdbd_conf(void)
 {
 	if (slurmdbd_conf) {
+		slurmdbd_conf->archive_compress = 0;
 		xfree(slurmdbd_conf->archive_dir);
 		xfree(slurmdbd_conf->archive_script);
 		xfree(slurmdbd_conf->auth_info);
@@ -99,6 +100,7 @@ static void _clear_slurmdbd_conf(void)
 		slurmdbd_conf->debug_level = 0;
 		xfree(slurmdbd_conf->default_qos);
 		xfree(slurmdbd_conf->log_file);
+		slurmdbd_conf->max_query_rpcs = 0;
 		xfree(slurmdbd_conf->pid_file);
 		xfree(slurmdbd_conf->plugindir);
 		slurmdbd_conf->private_data = 0;
@@ -132,6 +134,7 @@ static void _clear_slurmdbd_conf(void)
 extern int read_slurmdbd_conf(void)
 {
 	s_p_options_t options[] = {
+		{"ArchiveCompress", S_P_BOOLEAN},
 		{"ArchiveDir", S_P_STRING},
 		{"ArchiveEvents", S_P_BOOLEAN},
 		{"ArchiveJobs", S_P_BOOLEAN},
@@ -154,6 +157,7 @@ extern int read_slurmdbd_conf(void)
 		{"JobPurge", S_P_UINT32},
 		{"LogFile", S_P_STRING},
 		{"LogTimeFormat", S_P_STRING},
+		{"MaxQueryRPCs", S_P_UINT16},
 		{"MessageTimeout", S_P_UINT16},
 		{"PidFile", S_P_STRING},
 		{"PluginDir", S_P_STRING},
@@ -205,7 +209,7 @@ extern int read_slurmdbd_conf(void)
 	} else {
 		bool a_events = false, a_jobs = false, a_resv = false;
 		bool a_steps = false, a_suspend = false, a_txn = false;
-		bool a_usage = false;
+		bool a_usage = false, a_compress = false;
 		debug("Reading slurmdbd.conf file %s", conf_path);
 
 		tbl = s_p_hashtbl_create(options);
@@ -215,6 +219,8 @@ extern int read_slurmdbd_conf(void)
 			      conf_path);
 		}
 
+		if (s_p_get_boolean(&a_compress, "ArchiveCompress", tbl))
+			slurmdbd_conf->archive_compress = a_compress;
 		if (!s_p_get_string(&slurmdbd_conf->archive_dir, "ArchiveDir",
 				    tbl))
 			slurmdbd_conf->archive_dir =
@@ -285,6 +291,9 @@ extern int read_slurmdbd_conf(void)
 		} else
 			slurmdbd_conf->log_fmt = LOG_FMT_ISO8601_MS;
 
+		s_p_get_uint16(&slurmdbd_conf->max_query_rpcs,
+			       "MaxQueryRPCs", tbl);
+
 		if (!s_p_get_uint16(&slurmdbd_conf->msg_timeout,
 				    "MessageTimeout", tbl))
 			slurmdbd_conf->msg_timeout = DEFAULT_MSG_TIMEOUT;
@@ -606,6 +615,8 @@ extern void log_config(void)
 	char tmp_str[128];
 	char *tmp_ptr = NULL;
 
+	debug2("ArchiveCompress   = %s",
+	       slurmdbd_conf->archive_compress ? "Yes" : "No");
 	debug2("ArchiveDir        = %s", slurmdbd_conf->archive_dir);
 	debug2("ArchiveScript     = %s", slurmdbd_conf->archive_script);
 	debug2("AuthInfo          = %s", slurmdbd_conf->auth_info);
@@ -622,6 +633,7 @@ extern void log_config(void)
 	debug2("DefaultQOS        = %s", slurmdbd_conf->default_qos);
 
 	debug2("LogFile           = %s", slurmdbd_conf->log_file);
+	debug2("MaxQueryRPCs      = %u", slurmdbd_conf->max_query_rpcs);
 	debug2("MessageTimeout    = %u", slurmdbd_conf->msg_timeout);
 	debug2("PidFile           = %s", slurmdbd_conf->pid_file);
 	debug2("PluginDir         = %s", slurmdbd_conf->plugindir);
@@ -704,6 +716,12 @@ extern List dump_config(void)
 	config_key_pair_t *key_pair;
 	List my_list = list_create(destroy_config_key_pair);
 
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("ArchiveCompress");
+	key_pair->value = xstrdup(
+		slurmdbd_conf->archive_compress ? "Yes" : "No");
+	list_append(my_list, key_pair);
+
 	key_pair = xmalloc(sizeof(config_key_pair_t));
 	key_pair->name = xstrdup("ArchiveDir");
 	key_pair->value = xstrdup(slurmdbd_conf->archive_dir);
@@ -824,6 +842,11 @@ extern List dump_config(void)
 	key_pair->value = xstrdup(slurmdbd_conf->log_file);
 	list_append(my_list, key_pair);
 
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("MaxQueryRPCs");
+	key_pair->value = xstrdup_printf("%u", slurmdbd_conf->max_query_rpcs);
+	list_append(my_list, key_pair);
+
 	key_pair = xmalloc(sizeof(config_key_pair_t));
 	key_pair->name = xstrdup("MessageTimeout");
 	key_pair->value = xstrdup_printf("%u secs", slurmdbd_conf->msg_timeout);
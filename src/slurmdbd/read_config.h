@@ -55,6 +55,7 @@
 /* SlurmDBD configuration parameters */
 typedef struct slurm_dbd_conf {
 	time_t		last_update;	/* time slurmdbd.conf read	*/
+	uint16_t	archive_compress; /* gzip archive files		*/
 	char *		archive_dir;    /* location to localy
 					 * store data if not
 					 * using a script               */
@@ -74,6 +75,8 @@ typedef struct slurm_dbd_conf {
 					 * adding clusters              */
 	char *		log_file;	/* Log file			*/
 	uint16_t        log_fmt;        /* Log file timestamt format    */
+	uint16_t	max_query_rpcs;	/* client queries processed at
+					 * once, 0 is unlimited		*/
 	uint16_t        msg_timeout;    /* message timeout		*/
 	char *		pid_file;	/* where to store current PID	*/
 	char *		plugindir;	/* dir to look for plugins	*/
@@ -723,6 +723,9 @@ static void *_rollup_handler(void *db_conn)
 				MAX(rpc_stats.rollup_max_time[i],
 				    rollup_stats.rollup_time[i]);
 		}
+		rpc_stats.rollup_hours += rollup_stats.rollup_hours;
+		rpc_stats.rollup_last_hour = MAX(rpc_stats.rollup_last_hour,
+						 rollup_stats.rollup_last_hour);
 		slurm_mutex_unlock(&rpc_mutex);
 
 		/* get the time now we have rolled usage */
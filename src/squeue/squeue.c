@@ -163,15 +163,91 @@ _get_window_width( void )
 }
 
 
+/* Copy a List of uint32_t into an xmalloc'ed array */
+static uint32_t *_list_to_array(List id_list, uint32_t *id_cnt)
+{
+	ListIterator iterator;
+	uint32_t *id_array, *id;
+	int i = 0;
+
+	*id_cnt = list_count(id_list);
+	id_array = xmalloc(sizeof(uint32_t) * (*id_cnt));
+	iterator = list_iterator_create(id_list);
+	while ((id = list_next(iterator)))
+		id_array[i++] = *id;
+	list_iterator_destroy(iterator);
+	return id_array;
+}
+
+/* Join a List of strings into a comma separated string */
+static char *_list_to_str(List str_list)
+{
+	ListIterator iterator;
+	char *str = NULL, *name;
+
+	iterator = list_iterator_create(str_list);
+	while ((name = list_next(iterator)))
+		xstrfmtcat(str, "%s%s", str ? "," : "", name);
+	list_iterator_destroy(iterator);
+	return str;
+}
+
+/*
+ * Build the filter sent to slurmctld with the job information request so
+ * that only the jobs we could print are sent to us. The filter is a superset
+ * of the one in print.c, which is still applied to the response.
+ */
+static job_info_filter_t *_build_job_filter(void)
+{
+	job_info_filter_t *filter = xmalloc(sizeof(job_info_filter_t));
+	squeue_job_step_t *job_step_id;
+	ListIterator iterator;
+	int i = 0;
+
+	if (params.account_list && list_count(params.account_list))
+		filter->accounts = _list_to_str(params.account_list);
+	if (params.part_list && list_count(params.part_list))
+		filter->partitions = _list_to_str(params.part_list);
+	if (params.user_list && list_count(params.user_list))
+		filter->user_ids = _list_to_array(params.user_list,
+						  &filter->user_id_cnt);
+	if (params.state_list && list_count(params.state_list)) {
+		filter->states = _list_to_array(params.state_list,
+						&filter->state_cnt);
+	} else {
+		filter->state_cnt = 4;
+		filter->states = xmalloc(sizeof(uint32_t) * filter->state_cnt);
+		filter->states[0] = JOB_PENDING;
+		filter->states[1] = JOB_RUNNING;
+		filter->states[2] = JOB_SUSPENDED;
+		filter->states[3] = JOB_COMPLETING;
+	}
+	if (params.job_list && list_count(params.job_list)) {
+		filter->job_id_cnt = list_count(params.job_list);
+		filter->job_ids = xmalloc(sizeof(uint32_t) *
+					  filter->job_id_cnt);
+		iterator = list_iterator_create(params.job_list);
+		while ((job_step_id = list_next(iterator)))
+			filter->job_ids[i++] = job_step_id->job_id;
+		list_iterator_destroy(iterator);
+	}
+
+	return filter;
+}
+
 /* _print_job - print the specified job's information */
 static int
 _print_job ( bool clear_old )
 {
 	static job_info_msg_t *old_job_ptr;
+	static job_info_filter_t *filter = NULL;
 	job_info_msg_t *new_job_ptr;
 	int error_code;
 	uint16_t show_flags = 0;
 
+	if (!filter)
+		filter = _build_job_filter();
+
 	if (params.all_flag || (params.job_list && list_count(params.job_list)))
 		show_flags |= SHOW_ALL;
 
@@ -191,9 +267,9 @@ _print_job ( bool clear_old )
 							 params.user_id,
 							 show_flags);
 		} else {
-			error_code = slurm_load_jobs(
+			error_code = slurm_load_jobs_filter(
 				old_job_ptr->last_update,
-				&new_job_ptr, show_flags);
+				&new_job_ptr, show_flags, filter);
 		}
 		if (error_code ==  SLURM_SUCCESS)
 			slurm_free_job_info_msg( old_job_ptr );
@@ -208,8 +284,9 @@ _print_job ( bool clear_old )
 		error_code = slurm_load_job_user(&new_job_ptr, params.user_id,
 						 show_flags);
 	} else {
-		error_code = slurm_load_jobs((time_t) NULL, &new_job_ptr,
-					     show_flags);
+		error_code = slurm_load_jobs_filter((time_t) NULL,
+						    &new_job_ptr, show_flags,
+						    filter);
 	}
 
 	if (error_code) {
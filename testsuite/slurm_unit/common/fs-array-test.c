@@ -0,0 +1,366 @@
+/*****************************************************************************\
+ *  fs-array-test.c - Test of the flat association array used by the
+ *	priority/multifactor plugin to compute fair-share factors
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "slurm/slurmdb.h"
+#include "src/common/list.h"
+#include "src/common/slurmdb_defs.h"
+#include "src/common/timers.h"
+#include "src/common/xmalloc.h"
+
+#include "src/plugins/priority/multifactor/fs_array.h"
+
+#include <testsuite/dejagnu.h>
+
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define ASSOC_CNT	16
+#define DAMP_FACTOR	1
+
+/* Tree used when SLURM_UNIT_BENCHMARK is set, 100,101 associations */
+#define BENCH_ACCT_CNT		100
+#define BENCH_SUB_ACCT_CNT	10
+#define BENCH_USER_CNT		99
+#define BENCH_ASSOC_CNT		(1 + BENCH_ACCT_CNT * \
+				 (1 + BENCH_SUB_ACCT_CNT * \
+				  (1 + BENCH_USER_CNT)))
+#define BENCH_PASSES		10
+
+static slurmdb_assoc_rec_t *assocs = NULL;
+static int assoc_cnt = 0;
+
+/* Add an association the way assoc_mgr links it: to the children_list of
+ * its fair-share parent, the first ancestor not using FairShare=parent,
+ * unless its parent was given a children_list of its own */
+static slurmdb_assoc_rec_t *_add_assoc(slurmdb_assoc_rec_t *parent,
+				       uint32_t shares, char *user,
+				       long double usage_raw)
+{
+	slurmdb_assoc_rec_t *assoc = &assocs[assoc_cnt++], *fs_parent, *ptr;
+	List children;
+
+	assoc->usage = slurmdb_create_assoc_usage(1);
+	assoc->shares_raw = shares;
+	assoc->user = user;
+	if (!parent) {
+		assoc->usage->shares_norm = 1.0;
+		return assoc;
+	}
+
+	fs_parent = parent;
+	if (parent->shares_raw == SLURMDB_FS_USE_PARENT)
+		fs_parent = parent->usage->fs_assoc_ptr;
+	assoc->usage->parent_assoc_ptr = parent;
+	assoc->usage->fs_assoc_ptr = fs_parent;
+	if (!(children = parent->usage->children_list)) {
+		if (!fs_parent->usage->children_list)
+			fs_parent->usage->children_list = list_create(NULL);
+		children = fs_parent->usage->children_list;
+	}
+	list_append(children, assoc);
+
+	/* The decay thread adds usage to every ancestor */
+	for (ptr = assoc; ptr; ptr = ptr->usage->parent_assoc_ptr)
+		ptr->usage->usage_raw += usage_raw;
+	return assoc;
+}
+
+/* Set level_shares and shares_norm of the children of an association */
+static void _set_shares(slurmdb_assoc_rec_t *assoc)
+{
+	slurmdb_assoc_rec_t *child;
+	ListIterator itr;
+	uint32_t level_shares = 0;
+
+	if (!assoc->usage->children_list)
+		return;
+
+	itr = list_iterator_create(assoc->usage->children_list);
+	while ((child = list_next(itr))) {
+		if (child->shares_raw != SLURMDB_FS_USE_PARENT)
+			level_shares += child->shares_raw;
+	}
+	list_iterator_reset(itr);
+	while ((child = list_next(itr))) {
+		child->usage->level_shares = level_shares;
+		if (child->shares_raw == SLURMDB_FS_USE_PARENT)
+			child->usage->shares_norm = assoc->usage->shares_norm;
+		else
+			child->usage->shares_norm = assoc->usage->shares_norm *
+				(double)child->shares_raw /
+				(double)level_shares;
+		_set_shares(child);
+	}
+	list_iterator_destroy(itr);
+}
+
+/* Effective usage as computed by _set_assoc_usage_efctv() in
+ * priority_multifactor.c when walking the association tree */
+static long double _efctv(slurmdb_assoc_rec_t *root,
+			  slurmdb_assoc_rec_t *assoc, bool depth_oblivious)
+{
+	slurmdb_assoc_usage_t *usage = assoc->usage;
+	slurmdb_assoc_rec_t *parent = usage->fs_assoc_ptr, *sibling;
+	ListIterator itr;
+	long double ratio_p, ratio_l, ratio_s = 0, k;
+
+	if (parent == root)
+		return usage->usage_norm;
+	if (assoc->shares_raw == SLURMDB_FS_USE_PARENT)
+		return parent->usage->usage_efctv;
+	if (!depth_oblivious) {
+		if (!usage->level_shares)
+			return parent->usage->usage_efctv;
+		return usage->usage_norm +
+			(parent->usage->usage_efctv - usage->usage_norm) *
+			(assoc->shares_raw / (long double)usage->level_shares);
+	}
+
+	if (!usage->shares_norm || !parent->usage->shares_norm ||
+	    !parent->usage->usage_efctv || !usage->usage_norm)
+		return usage->usage_norm;
+	ratio_p = parent->usage->usage_efctv / parent->usage->shares_norm;
+	itr = list_iterator_create(parent->usage->children_list);
+	while ((sibling = list_next(itr))) {
+		if (sibling->shares_raw != SLURMDB_FS_USE_PARENT)
+			ratio_s += sibling->usage->usage_norm;
+	}
+	list_iterator_destroy(itr);
+	ratio_s /= parent->usage->shares_norm;
+	ratio_l = (usage->usage_norm / usage->shares_norm) / ratio_s;
+	if (!ratio_p || !ratio_l || (logl(ratio_p) * logl(ratio_l) >= 0))
+		k = 1;
+	else
+		k = 1 / (1 + powl(5.0 * logl(ratio_p), 2));
+	return ratio_p * pow(ratio_l, k) * usage->shares_norm;
+}
+
+/* Check the results of fs_array_calc() against the tree walk */
+static bool _check_tree(slurmdb_assoc_rec_t *root,
+			slurmdb_assoc_rec_t *assoc, bool depth_oblivious)
+{
+	slurmdb_assoc_rec_t *child;
+	slurmdb_assoc_usage_t *usage;
+	ListIterator itr;
+	long double efctv, saved;
+	bool rc = true;
+
+	if (!assoc->usage->children_list)
+		return true;
+
+	itr = list_iterator_create(assoc->usage->children_list);
+	while (rc && (child = list_next(itr))) {
+		usage = child->usage;
+		saved = usage->usage_efctv;
+		usage->usage_norm = usage->usage_raw / root->usage->usage_raw;
+		efctv = _efctv(root, child, depth_oblivious);
+		if (fabsl(saved - efctv) > (1e-9 * fabsl(efctv) + 1e-15)) {
+			printf("assoc %d: usage_efctv %.15Lf, expected "
+			       "%.15Lf\n", (int)(child - assocs), saved, efctv);
+			rc = false;
+		}
+		/* Continue from the expected value */
+		usage->usage_efctv = efctv;
+		rc = rc && _check_tree(root, child, depth_oblivious);
+	}
+	list_iterator_destroy(itr);
+	return rc;
+}
+
+/* The tree walk in priority_multifactor.c replaced by fs_array_calc() */
+static void _tree_walk(slurmdb_assoc_rec_t *root,
+		       slurmdb_assoc_rec_t *assoc, bool depth_oblivious)
+{
+	slurmdb_assoc_rec_t *child;
+	slurmdb_assoc_usage_t *usage;
+	ListIterator itr;
+
+	itr = list_iterator_create(assoc->usage->children_list);
+	while ((child = list_next(itr))) {
+		usage = child->usage;
+		usage->usage_norm = usage->usage_raw / root->usage->usage_raw;
+		usage->usage_efctv = _efctv(root, child, depth_oblivious);
+		if (usage->shares_norm > 0)
+			usage->fs_factor = exp2(-(usage->usage_efctv /
+						  usage->shares_norm) /
+						DAMP_FACTOR);
+		else
+			usage->fs_factor = 0;
+		if (usage->children_list)
+			_tree_walk(root, child, depth_oblivious);
+	}
+	list_iterator_destroy(itr);
+}
+
+/* Time fs_array_build() and fs_array_calc() on a large association tree
+ * against the tree walk they replaced */
+static void _benchmark(void)
+{
+	slurmdb_assoc_rec_t *root, *acct, *sub_acct;
+	fs_array_t *fs_array;
+	int i, j, k, pass_cnt;
+	bool depth_oblivious;
+	DEF_TIMERS;
+
+	assocs = xmalloc(sizeof(slurmdb_assoc_rec_t) * BENCH_ASSOC_CNT);
+	assoc_cnt = 0;
+	srand(42);
+	root = _add_assoc(NULL, 1, NULL, 0);
+	for (i = 0; i < BENCH_ACCT_CNT; i++) {
+		acct = _add_assoc(root, 1 + (i % 7), NULL, 0);
+		for (j = 0; j < BENCH_SUB_ACCT_CNT; j++) {
+			sub_acct = _add_assoc(acct, 1 + (j % 3), NULL, 0);
+			for (k = 0; k < BENCH_USER_CNT; k++) {
+				_add_assoc(sub_acct,
+					   (k % 50) ? 1 + (k % 5) :
+					   SLURMDB_FS_USE_PARENT, "user",
+					   (k % 13) ? rand() % 1000000 : 0);
+			}
+		}
+	}
+	_set_shares(root);
+
+	START_TIMER;
+	fs_array = fs_array_create();
+	fs_array_build(fs_array, root);
+	END_TIMER;
+	TEST(fs_array->count == BENCH_ASSOC_CNT, "all associations in array");
+	printf("%u associations built in %ld usec\n",
+	       fs_array->count, DELTA_TIMER);
+
+	for (depth_oblivious = false; ; depth_oblivious = true) {
+		START_TIMER;
+		for (pass_cnt = 0; pass_cnt < BENCH_PASSES; pass_cnt++)
+			_tree_walk(root, root, depth_oblivious);
+		END_TIMER;
+		printf("%d tree walk passes in %ld usec\n",
+		       BENCH_PASSES, DELTA_TIMER);
+
+		START_TIMER;
+		for (pass_cnt = 0; pass_cnt < BENCH_PASSES; pass_cnt++)
+			fs_array_calc(fs_array, depth_oblivious, DAMP_FACTOR);
+		END_TIMER;
+		printf("%d flat array passes in %ld usec\n",
+		       BENCH_PASSES, DELTA_TIMER);
+		TEST(_check_tree(root, root, depth_oblivious),
+		     "flat array matches tree walk");
+		if (depth_oblivious)
+			break;
+	}
+
+	fs_array_destroy(fs_array);
+	xfree(assocs);
+}
+
+int
+main(int argc, char *argv[])
+{
+	slurmdb_assoc_rec_t *root, *acct_a, *acct_b, *acct_c, *sub_acct;
+	fs_array_t *fs_array;
+	bool parents_ok = true;
+	uint32_t i;
+
+	note("Testing flat association array creation");
+	assocs = xmalloc(sizeof(slurmdb_assoc_rec_t) * ASSOC_CNT);
+	/* FairShare=parent on users and on interior accounts */
+	root = _add_assoc(NULL, 1, NULL, 0);
+	acct_a = _add_assoc(root, 2, NULL, 0);
+	acct_b = _add_assoc(root, SLURMDB_FS_USE_PARENT, NULL, 0);
+	acct_c = _add_assoc(root, 3, NULL, 0);
+	_add_assoc(acct_a, 1, "a1", 100);
+	_add_assoc(acct_a, SLURMDB_FS_USE_PARENT, "a2", 300);
+	sub_acct = _add_assoc(acct_a, SLURMDB_FS_USE_PARENT, NULL, 0);
+	/* Its users are not siblings of acct_a's own children */
+	sub_acct->usage->children_list = list_create(NULL);
+	_add_assoc(sub_acct, 2, "x1", 500);
+	_add_assoc(sub_acct, 1, "x2", 50);
+	_add_assoc(acct_b, 1, "b1", 200);
+	_add_assoc(acct_b, 2, "b2", 0);
+	sub_acct = _add_assoc(acct_c, 1, NULL, 0);
+	_add_assoc(sub_acct, 1, "c1", 700);
+	_add_assoc(sub_acct, SLURMDB_FS_USE_PARENT, "c2", 10);
+	_add_assoc(sub_acct, 3, "c3", 40);
+	_add_assoc(acct_c, 2, "c4", 400);
+	_set_shares(root);
+
+	fs_array = fs_array_create();
+	fs_array_build(fs_array, root);
+	TEST(fs_array->count == (uint32_t) assoc_cnt, "all associations in array");
+	for (i = 1; i < fs_array->count; i++) {
+		if (fs_array->assoc[fs_array->parent[i]] !=
+		    fs_array->usage[i]->fs_assoc_ptr)
+			parents_ok = false;
+	}
+	TEST(parents_ok, "parents are the fair-share parents");
+
+	note("Testing classic algorithm");
+	fs_array_calc(fs_array, false, DAMP_FACTOR);
+	TEST(_check_tree(root, root, false), "flat array matches tree walk");
+
+	note("Testing depth oblivious algorithm");
+	fs_array_calc(fs_array, true, DAMP_FACTOR);
+	TEST(_check_tree(root, root, true), "flat array matches tree walk");
+
+	note("Testing usage changes");
+	assocs[assoc_cnt - 1].usage->usage_raw += 1000;
+	acct_c->usage->usage_raw += 1000;
+	root->usage->usage_raw += 1000;
+	fs_array_calc(fs_array, false, DAMP_FACTOR);
+	TEST(_check_tree(root, root, false), "flat array picks up new usage");
+	TEST(fabs(acct_b->usage->fs_factor -
+		  exp2(-(acct_b->usage->usage_efctv /
+			 acct_b->usage->shares_norm) / DAMP_FACTOR)) < 1e-9,
+	     "fair-share factor stored");
+
+	fs_array_destroy(fs_array);
+	xfree(assocs);
+
+	if (getenv("SLURM_UNIT_BENCHMARK")) {
+		note("Benchmarking flat association array");
+		_benchmark();
+	}
+
+	totals();
+	return failed;
+}
@@ -0,0 +1,206 @@
+/*****************************************************************************\
+ *  job-records-test.c - Test of the job record offsets noted when unpacking
+ *	job information and of the copy of the records matching a job filter
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <string.h>
+
+#include "slurm/slurm.h"
+#include "src/common/pack.h"
+#include "src/common/slurm_protocol_common.h"
+#include "src/common/slurm_protocol_defs.h"
+#include "src/common/slurm_protocol_pack.h"
+#include "src/common/xmalloc.h"
+
+/* dejagnu.h defines a wait() of its own, the slurm headers include
+ * sys/wait.h */
+#define wait dejagnu_wait
+#include <testsuite/dejagnu.h>
+#undef wait
+
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define JOB_CNT		3
+#define LAST_UPDATE	1500000000
+
+/* As slurmcached tests its jobs */
+static bool _job_match(job_info_t *job, void *arg)
+{
+	job_filter_args_t *args = (job_filter_args_t *) arg;
+
+	if (!job_filter_match(args, job->job_id, job->array_job_id,
+			      job->user_id, job->job_state, job->account))
+		return false;
+	if (args->part_cnt && !job_filter_part_match(args, job->partition))
+		return false;
+	return true;
+}
+
+/* Is the record of job inx of src next in buffer, ending at end */
+static bool _next_record(Buf buffer, uint32_t end, Buf src,
+			 uint32_t *offsets, int inx)
+{
+	uint32_t len = offsets[inx + 1] - offsets[inx];
+
+	if ((end - get_buf_offset(buffer)) < len)
+		return false;
+	if (memcmp(get_buf_data(buffer) + get_buf_offset(buffer),
+		   get_buf_data(src) + offsets[inx], len))
+		return false;
+	set_buf_offset(buffer, get_buf_offset(buffer) + len);
+	return true;
+}
+
+int
+main(int argc, char *argv[])
+{
+	job_info_msg_t *job_info = NULL;
+	job_info_t jobs[JOB_CNT];
+	uint32_t offsets[JOB_CNT + 1], *unpack_offsets = NULL;
+	uint32_t end, job_cnt, user_id;
+	job_info_filter_t filter;
+	job_filter_args_t args;
+	time_t last_update;
+	Buf src, buffer;
+	char name[32];
+	int i, rc;
+
+	note("Testing unpack of job information offsets");
+	buffer = init_buf(1024);
+	pack32(0, buffer);
+	pack_time(LAST_UPDATE, buffer);
+	set_buf_offset(buffer, 0);
+	rc = unpack_job_info_offsets(&job_info, &unpack_offsets, buffer,
+				     SLURM_PROTOCOL_VERSION);
+	TEST((rc == SLURM_SUCCESS) && job_info &&
+	     (job_info->record_count == 0) &&
+	     (job_info->last_update == LAST_UPDATE), "empty message unpacked");
+	TEST(unpack_offsets && (unpack_offsets[0] == get_buf_offset(buffer)),
+	     "offsets end at the end of the message");
+	slurm_free_job_info_msg(job_info);
+	xfree(unpack_offsets);
+
+	/* Header cut short, freeing unpacked job records would need the
+	 * select plugin */
+	free_buf(buffer);
+	buffer = create_buf(xmalloc(sizeof(uint32_t)), sizeof(uint32_t));
+	pack32(JOB_CNT, buffer);
+	set_buf_offset(buffer, 0);
+	rc = unpack_job_info_offsets(&job_info, &unpack_offsets, buffer,
+				     SLURM_PROTOCOL_VERSION);
+	TEST((rc != SLURM_SUCCESS) && !job_info && !unpack_offsets,
+	     "truncated message rejected and freed");
+	free_buf(buffer);
+
+	note("Testing copy of selected job records");
+	/* The records are copied as is, their content does not matter */
+	src = init_buf(1024);
+	pack32(JOB_CNT, src);
+	pack_time(LAST_UPDATE, src);
+	memset(jobs, 0, sizeof(jobs));
+	for (i = 0; i < JOB_CNT; i++) {
+		jobs[i].job_id = i + 1;
+		jobs[i].user_id = (i == 1) ? 200 : 100;
+		jobs[i].partition = (i == 0) ? "debug" : "batch,debug";
+		offsets[i] = get_buf_offset(src);
+		snprintf(name, sizeof(name), "job%d", i + 1);
+		packstr(name, src);
+		pack32(jobs[i].job_id, src);
+	}
+	offsets[JOB_CNT] = get_buf_offset(src);
+	job_info = xmalloc(sizeof(job_info_msg_t));
+	job_info->last_update = LAST_UPDATE;
+	job_info->record_count = JOB_CNT;
+	job_info->job_array = jobs;
+
+	memset(&filter, 0, sizeof(filter));
+	user_id = 100;
+	filter.user_id_cnt = 1;
+	filter.user_ids = &user_id;
+	job_filter_args_init(&args, &filter);
+	buffer = pack_job_info_records(job_info, src, offsets, _job_match,
+				       &args);
+	job_filter_args_free(&args);
+	end = get_buf_offset(buffer);
+	set_buf_offset(buffer, 0);
+	job_cnt = 0;
+	last_update = 0;
+	unpack32(&job_cnt, buffer);
+	unpack_time(&last_update, buffer);
+	TEST(job_cnt == 2, "record count of matching jobs");
+	TEST(last_update == LAST_UPDATE, "last update copied");
+	TEST(_next_record(buffer, end, src, offsets, 0) &&
+	     _next_record(buffer, end, src, offsets, 2) &&
+	     (get_buf_offset(buffer) == end), "matching records copied");
+	free_buf(buffer);
+
+	/* Any of a job's partitions matches, ignoring case */
+	filter.partitions = "BATCH";
+	job_filter_args_init(&args, &filter);
+	buffer = pack_job_info_records(job_info, src, offsets, _job_match,
+				       &args);
+	job_filter_args_free(&args);
+	end = get_buf_offset(buffer);
+	set_buf_offset(buffer, 0);
+	unpack32(&job_cnt, buffer);
+	unpack_time(&last_update, buffer);
+	TEST((job_cnt == 1) && _next_record(buffer, end, src, offsets, 2) &&
+	     (get_buf_offset(buffer) == end),
+	     "user and partition records copied");
+	free_buf(buffer);
+
+	user_id = 300;
+	filter.partitions = NULL;
+	job_filter_args_init(&args, &filter);
+	buffer = pack_job_info_records(job_info, src, offsets, _job_match,
+				       &args);
+	job_filter_args_free(&args);
+	end = get_buf_offset(buffer);
+	set_buf_offset(buffer, 0);
+	unpack32(&job_cnt, buffer);
+	unpack_time(&last_update, buffer);
+	TEST((job_cnt == 0) && (get_buf_offset(buffer) == end),
+	     "no records copied without a match");
+	free_buf(buffer);
+
+	xfree(job_info);
+	free_buf(src);
+	totals();
+	return failed;
+}
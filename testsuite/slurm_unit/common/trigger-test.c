@@ -0,0 +1,170 @@
+/*****************************************************************************\
+ *  trigger-test.c - Test of slurmctld's trigger state recovery, as done by
+ *	the backup controller each time it takes over
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "slurm/slurm.h"
+#include "src/common/read_config.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmctld/locks.h"
+#include "src/slurmctld/slurmctld.h"
+#include "src/slurmctld/state_save.h"
+#include "src/slurmctld/trigger_mgr.h"
+
+/* dejagnu.h defines a wait() of its own, the slurm headers include
+ * sys/wait.h */
+#define wait dejagnu_wait
+#include <testsuite/dejagnu.h>
+#undef wait
+
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define JOB_ID		1234
+
+/* The slurmctld symbols used by trigger_mgr.o */
+front_end_record_t *front_end_nodes = NULL;
+uint16_t front_end_node_cnt = 0;
+time_t last_job_update = (time_t) 0;
+
+static struct job_record job;
+static int find_cnt = 0;
+
+extern struct job_record *find_job_record(uint32_t job_id)
+{
+	find_cnt++;
+	if (job_id == job.job_id)
+		return &job;
+	return NULL;
+}
+
+extern void lock_slurmctld(slurmctld_lock_t lock_levels)
+{
+}
+
+extern void unlock_slurmctld(slurmctld_lock_t lock_levels)
+{
+}
+
+extern void lock_state_files(void)
+{
+}
+
+extern void unlock_state_files(void)
+{
+}
+
+extern void schedule_trigger_save(void)
+{
+}
+
+extern int fsync_and_close(int fd, char *file_type)
+{
+	return close(fd);
+}
+
+int
+main(int argc, char *argv[])
+{
+	trigger_info_msg_t msg, *trig_info;
+	trigger_info_t trig;
+	char dir[] = "/tmp/trigger-test.XXXXXX", *file;
+	int i, rc;
+
+	if (!mkdtemp(dir)) {
+		fail("mkdtemp");
+		totals();
+		return failed;
+	}
+	slurmctld_conf.state_save_location = dir;
+	slurmctld_conf.slurm_user_id = getuid();
+	slurmctld_conf.max_job_cnt = 100;
+
+	job.job_id = JOB_ID;
+	job.job_state = JOB_RUNNING;
+	job.end_time = time(NULL) + 3600;
+
+	note("Testing save of a job trigger");
+	memset(&trig, 0, sizeof(trigger_info_t));
+	trig.res_type = TRIGGER_RES_TYPE_JOB;
+	trig.res_id = xstrdup_printf("%u", JOB_ID);
+	trig.trig_type = TRIGGER_TYPE_FINI;
+	trig.offset = 0x8000;
+	trig.program = xstrdup("/bin/true");
+	msg.record_count = 1;
+	msg.trigger_array = &trig;
+	rc = trigger_set(getuid(), getgid(), &msg);
+	TEST(rc == SLURM_SUCCESS, "trigger set");
+	TEST(trigger_state_save() == 0, "trigger state saved");
+
+	/* The backup controller restores the state on every takeover, with
+	 * the triggers of the previous one still indexed */
+	note("Testing restore of the trigger state twice");
+	for (i = 0; i < 2; i++)
+		trigger_state_restore();
+	trig_info = trigger_get(getuid(), NULL);
+	TEST(trig_info->record_count == 1, "one trigger restored");
+	slurm_free_trigger_msg(trig_info);
+
+	/* The job's trigger is tested once per pass, a stale index entry
+	 * left by the first restore would be tested too */
+	find_cnt = 0;
+	last_job_update++;
+	trigger_process();
+	TEST(find_cnt == 1, "restored trigger tested once");
+
+	trigger_fini();
+	xfree(trig.res_id);
+	xfree(trig.program);
+	file = xstrdup_printf("%s/trigger_state", dir);
+	(void) unlink(file);
+	xstrcat(file, ".old");
+	(void) unlink(file);
+	xfree(file);
+	(void) rmdir(dir);
+
+	totals();
+	return failed;
+}
@@ -0,0 +1,199 @@
+/*****************************************************************************\
+ *  used-limits-test.c - Test of the QOS used limits lookups by user and
+ *	account in src/common/slurmdb_defs.c
+ *****************************************************************************
+ *  Copyright (C) 2017 SchedMD LLC.
+ *
+ *  This file is part of SLURM, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  SLURM is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  SLURM is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with SLURM; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "slurm/slurmdb.h"
+#include "src/common/list.h"
+#include "src/common/slurmdb_defs.h"
+#include "src/common/timers.h"
+#include "src/common/xmalloc.h"
+
+#include <testsuite/dejagnu.h>
+
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define USER_CNT	100
+#define ACCT_CNT	10
+#define TRES_CNT	4
+
+/* Sizes used when SLURM_UNIT_BENCHMARK is set */
+#define BENCH_USER_CNT	10000
+#define BENCH_ACCT_CNT	1000
+#define BENCH_PASSES	10
+
+static int _find_used_limits_for_user(void *x, void *key)
+{
+	slurmdb_used_limits_t *used_limits = (slurmdb_used_limits_t *)x;
+	uint32_t user_id = *(uint32_t *)key;
+
+	if (used_limits->uid == user_id)
+		return 1;
+
+	return 0;
+}
+
+/* Time hashed lookups on a large QOS against the linear search they
+ * replaced */
+static void _benchmark(void)
+{
+	slurmdb_qos_usage_t *usage = xmalloc(sizeof(slurmdb_qos_usage_t));
+	slurmdb_used_limits_t *used_limits, **user_recs;
+	char acct[32];
+	uint32_t uid;
+	bool same = true, linear_same = true;
+	int i, pass_cnt;
+	DEF_TIMERS;
+
+	user_recs = xmalloc(sizeof(slurmdb_used_limits_t *) * BENCH_USER_CNT);
+	START_TIMER;
+	for (uid = 0; uid < BENCH_USER_CNT; uid++) {
+		user_recs[uid] = slurmdb_get_user_used_limits(usage, uid,
+							      TRES_CNT);
+	}
+	for (i = 0; i < BENCH_ACCT_CNT; i++) {
+		snprintf(acct, sizeof(acct), "acct%d", i);
+		(void) slurmdb_get_acct_used_limits(usage, acct, TRES_CNT);
+	}
+	END_TIMER;
+	printf("%d user and %d account records created in %ld usec\n",
+	       BENCH_USER_CNT, BENCH_ACCT_CNT, DELTA_TIMER);
+
+	START_TIMER;
+	for (pass_cnt = 0; pass_cnt < BENCH_PASSES; pass_cnt++) {
+		for (uid = 0; uid < BENCH_USER_CNT; uid++) {
+			used_limits = slurmdb_get_user_used_limits(
+				usage, uid, TRES_CNT);
+			if (used_limits != user_recs[uid])
+				same = false;
+		}
+	}
+	END_TIMER;
+	TEST(same, "hashed user lookups return existing records");
+	printf("%d hashed user lookups in %ld usec\n",
+	       BENCH_USER_CNT * BENCH_PASSES, DELTA_TIMER);
+
+	START_TIMER;
+	for (uid = 0; uid < BENCH_USER_CNT; uid++) {
+		used_limits = list_find_first(usage->user_limit_list,
+					      _find_used_limits_for_user,
+					      &uid);
+		if (used_limits != user_recs[uid])
+			linear_same = false;
+	}
+	END_TIMER;
+	TEST(linear_same, "linear user lookups return existing records");
+	printf("%d linear user lookups in %ld usec\n",
+	       BENCH_USER_CNT, DELTA_TIMER);
+
+	xfree(user_recs);
+	slurmdb_destroy_qos_usage(usage);
+}
+
+int
+main(int argc, char *argv[])
+{
+	slurmdb_qos_usage_t *usage = xmalloc(sizeof(slurmdb_qos_usage_t));
+	slurmdb_used_limits_t *used_limits, *user_recs[USER_CNT], *extra;
+	char acct[32];
+	uint32_t uid;
+	bool same = true;
+	int i;
+
+	note("Testing user and account used limits creation");
+	for (uid = 0; uid < USER_CNT; uid++) {
+		user_recs[uid] = slurmdb_get_user_used_limits(usage, uid,
+							      TRES_CNT);
+		user_recs[uid]->jobs = uid;
+	}
+	for (i = 0; i < ACCT_CNT; i++) {
+		snprintf(acct, sizeof(acct), "acct%d", i);
+		used_limits = slurmdb_get_acct_used_limits(usage, acct,
+							   TRES_CNT);
+		used_limits->submit_jobs = i;
+	}
+	TEST(list_count(usage->user_limit_list) == USER_CNT,
+	     "user records created");
+	TEST(list_count(usage->acct_limit_list) == ACCT_CNT,
+	     "account records created");
+	TEST(user_recs[42]->tres && (user_recs[42]->uid == 42),
+	     "user record initialized");
+
+	note("Testing lookups of existing records");
+	for (uid = 0; uid < USER_CNT; uid++) {
+		used_limits = slurmdb_get_user_used_limits(usage, uid,
+							   TRES_CNT);
+		if ((used_limits != user_recs[uid]) ||
+		    (used_limits->jobs != uid))
+			same = false;
+	}
+	TEST(same, "user lookups return existing records");
+	TEST(list_count(usage->user_limit_list) == USER_CNT,
+	     "no duplicate user records");
+
+	snprintf(acct, sizeof(acct), "acct%d", ACCT_CNT - 1);
+	used_limits = slurmdb_get_acct_used_limits(usage, acct, TRES_CNT);
+	TEST(used_limits->submit_jobs == (ACCT_CNT - 1),
+	     "account lookup returns existing record");
+	TEST(list_count(usage->acct_limit_list) == ACCT_CNT,
+	     "no duplicate account records");
+
+	note("Testing records added to the list directly");
+	extra = xmalloc(sizeof(slurmdb_used_limits_t));
+	extra->uid = USER_CNT + 1;
+	list_append(usage->user_limit_list, extra);
+	used_limits = slurmdb_get_user_used_limits(usage, USER_CNT + 1,
+						   TRES_CNT);
+	TEST(used_limits == extra, "index picks up unindexed record");
+	TEST(list_count(usage->user_limit_list) == (USER_CNT + 1),
+	     "no duplicate of unindexed record");
+
+	slurmdb_destroy_qos_usage(usage);
+
+	if (getenv("SLURM_UNIT_BENCHMARK")) {
+		note("Benchmarking used limits lookups");
+		_benchmark();
+	}
+
+	totals();
+	return failed;
+}